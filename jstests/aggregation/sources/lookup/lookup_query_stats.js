@@ -22,7 +22,7 @@ testDB.dropDatabase();
 const localColl = testDB.getCollection("local");
 const fromColl = testDB.getCollection("foreign");
 const foreignDocCount = 10;
-const localDocCount = 2;
+const localDocCount = 5;
 
 const kExecutionStats = "executionStats";
 const kAllPlansExecution = "allPlansExecution";
@@ -91,11 +91,14 @@ let checkExplainOutputForVerLevel = function(explainOutput, expected, verbosityL
         assert(lkpStage.hasOwnProperty("indexesUsed"), lkpStage);
         assert(Array.isArray(lkpStage.indexesUsed), lkpStage);
         assert.eq(lkpStage.indexesUsed, expected.indexesUsed, lkpStage);
+        assert(lkpStage.hasOwnProperty("joinStrategy"), lkpStage);
+        assert.eq(lkpStage.joinStrategy, expected.joinStrategy, lkpStage);
     } else {  // If no `verbosityLevel` is passed or 'queryPlanner' is passed.
         assert(!lkpStage.hasOwnProperty("totalDocsExamined"), lkpStage);
         assert(!lkpStage.hasOwnProperty("totalKeysExamined"), lkpStage);
         assert(!lkpStage.hasOwnProperty("collectionScans"), lkpStage);
         assert(!lkpStage.hasOwnProperty("indexesUsed"), lkpStage);
+        assert(!lkpStage.hasOwnProperty("joinStrategy"), lkpStage);
     }
 };
 
@@ -117,31 +120,72 @@ let checkExplainOutputForAllVerbosityLevels = function(localColl, fromColl, expe
     checkExplainOutputForVerLevel(explainOutput, expectedExplainResult);
 };
 
+let expectedLookupOutput = function() {
+    let expectedOutput = [];
+    for (let i = 0; i < localDocCount; i++) {
+        expectedOutput.push({_id: i, localField: i, output: [{_id: i, foreignField: i}]});
+    }
+    return expectedOutput;
+};
+
 let testQueryExecutorStatsWithCollectionScan = function() {
     let output = doAggregationLookup(localColl, fromColl);
 
-    let expectedOutput = [
-        {_id: 0, localField: 0, output: [{_id: 0, foreignField: 0}]},
-        {_id: 1, localField: 1, output: [{_id: 1, foreignField: 1}]}
-    ];
-
-    assert.eq(output, expectedOutput);
+    assert.eq(output, expectedLookupOutput());
 
     let [curScannedObjects, curScannedKeys] = getCurrentQueryExecutorStats();
 
-    // For collection scan, total scannedObjects should be sum of
-    // (total documents in local collection +
-    //  total documents in local collection * total documents in foreign collection)
-    assert.eq(localDocCount + localDocCount * foreignDocCount, curScannedObjects);
+    // After the first local document is looked up with a collection scan, the remaining ones are
+    // joined against a hash table built by one more scan of the foreign collection. So total
+    // scannedObjects should be sum of
+    // (total documents in local collection + 2 * total documents in foreign collection)
+    assert.eq(localDocCount + 2 * foreignDocCount, curScannedObjects);
 
     // There is no index in the collection.
     assert.eq(0, curScannedKeys);
 
-    let expectedExplainResult =
-        {totalDocsExamined: 20, totalKeysExamined: 0, collectionScans: 4, indexesUsed: []};
+    let expectedExplainResult = {
+        totalDocsExamined: 20,
+        totalKeysExamined: 0,
+        collectionScans: 4,
+        indexesUsed: [],
+        joinStrategy: "hashJoin"
+    };
     checkExplainOutputForAllVerbosityLevels(localColl, fromColl, expectedExplainResult);
 };
 
+let testQueryExecutorStatsWithHashJoinOverMemoryLimit = function() {
+    const kMaxMemoryParam = "internalDocumentSourceLookupHashJoinMaxMemoryBytes";
+    const maxMemory =
+        assert.commandWorked(testDB.adminCommand({getParameter: 1, [kMaxMemoryParam]: 1}))
+            [kMaxMemoryParam];
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, [kMaxMemoryParam]: 1}));
+
+    try {
+        let output = doAggregationLookup(localColl, fromColl);
+        assert.eq(output, expectedLookupOutput());
+
+        let [curScannedObjects, curScannedKeys] = getCurrentQueryExecutorStats();
+
+        // The hash table does not fit, so every local document is looked up with a collection
+        // scan, and the abandoned hash table costs one more scan of the foreign collection.
+        assert.eq(localDocCount + localDocCount * foreignDocCount + foreignDocCount,
+                  curScannedObjects);
+        assert.eq(0, curScannedKeys);
+
+        let expectedExplainResult = {
+            totalDocsExamined: (localDocCount + 1) * foreignDocCount,
+            totalKeysExamined: 0,
+            collectionScans: 2 * (localDocCount + 1),
+            indexesUsed: [],
+            joinStrategy: "nestedLoopJoin"
+        };
+        checkExplainOutputForAllVerbosityLevels(localColl, fromColl, expectedExplainResult);
+    } finally {
+        assert.commandWorked(testDB.adminCommand({setParameter: 1, [kMaxMemoryParam]: maxMemory}));
+    }
+};
+
 let createIndexForCollection = function(collection, fieldName) {
     let request = {};
     request[fieldName] = 1;
@@ -153,12 +197,7 @@ let testQueryExecutorStatsWithIndexScan = function() {
 
     let output = doAggregationLookup(localColl, fromColl);
 
-    let expectedOutput = [
-        {_id: 0, localField: 0, output: [{_id: 0, foreignField: 0}]},
-        {_id: 1, localField: 1, output: [{_id: 1, foreignField: 1}]}
-    ];
-
-    assert.eq(output, expectedOutput);
+    assert.eq(output, expectedLookupOutput());
 
     let [curScannedObjects, curScannedKeys] = getCurrentQueryExecutorStats();
 
@@ -171,10 +210,11 @@ let testQueryExecutorStatsWithIndexScan = function() {
     assert.eq(localDocCount, curScannedKeys);
 
     let expectedExplainResult = {
-        totalDocsExamined: 2,
-        totalKeysExamined: 2,
+        totalDocsExamined: localDocCount,
+        totalKeysExamined: localDocCount,
         collectionScans: 0,
-        indexesUsed: ["foreignField_1"]
+        indexesUsed: ["foreignField_1"],
+        joinStrategy: "nestedLoopJoin"
     };
     checkExplainOutputForAllVerbosityLevels(localColl, fromColl, expectedExplainResult);
 };
@@ -187,5 +227,6 @@ insertDocumentToCollection(localColl, localDocCount, "localField");
 getCurrentQueryExecutorStats();
 
 testQueryExecutorStatsWithCollectionScan();
+testQueryExecutorStatsWithHashJoinOverMemoryLimit();
 testQueryExecutorStatsWithIndexScan();
 }());
@@ -1505,6 +1505,23 @@ var authCommandsLib = {
               },
           ]
         },
+        {
+          testname: "aggregate_queryStats",
+          command: {aggregate: 1, pipeline: [{$queryStats: {}}], cursor: {}},
+          skipSharded: true,
+          testcases: [
+              {
+                // The query shape statistics store is disabled by default, so the command fails
+                // once it is authorized.
+                runOnDb: adminDbName,
+                roles: roles_monitoring,
+                privileges: [{resource: {cluster: true}, actions: ["top"]}],
+                expectFail: true
+              },
+              {runOnDb: firstDbName, roles: {}},
+              {runOnDb: secondDbName, roles: {}}
+          ]
+        },
         {
           testname: "aggregate_currentOp_allUsers_true",
           command: {aggregate: 1, pipeline: [{$currentOp: {allUsers: true}}], cursor: {}},
@@ -4958,6 +4975,31 @@ var authCommandsLib = {
               },
           ]
         },
+        {
+          testname: "analyze",
+          command: {analyze: "x", key: "a"},
+          skipSharded: true,
+          setup: function(db) {
+              assert.writeOK(db.x.save({a: 1}));
+          },
+          teardown: function(db) {
+              db.x.drop();
+          },
+          testcases: [
+              {
+                runOnDb: firstDbName,
+                roles: roles_dbAdmin,
+                privileges:
+                    [{resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+              {
+                runOnDb: secondDbName,
+                roles: roles_dbAdminAny,
+                privileges:
+                    [{resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"]}],
+              },
+          ]
+        },
         {
           testname: "ping",
           command: {ping: 1},
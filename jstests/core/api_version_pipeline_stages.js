@@ -26,6 +26,7 @@ const unstablePipelines = [
     [{$listLocalSessions: {}}],
     [{$listSessions: {}}],
     [{$planCacheStats: {}}],
+    [{$queryStats: {}}],
     [{$unionWith: {coll: "coll2", pipeline: [{$collStats: {latencyStats: {}}}]}}],
     [{$lookup: {from: "coll2", pipeline: [{$indexStats: {}}]}}],
     [{$lookup: {from: "coll2", _internalCollation: {locale: "simple"}}}],
@@ -35,10 +35,13 @@ function checkUniqueIndexFormatVersion(adminDB) {
                                   .storageStats.indexDetails[index.name]
                                   .metadata.formatVersion;
                     if (index.v === 2) {
-                        assert.eq(
+                        // Format version 14 is used for unique indexes created with
+                        // wiredTigerCreateIndexesWithKeyStringV2 enabled.
+                        assert.contains(
                             ifv,
-                            12,
-                            "Expected index format version 12 for unique index: " + tojson(index));
+                            [12, 14],
+                            "Expected index format version 12 or 14 for unique index: " +
+                                tojson(index));
                     } else {
                         assert.eq(
                             ifv,
@@ -0,0 +1,97 @@
+/**
+ * Tests that the 'analyze' command builds histograms of the values of a field, and that the query
+ * planner uses them to prune candidate plans far more expensive than the cheapest one before
+ * multi-planning when internalQueryEnableCardinalityEstimation is set. The histograms are persisted
+ * and survive a restart.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage, getRejectedPlans and getWinningPlan.
+
+const setParameter = {internalQueryEnableCardinalityEstimation: true};
+let conn = MongoRunner.runMongod({setParameter: setParameter});
+assert.neq(null, conn, "mongod was unable to start up");
+
+let db = conn.getDB("test");
+let coll = db.cardinality_estimation;
+
+// Most documents share the same value of 'a', while every document has its own value of 'b'.
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({_id: i, a: i < 990 ? 1 : i, b: i});
+}
+assert.commandWorked(coll.insertMany(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+const query = {a: 995, b: {$gte: 0}};
+
+function explainQuery() {
+    return assert.commandWorked(coll.find(query).explain());
+}
+
+// Without statistics both indexes are tried out by the multi-planner.
+assert.eq(1, getRejectedPlans(explainQuery()).length);
+
+// Invalid arguments are rejected.
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName()}), 6179056);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), key: "a", sampleSize: 0}),
+                             6179057);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), key: "a", numBuckets: -1}),
+                             6179058);
+assert.commandFailedWithCode(db.runCommand({analyze: "nonexistent", key: "a"}),
+                             ErrorCodes.NamespaceNotFound);
+
+for (let key of ["a", "b"]) {
+    const res =
+        assert.commandWorked(db.runCommand({analyze: coll.getName(), key: key, numBuckets: 10}));
+    assert.eq(1000, res.numRecords, res);
+    assert.gt(res.numSampled, 0, res);
+    assert.lte(res.histogram.buckets.length, 10, res);
+    assert.lt(Math.abs(1000 - res.histogram.totalCount), 1e-6, res);
+}
+
+// With statistics the scan of the 'b' index is estimated to examine all documents, while the one of
+// the 'a' index only examines a few, so that only the latter is planned.
+let explain = explainQuery();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+assert.eq("a_1", getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN").indexName, explain);
+assert.eq(1, coll.find(query).itcount());
+
+// Queries with a sort are still multi-planned.
+explain = assert.commandWorked(coll.find(query).sort({_id: 1}).explain());
+assert.gt(getRejectedPlans(explain).length, 0, explain);
+
+// The statistics are persisted, keyed by the UUID of the collection.
+const collUUID = db.getCollectionInfos({name: coll.getName()})[0].info.uuid;
+const persisted = conn.getDB("local").system.collectionStatistics.findOne({_id: collUUID});
+assert.neq(null, persisted);
+assert.eq(1000, persisted.numRecords, persisted);
+assert.sameMembers(["a", "b"], persisted.histograms.map(entry => entry.key), persisted);
+
+// After a restart, they are read back the first time the query planner needs them.
+MongoRunner.stopMongod(conn);
+conn = MongoRunner.runMongod({dbpath: conn.dbpath, noCleanData: true, setParameter: setParameter});
+assert.neq(null, conn, "mongod was unable to restart");
+db = conn.getDB("test");
+coll = db.cardinality_estimation;
+
+explain = explainQuery();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+assert.eq("a_1", getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN").indexName, explain);
+
+// Analyzing another field keeps the persisted histograms of the others.
+assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "_id", numBuckets: 10}));
+assert.sameMembers(
+    ["_id", "a", "b"],
+    conn.getDB("local").system.collectionStatistics.findOne({_id: collUUID}).histograms.map(
+        entry => entry.key));
+
+// Disabling cardinality estimation restores multi-planning of all candidate plans.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryEnableCardinalityEstimation: false}));
+assert.eq(1, getRejectedPlans(explainQuery()).length);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,67 @@
+/**
+ * Tests index builds that generate the keys of their collection scan on several threads through
+ * the 'maxIndexBuildKeyGenerationThreads' server parameter.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+load("jstests/libs/fail_point_util.js");
+load("jstests/noPassthrough/libs/index_build.js");
+
+const conn = MongoRunner.runMongod({setParameter: {maxIndexBuildKeyGenerationThreads: 4}});
+
+const db = conn.getDB("test");
+const coll = db.getCollection("index_build_key_generation_threads");
+
+const numDocs = 20000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < numDocs; i++) {
+    bulk.insert({
+        a: numDocs - i,
+        b: i % 100,
+        c: (i % 7 == 0) ? [i, i + 1, i + 2] : i,
+        u: i,
+        s: "x".repeat(i % 50),
+        w: (i == numDocs - 1) ? 0 : i,
+    });
+}
+assert.commandWorked(bulk.execute());
+
+// The scan reports the number of key generation threads in its progress message.
+const fp = configureFailPoint(
+    conn, "hangIndexBuildDuringCollectionScanPhaseBeforeInsertion", {fieldsToMatch: {u: 100}});
+const awaitCreateIndex = IndexBuildTest.startIndexBuild(conn, coll.getFullName(), {a: 1});
+fp.wait();
+IndexBuildTest.waitForIndexBuildToStart(
+    db, coll.getName(), "a_1", {msg: /scanning collection \(generating keys on 4 threads\)/});
+fp.off();
+awaitCreateIndex();
+
+assert.commandWorked(coll.createIndexes([{b: 1, c: 1}, {u: 1}, {s: 1}]));
+assert.commandWorked(coll.createIndex({u: -1}, {unique: true}));
+
+// Every key generated by the worker threads made it into the indexes.
+const validateRes = assert.commandWorked(coll.validate({full: true}));
+assert(validateRes.valid, tojson(validateRes));
+for (let index of ["a_1", "b_1_c_1", "u_1", "s_1", "u_-1"]) {
+    assert.eq(numDocs, coll.find().hint(index).itcount(), index);
+}
+
+// The multikey state gathered by the worker threads is reflected in the catalog.
+const explain = coll.find({b: 1, c: 1}).hint({b: 1, c: 1}).explain();
+const ixscan = getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN");
+assert(ixscan.isMultiKey, tojson(explain));
+assert.eq({b: [], c: ["c"]}, ixscan.multiKeyPaths, tojson(explain));
+
+// Key generation errors raised on the worker threads still fail the index build.
+assert.commandWorked(coll.insert({a: [1, 2], c: [3, 4]}));
+assert.commandFailedWithCode(coll.createIndex({a: 1, c: 1}), ErrorCodes.CannotIndexParallelArrays);
+
+// Duplicate keys generated on different threads are detected.
+assert.commandFailedWithCode(coll.createIndex({w: 1}, {unique: true}), ErrorCodes.DuplicateKey);
+
+IndexBuildTest.assertIndexes(coll, 6, ["_id_", "a_1", "b_1_c_1", "u_1", "s_1", "u_-1"]);
+
+MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,79 @@
+/**
+ * Tests that when internalQueryPlannerEnableIndexSkipScan is set, a query on the second field of a
+ * compound index is answered by skip scanning the index across the values of its leading field,
+ * and that the 'analyze' histogram of the leading field keeps the planner from skip scanning when
+ * that field has too many distinct values.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage, getRejectedPlans and isCollscan.
+
+const conn = MongoRunner.runMongod({setParameter: {internalQueryPlannerEnableIndexSkipScan: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.index_skip_scan;
+
+// Few distinct values of 'region', many of 'ts'.
+const docs = [];
+for (let i = 0; i < 4000; ++i) {
+    docs.push({_id: i, region: i % 4, ts: Math.floor(i / 4), user: i});
+}
+assert.commandWorked(coll.insertMany(docs));
+assert.commandWorked(coll.createIndex({region: 1, ts: 1}));
+assert.commandWorked(coll.createIndex({user: 1, ts: 1}));
+
+function explainQuery(query) {
+    return assert.commandWorked(coll.find(query).explain("executionStats"));
+}
+
+// The skip scan wins over the collection scan, seeking past each of the four 'region' values.
+let explain = explainQuery({ts: 5});
+let ixscan = getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN");
+assert.neq(null, ixscan, explain);
+assert.eq("region_1_ts_1", ixscan.indexName, explain);
+assert.eq(["[MinKey, MaxKey]"], ixscan.indexBounds.region, explain);
+assert.eq(["[5.0, 5.0]"], ixscan.indexBounds.ts, explain);
+assert.eq(4, explain.executionStats.nReturned, explain);
+assert.lt(explain.executionStats.totalKeysExamined, 20, explain);
+
+// The results match those of a collection scan.
+for (let query of [{ts: 5}, {ts: {$gte: 10, $lt: 20}}, {ts: {$in: [1, 100, 999]}, _id: {$gt: 0}}]) {
+    assert.sameMembers(coll.find(query).hint({$natural: 1}).toArray(),
+                       coll.find(query).toArray(),
+                       tojson(query));
+}
+
+// Hinting the index skip scans it, rather than scanning all of it.
+explain = assert.commandWorked(
+    coll.find({ts: 5}).hint({region: 1, ts: 1}).explain("executionStats"));
+assert.eq(4, explain.executionStats.nReturned, explain);
+assert.lt(explain.executionStats.totalKeysExamined, 20, explain);
+
+// Once 'analyze' finds 'user' to have more distinct values than allowed, the 'user_1_ts_1' index is
+// no longer skip scanned, while the 'region_1_ts_1' one still is.
+assert.commandWorked(db.adminCommand({
+    setParameter: 1,
+    internalQueryEnableCardinalityEstimation: true,
+    internalQueryPlannerSkipScanMaxPrefixDistinctValues: 100
+}));
+for (let key of ["region", "user", "ts"]) {
+    assert.commandWorked(db.runCommand({analyze: coll.getName(), key: key}));
+}
+explain = explainQuery({ts: 5});
+const plans = [getWinningPlan(explain.queryPlanner)].concat(getRejectedPlans(explain));
+for (let plan of plans) {
+    const stage = getPlanStage(plan, "IXSCAN");
+    assert(!stage || stage.indexName === "region_1_ts_1", explain);
+}
+assert.eq(4, coll.find({ts: 5}).itcount());
+
+// Disabling skip scans falls back to a collection scan.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryPlannerEnableIndexSkipScan: false}));
+explain = explainQuery({ts: 5});
+assert(isCollscan(db, getWinningPlan(explain.queryPlanner)), explain);
+
+MongoRunner.stopMongod(conn);
+})();
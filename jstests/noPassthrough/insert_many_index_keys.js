@@ -0,0 +1,68 @@
+/**
+ * Tests that the keys of a batch of inserted documents, which are inserted into each index in key
+ * order, leave the indexes with the same entries and multikey paths as inserting one document at a
+ * time would.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+
+const conn = MongoRunner.runMongod();
+const db = conn.getDB("test");
+
+function getMultikeyPaths(coll, indexName) {
+    const explain = coll.find().hint(indexName).explain();
+    return getPlanStage(getWinningPlan(explain.queryPlanner), "IXSCAN").multiKeyPaths;
+}
+
+function populate(coll, batched) {
+    assert.commandWorked(coll.createIndexes([{a: 1, b: 1}, {c: 1}, {u: 1}], {}));
+    assert.commandWorked(coll.createIndex({w: 1}, {unique: true}));
+    assert.commandWorked(coll.createIndex({"$**": 1}, {name: "wildcard"}));
+
+    const docs = [];
+    for (let i = 0; i < 1000; i++) {
+        docs.push({
+            _id: i,
+            a: (i * 7919) % 1000,
+            // Only a few documents make 'b' and the wildcard index multikey.
+            b: (i % 250 == 3) ? [i, -i] : i % 10,
+            c: "c" + (i % 17),
+            u: 1000 - i,
+            w: i,
+        });
+    }
+    if (batched) {
+        assert.commandWorked(coll.insertMany(docs, {ordered: true}));
+    } else {
+        docs.forEach(doc => assert.commandWorked(coll.insert(doc)));
+    }
+}
+
+const batched = db.batched;
+const single = db.single;
+populate(batched, true);
+populate(single, false);
+
+assert.commandWorked(batched.validate({full: true}));
+for (let index of ["a_1_b_1", "c_1", "u_1", "w_1"]) {
+    assert.eq(single.find().hint(index).toArray(), batched.find().hint(index).toArray(), index);
+    assert.eq(getMultikeyPaths(single, index), getMultikeyPaths(batched, index), index);
+}
+assert.eq({a: [], b: ["b"]}, getMultikeyPaths(batched, "a_1_b_1"));
+assert.eq(single.find({b: {$gt: 0}}).hint("wildcard").itcount(),
+          batched.find({b: {$gt: 0}}).hint("wildcard").itcount());
+
+// A duplicate in the middle of a batch still fails the insert of that document only.
+const error = assert.throws(() => batched.insertMany(
+                                [{_id: 2000, w: 2000}, {_id: 2001, w: 5}, {_id: 2002, w: 2002}]));
+const writeErrors = error.getWriteErrors();
+assert.eq(1, writeErrors.length, tojson(error));
+assert.eq(ErrorCodes.DuplicateKey, writeErrors[0].code, tojson(error));
+assert.eq(1, writeErrors[0].index, tojson(error));
+assert.eq(1, batched.find({_id: 2000}).itcount());
+assert.eq(0, batched.find({_id: 2002}).itcount());
+
+MongoRunner.stopMongod(conn);
+})();
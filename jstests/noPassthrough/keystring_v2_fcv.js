@@ -0,0 +1,55 @@
+/**
+ * Tests that indexes are only created with KeyString V2 while the featureCompatibilityVersion is
+ * fully upgraded, and that downgrading the featureCompatibilityVersion fails while such indexes
+ * exist.
+ *
+ * @tags: [
+ *   requires_wiredtiger,
+ * ]
+ */
+(function() {
+"use strict";
+
+const conn =
+    MongoRunner.runMongod({setParameter: {wiredTigerCreateIndexesWithKeyStringV2: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const adminDB = conn.getDB("admin");
+const db = conn.getDB("test");
+const coll = db.keystring_v2_fcv;
+assert.commandWorked(coll.insert({_id: 0, a: new Date(), b: 1}));
+
+// Data formats 13 and 14 store keys in KeyString V2, 8 and 12 in KeyString V1.
+function indexFormatVersion(indexName) {
+    const stats = assert.commandWorked(db.runCommand({collStats: coll.getName()}));
+    return stats.indexDetails[indexName].metadata.formatVersion;
+}
+
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}, {unique: true}));
+assert.eq(13, indexFormatVersion("a_1"));
+assert.eq(14, indexFormatVersion("b_1"));
+
+// The downgrade fails, leaving the featureCompatibilityVersion in the downgrading state, until
+// the indexes using KeyString V2 have been recreated.
+assert.commandFailedWithCode(adminDB.runCommand({setFeatureCompatibilityVersion: lastLTSFCV}),
+                             ErrorCodes.CannotDowngrade);
+checkFCV(adminDB, lastLTSFCV, lastLTSFCV);
+
+assert.commandWorked(coll.dropIndexes(["a_1", "b_1"]));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}, {unique: true}));
+assert.eq(8, indexFormatVersion("a_1"));
+assert.eq(12, indexFormatVersion("b_1"));
+
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: lastLTSFCV}));
+checkFCV(adminDB, lastLTSFCV);
+
+// Indexes created after upgrading use KeyString V2 again.
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: latestFCV}));
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+assert.eq(13, indexFormatVersion("a_1_b_1"));
+assert.eq([{_id: 0}], coll.find({a: {$lte: new Date()}}, {_id: 1}).hint({a: 1, b: 1}).toArray());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,42 @@
+/**
+ * Tests that a secondary which has indexes storing their keys in KeyString V2 shuts down when it
+ * replicates the end of a featureCompatibilityVersion downgrade, rather than leaving indexes that
+ * the downgraded binary cannot open.
+ *
+ * @tags: [
+ *   requires_replication,
+ *   requires_wiredtiger,
+ * ]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({
+    nodes: [
+        {},
+        {rsConfig: {priority: 0}},
+        {
+            rsConfig: {priority: 0},
+            setParameter: {wiredTigerCreateIndexesWithKeyStringV2: true},
+        },
+    ]
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const adminDB = primary.getDB("admin");
+const coll = primary.getDB("test").keystring_v2_fcv_secondary;
+assert.commandWorked(coll.insert({_id: 0, a: new Date()}));
+assert.commandWorked(coll.createIndex({a: 1}));
+rst.awaitReplication();
+
+// Only the third node created the index with KeyString V2, so the primary lets the downgrade
+// through, and the third node shuts down when it replicates its end.
+assert.commandWorked(adminDB.runCommand({setFeatureCompatibilityVersion: lastLTSFCV}));
+assert.soon(() => rawMongoProgramOutput().search(/6179069/) >= 0);
+rst.stop(2, undefined, {allowedExitCode: MongoRunner.EXIT_ABRUPT});
+
+checkFCV(adminDB, lastLTSFCV);
+rst.stopSet();
+})();
@@ -0,0 +1,143 @@
+/**
+ * Tests that a $group reading directly from a collection returns the same results whether or not it
+ * is split across threads by 'internalDocumentSourceGroupParallelism'.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getAggPlanStage.
+
+// Keep the $group in the classic aggregation pipeline rather than pushing it down into SBE.
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalDocumentSourceGroupParallelism: 4,
+        internalQueryEnableSlotBasedExecutionEngine: false
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.parallel_group;
+
+const kNumDocs = 20000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 13, b: i % 5, c: i, padding: "x".repeat(64)});
+}
+assert.commandWorked(coll.insertMany(docs));
+
+const pipelines = [
+    [{$group: {_id: null, count: {$sum: 1}}}],
+    [{
+        $group: {
+            _id: "$a",
+            count: {$sum: 1},
+            total: {$sum: "$c"},
+            avg: {$avg: "$c"},
+            min: {$min: "$c"},
+            max: {$max: "$c"},
+            bs: {$addToSet: "$b"},
+            stdDevPop: {$stdDevPop: "$c"},
+            stdDevSamp: {$stdDevSamp: "$c"}
+        }
+    }],
+    [{$match: {b: {$gt: 1}}}, {$group: {_id: {a: "$a", b: "$b"}, count: {$sum: 1}}}],
+    [{$group: {_id: "$c", count: {$sum: 1}}}, {$match: {count: {$ne: 1}}}],
+    // $push depends on the order of its input, so it is never split across threads.
+    [{$sort: {c: 1}}, {$group: {_id: "$a", cs: {$push: "$c"}}}],
+];
+
+function runPipelines(options) {
+    return pipelines.map(pipeline => coll.aggregate(pipeline, options).toArray().sort((x, y) => {
+        return bsonWoCompare({_id: x._id}, {_id: y._id});
+    }));
+}
+
+function setParallelism(parallelism) {
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalDocumentSourceGroupParallelism: parallelism}));
+}
+
+function numParallelExecutions() {
+    return db.serverStatus().metrics.query.group.parallelExecutions;
+}
+
+// Every pipeline but the one using $push is split across threads.
+let executionsBefore = numParallelExecutions();
+const parallelResults = runPipelines({});
+assert.eq(pipelines.length - 1, numParallelExecutions() - executionsBefore);
+
+// Force every partial $group to spill to disk.
+const previousMaxMemory =
+    assert
+        .commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: 1024}))
+        .was;
+const parallelResultsWithSpilling = runPipelines({allowDiskUse: true});
+
+// The partial groups share the memory budget of the $group they replace. Every partial group sees
+// all the groups here, so a budget the $group would fit in on a single thread is exceeded by them.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: previousMaxMemory}));
+const kNumGroups = 100;
+const groupPerC = [{$group: {_id: {$mod: ["$c", kNumGroups]}, count: {$sum: 1}}}];
+const groupStage = getAggPlanStage(coll.explain("executionStats").aggregate(groupPerC), "$group");
+const groupMemory = groupStage.maxAccumulatorMemoryUsageBytes.count;
+assert.commandWorked(db.adminCommand({
+    setParameter: 1,
+    internalDocumentSourceGroupMaxMemoryBytes: 2 * groupMemory + 64 * kNumGroups
+}));
+executionsBefore = numParallelExecutions();
+assert.commandFailedWithCode(
+    db.runCommand({aggregate: coll.getName(), pipeline: groupPerC, cursor: {}}),
+    ErrorCodes.QueryExceededMemoryLimitNoDiskUseAllowed);
+assert.eq(1, numParallelExecutions() - executionsBefore);
+assert.eq(kNumGroups, coll.aggregate(groupPerC, {allowDiskUse: true}).itcount());
+setParallelism(1);
+assert.eq(kNumGroups, coll.aggregate(groupPerC).itcount());
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: previousMaxMemory}));
+
+executionsBefore = numParallelExecutions();
+const serialResults = runPipelines({});
+assert.eq(0, numParallelExecutions() - executionsBefore);
+
+for (let i = 0; i < pipelines.length; ++i) {
+    assert.eq(serialResults[i].length, parallelResults[i].length, pipelines[i]);
+    for (let j = 0; j < serialResults[i].length; ++j) {
+        const serial = serialResults[i][j];
+        for (let result of [parallelResults[i][j], parallelResultsWithSpilling[i][j]]) {
+            assert.eq(serial._id, result._id, pipelines[i]);
+            for (let field of Object.keys(serial)) {
+                if (field === "bs") {
+                    assert.sameMembers(serial[field], result[field], pipelines[i]);
+                } else if (typeof serial[field] === "number" && !Number.isInteger(serial[field])) {
+                    assert.close(serial[field], result[field], pipelines[i]);
+                } else {
+                    assert.eq(serial[field], result[field], pipelines[i]);
+                }
+            }
+        }
+    }
+}
+
+// An error in the split $group is reported to the client.
+setParallelism(4);
+const divideByZero = {$divide: ["$c", {$subtract: ["$c", 7]}]};
+const failingPipeline = [{$group: {_id: "$a", bs: {$addToSet: divideByZero}}}];
+assert.commandFailedWithCode(
+    db.runCommand({aggregate: coll.getName(), pipeline: failingPipeline, cursor: {}}),
+    ErrorCodes.BadValue);
+
+// The plan summary still reports how the collection was read.
+const profileDb = db.getSiblingDB("profile_db");
+const profileColl = profileDb.coll;
+assert.commandWorked(profileColl.insert({a: 1}));
+assert.commandWorked(profileDb.setProfilingLevel(2));
+assert.eq(1, profileColl.aggregate([{$group: {_id: "$a", n: {$sum: 1}}}]).itcount());
+const profileEntry = profileDb.system.profile.findOne({op: "command", "command.aggregate": "coll"});
+assert.eq("COLLSCAN", profileEntry.planSummary, profileEntry);
+assert.commandWorked(profileDb.setProfilingLevel(0));
+
+MongoRunner.stopMongod(conn);
+}());
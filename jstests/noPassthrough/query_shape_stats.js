@@ -0,0 +1,94 @@
+/**
+ * Tests that the query shape statistics store aggregates the execution statistics of queries by
+ * shape, attributing getMores to the shape of the query which created the cursor, and that the
+ * statistics can be read through the $queryStats aggregation stage.
+ */
+(function() {
+"use strict";
+
+// The store is disabled by default.
+let conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+assert.commandFailedWithCode(
+    conn.adminCommand({aggregate: 1, pipeline: [{$queryStats: {}}], cursor: {}}), 6179061);
+MongoRunner.stopMongod(conn);
+
+conn = MongoRunner.runMongod({setParameter: {internalQueryShapeStatsMaxEntries: 100}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.query_shape_stats;
+const otherColl = db.query_shape_stats_other;
+
+const docs = [];
+for (let i = 0; i < 100; ++i) {
+    docs.push({_id: i, a: i % 10, b: i});
+}
+assert.commandWorked(coll.insertMany(docs));
+assert.commandWorked(otherColl.insertMany(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+// $queryStats must be run against the 'admin' database with {aggregate: 1}.
+assert.commandFailedWithCode(
+    db.runCommand({aggregate: 1, pipeline: [{$queryStats: {}}], cursor: {}}),
+    ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(
+    db.runCommand({aggregate: coll.getName(), pipeline: [{$queryStats: {}}], cursor: {}}),
+    ErrorCodes.InvalidNamespace);
+
+function getQueryStats(ns) {
+    return db.getSiblingDB("admin")
+        .aggregate([{$queryStats: {}}, {$match: {ns: ns}}, {$sort: {execCount: -1}}])
+        .toArray();
+}
+
+// Queries of the same shape with different constants are aggregated into a single entry. Each
+// query returns ten documents in batches of three, so it is followed by three getMores.
+const numQueries = 5;
+for (let i = 0; i < numQueries; ++i) {
+    assert.eq(10, coll.find({a: 3, b: {$gte: 0}}).batchSize(3).itcount());
+}
+assert.eq(0, coll.find({b: {$lt: 0}}).itcount());
+assert.eq(10, otherColl.find({a: 3}).itcount());
+
+let stats = getQueryStats(coll.getFullName());
+assert.eq(2, stats.length, tojson(stats));
+
+const entry = stats[0];
+assert.eq(numQueries, entry.execCount, tojson(entry));
+assert.eq(3 * numQueries, entry.getMoreCount, tojson(entry));
+assert.eq(10 * numQueries, entry.nReturned, tojson(entry));
+assert.gte(entry.docsExamined, 10 * numQueries, tojson(entry));
+assert.gte(entry.keysExamined, 10 * numQueries, tojson(entry));
+assert.gte(entry.totalExecMicros, 0, tojson(entry));
+// The shape of the query is reported without the constants it was run with.
+assert.eq({a: "?double", b: {$gte: "?double"}}, entry.shape.query, tojson(entry));
+assert.eq(conn.host, entry.host, tojson(entry));
+
+// Every operation falls into one of the latency buckets.
+assert.eq(4 * numQueries,
+          entry.latencyHistogram.reduce((sum, bucket) => sum + bucket.count, 0),
+          tojson(entry));
+
+// The query was multi-planned until the plan cache entry became active, after which it used the
+// cached plan.
+assert.gte(entry.planCacheHits, 1, tojson(entry));
+assert.lt(entry.planCacheHits, numQueries, tojson(entry));
+
+// The query hash is the one of the plan cache entry for the shape.
+const planCacheEntries = coll.aggregate([{$planCacheStats: {}}]).toArray();
+assert.eq(1, planCacheEntries.length, tojson(planCacheEntries));
+assert.eq(planCacheEntries[0].queryHash, entry.queryHash, tojson(entry));
+
+assert.eq(1, stats[1].execCount, tojson(stats[1]));
+assert.eq(0, stats[1].nReturned, tojson(stats[1]));
+
+stats = getQueryStats(otherColl.getFullName());
+assert.eq(1, stats.length, tojson(stats));
+assert.eq(1, stats[0].execCount, tojson(stats[0]));
+assert.eq(10, stats[0].nReturned, tojson(stats[0]));
+assert.eq(0, stats[0].planCacheHits, tojson(stats[0]));
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,179 @@
+/**
+ * Tests that a full collection scan in SBE can be split across several threads when
+ * 'internalQuerySBEParallelCollectionScanDegree' is greater than 1, and that such a scan returns
+ * the same documents as a serial one.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+// The worker pool has threads for only one parallel scan at a time.
+const conn = MongoRunner.runMongod({
+    setParameter:
+        {internalQuerySBEParallelCollectionScanDegree: 4, internalQueryWorkerPoolMaxThreads: 6}
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+if (!checkSBEEnabled(db)) {
+    jsTestLog("Skipping test because the SBE engine is not enabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = db.sbe_parallel_collection_scan;
+
+// The scan is split into one range per ten thousand or so records, so insert enough documents for
+// several ranges.
+const kNumDocs = 50000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 7, padding: "x".repeat(16)});
+}
+assert.commandWorked(coll.insertMany(docs));
+
+function sortedIds(cursor) {
+    return cursor.map(doc => doc._id).sort((a, b) => a - b);
+}
+
+function usesParallelScan(explain) {
+    return getPlanStages(explain.executionStats.executionStages, "exchange").length > 0;
+}
+
+// An unfiltered scan returns every document exactly once.
+let explain = coll.find().explain("executionStats");
+assert(usesParallelScan(explain), explain);
+assert.eq(kNumDocs, explain.executionStats.nReturned, explain);
+assert.eq(Array.from({length: kNumDocs}, (_, i) => i), sortedIds(coll.find({}, {_id: 1})));
+
+// The filter is applied by the scanning threads.
+const expectedFilteredIds = [];
+for (let i = 0; i < kNumDocs; i += 7) {
+    expectedFilteredIds.push(i);
+}
+explain = coll.find({a: 0}).explain("executionStats");
+assert(usesParallelScan(explain), explain);
+assert.eq(expectedFilteredIds.length, explain.executionStats.nReturned, explain);
+assert.eq(expectedFilteredIds, sortedIds(coll.find({a: 0}, {_id: 1})));
+assert.eq(kNumDocs / 7 | 0, coll.find({a: 6}).itcount());
+
+// A limit stops the scanning threads early.
+assert.eq(10, coll.find({a: 3}).limit(10).itcount());
+
+// Aggregations over a collection scan run in parallel as well.
+assert.eq([{_id: null, count: kNumDocs}],
+          coll.aggregate([{$group: {_id: null, count: {$sum: 1}}}]).toArray());
+
+// A $natural hint asks for the documents in natural order, which a parallel scan does not keep.
+explain = coll.find().hint({$natural: 1}).explain("executionStats");
+assert(!usesParallelScan(explain), explain);
+const naturalOrderIds = coll.find({}, {_id: 1}).hint({$natural: 1}).map(doc => doc._id);
+assert.eq(Array.from({length: kNumDocs}, (_, i) => i), naturalOrderIds);
+
+// The scanning threads only run while the query does. Between getMores they hold no locks, cursors
+// or threads, and carry on where they left off on the next getMore.
+const kProducerDesc = /^QueryWorker/;
+function numActiveProducers() {
+    return db.getSiblingDB("admin")
+        .aggregate(
+            [{$currentOp: {allUsers: true, localOps: true}}, {$match: {desc: kProducerDesc}}])
+        .itcount();
+}
+
+let cursor = coll.find({}, {_id: 1}).batchSize(100);
+assert(cursor.hasNext());
+assert.eq(0, numActiveProducers());
+assert.commandWorked(
+    db.runCommand({collMod: coll.getName(), validationLevel: "moderate", maxTimeMS: 10 * 1000}));
+assert.eq(Array.from({length: kNumDocs}, (_, i) => i), sortedIds(cursor));
+
+// The scanning threads are paused whenever the query yields.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryExecYieldIterations: 10}));
+explain = coll.find({a: 0}).explain("executionStats");
+assert(usesParallelScan(explain), explain);
+const exchangeStage = getPlanStages(explain.executionStats.executionStages, "exchange")[0];
+assert.gt(exchangeStage.saveState, 0, explain);
+assert.eq(expectedFilteredIds.length, explain.executionStats.nReturned, explain);
+assert.eq(expectedFilteredIds, sortedIds(coll.find({a: 0}, {_id: 1})));
+
+/**
+ * Starts a parallel scan which hangs in its first yield, runs 'interruptFn' with the operation id
+ * of the scan while it is hanging, and checks that the scan fails with 'expectedCode'.
+ */
+function testInterruptedScan(interruptFn, expectedCode) {
+    const kComment = "parallel scan " + expectedCode;
+    assert.commandWorked(db.adminCommand({
+        configureFailPoint: "setYieldAllLocksHang",
+        mode: "alwaysOn",
+        data: {namespace: coll.getFullName(), checkForInterruptAfterHang: true}
+    }));
+
+    const awaitScan = startParallelShell(
+        funWithArgs(function(collName, comment, expectedCode) {
+            assert.commandFailedWithCode(db.runCommand({
+                aggregate: collName,
+                pipeline: [{$group: {_id: null, count: {$sum: 1}}}],
+                cursor: {},
+                comment: comment
+            }),
+                                         expectedCode);
+        }, coll.getName(), kComment, expectedCode), conn.port);
+
+    let opId;
+    assert.soon(() => {
+        const ops = db.getSiblingDB("admin")
+                        .aggregate([
+                            {$currentOp: {allUsers: true, localOps: true}},
+                            {$match: {"command.comment": kComment, numYields: {$gt: 0}}}
+                        ])
+                        .toArray();
+        if (ops.length > 0) {
+            opId = ops[0].opid;
+            return true;
+        }
+        return false;
+    });
+
+    // The scanning threads are paused while the query is hanging in a yield.
+    assert.eq(0, numActiveProducers());
+
+    interruptFn(opId);
+    assert.commandWorked(
+        db.adminCommand({configureFailPoint: "setYieldAllLocksHang", mode: "off"}));
+    awaitScan();
+    assert.soon(() => numActiveProducers() == 0);
+}
+
+load("jstests/libs/parallel_shell_helpers.js");  // For funWithArgs.
+
+// Killing the query stops its scanning threads.
+testInterruptedScan(opId => assert.commandWorked(db.killOp(opId)), ErrorCodes.Interrupted);
+
+// A collection dropped while the query yields fails the query once the scanning threads resume.
+testInterruptedScan(() => assert(coll.drop()), ErrorCodes.QueryPlanKilled);
+
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryExecYieldIterations: 128}));
+assert.commandWorked(coll.insertMany(docs));
+
+// An open cursor keeps the threads of its scan, so that other scans stay on their own thread until
+// it is closed.
+cursor = coll.find({}, {_id: 1}).batchSize(100);
+assert(cursor.hasNext());
+explain = coll.find().explain("executionStats");
+assert(!usesParallelScan(explain), explain);
+assert.eq(kNumDocs, coll.find().itcount());
+cursor.close();
+explain = coll.find().explain("executionStats");
+assert(usesParallelScan(explain), explain);
+
+// A degree of 1 disables the parallel scan.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQuerySBEParallelCollectionScanDegree: 1}));
+explain = coll.find().explain("executionStats");
+assert(!usesParallelScan(explain), explain);
+assert.eq(kNumDocs, explain.executionStats.nReturned, explain);
+
+MongoRunner.stopMongod(conn);
+}());
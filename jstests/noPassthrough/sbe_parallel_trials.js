@@ -0,0 +1,120 @@
+/**
+ * Tests that the SBE multi-planner trials candidate plans concurrently on worker threads when
+ * internalQueryPlanEvaluationMaxParallelTrials allows, and that the plans it picks that way return
+ * the same documents as a collection scan.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");            // For getRejectedPlans.
+load("jstests/libs/fail_point_util.js");         // For configureFailPoint.
+load("jstests/libs/parallel_shell_helpers.js");  // For funWithArgs.
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQueryPlanEvaluationMaxParallelTrials: 8,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_parallel_trials;
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({_id: i, a: i % 10, b: i % 7, c: i % 5});
+}
+assert.commandWorked(coll.insertMany(docs));
+for (let key of ["a", "b", "c"]) {
+    assert.commandWorked(coll.createIndex({[key]: 1}));
+}
+
+function parallelTrialMetrics() {
+    return db.serverStatus().metrics.query.multiPlanner;
+}
+
+function sortedIds(cursor) {
+    return cursor.map(doc => doc._id).sort((a, b) => a - b);
+}
+
+const queries = [
+    {filter: {a: 1, b: 2, c: 3}},
+    {filter: {a: {$gte: 5}, b: {$in: [1, 2]}, c: {$lt: 2}}},
+    {filter: {a: 3, b: 4, c: {$gte: 0}}, sort: {_id: -1}, limit: 5},
+];
+
+// Hinted queries have a single candidate plan, so they are not multi-planned.
+function runQuery(query, hint) {
+    let cursor = coll.find(query.filter);
+    if (hint) {
+        cursor = cursor.hint(hint);
+    }
+    if (query.sort) {
+        cursor = cursor.sort(query.sort);
+    }
+    if (query.limit) {
+        cursor = cursor.limit(query.limit);
+    }
+    return query.sort ? cursor.toArray().map(doc => doc._id) : sortedIds(cursor);
+}
+
+function expectedIds(query) {
+    return runQuery(query, {$natural: 1});
+}
+
+for (let query of queries) {
+    const expected = expectedIds(query);
+
+    // Clear the plan cache so that the query is multi-planned.
+    assert.commandWorked(coll.runCommand("planCacheClear"));
+    const before = parallelTrialMetrics();
+    assert.eq(expected, runQuery(query), query);
+    const after = parallelTrialMetrics();
+    assert.eq(before.parallelTrials + 1, after.parallelTrials, {before: before, after: after});
+    assert.eq(before.parallelTrialsAbandoned,
+              after.parallelTrialsAbandoned,
+              {before: before, after: after});
+
+    // Explain reports the plans trialed concurrently like the ones trialed in turn.
+    const explain = assert.commandWorked(coll.find(query.filter).explain("allPlansExecution"));
+    assert.gt(getRejectedPlans(explain).length, 0, explain);
+}
+
+// Killing the planning operation stops the worker threads trialing its candidate plans.
+const kComment = "parallel trial killOp";
+const hangFp = configureFailPoint(conn, "hangDuringParallelTrial");
+assert.commandWorked(coll.runCommand("planCacheClear"));
+const awaitQuery = startParallelShell(
+    funWithArgs(function(collName, filter, comment) {
+        assert.commandFailedWithCode(
+            db.runCommand({find: collName, filter: filter, comment: comment}),
+            ErrorCodes.Interrupted);
+    }, coll.getName(), queries[0].filter, kComment), conn.port);
+hangFp.wait();
+const ops = db.getSiblingDB("admin")
+                .aggregate([
+                    {$currentOp: {allUsers: true, localOps: true}},
+                    {$match: {"command.comment": kComment}}
+                ])
+                .toArray();
+assert.eq(1, ops.length, ops);
+assert.commandWorked(db.killOp(ops[0].opid));
+awaitQuery();
+hangFp.off();
+
+// The query runs and trials its candidate plans concurrently again.
+assert.commandWorked(coll.runCommand("planCacheClear"));
+const beforeKill = parallelTrialMetrics();
+assert.eq(expectedIds(queries[0]), runQuery(queries[0]));
+assert.eq(beforeKill.parallelTrials + 1, parallelTrialMetrics().parallelTrials);
+
+// Queries with more candidate plans than allowed are trialed in turn.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryPlanEvaluationMaxParallelTrials: 2}));
+assert.commandWorked(coll.runCommand("planCacheClear"));
+const before = parallelTrialMetrics();
+assert.eq(expectedIds(queries[0]), runQuery(queries[0]));
+assert.docEq(before, parallelTrialMetrics());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,88 @@
+/**
+ * Tests that SBE queries of the same shape reuse the plan tree cached for that shape, with the
+ * index bounds of each query bound into the cloned tree, and that the cached trees stop being used
+ * once the indexes of the collection change.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/sbe_util.js");  // For checkSBEEnabled.
+
+const conn =
+    MongoRunner.runMongod({setParameter: {internalQuerySlotBasedPlanTreeCacheMaxEntries: 100}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+if (!checkSBEEnabled(db)) {
+    jsTestLog("Skipping test because the SBE engine is not enabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = db.sbe_plan_tree_cache;
+const docs = [];
+for (let i = 0; i < 100; ++i) {
+    docs.push({_id: i, a: i, b: i % 10});
+}
+assert.commandWorked(coll.insertMany(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+
+function planTreeCacheMetrics() {
+    return db.serverStatus().metrics.query.planTreeCache;
+}
+
+function sortedIds(cursor) {
+    return cursor.map(doc => doc._id).sort((a, b) => a - b);
+}
+
+// Point lookups, $in lookups with differing numbers of values and ranges of the same shapes must
+// return the same documents whether their plan tree is built or cloned from the cache.
+const before = planTreeCacheMetrics();
+for (let i = 0; i < 10; ++i) {
+    assert.eq([i], sortedIds(coll.find({a: i})));
+    assert.eq([i], sortedIds(coll.find({a: i}, {_id: 1, a: 1})));
+    assert.eq([i, i + 1, i + 2].slice(0, i % 3 + 1),
+              sortedIds(coll.find({a: {$in: [i, i + 1, i + 2].slice(0, i % 3 + 1)}})));
+    assert.eq([i, i + 1, i + 2, i + 3], sortedIds(coll.find({a: {$gte: i, $lt: i + 4}})));
+}
+const after = planTreeCacheMetrics();
+assert.gt(after.hits, before.hits, tojson({before: before, after: after}));
+
+// Queries with a residual filter are not parameterized and hence never served from the cache.
+const beforeFilter = planTreeCacheMetrics();
+for (let i = 0; i < 10; ++i) {
+    assert.eq([i], sortedIds(coll.find({a: i, b: i % 10})));
+}
+assert.eq(beforeFilter, planTreeCacheMetrics());
+
+// The size of the cache can be changed at runtime, and a size of zero disables and empties it.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQuerySlotBasedPlanTreeCacheMaxEntries: 0}));
+const beforeDisabled = planTreeCacheMetrics();
+for (let i = 0; i < 10; ++i) {
+    assert.eq([i], sortedIds(coll.find({a: i})));
+}
+assert.eq(beforeDisabled, planTreeCacheMetrics());
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQuerySlotBasedPlanTreeCacheMaxEntries: 100}));
+
+// The tree cached for this shape before the cache was disabled is gone, so the first query misses.
+assert.eq([0], sortedIds(coll.find({a: 0})));
+const afterReenabled = planTreeCacheMetrics();
+assert.eq(beforeDisabled.hits, afterReenabled.hits);
+assert.eq(beforeDisabled.misses + 1, afterReenabled.misses);
+for (let i = 1; i < 10; ++i) {
+    assert.eq([i], sortedIds(coll.find({a: i})));
+}
+assert.gt(planTreeCacheMetrics().hits, afterReenabled.hits);
+
+// Once the index is rebuilt the cached trees are stale, but queries still return correct results.
+assert.commandWorked(coll.dropIndex({a: 1}));
+assert.commandWorked(coll.createIndex({a: -1}));
+for (let i = 0; i < 10; ++i) {
+    assert.eq([i], sortedIds(coll.find({a: i})));
+    assert.eq([i, i + 1, i + 2, i + 3], sortedIds(coll.find({a: {$gte: i, $lt: i + 4}})));
+}
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,62 @@
+/**
+ * Tests that the data spilled by a blocking sort is compressed with the codec named by the
+ * 'sorterSpillCompressor' server parameter, and accounted for in the 'sorter.spill' metrics.
+ */
+(function() {
+"use strict";
+
+assert.eq(null,
+          MongoRunner.runMongod({setParameter: {sorterSpillCompressor: "lz4"}}),
+          "mongod started with an unknown spill compressor");
+
+function getSpillMetrics(db) {
+    return db.serverStatus().metrics.sorter.spill;
+}
+
+function runSpillingSort(compressor) {
+    const conn = MongoRunner.runMongod({
+        setParameter: {
+            sorterSpillCompressor: compressor,
+            internalQueryMaxBlockingSortMemoryUsageBytes: 1024 * 1024
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+    const db = conn.getDB("test");
+    const coll = db[jsTestName()];
+
+    const numDocs = 20000;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; i++) {
+        bulk.insert({a: (i * 7919) % numDocs, s: "padding ".repeat(16) + i});
+    }
+    assert.commandWorked(bulk.execute());
+
+    const before = getSpillMetrics(db);
+    const results = coll.aggregate([{$sort: {a: 1}}], {allowDiskUse: true}).toArray();
+    const after = getSpillMetrics(db);
+
+    assert.eq(numDocs, results.length);
+    for (let i = 0; i < numDocs; i++) {
+        assert.eq(i, results[i].a, results[i]);
+    }
+
+    const blocks = after.blocks - before.blocks;
+    const uncompressedBytes = after.uncompressedBytes - before.uncompressedBytes;
+    const writtenBytes = after.writtenBytes - before.writtenBytes;
+    assert.gt(blocks, 0, tojson(after));
+    assert.gt(uncompressedBytes, 0, tojson(after));
+
+    MongoRunner.stopMongod(conn);
+    return {uncompressedBytes: uncompressedBytes, writtenBytes: writtenBytes};
+}
+
+// Without compression every block takes its size on disk, plus its header.
+const uncompressed = runSpillingSort("none");
+assert.gt(uncompressed.writtenBytes, uncompressed.uncompressedBytes, tojson(uncompressed));
+
+for (let compressor of ["snappy", "zstd"]) {
+    const compressed = runSpillingSort(compressor);
+    assert.eq(uncompressed.uncompressedBytes, compressed.uncompressedBytes, tojson(compressed));
+    assert.lt(compressed.writtenBytes, compressed.uncompressedBytes / 2, tojson(compressed));
+}
+})();
@@ -0,0 +1,59 @@
+/**
+ * Tests that initial sync clones a collection correctly when the collection cloner splits it into
+ * several _id ranges fetched by concurrent queries.
+ *
+ * @tags: [requires_replication]
+ */
+(function() {
+"use strict";
+
+const dbName = "test";
+const collName = "coll";
+const numPartitions = 4;
+
+const rst = new ReplSetTest({name: "initial_sync_partitioned_collection_clone", nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const primaryDB = rst.getPrimary().getDB(dbName);
+const primaryColl = primaryDB.getCollection(collName);
+
+// Use _id values of several types, so that the partition boundaries have to follow the _id
+// index order across types.
+let bulk = primaryColl.initializeUnorderedBulkOp();
+for (let i = 0; i < 2000; ++i) {
+    bulk.insert({_id: i, x: i});
+    bulk.insert({_id: "str" + i, x: i});
+    bulk.insert({_id: ObjectId(), x: i});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(primaryColl.createIndex({x: 1}));
+
+// Capped collections are never partitioned.
+assert.commandWorked(primaryDB.createCollection("capped", {capped: true, size: 1024 * 1024}));
+for (let i = 0; i < 100; ++i) {
+    assert.commandWorked(primaryDB.capped.insert({_id: i}));
+}
+
+const secondary = rst.add({
+    rsConfig: {votes: 0, priority: 0},
+    setParameter: {
+        numInitialSyncAttempts: 1,
+        collectionClonerPartitions: numPartitions,
+        collectionClonerPartitionMinBytes: 0,
+        collectionClonerBatchSize: 100,
+        logComponentVerbosity: tojson({replication: {initialSync: 1}}),
+    }
+});
+rst.reInitiate();
+rst.awaitSecondaryNodes();
+checkLog.containsJson(secondary, 6179053, {partitions: numPartitions});
+rst.awaitReplication();
+
+const secondaryDB = secondary.getDB(dbName);
+assert.eq(primaryColl.find().itcount(), secondaryDB.getCollection(collName).find().itcount());
+assert.eq(100, secondaryDB.capped.find().itcount());
+assert.eq(primaryColl.getIndexes().length, secondaryDB.getCollection(collName).getIndexes().length);
+
+rst.stopSet();
+})();
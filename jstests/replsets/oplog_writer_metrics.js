@@ -0,0 +1,36 @@
+/**
+ * Tests that replSetGetStatus reports how busy the oplog writer threads of a secondary are, once
+ * it has applied a batch.
+ */
+
+(function() {
+"use strict";
+
+const rst = ReplSetTest({name: jsTestName(), nodes: [{}, {rsConfig: {priority: 0}}]});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const secondary = rst.getSecondary();
+
+const coll = primary.getDB("test").oplog_writer_metrics;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; i++) {
+    bulk.insert({_id: i});
+}
+assert.commandWorked(bulk.execute());
+rst.awaitReplication();
+
+const metrics =
+    assert.commandWorked(secondary.adminCommand({replSetGetStatus: 1})).oplogWriterMetrics;
+jsTestLog("Oplog writer metrics: " + tojson(metrics));
+assert.gt(metrics.numBatches, 0, tojson(metrics));
+assert.gte(metrics.busyMicros, 0, tojson(metrics));
+assert.gte(metrics.idleMicros, 0, tojson(metrics));
+assert.gte(metrics.utilization, 0, tojson(metrics));
+assert.lte(metrics.utilization, 1, tojson(metrics));
+assert.gte(metrics.lastBatch.utilization, 0, tojson(metrics));
+assert.lte(metrics.lastBatch.utilization, 1, tojson(metrics));
+
+rst.stopSet();
+})();
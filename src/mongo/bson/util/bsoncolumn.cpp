@@ -0,0 +1,432 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/bsoncolumn.h"
+
+#include <cstring>
+
+#include "mongo/bson/util/simple8b_type_util.h"
+#include "mongo/platform/bits.h"
+#include "mongo/util/decimal_counter.h"
+
+namespace mongo {
+namespace {
+
+using namespace bsoncolumn;
+
+bool isIntegerLike(BSONType type) {
+    switch (type) {
+        case NumberInt:
+        case NumberLong:
+        case Date:
+        case bsonTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int64_t toInt64(const BSONElement& elem) {
+    switch (elem.type()) {
+        case NumberInt:
+            return elem._numberInt();
+        case NumberLong:
+            return elem._numberLong();
+        case Date:
+            return elem.date().toMillisSinceEpoch();
+        case bsonTimestamp:
+            return static_cast<int64_t>(elem.timestamp().asULL());
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsToDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Deltas are computed with unsigned arithmetic so that wrap-around is well defined. The decoder
+// performs the inverse operation the same way.
+int64_t wrappingSub(int64_t lhs, int64_t rhs) {
+    return static_cast<int64_t>(static_cast<uint64_t>(lhs) - static_cast<uint64_t>(rhs));
+}
+
+int64_t wrappingAdd(int64_t lhs, int64_t rhs) {
+    return static_cast<int64_t>(static_cast<uint64_t>(lhs) + static_cast<uint64_t>(rhs));
+}
+
+void appendVarint(BufBuilder* buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf->appendUChar(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    buf->appendUChar(static_cast<uint8_t>(value));
+}
+
+int varintSize(uint64_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * Bounds-checked cursor over the column binary.
+ */
+class ColumnReader {
+public:
+    ColumnReader(const char* data, int size) : _pos(data), _end(data + size) {}
+
+    uint8_t readByte() {
+        uassert(6179000, "Unexpected end of compressed column", _pos < _end);
+        return static_cast<uint8_t>(*_pos++);
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        uasserted(6179001, "Invalid varint in compressed column");
+    }
+
+    BSONElement readElement() {
+        uassert(6179002, "Unexpected end of compressed column", _end - _pos >= 2);
+        uassert(6179003, "Literal in compressed column must have an empty field name", !_pos[1]);
+        BSONElement elem(_pos);
+        uassert(6179004,
+                "Literal in compressed column exceeds the column size",
+                elem.size() <= _end - _pos);
+        _pos += elem.size();
+        return elem;
+    }
+
+    const char* read(int len) {
+        uassert(6179005, "Unexpected end of compressed column", _end - _pos >= len);
+        const char* data = _pos;
+        _pos += len;
+        return data;
+    }
+
+private:
+    const char* _pos;
+    const char* _end;
+};
+
+}  // namespace
+
+BSONColumnBuilder::BSONColumnBuilder(StringData fieldName) : _fieldName(fieldName.toString()) {
+    _buf.appendUChar(kFormatVersion);
+}
+
+BSONColumnBuilder& BSONColumnBuilder::append(BSONElement elem) {
+    invariant(!_finalized);
+    invariant(!elem.eoo());
+    ++_size;
+
+    BSONElement prev = _prev.firstElement();
+    if (!prev || prev.type() != elem.type()) {
+        _appendLiteral(elem);
+        return *this;
+    }
+
+    if (isIntegerLike(elem.type())) {
+        if (!_appendDelta(toInt64(elem))) {
+            _appendLiteral(elem);
+        }
+        return *this;
+    }
+
+    if (elem.type() == NumberDouble) {
+        uint64_t xorValue = doubleBits(elem._numberDouble()) ^ doubleBits(prev._numberDouble());
+        if (xorValue == 0) {
+            _appendRun(kRepeat);
+            return *this;
+        }
+
+        _flushRun();
+        int leading = countLeadingZeros64(xorValue) / 8;
+        int trailing = countTrailingZeros64(xorValue) / 8;
+        _buf.appendUChar(kXorDouble);
+        _buf.appendUChar(static_cast<uint8_t>((leading << 4) | trailing));
+        uint64_t meaningful = xorValue >> (8 * trailing);
+        for (int i = 0; i < 8 - leading - trailing; ++i) {
+            _buf.appendUChar(static_cast<uint8_t>(meaningful >> (8 * i)));
+        }
+        _prev = elem.wrap(""_sd);
+        return *this;
+    }
+
+    if (elem.binaryEqualValues(prev)) {
+        _appendRun(kRepeat);
+        return *this;
+    }
+
+    _appendLiteral(elem);
+    return *this;
+}
+
+BSONColumnBuilder& BSONColumnBuilder::skip() {
+    invariant(!_finalized);
+    ++_size;
+    _appendRun(kSkip);
+    return *this;
+}
+
+BSONBinData BSONColumnBuilder::finalize() {
+    if (!_finalized) {
+        _flushRun();
+        _buf.appendUChar(kEOO);
+        _finalized = true;
+    }
+    return {_buf.buf(), _buf.len(), BinDataType::Column};
+}
+
+void BSONColumnBuilder::_appendRun(uint8_t control) {
+    if (_runControl != control) {
+        _flushRun();
+        _runControl = control;
+    }
+    ++_runLength;
+}
+
+void BSONColumnBuilder::_flushRun() {
+    if (_runLength == 0) {
+        return;
+    }
+    _buf.appendUChar(_runControl);
+    appendVarint(&_buf, _runLength);
+    _runControl = kEOO;
+    _runLength = 0;
+}
+
+void BSONColumnBuilder::_appendLiteral(BSONElement elem) {
+    _flushRun();
+    _buf.appendUChar(kLiteral);
+    _buf.appendUChar(static_cast<uint8_t>(elem.type()));
+    _buf.appendUChar(0);
+    _buf.appendBuf(elem.value(), elem.valuesize());
+
+    _prev = elem.wrap(""_sd);
+    if (isIntegerLike(elem.type())) {
+        _prevInt = toInt64(elem);
+    }
+    _prevDelta = 0;
+}
+
+bool BSONColumnBuilder::_appendDelta(int64_t value) {
+    int64_t delta = wrappingSub(value, _prevInt);
+    if (_prev.firstElement().type() == NumberInt &&
+        (delta > std::numeric_limits<int32_t>::max() ||
+         delta < std::numeric_limits<int32_t>::min())) {
+        // Keep the decoder arithmetic within the 32-bit range by restarting from a literal.
+        return false;
+    }
+
+    _prevInt = value;
+    if (delta == _prevDelta) {
+        _appendRun(kRepeat);
+        return true;
+    }
+
+    _flushRun();
+    uint64_t encodedDelta = Simple8bTypeUtil::encodeInt64(delta);
+    uint64_t encodedDeltaOfDelta =
+        Simple8bTypeUtil::encodeInt64(wrappingSub(delta, _prevDelta));
+    if (varintSize(encodedDeltaOfDelta) < varintSize(encodedDelta)) {
+        _buf.appendUChar(kDeltaOfDelta);
+        appendVarint(&_buf, encodedDeltaOfDelta);
+    } else {
+        _buf.appendUChar(kDelta);
+        appendVarint(&_buf, encodedDelta);
+    }
+    _prevDelta = delta;
+    return true;
+}
+
+BSONColumn::BSONColumn(BSONElement bin) {
+    uassert(6179006,
+            "Compressed column must be BinData of the Column subtype",
+            isCompressedColumn(bin));
+    _data = bin.binData(_size);
+}
+
+BSONColumn::BSONColumn(const char* data, int size) : _data(data), _size(size) {}
+
+template <typename F>
+int BSONColumn::_decode(F&& onValue) const {
+    ColumnReader reader(_data, _size);
+    uassert(6179007,
+            "Unsupported compressed column format version",
+            reader.readByte() == kFormatVersion);
+
+    BSONElement prev;
+    int64_t prevInt = 0;
+    int64_t prevDelta = 0;
+    uint64_t prevBits = 0;
+    int index = 0;
+
+    auto appendPrevious = [&](BSONObjBuilder* builder, StringData fieldName) {
+        switch (prev.type()) {
+            case NumberInt:
+                builder->append(fieldName, static_cast<int32_t>(prevInt));
+                break;
+            case NumberLong:
+                builder->append(fieldName, static_cast<long long>(prevInt));
+                break;
+            case Date:
+                builder->appendDate(fieldName, Date_t::fromMillisSinceEpoch(prevInt));
+                break;
+            case bsonTimestamp:
+                builder->append(fieldName, Timestamp(static_cast<unsigned long long>(prevInt)));
+                break;
+            case NumberDouble:
+                builder->append(fieldName, bitsToDouble(prevBits));
+                break;
+            default:
+                builder->appendAs(prev, fieldName);
+                break;
+        }
+    };
+
+    auto requireIntegerLike = [&] {
+        uassert(6179008,
+                "Delta in compressed column must follow an integer-like value",
+                prev && isIntegerLike(prev.type()));
+    };
+
+    while (true) {
+        uint8_t control = reader.readByte();
+        switch (control) {
+            case kEOO:
+                return index;
+            case kLiteral:
+                prev = reader.readElement();
+                uassert(6179009, "Compressed column literal must not be EOO", !prev.eoo());
+                if (isIntegerLike(prev.type())) {
+                    prevInt = toInt64(prev);
+                } else if (prev.type() == NumberDouble) {
+                    prevBits = doubleBits(prev._numberDouble());
+                }
+                prevDelta = 0;
+                onValue(index++, appendPrevious);
+                break;
+            case kSkip:
+                index += reader.readVarint();
+                break;
+            case kRepeat: {
+                uassert(6179010, "Repeat in compressed column must follow a value", prev);
+                auto count = reader.readVarint();
+                for (uint64_t i = 0; i < count; ++i) {
+                    if (isIntegerLike(prev.type())) {
+                        prevInt = wrappingAdd(prevInt, prevDelta);
+                    }
+                    onValue(index++, appendPrevious);
+                }
+                break;
+            }
+            case kDelta:
+                requireIntegerLike();
+                prevDelta = Simple8bTypeUtil::decodeInt64(reader.readVarint());
+                prevInt = wrappingAdd(prevInt, prevDelta);
+                onValue(index++, appendPrevious);
+                break;
+            case kDeltaOfDelta:
+                requireIntegerLike();
+                prevDelta =
+                    wrappingAdd(prevDelta, Simple8bTypeUtil::decodeInt64(reader.readVarint()));
+                prevInt = wrappingAdd(prevInt, prevDelta);
+                onValue(index++, appendPrevious);
+                break;
+            case kXorDouble: {
+                uassert(6179011,
+                        "XOR in compressed column must follow a double",
+                        prev && prev.type() == NumberDouble);
+                uint8_t header = reader.readByte();
+                int leading = header >> 4;
+                int trailing = header & 0x0f;
+                uassert(6179012,
+                        "Invalid XOR header in compressed column",
+                        leading + trailing < 8);
+                const char* bytes = reader.read(8 - leading - trailing);
+                uint64_t meaningful = 0;
+                for (int i = 0; i < 8 - leading - trailing; ++i) {
+                    meaningful |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+                }
+                prevBits ^= meaningful << (8 * trailing);
+                onValue(index++, appendPrevious);
+                break;
+            }
+            default:
+                uasserted(6179013,
+                          str::stream() << "Invalid control byte in compressed column: "
+                                        << static_cast<int>(control));
+        }
+    }
+}
+
+void BSONColumn::decompress(BSONObjBuilder* builder) const {
+    DecimalCounter<uint32_t> counter;
+    uint32_t current = 0;
+    _decode([&](int index, auto&& appendValue) {
+        while (current < static_cast<uint32_t>(index)) {
+            ++counter;
+            ++current;
+        }
+        appendValue(builder, counter);
+    });
+}
+
+BSONObj BSONColumn::decompress() const {
+    BSONObjBuilder builder;
+    decompress(&builder);
+    return builder.obj();
+}
+
+int BSONColumn::size() const {
+    return _decode([](int, auto&&) {});
+}
+
+}  // namespace mongo
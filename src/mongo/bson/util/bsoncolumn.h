@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/builder.h"
+
+namespace mongo {
+
+/**
+ * Binary format shared by BSONColumnBuilder and BSONColumn. A column is a BinData of subtype
+ * 'Column' holding a version byte followed by a stream of control bytes, each optionally followed
+ * by a payload, and terminated by kEOO:
+ *
+ *   kLiteral       - an uncompressed BSONElement with an empty field name.
+ *   kSkip <n>      - 'n' missing values.
+ *   kRepeat <n>    - 'n' values repeating the previous step: integer-like values add the last
+ *                    delta again, everything else repeats the previous value.
+ *   kDelta <d>     - integer-like value equal to the previous value plus 'd'.
+ *   kDeltaOfDelta  - integer-like value whose delta differs from the previous delta by <d>.
+ *   kXorDouble     - double whose bit pattern XOR'ed with the previous double has its zero
+ *                    leading and trailing bytes stripped. The header byte holds the number of
+ *                    leading zero bytes in the high nibble and trailing zero bytes in the low one.
+ *
+ * Counts are unsigned LEB128 varints and deltas are zig-zag encoded varints. Dates, Timestamps,
+ * and 32/64-bit integers are integer-like.
+ */
+namespace bsoncolumn {
+static constexpr uint8_t kFormatVersion = 1;
+
+static constexpr uint8_t kEOO = 0x00;
+static constexpr uint8_t kLiteral = 0x01;
+static constexpr uint8_t kSkip = 0x02;
+static constexpr uint8_t kRepeat = 0x03;
+static constexpr uint8_t kDelta = 0x04;
+static constexpr uint8_t kDeltaOfDelta = 0x05;
+static constexpr uint8_t kXorDouble = 0x06;
+}  // namespace bsoncolumn
+
+/**
+ * Builds a compressed column out of a sequence of BSONElements. Field names of the appended
+ * elements are ignored; their position in the sequence is what is preserved.
+ */
+class BSONColumnBuilder {
+public:
+    explicit BSONColumnBuilder(StringData fieldName);
+
+    BSONColumnBuilder(const BSONColumnBuilder&) = delete;
+    BSONColumnBuilder& operator=(const BSONColumnBuilder&) = delete;
+
+    /**
+     * Appends the value of 'elem' as the next entry in the column.
+     */
+    BSONColumnBuilder& append(BSONElement elem);
+
+    /**
+     * Records a missing value as the next entry in the column.
+     */
+    BSONColumnBuilder& skip();
+
+    /**
+     * Completes the column and returns the binary. The returned BSONBinData points into memory
+     * owned by this builder and must not outlive it. No further appends are allowed.
+     */
+    BSONBinData finalize();
+
+    StringData fieldName() const {
+        return _fieldName;
+    }
+
+    /**
+     * Number of entries, including skipped ones, appended so far.
+     */
+    int size() const {
+        return _size;
+    }
+
+private:
+    void _appendRun(uint8_t control);
+    void _flushRun();
+    void _appendLiteral(BSONElement elem);
+    bool _appendDelta(int64_t value);
+
+    std::string _fieldName;
+    BufBuilder _buf;
+
+    // Copy of the last appended value, stored as a single element object with an empty field name.
+    BSONObj _prev;
+
+    // Integer-like representation of '_prev' and the last delta written. Only meaningful when
+    // '_prev' holds an integer-like value.
+    int64_t _prevInt = 0;
+    int64_t _prevDelta = 0;
+
+    // The pending run of kSkip or kRepeat control bytes not yet written to '_buf'.
+    uint8_t _runControl = bsoncolumn::kEOO;
+    uint64_t _runLength = 0;
+
+    int _size = 0;
+    bool _finalized = false;
+};
+
+/**
+ * Read-only view over a compressed column produced by BSONColumnBuilder. The underlying binary
+ * must outlive this object.
+ */
+class BSONColumn {
+public:
+    /**
+     * Takes a BinData element of subtype 'Column'. Throws if 'bin' is not such an element.
+     */
+    explicit BSONColumn(BSONElement bin);
+    BSONColumn(const char* data, int size);
+
+    /**
+     * Appends every present value of the column to 'builder', using the decimal index of each
+     * entry as its field name. Missing values are omitted, so the output has the same shape as
+     * an uncompressed time-series bucket column.
+     */
+    void decompress(BSONObjBuilder* builder) const;
+    BSONObj decompress() const;
+
+    /**
+     * Number of entries, including missing ones, in the column.
+     */
+    int size() const;
+
+private:
+    /**
+     * Walks the column, invoking 'onValue(index, appendFn)' for each present value. The
+     * 'appendFn(builder, fieldName)' argument materializes the value into a builder.
+     */
+    template <typename F>
+    int _decode(F&& onValue) const;
+
+    const char* _data;
+    int _size;
+};
+
+/**
+ * Returns true if 'elem' is a BinData element holding a compressed column.
+ */
+inline bool isCompressedColumn(const BSONElement& elem) {
+    return elem.type() == BSONType::BinData && elem.binDataType() == BinDataType::Column;
+}
+
+}  // namespace mongo
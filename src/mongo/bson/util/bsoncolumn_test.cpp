@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/bson/util/bsoncolumn.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+/**
+ * Compresses the values of 'uncompressed' into a column, verifies that decompressing yields the
+ * same object, and returns the compressed size in bytes.
+ */
+int assertRoundTrip(const BSONObj& uncompressed, int expectedSize) {
+    BSONColumnBuilder builder("f"_sd);
+    int index = 0;
+    for (auto&& elem : uncompressed) {
+        int elemIndex = std::stoi(elem.fieldName());
+        for (; index < elemIndex; ++index) {
+            builder.skip();
+        }
+        builder.append(elem);
+        ++index;
+    }
+    for (; index < expectedSize; ++index) {
+        builder.skip();
+    }
+
+    BSONObjBuilder bob;
+    bob.append(builder.fieldName(), builder.finalize());
+    BSONObj compressedObj = bob.obj();
+
+    BSONColumn column(compressedObj.firstElement());
+    ASSERT_EQ(column.size(), expectedSize);
+    ASSERT_BSONOBJ_EQ(column.decompress(), uncompressed);
+    ASSERT(column.decompress().binaryEqual(uncompressed));
+
+    int len;
+    compressedObj.firstElement().binData(len);
+    return len;
+}
+
+TEST(BSONColumnTest, Empty) {
+    assertRoundTrip(BSONObj(), 0);
+}
+
+TEST(BSONColumnTest, OnlySkips) {
+    assertRoundTrip(BSONObj(), 5);
+}
+
+TEST(BSONColumnTest, RegularDatesCompressToConstantSize) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < 1000; ++i) {
+        bob.appendDate(std::to_string(i), Date_t::fromMillisSinceEpoch(1625000000000 + i * 1000));
+    }
+    // Literal, one delta and a single run of repeats.
+    ASSERT_LT(assertRoundTrip(bob.obj(), 1000), 20);
+}
+
+TEST(BSONColumnTest, JitteredDatesUseDeltaOfDelta) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < 100; ++i) {
+        bob.appendDate(std::to_string(i),
+                       Date_t::fromMillisSinceEpoch(1625000000000 + i * 60000 + (i % 3)));
+    }
+    // Each value should take a control byte and a single byte delta-of-delta.
+    ASSERT_LT(assertRoundTrip(bob.obj(), 100), 2 * 100 + 20);
+}
+
+TEST(BSONColumnTest, IntegersAndOverflow) {
+    BSONObjBuilder bob;
+    bob.append("0", 1);
+    bob.append("1", std::numeric_limits<int32_t>::max());
+    bob.append("2", std::numeric_limits<int32_t>::min());
+    bob.append("3", 0);
+    bob.append("4", std::numeric_limits<long long>::max());
+    bob.append("5", std::numeric_limits<long long>::min());
+    bob.append("6", 5LL);
+    assertRoundTrip(bob.obj(), 7);
+}
+
+TEST(BSONColumnTest, Timestamps) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < 10; ++i) {
+        bob.append(std::to_string(i), Timestamp(100 + i, i % 2));
+    }
+    assertRoundTrip(bob.obj(), 10);
+}
+
+TEST(BSONColumnTest, Doubles) {
+    BSONObjBuilder bob;
+    double values[] = {20.5, 20.5, 20.75, 21.0, -3.125, 0.1, 0.2, 0.2, 1e300, -0.0, 0.0};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        bob.append(std::to_string(i), values[i]);
+    }
+    assertRoundTrip(bob.obj(), sizeof(values) / sizeof(values[0]));
+}
+
+TEST(BSONColumnTest, NaNs) {
+    BSONObjBuilder bob;
+    bob.append("0", std::numeric_limits<double>::quiet_NaN());
+    bob.append("1", std::numeric_limits<double>::quiet_NaN());
+    bob.append("2", 1.0);
+    assertRoundTrip(bob.obj(), 3);
+}
+
+TEST(BSONColumnTest, RepeatedStringsAreRunLengthEncoded) {
+    BSONObjBuilder bob;
+    for (int i = 0; i < 500; ++i) {
+        bob.append(std::to_string(i), "sensor-status-ok");
+    }
+    ASSERT_LT(assertRoundTrip(bob.obj(), 500), 40);
+}
+
+TEST(BSONColumnTest, MixedTypesWithGaps) {
+    BSONObjBuilder bob;
+    bob.append("0", 1);
+    bob.append("2", 1.5);
+    bob.append("3", "str");
+    bob.append("4", BSON("a" << 1));
+    bob.append("7", 2LL);
+    bob.appendNull("8");
+    bob.append("9", true);
+    bob.append("10", 3);
+    assertRoundTrip(bob.obj(), 13);
+}
+
+TEST(BSONColumnTest, RejectsNonColumnBinData) {
+    BSONObj obj = BSON("f" << 1);
+    ASSERT_THROWS_CODE(BSONColumn(obj.firstElement()), DBException, 6179006);
+}
+
+TEST(BSONColumnTest, RejectsTruncatedColumn) {
+    BSONColumnBuilder builder("f"_sd);
+    builder.append(BSON("0" << 1.5).firstElement());
+    BSONBinData bin = builder.finalize();
+
+    BSONColumn truncated(static_cast<const char*>(bin.data), bin.length - 3);
+    ASSERT_THROWS(truncated.decompress(), DBException);
+}
+
+}  // namespace
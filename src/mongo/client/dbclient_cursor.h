@@ -376,6 +376,11 @@ public:
         return _c.getPostBatchResumeToken();
     }
 
+    /// Changes the batchSize of the getMores which fetch the batches after this one.
+    void setBatchSize(int newBatchSize) {
+        _c.setBatchSize(newBatchSize);
+    }
+
 private:
     DBClientCursor& _c;
     int _n;
@@ -56,6 +56,7 @@
 #include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
+#include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/delete.h"
@@ -1356,6 +1357,76 @@ Status IndexCatalogImpl::_indexKeys(OperationContext* opCtx,
     return status;
 }
 
+Status IndexCatalogImpl::_indexRecordBatch(OperationContext* opCtx,
+                                           const CollectionPtr& coll,
+                                           const IndexCatalogEntry* index,
+                                           std::vector<BsonRecord>::const_iterator begin,
+                                           std::vector<BsonRecord>::const_iterator end,
+                                           const InsertDeleteOptions& options,
+                                           int64_t* keysInsertedOut) const {
+    auto& executionCtx = StorageExecutionContext::get(opCtx);
+    auto accessMethod = index->accessMethod();
+
+    KeyStringSet::sequence_type keys;
+    KeyStringSet multikeyMetadataKeys;
+    boost::optional<MultikeyPaths> multikeyPaths;
+    for (auto it = begin; it != end; ++it) {
+        invariant(it->id != RecordId());
+
+        auto recordKeys = executionCtx.keys();
+        auto recordMultikeyMetadataKeys = executionCtx.multikeyMetadataKeys();
+        auto recordMultikeyPaths = executionCtx.multikeyPaths();
+
+        accessMethod->getKeys(opCtx,
+                              coll,
+                              executionCtx.pooledBufferBuilder(),
+                              *it->docPtr,
+                              options.getKeysMode,
+                              IndexAccessMethod::GetKeysContext::kAddingKeys,
+                              recordKeys.get(),
+                              recordMultikeyMetadataKeys.get(),
+                              recordMultikeyPaths.get(),
+                              it->id,
+                              IndexAccessMethod::kNoopOnSuppressedErrorFn);
+
+        // Whether a record makes the index multikey depends on its own keys only.
+        if (accessMethod->shouldMarkIndexAsMultikey(
+                recordKeys->size(), *recordMultikeyMetadataKeys, *recordMultikeyPaths)) {
+            if (multikeyPaths) {
+                MultikeyPathTracker::mergeMultikeyPaths(&*multikeyPaths, *recordMultikeyPaths);
+            } else {
+                multikeyPaths = *recordMultikeyPaths;
+            }
+            multikeyMetadataKeys.insert(recordMultikeyMetadataKeys->begin(),
+                                        recordMultikeyMetadataKeys->end());
+        }
+
+        keys.insert(keys.end(), recordKeys->begin(), recordKeys->end());
+    }
+
+    // The RecordId at the end of every key tells apart the keys of different records.
+    KeyStringSet sortedKeys;
+    sortedKeys.adopt_sequence(std::move(keys));
+
+    int64_t numInserted;
+    Status status = accessMethod->insertKeys(
+        opCtx, coll, sortedKeys, RecordId(), options, nullptr, &numInserted);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (multikeyPaths) {
+        index->setMultikey(opCtx, coll, multikeyMetadataKeys, *multikeyPaths);
+        // The multikey metadata keys were inserted while marking the index as multikey.
+        numInserted += multikeyMetadataKeys.size();
+    }
+
+    if (keysInsertedOut) {
+        *keysInsertedOut += numInserted;
+    }
+    return Status::OK();
+}
+
 Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
                                                const CollectionPtr& coll,
                                                const IndexCatalogEntry* index,
@@ -1366,15 +1437,38 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
     InsertDeleteOptions options;
     prepareInsertDeleteOptions(opCtx, coll->ns(), index->descriptor(), &options);
 
-    for (auto bsonRecord : bsonRecords) {
-        invariant(bsonRecord.id != RecordId());
+    // Keys must be written at the timestamp of their record, so the records that share a timestamp
+    // are indexed together. This spares positioning a cursor in the index for every record, and
+    // inserting all their keys in order is friendlier to the storage engine. Hybrid builds write
+    // to their side table instead, one record at a time.
+    for (auto begin = bsonRecords.begin(); begin != bsonRecords.end();) {
+        auto end = std::next(begin);
+        if (!index->isHybridBuilding()) {
+            while (end != bsonRecords.end() && end->ts == begin->ts) {
+                ++end;
+            }
+        }
 
-        if (!bsonRecord.ts.isNull()) {
-            Status status = opCtx->recoveryUnit()->setTimestamp(bsonRecord.ts);
+        if (!begin->ts.isNull()) {
+            Status status = opCtx->recoveryUnit()->setTimestamp(begin->ts);
             if (!status.isOK())
                 return status;
         }
 
+        if (std::distance(begin, end) > 1) {
+            Status status =
+                _indexRecordBatch(opCtx, coll, index, begin, end, options, keysInsertedOut);
+            if (!status.isOK()) {
+                return status;
+            }
+            begin = end;
+            continue;
+        }
+
+        const auto& bsonRecord = *begin;
+        begin = end;
+        invariant(bsonRecord.id != RecordId());
+
         auto keys = executionCtx.keys();
         auto multikeyMetadataKeys = executionCtx.multikeyMetadataKeys();
         auto multikeyPaths = executionCtx.multikeyPaths();
@@ -330,6 +330,18 @@ private:
                       const InsertDeleteOptions& options,
                       int64_t* keysInsertedOut) const;
 
+    /**
+     * Generates the keys of all the records in [begin, end), which must share the same timestamp,
+     * and inserts them into 'index' in key order.
+     */
+    Status _indexRecordBatch(OperationContext* opCtx,
+                             const CollectionPtr& coll,
+                             const IndexCatalogEntry* index,
+                             std::vector<BsonRecord>::const_iterator begin,
+                             std::vector<BsonRecord>::const_iterator end,
+                             const InsertDeleteOptions& options,
+                             int64_t* keysInsertedOut) const;
+
     Status _indexFilteredRecords(OperationContext* opCtx,
                                  const CollectionPtr& coll,
                                  const IndexCatalogEntry* index,
@@ -44,6 +44,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/multikey_paths.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/multi_key_path_tracker.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context.h"
@@ -56,6 +57,7 @@
 #include "mongo/logv2/log.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/future.h"
 #include "mongo/util/log_and_backoff.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/quick_exit.h"
@@ -83,8 +85,166 @@ size_t getEachIndexBuildMaxMemoryUsageBytes(size_t numIndexSpecs) {
         numIndexSpecs;
 }
 
+// Upper bounds on the documents buffered by the collection scan before they are handed to the
+// key generation threads.
+constexpr size_t kKeyGenerationDocsPerThread = 1024;
+constexpr size_t kKeyGenerationMaxBufferedBytes = 16 * 1024 * 1024;
+
 }  // namespace
 
+/**
+ * Generates the index keys of the documents returned by the collection scan on several threads.
+ * Every thread inserts the keys into its own set of BulkBuilders, which are absorbed into the
+ * BulkBuilders of the MultiIndexBlock when the generator is destroyed.
+ *
+ * Documents are handed to the threads in rounds and the scanning thread waits for all of them at
+ * the end of each round. This keeps '_lastRecordIdInserted' pointing at a prefix of the collection
+ * whose keys have all been generated, as required to resume the index build.
+ */
+class MultiIndexBlock::ParallelKeyGenerator {
+public:
+    ParallelKeyGenerator(MultiIndexBlock* block,
+                         StringData dbName,
+                         QueryWorkerPool::Reservation* threads)
+        : _block(block), _threads(threads), _workers(threads->numThreads()) {
+        const auto maxMemoryUsageBytes =
+            getEachIndexBuildMaxMemoryUsageBytes(_block->_indexes.size()) / _workers.size();
+        for (auto& worker : _workers) {
+            for (const auto& index : _block->_indexes) {
+                worker.bulks.push_back(
+                    index.real->initiateBulk(maxMemoryUsageBytes, boost::none, dbName));
+
+                // Key generation errors are reported back to the scanning thread rather than
+                // suppressed, since recording a skipped document requires a storage transaction.
+                worker.options.push_back(index.options);
+                worker.options.back().getKeysMode =
+                    IndexAccessMethod::GetKeysMode::kEnforceConstraints;
+            }
+        }
+    }
+
+    ~ParallelKeyGenerator() {
+        // Every round has completed by now, so the keys held by the workers cover the documents up
+        // to '_lastRecordIdInserted'. They must reach the MultiIndexBlock whether the scan finished
+        // or stopped, to be either committed or persisted for resuming the build.
+        for (auto& worker : _workers) {
+            for (size_t i = 0; i < worker.bulks.size(); ++i) {
+                _block->_indexes[i].bulk->absorb(std::move(worker.bulks[i]));
+            }
+        }
+    }
+
+    /**
+     * Buffers a document for key generation, running a round once enough documents are buffered.
+     */
+    void add(OperationContext* opCtx,
+             const CollectionPtr& collection,
+             const BSONObj& doc,
+             const RecordId& loc) {
+        _workers[_numBuffered % _workers.size()].docs.emplace_back(doc.getOwned(), loc);
+        ++_numBuffered;
+        _bufferedBytes += doc.objsize();
+        _lastBufferedRecordId = loc;
+
+        if (_numBuffered >= kKeyGenerationDocsPerThread * _workers.size() ||
+            _bufferedBytes >= kKeyGenerationMaxBufferedBytes) {
+            _runRound(opCtx, collection);
+        }
+    }
+
+    /**
+     * Generates the keys of the documents still buffered. Must be called once the scan is done.
+     */
+    void flush(OperationContext* opCtx, const CollectionPtr& collection) {
+        if (_numBuffered > 0) {
+            _runRound(opCtx, collection);
+        }
+    }
+
+private:
+    struct Worker {
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> bulks;
+        std::vector<InsertDeleteOptions> options;
+
+        // The documents of the current round.
+        std::vector<std::pair<BSONObj, RecordId>> docs;
+
+        // The (document, index) positions whose keys could not be generated in the current round.
+        std::vector<std::pair<size_t, size_t>> failed;
+    };
+
+    void _generateKeys(Worker* worker) {
+        auto opCtx = cc().makeOperationContext();
+        for (size_t docIdx = 0; docIdx < worker->docs.size(); ++docIdx) {
+            const auto& [doc, loc] = worker->docs[docIdx];
+            for (size_t i = 0; i < worker->bulks.size(); ++i) {
+                auto status = worker->bulks[i]->insert(
+                    opCtx.get(), CollectionPtr::null, doc, loc, worker->options[i]);
+                if (!status.isOK()) {
+                    worker->failed.emplace_back(docIdx, i);
+                }
+            }
+        }
+    }
+
+    void _runRound(OperationContext* opCtx, const CollectionPtr& collection) {
+        std::vector<Future<void>> futures;
+        for (auto& worker : _workers) {
+            if (worker.docs.empty()) {
+                continue;
+            }
+
+            auto pf = makePromiseFuture<void>();
+            futures.push_back(std::move(pf.future));
+            _threads->schedule(
+                [this, worker = &worker, promise = std::move(pf.promise)](auto status) mutable {
+                    if (!status.isOK()) {
+                        promise.setError(status);
+                        return;
+                    }
+                    promise.setWith([&] { _generateKeys(worker); });
+                });
+        }
+
+        // The workers reference the buffered documents, so wait for all of them before reporting
+        // the first error.
+        Status firstError = Status::OK();
+        for (auto& future : futures) {
+            auto status = std::move(future).getNoThrow();
+            if (!status.isOK() && firstError.isOK()) {
+                firstError = status;
+            }
+        }
+        uassertStatusOK(firstError);
+
+        // Documents the workers could not generate keys for go through the regular path, which
+        // either records them as skipped or fails the index build.
+        for (auto& worker : _workers) {
+            for (const auto& [docIdx, i] : worker.failed) {
+                const auto& [doc, loc] = worker.docs[docIdx];
+                auto& index = _block->_indexes[i];
+                uassertStatusOK(index.bulk->insert(opCtx, collection, doc, loc, index.options));
+            }
+            worker.failed.clear();
+        }
+
+        _block->_lastRecordIdInserted = _lastBufferedRecordId;
+        for (auto& worker : _workers) {
+            worker.docs.clear();
+        }
+        _numBuffered = 0;
+        _bufferedBytes = 0;
+    }
+
+    MultiIndexBlock* const _block;
+    QueryWorkerPool::Reservation* const _threads;
+    std::vector<Worker> _workers;
+
+    size_t _numBuffered = 0;
+    size_t _bufferedBytes = 0;
+    RecordId _lastBufferedRecordId;
+};
+
 MultiIndexBlock::~MultiIndexBlock() {
     invariant(_buildIsCleanedUp);
 }
@@ -370,7 +530,14 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
     }
     MultikeyPathTracker::get(opCtx).startTrackingMultikeyPathInfo();
 
-    const char* curopMessage = "Index Build: scanning collection";
+    auto keyGenerationThreads = _reserveKeyGenerationThreads();
+    const auto numKeyGenerationThreads =
+        keyGenerationThreads ? keyGenerationThreads->numThreads() : 1;
+    std::string curopMessage = "Index Build: scanning collection";
+    if (numKeyGenerationThreads > 1) {
+        curopMessage = str::stream() << curopMessage << " (generating keys on "
+                                     << numKeyGenerationThreads << " threads)";
+    }
     const auto numRecords = collection->numRecords(opCtx);
     ProgressMeterHolder progress;
     {
@@ -433,6 +600,7 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
             _doCollectionScan(opCtx,
                               collection,
                               numScanRestarts == 0 ? resumeAfterRecordId : boost::none,
+                              keyGenerationThreads.get_ptr(),
                               &progress);
 
             LOGV2(20391,
@@ -551,9 +719,29 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
     return Status::OK();
 }
 
+boost::optional<QueryWorkerPool::Reservation> MultiIndexBlock::_reserveKeyGenerationThreads()
+    const {
+    const auto numThreads = static_cast<size_t>(maxIndexBuildKeyGenerationThreads.load());
+    if (numThreads <= 1) {
+        return boost::none;
+    }
+
+    // The key generation threads build keys without access to the collection and without
+    // evaluating partial filters, which only the btree access method supports.
+    for (const auto& index : _indexes) {
+        if (index.filterExpression ||
+            IndexNames::findPluginName(index.block->getSpec().getObjectField("key")) !=
+                IndexNames::BTREE) {
+            return boost::none;
+        }
+    }
+    return QueryWorkerPool::tryReserve(numThreads);
+}
+
 void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
                                         const CollectionPtr& collection,
                                         boost::optional<RecordId> resumeAfterRecordId,
+                                        QueryWorkerPool::Reservation* keyGenerationThreads,
                                         ProgressMeterHolder* progress) {
     PlanYieldPolicy::YieldPolicy yieldPolicy;
     if (isBackgroundBuilding()) {
@@ -572,6 +760,11 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
               IndexBuildPhase_serializer(_phase).toString());
     _phase = IndexBuildPhaseEnum::kCollectionScan;
 
+    boost::optional<ParallelKeyGenerator> keyGenerator;
+    if (keyGenerationThreads) {
+        keyGenerator.emplace(this, collection->ns().db(), keyGenerationThreads);
+    }
+
     BSONObj objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -594,7 +787,11 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
 
         // The external sorter is not part of the storage engine and therefore does not need
         // a WriteUnitOfWork to write keys.
-        uassertStatusOK(_insert(opCtx, collection, objToIndex, loc));
+        if (keyGenerator) {
+            keyGenerator->add(opCtx, collection, objToIndex, loc);
+        } else {
+            uassertStatusOK(_insert(opCtx, collection, objToIndex, loc));
+        }
 
         _failPointHangDuringBuild(opCtx,
                                   &hangIndexBuildDuringCollectionScanPhaseAfterInsertion,
@@ -606,6 +803,10 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
         // Go to the next document.
         progress->hit();
     }
+
+    if (keyGenerator) {
+        keyGenerator->flush(opCtx, collection);
+    }
 }
 
 Status MultiIndexBlock::insertSingleDocumentForInitialSyncOrRecovery(
@@ -46,6 +46,7 @@
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_build_interceptor.h"
+#include "mongo/db/query/query_worker_pool.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/resumable_index_builds_gen.h"
 #include "mongo/platform/mutex.h"
@@ -292,6 +293,8 @@ public:
     void setIndexBuildMethod(IndexBuildMethod indexBuildMethod);
 
 private:
+    class ParallelKeyGenerator;
+
     struct IndexToBuild {
         std::unique_ptr<IndexBuildBlock> block;
 
@@ -317,13 +320,24 @@ private:
                    const BSONObj& wholeDocument,
                    const RecordId& loc);
 
+    /**
+     * Reserves the threads the collection scan generates index keys on. Returns boost::none, and
+     * the keys are generated by the thread scanning the collection, unless
+     * 'maxIndexBuildKeyGenerationThreads' is raised, every index being built can generate its keys
+     * away from the thread scanning the collection and the query worker pool has enough threads
+     * left.
+     */
+    boost::optional<QueryWorkerPool::Reservation> _reserveKeyGenerationThreads() const;
+
     /**
      * Performs a collection scan on the given collection and inserts the relevant index keys into
-     * the external sorter.
+     * the external sorter. When 'keyGenerationThreads' is set, the keys are generated and sorted
+     * on those threads while this thread scans the collection.
      */
     void _doCollectionScan(OperationContext* opCtx,
                            const CollectionPtr& collection,
                            boost::optional<RecordId> resumeAfterRecordId,
+                           QueryWorkerPool::Reservation* keyGenerationThreads,
                            ProgressMeterHolder* progress);
 
     // Is set during init() and ensures subsequent function calls act on the same Collection.
@@ -247,6 +247,14 @@ public:
         return StringData(_planSummary);
     }
 
+    /**
+     * Returns the key of the shape of the cursor's query in the query shape statistics store, if
+     * the operation which created the cursor registered one.
+     */
+    const boost::optional<std::string>& getQueryShapeStatsKey() const {
+        return _queryShapeStatsKey;
+    }
+
     /**
      * Returns a generic cursor containing diagnostics about this cursor.
      * The caller must either have this cursor pinned or hold a mutex from the cursor manager.
@@ -415,6 +423,10 @@ private:
     // A string with the plan summary of the cursor's query.
     std::string _planSummary;
 
+    // The key under which the getMore operations of this cursor are recorded in the query shape
+    // statistics store.
+    boost::optional<std::string> _queryShapeStatsKey;
+
     // Commit point at the time the last batch was returned. This is only used by internal exhaust
     // oplog fetching.
     boost::optional<repl::OpTime> _lastKnownCommittedOpTime;
@@ -0,0 +1,213 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/collection_statistics_store.h"
+#include "mongo/db/query/histogram.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace {
+
+const long long kDefaultSampleSize = 10000;
+const long long kDefaultNumBuckets = 100;
+
+long long parsePositiveNumber(const BSONObj& cmdObj,
+                              StringData fieldName,
+                              long long defaultValue,
+                              int errorCode) {
+    auto elt = cmdObj[fieldName];
+    if (!elt) {
+        return defaultValue;
+    }
+    uassert(errorCode,
+            str::stream() << "'" << fieldName << "' must be a positive number",
+            elt.isNumber() && elt.safeNumberLong() > 0);
+    return elt.safeNumberLong();
+}
+
+}  // namespace
+
+/**
+ * The 'analyze' command samples the documents of a collection to build a histogram of the values
+ * of one of their fields, which the query planner then uses to estimate the cost of candidate
+ * plans when internalQueryEnableCardinalityEstimation is set:
+ *
+ *    {
+ *        analyze: <collection>,
+ *        key: <field path>,
+ *        sampleSize: <number of documents to sample>,
+ *        numBuckets: <maximum number of buckets of the histogram>
+ *    }
+ *
+ * The statistics are persisted, keyed by the UUID of the collection, and the plan cache of the
+ * collection is cleared so that queries are planned anew with them.
+ */
+class AnalyzeCommand final : public BasicCommand {
+public:
+    AnalyzeCommand() : BasicCommand("analyze") {}
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override;
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kOptIn;
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const override;
+
+    std::string help() const override {
+        return "Builds a histogram of the values of a field of a collection for the query planner.";
+    }
+} analyzeCommand;
+
+Status AnalyzeCommand::checkAuthForCommand(Client* client,
+                                           const std::string& dbname,
+                                           const BSONObj& cmdObj) const {
+    AuthorizationSession* authzSession = AuthorizationSession::get(client);
+    ResourcePattern pattern = parseResourcePattern(dbname, cmdObj);
+
+    if (authzSession->isAuthorizedForActionsOnResource(pattern, ActionType::planCacheWrite)) {
+        return Status::OK();
+    }
+
+    return Status(ErrorCodes::Unauthorized, "unauthorized");
+}
+
+bool AnalyzeCommand::run(OperationContext* opCtx,
+                         const std::string& dbname,
+                         const BSONObj& cmdObj,
+                         BSONObjBuilder& result) {
+    const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+
+    const auto keyElt = cmdObj["key"];
+    uassert(6179056,
+            "'key' must be a non-empty string",
+            keyElt.type() == String && !keyElt.valueStringData().empty());
+    const std::string path = keyElt.str();
+    const auto sampleSize = parsePositiveNumber(cmdObj, "sampleSize", kDefaultSampleSize, 6179057);
+    const auto numBuckets = parsePositiveNumber(cmdObj, "numBuckets", kDefaultNumBuckets, 6179058);
+
+    boost::optional<UUID> uuid;
+    BSONObj persistedStats;
+    double numRecords = 0;
+    long long numSampled = 0;
+    std::shared_ptr<const Histogram> histogram;
+    {
+        // This is a read lock. The statistics, like the query cache, are owned by the collection.
+        AutoGetCollectionForReadCommand ctx(opCtx, nss);
+        const auto& collection = ctx.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << nss << " does not exist",
+                collection);
+        uuid = collection->uuid();
+
+        auto cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+        uassert(6179059,
+                str::stream() << "Collection " << nss << " does not support random sampling",
+                cursor);
+
+        numRecords = collection->numRecords(opCtx);
+        const long long numToSample = std::min(sampleSize, static_cast<long long>(numRecords));
+
+        std::vector<BSONObj> values;
+        for (; numSampled < numToSample; ++numSampled) {
+            auto record = cursor->next();
+            if (!record) {
+                break;
+            }
+            opCtx->checkForInterrupt();
+
+            BSONElementSet elements;
+            dotted_path_support::extractAllElementsAlongPath(record->data.toBson(), path, elements);
+            if (elements.empty()) {
+                // Missing fields are indexed as null.
+                values.push_back(BSON("" << BSONNULL));
+            }
+            for (auto&& elt : elements) {
+                BSONObjBuilder bob;
+                bob.appendAs(elt, "");
+                values.push_back(bob.obj());
+            }
+        }
+
+        const double scale = numSampled > 0 ? numRecords / numSampled : 0;
+        histogram = std::make_shared<const Histogram>(
+            Histogram::make(std::move(values), static_cast<size_t>(numBuckets), scale));
+
+        // Loads the histograms of the other fields first, so that they remain persisted.
+        auto stats = collection_statistics_store::get(opCtx, collection);
+        stats->setHistogram(path, histogram, numRecords);
+        persistedStats = stats->toBSON();
+
+        // Queries planned without the new statistics may have cached plans they would not pick
+        // now.
+        CollectionQueryInfo::get(collection).getPlanCache()->clear();
+    }
+
+    // The statistics are written once the collection is unlocked, since a write cannot be nested
+    // in a read.
+    collection_statistics_store::persist(opCtx, *uuid, persistedStats);
+
+    LOGV2_DEBUG(6179060,
+                1,
+                "Built histogram for the query planner",
+                "namespace"_attr = nss,
+                "key"_attr = path,
+                "numSampled"_attr = numSampled,
+                "numBuckets"_attr = histogram->getBuckets().size());
+
+    result.append("numRecords", numRecords);
+    result.append("numSampled", numSampled);
+    result.append("histogram", histogram->toBSON());
+    return true;
+}
+
+}  // namespace mongo
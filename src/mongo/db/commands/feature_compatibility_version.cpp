@@ -36,11 +36,15 @@
 #include <fmt/format.h>
 
 #include "mongo/base/status.h"
+#include "mongo/db/catalog/collection_catalog_helper.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
 #include "mongo/db/commands/feature_compatibility_version_gen.h"
 #include "mongo/db/commands/feature_compatibility_version_parser.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/optime.h"
@@ -519,6 +523,32 @@ void FeatureCompatibilityVersion::clearLastFCVUpdateTimestamp() {
     lastFCVUpdateTimestamp = Timestamp();
 }
 
+boost::optional<std::string> FeatureCompatibilityVersion::findKeyStringV2Index(
+    OperationContext* opCtx) {
+    boost::optional<std::string> keyStringV2Index;
+    for (const auto& dbName : DatabaseHolder::get(opCtx)->getNames()) {
+        catalog::forEachCollectionFromDb(
+            opCtx, dbName, MODE_IS, [&](const CollectionPtr& collection) {
+                auto it = collection->getIndexCatalog()->getIndexIterator(
+                    opCtx, true /* includeUnfinishedIndexes */);
+                while (it->more()) {
+                    const auto entry = it->next();
+                    if (entry->accessMethod()->getSortedDataInterface()->getKeyStringVersion() ==
+                        KeyString::Version::V2) {
+                        keyStringV2Index = str::stream() << entry->descriptor()->indexName()
+                                                         << " on " << collection->ns();
+                        return false;
+                    }
+                }
+                return true;
+            });
+        if (keyStringV2Index) {
+            break;
+        }
+    }
+    return keyStringV2Index;
+}
+
 
 /**
  * Read-only server parameter for featureCompatibilityVersion.
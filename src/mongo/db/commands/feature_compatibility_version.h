@@ -122,6 +122,12 @@ public:
      * majority snapshot, so it is safe to clear the lastFCVUpdateTimestamp then.
      */
     static void clearLastFCVUpdateTimestamp();
+
+    /**
+     * Returns the name and namespace of the first index of this node which stores its keys in
+     * KeyString V2, which earlier versions of the server cannot read, if there is one.
+     */
+    static boost::optional<std::string> findKeyStringV2Index(OperationContext* opCtx);
 };
 
 /**
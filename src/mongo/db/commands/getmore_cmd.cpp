@@ -566,6 +566,9 @@ public:
                 curOp->setGenericCursor_inlock(cursorPin->toGenericCursor());
             }
 
+            // Attribute this getMore to the shape of the query which created the cursor.
+            curOp->debug().queryShapeStatsKey = cursorPin->getQueryShapeStatsKey();
+
             // If the 'failGetMoreAfterCursorCheckout' failpoint is enabled, throw an exception with
             // the given 'errorCode' value, or ErrorCodes::InternalError if 'errorCode' is omitted.
             failGetMoreAfterCursorCheckout.executeIf(
@@ -35,6 +35,7 @@
 
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/coll_mod.h"
+#include "mongo/db/catalog/collection_catalog_helper.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/drop_collection.h"
@@ -66,6 +67,7 @@
 #include "mongo/db/s/resharding/resharding_donor_recipient_common.h"
 #include "mongo/db/s/sharding_ddl_coordinator_service.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/timeseries/timeseries_constants.h"
 #include "mongo/db/transaction_history_iterator.h"
 #include "mongo/db/vector_clock.h"
 #include "mongo/db/views/view_catalog.h"
@@ -287,6 +289,49 @@ void dropReshardingCollectionsOnShard(OperationContext* opCtx) {
                        DropCollectionSystemCollectionMode::kAllowSystemCollectionDrops));
 }
 
+/**
+ * Fails the downgrade if an index of this node stores its keys in KeyString V2, which earlier
+ * versions of the server cannot read.
+ */
+void uassertNoKeyStringV2Indexes(OperationContext* opCtx) {
+    auto keyStringV2Index = FeatureCompatibilityVersion::findKeyStringV2Index(opCtx);
+    uassert(ErrorCodes::CannotDowngrade,
+            str::stream() << "Cannot downgrade the cluster when there are indexes storing their "
+                             "keys in KeyString V2; drop and recreate them before downgrading. "
+                             "First detected index: "
+                          << *keyStringV2Index,
+            !keyStringV2Index);
+}
+
+/**
+ * Fails the downgrade if a time-series bucket of this node is compressed, which earlier versions
+ * of the server cannot read.
+ */
+void uassertNoCompressedTimeseriesBuckets(OperationContext* opCtx) {
+    std::vector<NamespaceString> bucketsNamespaces;
+    for (const auto& dbName : DatabaseHolder::get(opCtx)->getNames()) {
+        catalog::forEachCollectionFromDb(
+            opCtx, dbName, MODE_IS, [&](const CollectionPtr& collection) {
+                if (collection->getTimeseriesOptions()) {
+                    bucketsNamespaces.push_back(collection->ns());
+                }
+                return true;
+            });
+    }
+
+    DBDirectClient client(opCtx);
+    for (const auto& nss : bucketsNamespaces) {
+        auto compressedBucket = client.findOne(
+            nss.ns(), BSON("control.version" << timeseries::kTimeseriesControlCompressedVersion));
+        uassert(ErrorCodes::CannotDowngrade,
+                str::stream() << "Cannot downgrade the cluster when there are compressed "
+                                 "time-series buckets; drop the time-series collections before "
+                                 "downgrading. First detected collection: "
+                              << nss.getTimeseriesViewNamespace(),
+                compressedBucket.isEmpty());
+    }
+}
+
 /**
  * Sets the minimum allowed feature compatibility version for the cluster. The cluster should not
  * use any new features introduced in binary versions that are newer than the feature compatibility
@@ -670,6 +715,14 @@ private:
             Lock::GlobalLock lk(opCtx, MODE_S);
         }
 
+        // Indexes using KeyString V2 are only created while the FCV is fully upgraded. Check for
+        // them after the barrier above, so that no index build started before the FCV change can
+        // still create one.
+        uassertNoKeyStringV2Indexes(opCtx);
+
+        // Likewise, time-series buckets are only compressed while the FCV is fully upgraded.
+        uassertNoCompressedTimeseriesBuckets(opCtx);
+
         uassert(ErrorCodes::Error(549181),
                 "Failing upgrade due to 'failDowngrading' failpoint set",
                 !failDowngrading.shouldFail());
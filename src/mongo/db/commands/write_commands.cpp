@@ -27,6 +27,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
 #include "mongo/base/checked_cast.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/mutable/document.h"
@@ -63,9 +65,11 @@
 #include "mongo/db/storage/duplicate_key_error_info.h"
 #include "mongo/db/storage/storage_parameters_gen.h"
 #include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/timeseries/timeseries_constants.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/logv2/log.h"
 #include "mongo/logv2/redaction.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/util/fail_point.h"
@@ -264,9 +268,6 @@ bool updateOnlyModifiesTimeseriesMetaField(OperationContext* opCtx,
     return true;
 }
 
-// Default for control.version in time-series bucket collection.
-const int kTimeseriesControlVersion = 1;
-
 /**
  * Transforms a single time-series insert to an update request on an existing bucket.
  */
@@ -363,7 +364,8 @@ BSONObj makeTimeseriesInsertDocument(std::shared_ptr<BucketCatalog::WriteBatch>
     builder.append("_id", batch->bucket()->id());
     {
         BSONObjBuilder bucketControlBuilder(builder.subobjStart("control"));
-        bucketControlBuilder.append("version", kTimeseriesControlVersion);
+        bucketControlBuilder.append(timeseries::kBucketControlVersionFieldName,
+                                    timeseries::kTimeseriesControlDefaultVersion);
         bucketControlBuilder.append("min", batch->min());
         bucketControlBuilder.append("max", batch->max());
     }
@@ -770,6 +772,50 @@ public:
                 OperationSource::kTimeseries));
         }
 
+        /**
+         * Compresses a bucket that will no longer be written to by the bucket catalog. Failing to
+         * compress is not an error for the insert, the bucket just stays uncompressed.
+         */
+        void _performTimeseriesBucketCompression(
+            OperationContext* opCtx, const BucketCatalog::ClosedBucket& closedBucket) const {
+            if (!feature_flags::gTimeseriesBucketCompression.isEnabled(
+                    serverGlobalParams.featureCompatibility)) {
+                return;
+            }
+
+            // Use a separate client so that the rewrite is neither part of the user's session nor
+            // interrupted along with the user's operation. It is a write, so it must still be
+            // interrupted when the node steps down.
+            auto client = opCtx->getServiceContext()->makeClient("TimeseriesBucketCompression");
+            {
+                stdx::lock_guard<Client> lk(*client.get());
+                client->setSystemOperationKillableByStepdown(lk);
+            }
+            AlternativeClientRegion acr(client);
+            auto compressionOpCtx = cc().makeOperationContext();
+
+            auto status = write_ops_exec::performTimeseriesBucketCompression(
+                compressionOpCtx.get(),
+                ns().makeTimeseriesBucketsNamespace(),
+                closedBucket.bucketId,
+                closedBucket.timeField);
+            if (status == ErrorCodes::InterruptedDueToReplStateChange) {
+                // The bucket stays uncompressed, like the buckets expired under memory pressure.
+                LOGV2_DEBUG(6179068,
+                            1,
+                            "Time-series bucket compression interrupted by a replication state "
+                            "change",
+                            "bucketId"_attr = closedBucket.bucketId,
+                            "error"_attr = status);
+            } else if (!status.isOK()) {
+                LOGV2_DEBUG(6179021,
+                            1,
+                            "Failed to compress time-series bucket",
+                            "bucketId"_attr = closedBucket.bucketId,
+                            "error"_attr = status);
+            }
+        }
+
         void _commitTimeseriesBucket(OperationContext* opCtx,
                                      std::shared_ptr<BucketCatalog::WriteBatch> batch,
                                      size_t start,
@@ -781,7 +827,7 @@ public:
                                      std::vector<size_t>* docsToRetry) const {
             auto& bucketCatalog = BucketCatalog::get(opCtx);
 
-            auto metadata = bucketCatalog.getMetadata(batch->bucket());
+            auto metadata = bucketCatalog.getMetadata(batch);
             bool prepared = bucketCatalog.prepareCommit(batch);
             if (!prepared) {
                 invariant(batch->finished());
@@ -831,8 +877,13 @@ public:
 
             getOpTimeAndElectionId(opCtx, opTime, electionId);
 
-            bucketCatalog.finish(batch, BucketCatalog::CommitInfo{*opTime, *electionId});
+            auto closedBuckets =
+                bucketCatalog.finish(batch, BucketCatalog::CommitInfo{*opTime, *electionId});
             batchGuard.dismiss();
+
+            for (const auto& closedBucket : closedBuckets) {
+                _performTimeseriesBucketCompression(opCtx, closedBucket);
+            }
         }
 
         bool _commitTimeseriesBucketsAtomically(OperationContext* opCtx,
@@ -865,7 +916,7 @@ public:
             std::vector<write_ops::UpdateCommandRequest> updateOps;
 
             for (auto batch : batchesToCommit) {
-                auto metadata = bucketCatalog.getMetadata(batch.get()->bucket());
+                auto metadata = bucketCatalog.getMetadata(batch.get());
                 if (!bucketCatalog.prepareCommit(batch)) {
                     for (auto batchToAbort : batchesToCommit) {
                         bucketCatalog.abort(batchToAbort);
@@ -895,11 +946,20 @@ public:
 
             getOpTimeAndElectionId(opCtx, opTime, electionId);
 
+            BucketCatalog::ClosedBuckets closedBuckets;
             for (auto batch : batchesToCommit) {
-                bucketCatalog.finish(batch, BucketCatalog::CommitInfo{*opTime, *electionId});
+                auto batchClosedBuckets =
+                    bucketCatalog.finish(batch, BucketCatalog::CommitInfo{*opTime, *electionId});
+                std::move(batchClosedBuckets.begin(),
+                          batchClosedBuckets.end(),
+                          std::back_inserter(closedBuckets));
                 batch.get().reset();
             }
 
+            for (const auto& closedBucket : closedBuckets) {
+                _performTimeseriesBucketCompression(opCtx, closedBucket);
+            }
+
             return true;
         }
 
@@ -240,6 +240,9 @@ public:
     // single solution).
     bool fromMultiPlanner{false};
 
+    // True if the plan came from the plan cache.
+    bool fromPlanCache{false};
+
     // True if a replan was triggered during the execution of this operation.
     std::optional<std::string> replanReason;
 
@@ -253,6 +256,8 @@ public:
     boost::optional<uint32_t> planCacheKey;
     // The hash of the query's "stable" key. This represents the query's shape.
     boost::optional<uint32_t> queryHash;
+    // The key of the query's shape in the query shape statistics store, if the store is enabled.
+    boost::optional<std::string> queryShapeStatsKey;
 
     // Details of any error (whether from an exception or a command returning failure).
     Status errInfo = Status::OK();
@@ -30,6 +30,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/exec/bucket_unpacker.h"
+
+#include "mongo/bson/util/bsoncolumn.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/db/timeseries/timeseries_constants.h"
 
 namespace mongo {
@@ -92,14 +95,29 @@ void BucketUnpacker::reset(BSONObj&& bucket) {
     _bucket = std::move(bucket);
     uassert(5346510, "An empty bucket cannot be unpacked", !_bucket.isEmpty());
 
-    auto&& dataRegion = _bucket.getField(timeseries::kBucketDataFieldName).Obj();
-    if (dataRegion.isEmpty()) {
+    _dataRegion = _bucket.getField(timeseries::kBucketDataFieldName).Obj();
+    if (_dataRegion.isEmpty()) {
         // If the data field of a bucket is present but it holds an empty object, there's nothing to
         // unpack.
         return;
     }
 
-    auto&& timeFieldElem = dataRegion.getField(_spec.timeField);
+    if (timeseries::isCompressedBucket(_bucket)) {
+        // Decompress only the columns this unpacker needs. The decompressed columns have the same
+        // layout as an uncompressed bucket, so the rest of the unpacking is shared.
+        BSONObjBuilder decompressed;
+        for (auto&& elem : _dataRegion) {
+            auto colName = elem.fieldNameStringData();
+            if (colName == _spec.timeField ||
+                determineIncludeField(colName, _unpackerBehavior, _spec)) {
+                BSONObjBuilder columnBuilder(decompressed.subobjStart(colName));
+                BSONColumn(elem).decompress(&columnBuilder);
+            }
+        }
+        _dataRegion = decompressed.obj();
+    }
+
+    auto&& timeFieldElem = _dataRegion.getField(_spec.timeField);
     uassert(5346700,
             "The $_internalUnpackBucket stage requires the data region to have a timeField object",
             timeFieldElem);
@@ -126,7 +144,7 @@ void BucketUnpacker::reset(BSONObj&& bucket) {
 
     // Walk the data region of the bucket, and decide if an iterator should be set up based on the
     // include or exclude case.
-    for (auto&& elem : dataRegion) {
+    for (auto&& elem : _dataRegion) {
         auto& colName = elem.fieldNameStringData();
         if (colName == _spec.timeField) {
             // Skip adding a FieldIterator for the timeField since the timestamp value from
@@ -218,6 +236,80 @@ Document BucketUnpacker::getNext() {
     return measurement.freeze();
 }
 
+BucketUnpacker::MeasurementBatch BucketUnpacker::getNextBatch(size_t maxBatchSize) {
+    tassert(6179030, "'getNextBatch()' requires the bucket to be owned", _bucket.isOwned());
+    tassert(6179031, "'getNextBatch()' was called after the bucket has been exhausted", hasNext());
+    tassert(6179032,
+            "'getNextBatch()' does not support including the bucket id and row index",
+            !_spec.includeBucketIdAndRowIndex);
+
+    MeasurementBatch batch;
+
+    // The time column drives the iteration, so it determines the row keys of the batch.
+    auto& timeElems = batch.timeElements;
+    timeElems.reserve(std::min<size_t>(maxBatchSize, _numberOfMeasurements));
+    while (timeElems.size() < maxBatchSize && _timeFieldIter->more()) {
+        timeElems.push_back(_timeFieldIter->next());
+    }
+    batch.numMeasurements = timeElems.size();
+    batch.columns.reserve(2 + _fieldIters.size() + _spec.computedMetaProjFields.size());
+
+    if (_includeTimeField) {
+        auto& column = batch.columns.emplace_back();
+        column.fieldName = _spec.timeField;
+        column.values.reserve(timeElems.size());
+        for (auto&& timeElem : timeElems) {
+            column.values.emplace_back(timeElem);
+        }
+    }
+
+    if (_includeMetaField && _metaValue) {
+        batch.columns.push_back({*_spec.metaField, {Value{_metaValue}}, true});
+    }
+
+    for (auto&& [colName, colIter] : _fieldIters) {
+        auto& column = batch.columns.emplace_back();
+        column.fieldName = colName;
+        column.values.resize(timeElems.size());
+        for (size_t i = 0; i < timeElems.size() && colIter.more(); ++i) {
+            if (auto&& elem = *colIter;
+                elem.fieldNameStringData() == timeElems[i].fieldNameStringData()) {
+                column.values[i] = Value{elem};
+                colIter.advance(elem);
+            }
+        }
+    }
+
+    for (auto&& name : _spec.computedMetaProjFields) {
+        batch.columns.push_back({name, {Value{_computedMetaProjections[name]}}, true});
+    }
+
+    return batch;
+}
+
+int32_t BucketUnpacker::skipRemaining() {
+    int32_t skipped = 0;
+    while (hasNext()) {
+        _timeFieldIter->next();
+        ++skipped;
+    }
+    return skipped;
+}
+
+Document BucketUnpacker::MeasurementBatch::getMeasurement(size_t i) const {
+    tassert(6179033, "measurement index out of range of the batch", i < numMeasurements);
+
+    MutableDocument measurement{columns.size()};
+    for (auto&& column : columns) {
+        if (column.isConstant) {
+            measurement.addField(column.fieldName, column.values.front());
+        } else if (auto&& value = column.values[i]; !value.missing()) {
+            measurement.addField(column.fieldName, value);
+        }
+    }
+    return measurement.freeze();
+}
+
 Document BucketUnpacker::extractSingleMeasurement(int j) {
     tassert(5422101,
             "'extractSingleMeasurment' expects j to be greater than or equal to zero and less than "
@@ -228,13 +320,12 @@ Document BucketUnpacker::extractSingleMeasurement(int j) {
 
     auto rowKey = std::to_string(j);
     auto targetIdx = StringData{rowKey};
-    auto&& dataRegion = _bucket.getField(timeseries::kBucketDataFieldName).Obj();
 
     if (_includeMetaField && !_metaValue.isNull()) {
         measurement.addField(*_spec.metaField, Value{_metaValue});
     }
 
-    for (auto&& dataElem : dataRegion) {
+    for (auto&& dataElem : _dataRegion) {
         auto colName = dataElem.fieldNameStringData();
         if (!determineIncludeField(colName, _unpackerBehavior, _spec)) {
             continue;
@@ -97,6 +97,41 @@ public:
     // set difference between all fields in the bucket and the provided fields.
     enum class Behavior { kInclude, kExclude };
 
+    /**
+     * A block of consecutive measurements from a single bucket, decoded one column at a time. Only
+     * the columns that the unpacker materializes are decoded.
+     */
+    struct MeasurementBatch {
+        struct Column {
+            std::string fieldName;
+
+            // One value per measurement in the batch, where missing values are absent from the
+            // measurement. Constant columns (metadata and computed meta projections) instead hold a
+            // single value that is shared by all measurements in the batch.
+            std::vector<Value> values;
+            bool isConstant = false;
+        };
+
+        size_t size() const {
+            return numMeasurements;
+        }
+
+        /**
+         * Materializes the i-th measurement of the batch. The result is identical to what
+         * 'BucketUnpacker::getNext()' would have produced for the same measurement.
+         */
+        Document getMeasurement(size_t i) const;
+
+        size_t numMeasurements = 0;
+
+        // The time value of each measurement in the batch, whether or not the time field is
+        // materialized. These point into the bucket and are only valid until the next 'reset()'.
+        std::vector<BSONElement> timeElements;
+
+        // The columns in the order their fields appear in a materialized measurement.
+        std::vector<Column> columns;
+    };
+
     BucketUnpacker(BucketSpec spec, Behavior unpackerBehavior);
 
     /**
@@ -105,6 +140,14 @@ public:
      */
     Document getNext();
 
+    /**
+     * Decodes up to 'maxBatchSize' of the remaining measurements in the bucket column by column,
+     * without materializing a Document per measurement. Can be interleaved with 'getNext()'. A
+     * precondition of this method is that 'hasNext()' must be true and that the bucket spec does
+     * not request the bucket id and row index.
+     */
+    MeasurementBatch getNextBatch(size_t maxBatchSize);
+
     /**
      * This method will extract the j-th measurement from the bucket. A precondition of this method
      * is that j >= 0 && j <= the number of measurements within the underlying bucket.
@@ -115,6 +158,21 @@ public:
         return _timeFieldIter && _timeFieldIter->more();
     }
 
+    /**
+     * Skips the measurements of the current bucket that have not been unpacked yet and returns how
+     * many were skipped.
+     */
+    int32_t skipRemaining();
+
+    /**
+     * Returns true if every measurement materialized from the current bucket is an empty document,
+     * which is the case when the rest of the pipeline does not depend on any field.
+     */
+    bool producesEmptyMeasurements() const {
+        return _fieldIters.empty() && !_includeTimeField && !(_includeMetaField && _metaValue) &&
+            _spec.computedMetaProjFields.empty() && !_spec.includeBucketIdAndRowIndex;
+    }
+
     /**
      * This resets the unpacker to prepare to unpack a new bucket described by the given document.
      */
@@ -165,6 +223,10 @@ private:
     // The bucket being unpacked.
     BSONObj _bucket;
 
+    // The data region of the bucket. For compressed buckets this owns the decompressed columns
+    // that are needed by this unpacker, otherwise it points into '_bucket'.
+    BSONObj _dataRegion;
+
     // Since the metadata value is the same across all materialized measurements we can cache the
     // metadata BSONElement in the reset phase and use it to materialize the metadata in each
     // measurement.
@@ -32,6 +32,7 @@
 #include "mongo/bson/json.h"
 #include "mongo/db/exec/bucket_unpacker.h"
 #include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -185,6 +186,33 @@ TEST_F(BucketUnpackerTest, SparseColumnsWhereOneColumnIsExhaustedBeforeTheOther)
     ASSERT_FALSE(unpacker.hasNext());
 }
 
+TEST_F(BucketUnpackerTest, GetNextBatchMatchesGetNext) {
+    auto bucket = fromjson(
+        "{meta: {'m1': 999, 'm2': 9999}, data: {_id: {'0':1, '1':2, '2':3}, time: {'0':1, '1':2, "
+        "'2':3}, a:{'0':1, '2':3}, b:{'1':1}, c:{'2':'x'}}}");
+
+    auto expected = makeBucketUnpacker({"c"},
+                                       BucketUnpacker::Behavior::kExclude,
+                                       bucket.getOwned(),
+                                       kUserDefinedMetaName.toString());
+    auto unpacker = makeBucketUnpacker({"c"},
+                                       BucketUnpacker::Behavior::kExclude,
+                                       bucket.getOwned(),
+                                       kUserDefinedMetaName.toString());
+
+    // The first batch is cut short by the batch size, the second one by the end of the bucket.
+    auto batch = unpacker.getNextBatch(2);
+    ASSERT_EQ(batch.size(), 2);
+    ASSERT_DOCUMENT_EQ(batch.getMeasurement(0), expected.getNext());
+    ASSERT_DOCUMENT_EQ(batch.getMeasurement(1), expected.getNext());
+
+    ASSERT_TRUE(unpacker.hasNext());
+    batch = unpacker.getNextBatch(2);
+    ASSERT_EQ(batch.size(), 1);
+    ASSERT_DOCUMENT_EQ(batch.getMeasurement(0), expected.getNext());
+    ASSERT_FALSE(unpacker.hasNext());
+}
+
 TEST_F(BucketUnpackerTest, UnpackBasicIncludeWithDollarPrefix) {
     std::set<std::string> fields{
         "_id", "$a", "b", kUserDefinedMetaName.toString(), kUserDefinedTimeName.toString()};
@@ -646,6 +674,36 @@ TEST_F(BucketUnpackerTest, ExtractSingleMeasurementSparseIncludeBucketIdRowIndex
     ASSERT_DOCUMENT_EQ(next, expected);
 }
 
+TEST_F(BucketUnpackerTest, UnpackCompressedBucket) {
+    std::set<std::string> fields{"b"};
+
+    auto d1 = dateFromISOString("2020-02-17T00:00:00.000Z").getValue();
+    auto d2 = dateFromISOString("2020-02-17T01:00:00.000Z").getValue();
+    auto d3 = dateFromISOString("2020-02-17T02:00:00.000Z").getValue();
+    auto bucket = BSON("control" << BSON("version" << 1) << "meta"
+                                 << BSON("m1" << 999) << "data"
+                                 << BSON("time" << BSON("0" << d2 << "1" << d1 << "2" << d3)
+                                                << "a" << BSON("0" << 2 << "1" << 1 << "2" << 3)
+                                                << "b" << BSON("2" << 1.5)));
+    auto compressed = timeseries::compressBucket(bucket, kUserDefinedTimeName);
+    ASSERT(compressed);
+
+    auto unpacker = makeBucketUnpacker(std::move(fields),
+                                       BucketUnpacker::Behavior::kExclude,
+                                       std::move(*compressed),
+                                       kUserDefinedMetaName.toString());
+    ASSERT_EQ(unpacker.numberOfMeasurements(), 3);
+
+    // Measurements come out in time order since compression sorts them.
+    assertGetNext(unpacker, Document{{"time", d1}, {"myMeta", Document{{"m1", 999}}}, {"a", 1}});
+    assertGetNext(unpacker, Document{{"time", d2}, {"myMeta", Document{{"m1", 999}}}, {"a", 2}});
+    assertGetNext(unpacker, Document{{"time", d3}, {"myMeta", Document{{"m1", 999}}}, {"a", 3}});
+    ASSERT_FALSE(unpacker.hasNext());
+
+    ASSERT_DOCUMENT_EQ(unpacker.extractSingleMeasurement(1),
+                       Document({{"myMeta", Document{{"m1", 999}}}, {"time", d2}, {"a", 2}}));
+}
+
 TEST_F(BucketUnpackerTest, ComputeMeasurementCountLowerBoundsAreCorrect) {
     // The last table entry is a sentinel for an upper bound on the interval that covers measurement
     // counts up to 16 MB.
@@ -516,6 +516,52 @@ static stdx::unordered_map<std::string, InstrFn> kInstrFunctions = {
     {"collMax", InstrFn{[](size_t n) { return n == 2; }, &vm::CodeFragment::appendCollMax, true}},
     {"mod", InstrFn{[](size_t n) { return n == 2; }, &vm::CodeFragment::appendMod, false}},
 };
+
+/**
+ * Field lookups by a constant name and defaulting a missing value to a constant make up most of the
+ * work of typical filters and projections. Compiles such calls into a single instruction carrying
+ * the constant rather than one pushing the constant and another consuming it. Returns nullptr if
+ * 'name' with 'args' is not one of them.
+ */
+std::unique_ptr<vm::CodeFragment> compileWithImmediate(
+    const std::string& name,
+    const std::vector<std::unique_ptr<EExpression>>& args,
+    CompileCtx& ctx) {
+    if (args.size() != 2) {
+        return nullptr;
+    }
+    auto constant = dynamic_cast<const EConstant*>(args[1].get());
+    if (!constant) {
+        return nullptr;
+    }
+    auto [tag, val] = constant->getConstant();
+
+    if (name == "getField" && value::isString(tag)) {
+        auto fieldName = value::getStringView(tag, val);
+        if (fieldName.size() > std::numeric_limits<uint8_t>::max()) {
+            return nullptr;
+        }
+
+        auto code = std::make_unique<vm::CodeFragment>();
+        code->append(args[0]->compile(ctx));
+        code->appendGetField(fieldName);
+        return code;
+    }
+
+    if (name == "fillEmpty" &&
+        (tag == value::TypeTags::Null || tag == value::TypeTags::Boolean)) {
+        auto k = tag == value::TypeTags::Null
+            ? vm::Instruction::Null
+            : (value::bitcastTo<bool>(val) ? vm::Instruction::True : vm::Instruction::False);
+
+        auto code = std::make_unique<vm::CodeFragment>();
+        code->append(args[0]->compile(ctx));
+        code->appendFillEmpty(k);
+        return code;
+    }
+
+    return nullptr;
+}
 }  // namespace
 
 std::unique_ptr<vm::CodeFragment> EFunction::compile(CompileCtx& ctx) const {
@@ -546,6 +592,10 @@ std::unique_ptr<vm::CodeFragment> EFunction::compile(CompileCtx& ctx) const {
         return code;
     }
 
+    if (auto code = compileWithImmediate(_name, _nodes, ctx)) {
+        return code;
+    }
+
     if (auto it = kInstrFunctions.find(_name); it != kInstrFunctions.end()) {
         if (!it->second.arityTest(_nodes.size())) {
             uasserted(4822845,
@@ -892,6 +942,28 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy(bool isSmp) {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    auto env = std::make_unique<RuntimeEnvironment>();
+    env->_state = std::make_shared<State>(*_state);
+
+    auto& state = *env->_state;
+    for (size_t idx = 0; idx < state.vals.size(); ++idx) {
+        if (state.owned[idx]) {
+            // Until the value is copied the slot still refers to the value owned by this
+            // environment, which the copy must not release should the copying fail.
+            state.owned[idx] = false;
+            std::tie(state.typeTags[idx], state.vals[idx]) =
+                copyValue(state.typeTags[idx], state.vals[idx]);
+            state.owned[idx] = true;
+        }
+    }
+
+    for (auto&& [slotId, index] : state.slots) {
+        env->emplaceAccessor(slotId, index);
+    }
+    return env;
+}
+
 void RuntimeEnvironment::debugString(StringBuilder* builder) {
     using namespace std::literals;
 
@@ -165,6 +165,14 @@ public:
      */
     std::unique_ptr<RuntimeEnvironment> makeCopy(bool isSmp);
 
+    /**
+     * Make a copy of this environment which does not share any data with it. Owned slot values are
+     * copied, unowned ones are shared. Unlike 'makeCopy()' the new environment can be modified
+     * independently of this one, which allows a plan built against this environment to be cloned
+     * and executed with different slot values.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
@@ -212,6 +220,7 @@ private:
 };
 
 class PlanStage;
+struct ParallelScanState;
 struct CompileCtx {
     CompileCtx(std::unique_ptr<RuntimeEnvironment> env) : env{std::move(env)} {}
 
@@ -234,6 +243,10 @@ struct CompileCtx {
     stdx::unordered_map<SpoolId, std::shared_ptr<SpoolBuffer>> spoolBuffers;
     bool aggExpression{false};
 
+    // Set by an exchange on the contexts its producers are prepared with, so that the parallel
+    // scans the producers run split the collection between them.
+    std::shared_ptr<ParallelScanState> parallelScanState;
+
 private:
     // Any data that a PlanStage needs from the RuntimeEnvironment should not be accessed directly
     // but insteady by looking up the corresponding slots. These slots are set up during the process
@@ -353,6 +366,10 @@ public:
 
     std::vector<DebugPrinter::Block> debugPrint() const override;
 
+    std::pair<value::TypeTags, value::Value> getConstant() const {
+        return {_tag, _val};
+    }
+
 private:
     value::TypeTags _tag;
     value::Value _val;
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+
+namespace mongo::sbe {
+class SBEGetFieldFillEmptyTest : public EExpressionTestFixture {
+protected:
+    void runAndAssertInt32(const vm::CodeFragment* compiledExpr, int32_t expected) {
+        auto [tag, val] = runCompiledExpression(compiledExpr);
+        value::ValueGuard guard(tag, val);
+
+        ASSERT_EQUALS(value::TypeTags::NumberInt32, tag);
+        ASSERT_EQUALS(expected, value::bitcastTo<int32_t>(val));
+    }
+};
+
+TEST_F(SBEGetFieldFillEmptyTest, GetFieldByConstantName) {
+    value::OwnedValueAccessor objAccessor;
+    auto objSlot = bindAccessor(&objAccessor);
+    auto getFieldExpr = makeE<EFunction>(
+        "getField", makeEs(makeE<EVariable>(objSlot), makeE<EConstant>("b"_sd)));
+    auto compiledExpr = compileExpression(*getFieldExpr);
+
+    auto bsonObj = BSON("a" << 1 << "b" << 2);
+    objAccessor.reset(false,
+                      value::TypeTags::bsonObject,
+                      value::bitcastFrom<const char*>(bsonObj.objdata()));
+    runAndAssertInt32(compiledExpr.get(), 2);
+
+    auto [objTag, objVal] = value::makeNewObject();
+    value::getObjectView(objVal)->push_back(
+        "b", value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(3));
+    objAccessor.reset(true, objTag, objVal);
+    runAndAssertInt32(compiledExpr.get(), 3);
+
+    auto missingObj = BSON("a" << 1);
+    objAccessor.reset(false,
+                      value::TypeTags::bsonObject,
+                      value::bitcastFrom<const char*>(missingObj.objdata()));
+    runAndAssertNothing(compiledExpr.get());
+
+    objAccessor.reset(false, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(1));
+    runAndAssertNothing(compiledExpr.get());
+}
+
+TEST_F(SBEGetFieldFillEmptyTest, GetFieldByLongOrVariableName) {
+    value::OwnedValueAccessor objAccessor;
+    value::OwnedValueAccessor nameAccessor;
+    auto objSlot = bindAccessor(&objAccessor);
+    auto nameSlot = bindAccessor(&nameAccessor);
+
+    // A name too long to be carried by the instruction.
+    std::string longName(300, 'x');
+    auto longNameExpr = makeE<EFunction>(
+        "getField", makeEs(makeE<EVariable>(objSlot), makeE<EConstant>(StringData{longName})));
+    auto compiledLongNameExpr = compileExpression(*longNameExpr);
+
+    auto variableNameExpr = makeE<EFunction>(
+        "getField", makeEs(makeE<EVariable>(objSlot), makeE<EVariable>(nameSlot)));
+    auto compiledVariableNameExpr = compileExpression(*variableNameExpr);
+
+    auto bsonObj = BSON(longName << 1 << "b" << 2);
+    objAccessor.reset(false,
+                      value::TypeTags::bsonObject,
+                      value::bitcastFrom<const char*>(bsonObj.objdata()));
+    runAndAssertInt32(compiledLongNameExpr.get(), 1);
+
+    auto [nameTag, nameVal] = value::makeNewString("b");
+    nameAccessor.reset(true, nameTag, nameVal);
+    runAndAssertInt32(compiledVariableNameExpr.get(), 2);
+}
+
+TEST_F(SBEGetFieldFillEmptyTest, FillEmptyWithConstant) {
+    value::OwnedValueAccessor inputAccessor;
+    auto inputSlot = bindAccessor(&inputAccessor);
+
+    auto compileFillEmpty = [&](std::unique_ptr<EExpression> constant) {
+        auto fillEmptyExpr = makeE<EFunction>(
+            "fillEmpty", makeEs(makeE<EVariable>(inputSlot), std::move(constant)));
+        return compileExpression(*fillEmptyExpr);
+    };
+    auto fillEmptyNull = compileFillEmpty(makeE<EConstant>(value::TypeTags::Null, 0));
+    auto fillEmptyFalse = compileFillEmpty(
+        makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(false)));
+    auto fillEmptyTrue = compileFillEmpty(
+        makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(true)));
+    auto fillEmptyInt = compileFillEmpty(
+        makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(7)));
+
+    inputAccessor.reset(value::TypeTags::Nothing, 0);
+    {
+        auto [tag, val] = runCompiledExpression(fillEmptyNull.get());
+        ASSERT_EQUALS(value::TypeTags::Null, tag);
+    }
+    ASSERT_FALSE(runCompiledExpressionPredicate(fillEmptyFalse.get()));
+    ASSERT_TRUE(runCompiledExpressionPredicate(fillEmptyTrue.get()));
+    runAndAssertInt32(fillEmptyInt.get(), 7);
+
+    inputAccessor.reset(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(5));
+    for (auto compiledExpr : {fillEmptyNull.get(), fillEmptyFalse.get(), fillEmptyTrue.get()}) {
+        runAndAssertInt32(compiledExpr, 5);
+    }
+    runAndAssertInt32(fillEmptyInt.get(), 5);
+
+    auto [strTag, strVal] = value::makeNewString("a string too long to be stored inline");
+    inputAccessor.reset(true, strTag, strVal);
+    auto [tag, val] = runCompiledExpression(fillEmptyFalse.get());
+    value::ValueGuard guard(tag, val);
+    ASSERT_EQUALS(strTag, tag);
+    ASSERT_EQUALS("a string too long to be stored inline", value::getStringView(tag, val));
+}
+}  // namespace mongo::sbe
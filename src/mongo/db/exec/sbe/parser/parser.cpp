@@ -160,7 +160,9 @@ static constexpr auto kSyntax = R"(
                 GROUP <- 'group' IDENT_LIST
                                  PROJECT_LIST
                                  IDENT? # optional collator slot
+                                 GROUP_SPILL_FLAG? # allowDiskUse
                                  OPERATOR
+                GROUP_SPILL_FLAG <- <'spill'>
                 HJOIN <- 'hj' IDENT? # optional collator slot
                               LEFT
                               RIGHT
@@ -291,7 +293,8 @@ static constexpr auto kSyntax = R"(
                 SORT_DIR <- <'asc'> / <'desc'>
                 SORT_DIR_LIST <- '[' (SORT_DIR (',' SORT_DIR)* )? ']'
 
-                STAGE_KEYWORDS <- <'left'> / <'right'> # reserved keywords to avoid collision with IDENT names
+                # Reserved keywords to avoid collision with IDENT names.
+                STAGE_KEYWORDS <- <'left'> / <'right'> / <'spill'>
 
                 %whitespace  <-  ([ \t\r\n]* ('#' (!'\n' .)* '\n' [ \t\r\n]*)*)
                 %word        <-  [a-z]+
@@ -1113,25 +1116,28 @@ void Parser::walkMkObj(AstQuery& ast) {
 }
 
 void Parser::walkGroup(AstQuery& ast) {
+    using namespace peg::udl;
+
     walkChildren(ast);
 
-    size_t collatorSlotPos = 0;
-    size_t inputPos = 0;
-    // Check if an optional collator slot was provided.
-    if (ast.nodes.size() == 4) {
-        inputPos = 3;
-        collatorSlotPos = 2;
-    } else {
-        inputPos = 2;
+    // The optional collator slot and spill flag sit between the project list and the input.
+    size_t inputPos = ast.nodes.size() - 1;
+    boost::optional<value::SlotId> collatorSlot;
+    bool allowDiskUse = false;
+    for (size_t idx = 2; idx < inputPos; ++idx) {
+        if (ast.nodes[idx]->tag == "GROUP_SPILL_FLAG"_) {
+            allowDiskUse = true;
+        } else {
+            collatorSlot = lookupSlot(std::move(ast.nodes[idx]->identifier));
+        }
     }
 
-    ast.stage = makeS<HashAggStage>(
-        std::move(ast.nodes[inputPos]->stage),
-        lookupSlots(std::move(ast.nodes[0]->identifiers)),
-        lookupSlots(std::move(ast.nodes[1]->projects)),
-        collatorSlotPos ? lookupSlot(std::move(ast.nodes[collatorSlotPos]->identifier))
-                        : boost::none,
-        getCurrentPlanNodeId());
+    ast.stage = makeS<HashAggStage>(std::move(ast.nodes[inputPos]->stage),
+                                    lookupSlots(std::move(ast.nodes[0]->identifiers)),
+                                    lookupSlots(std::move(ast.nodes[1]->projects)),
+                                    collatorSlot,
+                                    allowDiskUse,
+                                    getCurrentPlanNodeId());
 }
 
 void Parser::walkHashJoin(AstQuery& ast) {
@@ -1154,6 +1160,7 @@ void Parser::walkHashJoin(AstQuery& ast) {
                              lookupSlots(innerNode->nodes[0]->identifiers),  // inner conditions
                              lookupSlots(innerNode->nodes[1]->identifiers),  // inner projections
                              collatorSlot,                                   // collator
+                             false,                                          // allowDiskUse
                              getCurrentPlanNodeId());
 }
 
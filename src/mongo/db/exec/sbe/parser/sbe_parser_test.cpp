@@ -359,6 +359,7 @@ protected:
                             stage_builder::makeFunction(
                                 "max", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
                 boost::none, /* optional collator slot */
+                false,       /* allowDiskUse */
                 planNodeId),
             // GROUP with a collator slot.
             sbe::makeS<sbe::HashAggStage>(
@@ -371,6 +372,26 @@ protected:
                             stage_builder::makeFunction(
                                 "max", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
                 sbe::value::SlotId{4}, /* optional collator slot */
+                false,                 /* allowDiskUse */
+                planNodeId),
+            // GROUP allowed to spill, with and without a collator slot.
+            sbe::makeS<sbe::HashAggStage>(
+                sbe::makeS<sbe::CoScanStage>(planNodeId),
+                sbe::makeSV(sbe::value::SlotId{1}),
+                sbe::makeEM(sbe::value::SlotId{2},
+                            stage_builder::makeFunction(
+                                "sum", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
+                boost::none, /* optional collator slot */
+                true,        /* allowDiskUse */
+                planNodeId),
+            sbe::makeS<sbe::HashAggStage>(
+                sbe::makeS<sbe::CoScanStage>(planNodeId),
+                sbe::makeSV(sbe::value::SlotId{1}),
+                sbe::makeEM(sbe::value::SlotId{2},
+                            stage_builder::makeFunction(
+                                "sum", sbe::makeE<sbe::EVariable>(sbe::value::SlotId{1}))),
+                sbe::value::SlotId{4}, /* optional collator slot */
+                true,                  /* allowDiskUse */
                 planNodeId),
             // LIMIT
             sbe::makeS<sbe::LimitSkipStage>(
@@ -419,6 +440,7 @@ protected:
                                            sbe::makeSV(1, 2) /* inner conditions */,
                                            sbe::makeSV(5, 6) /* inner projections */,
                                            boost::none, /* optional collator slot */
+                                           false,       /* allowDiskUse */
                                            planNodeId),
             // HJOIN with a collator slot.
             sbe::makeS<sbe::HashJoinStage>(sbe::makeS<sbe::CoScanStage>(planNodeId),
@@ -428,6 +450,7 @@ protected:
                                            sbe::makeSV(1, 2) /* inner conditions */,
                                            sbe::makeSV(5, 6) /* inner projections */,
                                            sbe::value::SlotId{7}, /* optional collator slot */
+                                           false,                 /* allowDiskUse */
                                            planNodeId),
             // FILTER
             sbe::makeS<sbe::FilterStage<false>>(
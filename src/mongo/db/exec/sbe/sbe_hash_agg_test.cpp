@@ -37,6 +37,10 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 
@@ -82,6 +86,7 @@ TEST_F(HashAggStageTest, HashAggMinMaxTest) {
                    stage_builder::makeFunction(
                        "collMax", collExpr->clone(), makeE<EVariable>(scanSlot))),
             boost::none,
+            false /* allowDiskUse */,
             kEmptyPlanNodeId);
 
         auto outSlot = generateSlotId();
@@ -136,6 +141,7 @@ TEST_F(HashAggStageTest, HashAggAddToSetTest) {
                    stage_builder::makeFunction(
                        "collAddToSet", std::move(collExpr), makeE<EVariable>(scanSlot))),
             boost::none,
+            false /* allowDiskUse */,
             kEmptyPlanNodeId);
 
         return std::make_pair(hashAggSlot, std::move(hashAggStage));
@@ -220,6 +226,7 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
                                                makeE<EConstant>(value::TypeTags::NumberInt64,
                                                                 value::bitcastFrom<int64_t>(1)))),
                                     boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                    false /* allowDiskUse */,
                                     kEmptyPlanNodeId);
 
             return std::make_pair(countsSlot, std::move(hashAggStage));
@@ -280,4 +287,169 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
     }
 }
 
+/**
+ * Groups 'input' by value and counts the members of each group, with a hash table budget of
+ * 'memoryLimit' bytes. The members are counted by summing them up or, if 'collectMembers' is set,
+ * by collecting them into an array whose size grows with the group. Returns the counts ordered by
+ * group, along with the statistics of the stage.
+ */
+std::pair<std::vector<int64_t>, HashAggStats> runSpillingCountTest(
+    PlanStageTestFixture* fixture,
+    const BSONArray& input,
+    bool allowDiskUse,
+    bool useCollator,
+    long long memoryLimit = 256,
+    bool collectMembers = false) {
+    auto oldMemoryLimit = internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load();
+    internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.store(memoryLimit);
+    ON_BLOCK_EXIT(
+        [&] { internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.store(oldMemoryLimit); });
+
+    auto ctx = fixture->makeCompileCtx();
+    auto collatorSlot = fixture->generateSlotId();
+    auto collator =
+        std::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kToLowerString);
+    value::OwnedValueAccessor collatorAccessor;
+    ctx->pushCorrelated(collatorSlot, &collatorAccessor);
+    collatorAccessor.reset(value::TypeTags::collator,
+                           value::bitcastFrom<CollatorInterface*>(collator.get()));
+
+    auto [inputTag, inputVal] = stage_builder::makeValue(input);
+    auto [scanSlot, scanStage] = fixture->generateVirtualScan(inputTag, inputVal);
+
+    // Output the group-by key along with the count, so that the results can be put in order.
+    auto countSlot = fixture->generateSlotId();
+    auto countExpr = collectMembers
+        ? stage_builder::makeFunction("addToArray", makeE<EVariable>(scanSlot))
+        : stage_builder::makeFunction(
+              "sum",
+              makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1)));
+    auto hashAggStage =
+        makeS<HashAggStage>(std::move(scanStage),
+                            makeSV(scanSlot),
+                            makeEM(countSlot, std::move(countExpr)),
+                            boost::optional<value::SlotId>{useCollator, collatorSlot},
+                            allowDiskUse,
+                            kEmptyPlanNodeId);
+    auto hashAggStagePtr = hashAggStage.get();
+    auto outSlot = fixture->generateSlotId();
+    auto stage = makeProjectStage(
+        std::move(hashAggStage),
+        kEmptyPlanNodeId,
+        outSlot,
+        stage_builder::makeFunction(
+            "newArray", makeE<EVariable>(scanSlot), makeE<EVariable>(countSlot)));
+
+    auto resultAccessor = fixture->prepareTree(ctx.get(), stage.get(), outSlot);
+    auto [resultsTag, resultsVal] = fixture->getAllResults(stage.get(), resultAccessor);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    auto resultsView = value::getArrayView(resultsVal);
+    std::vector<std::pair<std::string, int64_t>> groups;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto group = value::getArrayView(resultsView->getAt(i).second);
+        auto [keyTag, keyVal] = group->getAt(0);
+        auto [countTag, countVal] = group->getAt(1);
+        int64_t count;
+        if (collectMembers) {
+            ASSERT_EQ(countTag, value::TypeTags::Array);
+            count = value::getArrayView(countVal)->size();
+        } else {
+            ASSERT_EQ(countTag, value::TypeTags::NumberInt64);
+            count = value::bitcastTo<int64_t>(countVal);
+        }
+        groups.emplace_back(str::toLower(value::getStringView(keyTag, keyVal)), count);
+    }
+    std::sort(groups.begin(), groups.end());
+
+    std::vector<int64_t> counts;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        // Every group must be returned exactly once, no matter whether it was spilled.
+        ASSERT(i == 0 || groups[i - 1].first != groups[i].first);
+        counts.push_back(groups[i].second);
+    }
+    return {std::move(counts),
+            *static_cast<const HashAggStats*>(hashAggStagePtr->getSpecificStats())};
+}
+
+TEST_F(HashAggStageTest, HashAggSpillTest) {
+    unittest::TempDir tempDir("HashAggSpillTest");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    BSONArrayBuilder bab;
+    std::vector<int64_t> expectedCounts;
+    for (int i = 0; i < 50; ++i) {
+        for (int j = 0; j <= i % 3; ++j) {
+            bab.append(str::stream() << "key" << (i < 10 ? "0" : "") << i);
+        }
+        expectedCounts.push_back(i % 3 + 1);
+    }
+    auto [counts, stats] = runSpillingCountTest(this, bab.arr(), true, false);
+    ASSERT(expectedCounts == counts);
+    ASSERT_GT(stats.spilledRecords, 0U);
+    ASSERT_GT(stats.spills, 0U);
+}
+
+TEST_F(HashAggStageTest, HashAggSpillCollationTest) {
+    unittest::TempDir tempDir("HashAggSpillCollationTest");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    // The spilled rows of a group differing only in case must still be aggregated together.
+    BSONArrayBuilder bab;
+    std::vector<int64_t> expectedCounts;
+    for (int i = 0; i < 30; ++i) {
+        auto suffix = std::string(str::stream() << (i < 10 ? "0" : "") << i);
+        bab.append("key" + suffix).append("KEY" + suffix).append("Key" + suffix);
+        expectedCounts.push_back(3);
+    }
+    auto [counts, stats] = runSpillingCountTest(this, bab.arr(), true, true);
+    ASSERT(expectedCounts == counts);
+    ASSERT_GT(stats.spilledRecords, 0U);
+    ASSERT_GT(stats.spills, 0U);
+}
+
+TEST_F(HashAggStageTest, HashAggSpillsWhenAccumulatorsGrow) {
+    unittest::TempDir tempDir("HashAggSpillsWhenAccumulatorsGrow");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    // The groups inserted into the table fit in the budget, but the array collected for the first
+    // one outgrows it, so that the groups coming after it are spilled.
+    BSONArrayBuilder bab;
+    std::vector<int64_t> expectedCounts{1000};
+    for (int i = 0; i < 1000; ++i) {
+        bab.append("key00");
+    }
+    for (int i = 1; i < 10; ++i) {
+        bab.append(str::stream() << "key0" << i);
+        expectedCounts.push_back(1);
+    }
+
+    auto input = bab.arr();
+    auto [counts, stats] = runSpillingCountTest(
+        this, input, true, false, 4096 /* memoryLimit */, true /* collectMembers */);
+    ASSERT(expectedCounts == counts);
+    ASSERT_EQ(stats.spilledRecords, 9U);
+
+    // Summing up the members rather than collecting them, the same groups fit in the budget.
+    auto [summedCounts, summedStats] =
+        runSpillingCountTest(this, input, true, false, 4096 /* memoryLimit */);
+    ASSERT(expectedCounts == summedCounts);
+    ASSERT_EQ(summedStats.spilledRecords, 0U);
+}
+
+TEST_F(HashAggStageTest, HashAggSpillFailsWithoutDiskUse) {
+    BSONArrayBuilder bab;
+    for (int i = 0; i < 50; ++i) {
+        bab.append(str::stream() << "key" << i);
+    }
+    ASSERT_THROWS_CODE(runSpillingCountTest(this, bab.arr(), false, false),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
 }  // namespace mongo::sbe
@@ -37,6 +37,10 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 
@@ -79,6 +83,7 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
                                      makeSV(innerCondSlot),
                                      makeSV(),
                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                     false /* allowDiskUse */,
                                      kEmptyPlanNodeId);
 
             return std::make_pair(makeSV(innerCondSlot, outerCondSlot), std::move(hashJoinStage));
@@ -136,4 +141,190 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     }
 }
 
+BSONArray joinRow(const std::string& key, const std::string& tag) {
+    return BSON_ARRAY(key << tag);
+}
+
+/**
+ * Joins 'outer' with 'inner', both arrays of [key, tag] pairs, with a hash table budget which only
+ * fits a few rows. Returns the matches as "<outer tag>:<inner tag>" strings in order, and the stats
+ * of the join in 'stats'.
+ */
+std::vector<std::string> runSpillingJoinTest(PlanStageTestFixture* fixture,
+                                             const BSONArray& outer,
+                                             const BSONArray& inner,
+                                             bool allowDiskUse,
+                                             bool useCollator,
+                                             HashJoinStats* stats = nullptr) {
+    auto memoryLimit = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(256);
+    ON_BLOCK_EXIT(
+        [&] { internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(memoryLimit); });
+
+    auto ctx = fixture->makeCompileCtx();
+    auto collatorSlot = fixture->generateSlotId();
+    auto collator =
+        std::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kToLowerString);
+    value::OwnedValueAccessor collatorAccessor;
+    ctx->pushCorrelated(collatorSlot, &collatorAccessor);
+    collatorAccessor.reset(value::TypeTags::collator,
+                           value::bitcastFrom<CollatorInterface*>(collator.get()));
+
+    auto [outerSlots, outerStage] = fixture->generateVirtualScanMulti(2, outer);
+    auto [innerSlots, innerStage] = fixture->generateVirtualScanMulti(2, inner);
+    auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                      std::move(innerStage),
+                                      makeSV(outerSlots[0]),
+                                      makeSV(outerSlots[1]),
+                                      makeSV(innerSlots[0]),
+                                      makeSV(innerSlots[1]),
+                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                      allowDiskUse,
+                                      kEmptyPlanNodeId);
+
+    auto resultAccessors = fixture->prepareTree(
+        ctx.get(), stage.get(), makeSV(outerSlots[0], outerSlots[1], innerSlots[0], innerSlots[1]));
+    auto [resultsTag, resultsVal] = fixture->getAllResultsMulti(stage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+    auto resultsView = value::getArrayView(resultsVal);
+    std::vector<std::string> matches;
+    for (size_t i = 0; i < resultsView->size(); ++i) {
+        auto row = value::getArrayView(resultsView->getAt(i).second);
+        auto [outerKeyTag, outerKeyVal] = row->getAt(0);
+        auto [innerKeyTag, innerKeyVal] = row->getAt(2);
+        // The keys of every match must be equal, also when read back from disk.
+        ASSERT_EQ(str::toLower(value::getStringView(outerKeyTag, outerKeyVal)),
+                  str::toLower(value::getStringView(innerKeyTag, innerKeyVal)));
+
+        auto [outerTag, outerVal] = row->getAt(1);
+        auto [innerTag, innerVal] = row->getAt(3);
+        matches.push_back(str::stream() << value::getStringView(outerTag, outerVal) << ":"
+                                        << value::getStringView(innerTag, innerVal));
+    }
+    std::sort(matches.begin(), matches.end());
+
+    if (stats) {
+        *stats = *checked_cast<const HashJoinStats*>(stage->getSpecificStats());
+    }
+    return matches;
+}
+
+/**
+ * Returns the matches runSpillingJoinTest() is expected to produce, by comparing each pair of rows.
+ */
+std::vector<std::string> expectedJoinMatches(const BSONArray& outer,
+                                             const BSONArray& inner,
+                                             bool useCollator) {
+    auto normalize = [&](const BSONElement& key) {
+        return useCollator ? str::toLower(key.str()) : key.str();
+    };
+
+    std::vector<std::string> matches;
+    for (auto&& outerElem : outer) {
+        auto outerRow = outerElem.Obj();
+        for (auto&& innerElem : inner) {
+            auto innerRow = innerElem.Obj();
+            if (normalize(outerRow["0"]) == normalize(innerRow["0"])) {
+                matches.push_back(str::stream()
+                                  << outerRow["1"].str() << ":" << innerRow["1"].str());
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+TEST_F(HashJoinStageTest, HashJoinSpillTest) {
+    unittest::TempDir tempDir("HashJoinSpillTest");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    // Some inner keys have no match, others match several times.
+    BSONArrayBuilder outer;
+    for (int i = 0; i < 100; ++i) {
+        outer.append(joinRow(str::stream() << "key" << i, str::stream() << "o" << i));
+    }
+    BSONArrayBuilder inner;
+    for (int i = 0; i < 150; ++i) {
+        inner.append(joinRow(str::stream() << "key" << i % 120, str::stream() << "i" << i));
+    }
+    auto outerArr = outer.arr();
+    auto innerArr = inner.arr();
+
+    HashJoinStats stats;
+    auto matches = runSpillingJoinTest(this, outerArr, innerArr, true, false, &stats);
+    ASSERT_EQ(matches.size(), 130);
+    ASSERT(expectedJoinMatches(outerArr, innerArr, false) == matches);
+    ASSERT_GT(stats.spilledPartitions, 0);
+    ASSERT_GT(stats.spilledBuildRecords, 0);
+    ASSERT_GT(stats.spilledProbeRecords, 0);
+}
+
+TEST_F(HashJoinStageTest, HashJoinSpillCollationTest) {
+    unittest::TempDir tempDir("HashJoinSpillCollationTest");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    // Keys differing only in case must end up in the same partition.
+    BSONArrayBuilder outer;
+    BSONArrayBuilder inner;
+    for (int i = 0; i < 50; ++i) {
+        outer.append(joinRow(str::stream() << "key" << i, str::stream() << "o" << i));
+        inner.append(joinRow(str::stream() << "KEY" << i, str::stream() << "i" << i));
+        inner.append(joinRow(str::stream() << "Key" << i, str::stream() << "j" << i));
+    }
+    auto outerArr = outer.arr();
+    auto innerArr = inner.arr();
+
+    for (auto useCollator : {false, true}) {
+        HashJoinStats stats;
+        auto matches = runSpillingJoinTest(this, outerArr, innerArr, true, useCollator, &stats);
+        ASSERT_EQ(matches.size(), useCollator ? 100 : 0);
+        ASSERT(expectedJoinMatches(outerArr, innerArr, useCollator) == matches);
+        ASSERT_GT(stats.spilledPartitions, 0);
+    }
+}
+
+TEST_F(HashJoinStageTest, HashJoinSpillSkewedKeyTest) {
+    unittest::TempDir tempDir("HashJoinSpillSkewedKeyTest");
+    auto dbpath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = dbpath; });
+
+    // Rows sharing a single key cannot be split by partitioning, so they are eventually joined in
+    // memory in spite of the budget.
+    BSONArrayBuilder outer;
+    for (int i = 0; i < 40; ++i) {
+        outer.append(joinRow("a", str::stream() << "o" << i));
+    }
+    outer.append(joinRow("b", "ob"));
+    auto outerArr = outer.arr();
+    auto innerArr = BSON_ARRAY(joinRow("a", "i0") << joinRow("b", "ib") << joinRow("a", "i1"));
+
+    HashJoinStats stats;
+    auto matches = runSpillingJoinTest(this, outerArr, innerArr, true, false, &stats);
+    ASSERT_EQ(matches.size(), 81);
+    ASSERT(expectedJoinMatches(outerArr, innerArr, false) == matches);
+    ASSERT_GT(stats.maxRecursionDepth, 0);
+}
+
+TEST_F(HashJoinStageTest, HashJoinKeepsOuterSideInMemoryWithoutDiskUse) {
+    // Plain finds, such as those using AND_HASH, do not allow disk use. Their joins must keep
+    // succeeding past the budget, as they did before the hash join could spill.
+    BSONArrayBuilder outer;
+    for (int i = 0; i < 50; ++i) {
+        outer.append(joinRow(str::stream() << "key" << i, str::stream() << "o" << i));
+    }
+    auto outerArr = outer.arr();
+    auto innerArr = BSON_ARRAY(joinRow("key0", "i0") << joinRow("key49", "i49"));
+
+    HashJoinStats stats;
+    auto matches = runSpillingJoinTest(this, outerArr, innerArr, false, false, &stats);
+    ASSERT(expectedJoinMatches(outerArr, innerArr, false) == matches);
+    ASSERT_EQ(stats.spilledPartitions, 0);
+    ASSERT_EQ(stats.spilledBuildRecords, 0);
+}
 }  // namespace mongo::sbe
@@ -27,6 +27,7 @@
  *    it in the license file.
  */
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
@@ -466,4 +467,34 @@ TEST(SBESmallString, Length) {
         ASSERT_EQ(length, value::getStringLength(tag, val));
     }
 }
+
+TEST(SBERuntimeEnvironment, DeepCopyDoesNotShareSlotValues) {
+    value::SlotIdGenerator slotIdGenerator;
+    RuntimeEnvironment env;
+
+    auto [strTag, strVal] = value::makeNewString("a string which is not small"_sd);
+    auto ownedSlot = env.registerSlot("owned"_sd, strTag, strVal, true, &slotIdGenerator);
+    auto unownedSlot = env.registerSlot("unowned"_sd,
+                                        value::TypeTags::NumberInt32,
+                                        value::bitcastFrom<int32_t>(1),
+                                        false,
+                                        &slotIdGenerator);
+
+    auto copy = env.makeDeepCopy();
+    ASSERT_EQ(ownedSlot, copy->getSlot("owned"_sd));
+    ASSERT_EQ(unownedSlot, copy->getSlot("unowned"_sd));
+
+    // The owned value is copied rather than shared.
+    auto [copyTag, copyVal] = copy->getAccessor(ownedSlot)->getViewOfValue();
+    ASSERT_EQ(strTag, copyTag);
+    ASSERT_NE(strVal, copyVal);
+    ASSERT_EQ("a string which is not small"_sd, value::getStringView(copyTag, copyVal));
+
+    // Resetting a slot of the copy does not affect the original environment.
+    copy->resetSlot(
+        unownedSlot, value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(2), false);
+    ASSERT_EQ(1, value::bitcastTo<int32_t>(env.getAccessor(unownedSlot)->getViewOfValue().second));
+    ASSERT_EQ(2,
+              value::bitcastTo<int32_t>(copy->getAccessor(unownedSlot)->getViewOfValue().second));
+}
 }  // namespace mongo::sbe
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/values/slot.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo::sbe {
+namespace {
+/**
+ * Runs a compiled expression over a document of 'kNumFields' fields, for both the code the
+ * expression compiler generates and the same code written out with only the generic instructions,
+ * so that the instructions carrying their constant inline can be compared to the plain interpreter.
+ */
+class VmBenchmark {
+public:
+    static constexpr int kNumFields = 16;
+
+    VmBenchmark() : _ctx{std::make_unique<RuntimeEnvironment>()} {
+        _ctx.root = &_emptyStage;
+        _slot = _slotIdGenerator.generate();
+        _ctx.pushCorrelated(_slot, &_accessor);
+
+        BSONObjBuilder bob;
+        for (int i = 0; i < kNumFields; ++i) {
+            bob.append(str::stream() << "field" << i, i);
+        }
+        _doc = bob.obj();
+        _accessor.reset(false,
+                        value::TypeTags::bsonObject,
+                        value::bitcastFrom<const char*>(_doc.objdata()));
+    }
+
+    ~VmBenchmark() {
+        for (auto [tag, val] : _constants) {
+            value::releaseValue(tag, val);
+        }
+    }
+
+    std::unique_ptr<EExpression> makeGetField(StringData fieldName) {
+        return makeE<EFunction>("getField",
+                                makeEs(makeE<EVariable>(_slot), makeE<EConstant>(fieldName)));
+    }
+
+    std::unique_ptr<vm::CodeFragment> compile(const EExpression& expr) {
+        return expr.compile(_ctx);
+    }
+
+    /**
+     * Generic code for 'getField(slot, fieldName)'.
+     */
+    std::unique_ptr<vm::CodeFragment> genericGetField(StringData fieldName) {
+        auto code = std::make_unique<vm::CodeFragment>();
+        code->appendAccessVal(&_accessor);
+        auto [tag, val] = makeConstant(value::makeNewString(fieldName));
+        code->appendConstVal(tag, val);
+        code->appendGetField();
+        return code;
+    }
+
+    /**
+     * Generic code for 'fillEmpty(getField(slot, fieldName) == value, false)'.
+     */
+    std::unique_ptr<vm::CodeFragment> genericFieldEquals(StringData fieldName, int32_t value) {
+        auto code = genericGetField(fieldName);
+        code->appendConstVal(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(value));
+        code->appendEq();
+        code->appendConstVal(value::TypeTags::Boolean, value::bitcastFrom<bool>(false));
+        code->appendFillEmpty();
+        return code;
+    }
+
+    void run(benchmark::State& state, const vm::CodeFragment* code) {
+        for (auto keepRunning : state) {
+            auto [owned, tag, val] = _vm.run(code);
+            benchmark::DoNotOptimize(tag);
+            benchmark::DoNotOptimize(val);
+            if (owned) {
+                value::releaseValue(tag, val);
+            }
+        }
+    }
+
+    void runPredicate(benchmark::State& state, const vm::CodeFragment* code) {
+        for (auto keepRunning : state) {
+            benchmark::DoNotOptimize(_vm.runPredicate(code));
+        }
+    }
+
+private:
+    std::pair<value::TypeTags, value::Value> makeConstant(
+        std::pair<value::TypeTags, value::Value> constant) {
+        _constants.push_back(constant);
+        return constant;
+    }
+
+    value::SlotIdGenerator _slotIdGenerator;
+    CoScanStage _emptyStage{kEmptyPlanNodeId};
+    CompileCtx _ctx;
+    vm::ByteCode _vm;
+
+    value::SlotId _slot;
+    value::OwnedValueAccessor _accessor;
+    BSONObj _doc;
+    std::vector<std::pair<value::TypeTags, value::Value>> _constants;
+};
+
+StringData fieldName(benchmark::State& state) {
+    static const StringData kFirst = "field0"_sd;
+    static const StringData kLast = "field15"_sd;
+    return state.range(0) ? kLast : kFirst;
+}
+
+void BM_GetFieldCompiled(benchmark::State& state) {
+    VmBenchmark bm;
+    auto code = bm.compile(*bm.makeGetField(fieldName(state)));
+    bm.run(state, code.get());
+}
+
+void BM_GetFieldGeneric(benchmark::State& state) {
+    VmBenchmark bm;
+    auto code = bm.genericGetField(fieldName(state));
+    bm.run(state, code.get());
+}
+
+void BM_FieldEqualsCompiled(benchmark::State& state) {
+    VmBenchmark bm;
+    auto expr = makeE<EFunction>(
+        "fillEmpty",
+        makeEs(makeE<EPrimBinary>(
+                   EPrimBinary::eq,
+                   bm.makeGetField(fieldName(state)),
+                   makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(0))),
+               makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(false))));
+    auto code = bm.compile(*expr);
+    bm.runPredicate(state, code.get());
+}
+
+void BM_FieldEqualsGeneric(benchmark::State& state) {
+    VmBenchmark bm;
+    auto code = bm.genericFieldEquals(fieldName(state), 0);
+    bm.runPredicate(state, code.get());
+}
+
+// The argument selects the first (0) or the last (1) field of the document.
+BENCHMARK(BM_GetFieldCompiled)->Arg(0)->Arg(1);
+BENCHMARK(BM_GetFieldGeneric)->Arg(0)->Arg(1);
+BENCHMARK(BM_FieldEqualsCompiled)->Arg(0)->Arg(1);
+BENCHMARK(BM_FieldEqualsGeneric)->Arg(0)->Arg(1);
+}  // namespace
+}  // namespace mongo::sbe
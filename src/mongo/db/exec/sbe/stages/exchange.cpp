@@ -31,22 +31,16 @@
 
 #include "mongo/db/exec/sbe/stages/exchange.h"
 
-#include "mongo/base/init.h"
+#include <algorithm>
+
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/client.h"
+#include "mongo/db/exec/sbe/stages/scan.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/recovery_unit.h"
 
 namespace mongo::sbe {
-std::unique_ptr<ThreadPool> s_globalThreadPool;
-MONGO_INITIALIZER(s_globalThreadPool)(InitializerContext* context) {
-    ThreadPool::Options options;
-    options.poolName = "parallel execution pool";
-    options.threadNamePrefix = "ExchProd";
-    options.minThreads = 0;
-    options.maxThreads = 128;
-    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
-    s_globalThreadPool = std::make_unique<ThreadPool>(options);
-    s_globalThreadPool->startup();
-}
-
 ExchangePipe::ExchangePipe(size_t size) {
     // All buffers start empty.
     _fullCount = 0;
@@ -68,10 +62,11 @@ void ExchangePipe::close() {
     _cond.notify_all();
 }
 
-std::unique_ptr<ExchangeBuffer> ExchangePipe::getEmptyBuffer() {
+std::unique_ptr<ExchangeBuffer> ExchangePipe::getEmptyBuffer(OperationContext* opCtx) {
     stdx::unique_lock lock(_mutex);
 
-    _cond.wait(lock, [this]() { return _closed || _emptyCount > 0; });
+    opCtx->waitForConditionOrInterrupt(
+        _cond, lock, [this]() { return _closed || _emptyCount > 0; });
 
     if (_closed) {
         return nullptr;
@@ -82,10 +77,11 @@ std::unique_ptr<ExchangeBuffer> ExchangePipe::getEmptyBuffer() {
     return std::move(_emptyBuffers[_emptyCount]);
 }
 
-std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer() {
+std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer(OperationContext* opCtx) {
     stdx::unique_lock lock(_mutex);
 
-    _cond.wait(lock, [this]() { return _closed || _fullCount != _fullPosition; });
+    opCtx->waitForConditionOrInterrupt(
+        _cond, lock, [this]() { return _closed || _fullCount != _fullPosition; });
 
     if (_closed) {
         return nullptr;
@@ -126,7 +122,115 @@ ExchangeState::ExchangeState(size_t numOfProducers,
       _numOfProducers(numOfProducers),
       _fields(std::move(fields)),
       _partition(std::move(partition)),
-      _orderLess(std::move(orderLess)) {}
+      _orderLess(std::move(orderLess)) {
+    _producerStats.resize(_numOfProducers);
+    _producerOpCtxs.resize(_numOfProducers);
+    _producerDone.resize(_numOfProducers);
+}
+
+void ExchangeState::resetProducers() {
+    {
+        stdx::lock_guard lock(_producerRunMutex);
+        invariant(_numOfRunningProducers == 0);
+        _producersStarted = false;
+        _producerDone.assign(_numOfProducers, false);
+        _producerStatus = Status::OK();
+    }
+
+    _producers.clear();
+    _producerPlans.clear();
+
+    stdx::lock_guard lock(_producerStatsMutex);
+    _producerStats.clear();
+    _producerStats.resize(_numOfProducers);
+}
+
+std::vector<size_t> ExchangeState::beginProducerRun() {
+    stdx::lock_guard lock(_producerRunMutex);
+    invariant(_numOfRunningProducers == 0);
+
+    std::vector<size_t> producerTids;
+    for (size_t idx = 0; idx < _numOfProducers; ++idx) {
+        if (!_producerDone[idx]) {
+            producerTids.push_back(idx);
+        }
+    }
+
+    _producersStarted = true;
+    _numOfRunningProducers = producerTids.size();
+    _pauseRequested.store(false);
+
+    return producerTids;
+}
+
+bool ExchangeState::registerProducerOpCtx(size_t producerTid, OperationContext* opCtx) {
+    stdx::lock_guard lock(_producerRunMutex);
+    if (_pauseRequested.load()) {
+        return false;
+    }
+
+    _producerOpCtxs[producerTid] = opCtx;
+    return true;
+}
+
+void ExchangeState::producerStopped(size_t producerTid, bool done, Status status) {
+    stdx::lock_guard lock(_producerRunMutex);
+    invariant(_numOfRunningProducers > 0);
+
+    _producerOpCtxs[producerTid] = nullptr;
+    if (done) {
+        _producerDone[producerTid] = true;
+    }
+    if (!status.isOK() && _producerStatus.isOK()) {
+        _producerStatus = std::move(status);
+    }
+
+    if (--_numOfRunningProducers == 0) {
+        _producerRunCond.notify_all();
+    }
+}
+
+void ExchangeState::pauseProducers() {
+    stdx::unique_lock lock(_producerRunMutex);
+    if (_numOfRunningProducers == 0) {
+        return;
+    }
+
+    // Producers check for the request between rows, and producers which are waiting on a pipe or
+    // scanning are interrupted.
+    _pauseRequested.store(true);
+    for (auto opCtx : _producerOpCtxs) {
+        if (opCtx) {
+            stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+            opCtx->getServiceContext()->killOperation(clientLock, opCtx);
+        }
+    }
+
+    _producerRunCond.wait(lock, [this]() { return _numOfRunningProducers == 0; });
+}
+
+bool ExchangeState::producersPaused() const {
+    stdx::lock_guard lock(_producerRunMutex);
+    return _producersStarted && _numOfRunningProducers == 0 &&
+        std::find(_producerDone.begin(), _producerDone.end(), false) != _producerDone.end();
+}
+
+Status ExchangeState::producerStatus() const {
+    stdx::lock_guard lock(_producerRunMutex);
+    return _producerStatus;
+}
+
+std::vector<std::unique_ptr<PlanStageStats>> ExchangeState::getProducerStats() const {
+    stdx::lock_guard lock(_producerStatsMutex);
+
+    std::vector<std::unique_ptr<PlanStageStats>> stats;
+    for (auto&& producerStats : _producerStats) {
+        if (producerStats) {
+            stats.emplace_back(producerStats->clone());
+        }
+    }
+    return stats;
+}
 
 ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
@@ -137,7 +241,7 @@ ExchangeBuffer* ExchangeConsumer::getBuffer(size_t producerId) {
         return _fullBuffers[producerId].get();
     }
 
-    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer();
+    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer(_opCtx);
 
     return _fullBuffers[producerId].get();
 }
@@ -159,11 +263,14 @@ ExchangeConsumer::ExchangeConsumer(std::unique_ptr<PlanStage> input,
                                    ExchangePolicy policy,
                                    std::unique_ptr<EExpression> partition,
                                    std::unique_ptr<EExpression> orderLess,
-                                   PlanNodeId planNodeId)
-    : PlanStage("exchange"_sd, planNodeId) {
+                                   PlanNodeId planNodeId,
+                                   PlanYieldPolicy* yieldPolicy,
+                                   boost::optional<QueryWorkerPool::Reservation> workers)
+    : PlanStage("exchange"_sd, yieldPolicy, planNodeId) {
     _children.emplace_back(std::move(input));
     _state = std::make_shared<ExchangeState>(
         numOfProducers, std::move(fields), policy, std::move(partition), std::move(orderLess));
+    _state->workers() = std::move(workers);
 
     _tid = _state->addConsumer(this);
     _orderPreserving = _state->isOrderPreserving();
@@ -173,16 +280,38 @@ ExchangeConsumer::ExchangeConsumer(std::shared_ptr<ExchangeState> state, PlanNod
     _tid = _state->addConsumer(this);
     _orderPreserving = _state->isOrderPreserving();
 }
+ExchangeConsumer::~ExchangeConsumer() {
+    // The producers send their rows to the pipes of the consumers, so they must not outlive them
+    // even if the exchange is not closed.
+    if (_tid == 0) {
+        _state->pauseProducers();
+    }
+}
 std::unique_ptr<PlanStage> ExchangeConsumer::clone() const {
-    return std::make_unique<ExchangeConsumer>(_state, _commonStats.nodeId);
+    tassert(6179065,
+            "only the consumer which holds the subtree of an exchange can be cloned",
+            !_children.empty());
+
+    return std::make_unique<ExchangeConsumer>(
+        _children[0]->clone(),
+        _state->numOfProducers(),
+        _state->fields(),
+        _state->policy(),
+        _state->partition() ? _state->partition()->clone() : nullptr,
+        _state->orderLess() ? _state->orderLess()->clone() : nullptr,
+        _commonStats.nodeId,
+        _yieldPolicy);
 }
 void ExchangeConsumer::prepare(CompileCtx& ctx) {
     for (size_t idx = 0; idx < _state->fields().size(); ++idx) {
         _outgoing.emplace_back(ExchangeBuffer::Accessor{});
     }
 
-    for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-        _state->producerCompileCtxs().push_back(ctx.makeCopy(true));
+    if (_tid == 0) {
+        _state->producerCompileCtxs().clear();
+        for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
+            _state->producerCompileCtxs().push_back(ctx.makeCopy(true));
+        }
     }
     // Compile '<' function once we implement order preserving exchange.
 }
@@ -210,6 +339,9 @@ void ExchangeConsumer::open(bool reOpen) {
         bool allConsumers = (++_state->consumerOpen()) == _state->numOfConsumers();
 
         // Create all pipes.
+        _pipes.clear();
+        _fullBuffers.clear();
+        _bufferPos.clear();
         if (_orderPreserving) {
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 _pipes.emplace_back(std::make_unique<ExchangePipe>(2));
@@ -232,41 +364,27 @@ void ExchangeConsumer::open(bool reOpen) {
                     lock, [this]() { return _state->consumerOpen() == _state->numOfConsumers(); });
             }
 
-            // Clone n copies of the subtree for every producer.
+            // All consumers are done with a previous open, if any, so it is safe to reset the
+            // close counter and to forget about the producers which have finished by now.
+            _state->consumerClose() = 0;
+            _state->resetProducers();
 
+            // Clone n copies of the subtree for every producer. The subtree itself is never
+            // executed but kept as a template, so that the exchange can be opened again.
             PlanStage* masterSubTree = _children[0].get();
-            masterSubTree->detachFromOperationContext();
-
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-                if (idx == 0) {
-                    _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
-                        std::move(_children[0]), _state, _commonStats.nodeId));
-                    // We have moved the child to the producer so clear the children vector.
-                    _children.clear();
-                } else {
-                    _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
-                        masterSubTree->clone(), _state, _commonStats.nodeId));
-                }
+                _state->producerPlans().emplace_back(std::make_unique<ExchangeProducer>(
+                    masterSubTree->clone(), _state, _commonStats.nodeId));
             }
 
-            // Start n producers.
-            invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
-            for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-                auto pf = makePromiseFuture<void>();
-                s_globalThreadPool->schedule(
-                    [this, idx, promise = std::move(pf.promise)](auto status) mutable {
-                        invariant(status);
-
-                        auto opCtx = cc().makeOperationContext();
-
-                        promise.setWith([&] {
-                            ExchangeProducer::start(opCtx.get(),
-                                                    _state->producerCompileCtxs()[idx],
-                                                    std::move(_state->producerPlans()[idx]));
-                        });
-                    });
-                _state->addProducerFuture(std::move(pf.future));
+            // The parallel scans in the producers of this open share the ranges they split the
+            // collection into.
+            auto parallelScanState = std::make_shared<ParallelScanState>();
+            for (auto& ctx : _state->producerCompileCtxs()) {
+                ctx.parallelScanState = parallelScanState;
             }
+
+            startProducers();
         } else {
             // Consumer ID >0
 
@@ -290,9 +408,67 @@ void ExchangeConsumer::open(bool reOpen) {
     }
 }
 
+void ExchangeConsumer::startProducers() {
+    // Producers read at the same point in time as this consumer, if it reads at a timestamp.
+    // Otherwise every producer reads the latest data as of when it opens its storage snapshot, much
+    // like a single scan which yields and reopens its snapshot.
+    _state->setReadTimestamp(_opCtx->recoveryUnit()->getPointInTimeReadTimestamp(_opCtx));
+
+    // Producers take no locks. They only run while this consumer holds the locks of the query, and
+    // see the collections of the catalog the query sees. They are interrupted when the query is, as
+    // a consumer which is interrupted closes the exchange, and share its deadline.
+    auto catalog = CollectionCatalog::get(_opCtx);
+    auto deadline = _opCtx->getDeadline();
+    auto timeoutError = _opCtx->getTimeoutError();
+
+    if (!_state->workers()) {
+        _state->workers() = QueryWorkerPool::tryReserve(_state->numOfProducers());
+        uassert(6179067,
+                "not enough query worker threads are left for the producers of the exchange",
+                _state->workers());
+    }
+
+    for (auto idx : _state->beginProducerRun()) {
+        auto producer = static_cast<ExchangeProducer*>(_state->producerPlans()[idx].get());
+        _state->workers()->schedule(
+            [state = _state, idx, producer, catalog, deadline, timeoutError](auto status) {
+                if (!status.isOK()) {
+                    producer->closePipes();
+                    state->producerStopped(idx, true /* done */, std::move(status));
+                    return;
+                }
+
+                auto opCtx = cc().makeOperationContext();
+                if (auto& readTimestamp = state->readTimestamp()) {
+                    opCtx->recoveryUnit()->setTimestampReadSource(
+                        RecoveryUnit::ReadSource::kProvided, *readTimestamp);
+                }
+                if (deadline < Date_t::max()) {
+                    opCtx->setDeadlineByDate(deadline, timeoutError);
+                }
+                CollectionCatalog::stash(opCtx.get(), catalog);
+
+                producer->run(std::move(opCtx));
+            });
+    }
+}
+
+void ExchangeConsumer::doSaveState() {
+    if (_tid == 0) {
+        _state->pauseProducers();
+    }
+}
+
 PlanState ExchangeConsumer::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
+    // A yield pauses the producers, which are resumed right after.
+    checkForInterrupt(_opCtx);
+
+    if (_tid == 0 && _state->producersPaused()) {
+        startProducers();
+    }
+
     if (_orderPreserving) {
         // Build a heap and return min element.
         uasserted(4822834, "ordere exchange not yet implemented");
@@ -300,7 +476,8 @@ PlanState ExchangeConsumer::getNext() {
         while (_eofs < _state->numOfProducers()) {
             auto buffer = getBuffer(0);
             if (!buffer) {
-                // early out
+                // early out, unless a producer failed
+                uassertStatusOK(_state->producerStatus());
                 return trackPlanState(PlanState::IS_EOF);
             }
             if (_bufferPos[0] < buffer->count()) {
@@ -340,10 +517,8 @@ void ExchangeConsumer::close() {
 
         if (_tid == 0) {
             // Consumer ID 0
-            // Wait for n producers to finish.
-            for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-                _state->producerResults()[idx].wait();
-            }
+            // Stop the producers which have not finished yet for good.
+            _state->pauseProducers();
         }
 
         if (_state->consumerClose() == _state->numOfConsumers()) {
@@ -359,15 +534,18 @@ void ExchangeConsumer::close() {
     // We can do it outside of the lock as everybody else is gone by now.
     if (_tid == 0) {
         // Consumer ID 0
-        for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-            _state->producerResults()[idx].get();
-        }
+        uassertStatusOK(_state->producerStatus());
     }
 }
 
 std::unique_ptr<PlanStageStats> ExchangeConsumer::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
-    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    // Report the producers which did the actual work, if they have run, and the template they are
+    // cloned from otherwise.
+    ret->children = _state->getProducerStats();
+    if (ret->children.empty() && !_children.empty()) {
+        ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    }
     return ret;
 }
 
@@ -419,7 +597,7 @@ ExchangeBuffer* ExchangeProducer::getBuffer(size_t consumerId) {
         return _emptyBuffers[consumerId].get();
     }
 
-    _emptyBuffers[consumerId] = _pipes[consumerId]->getEmptyBuffer();
+    _emptyBuffers[consumerId] = _pipes[consumerId]->getEmptyBuffer(_opCtx);
 
     if (!_emptyBuffers[consumerId]) {
         closePipes();
@@ -457,28 +635,52 @@ ExchangeProducer::ExchangeProducer(std::unique_ptr<PlanStage> input,
     }
 }
 
-void ExchangeProducer::start(OperationContext* opCtx,
-                             CompileCtx& ctx,
-                             std::unique_ptr<PlanStage> producer) {
-    ExchangeProducer* p = static_cast<ExchangeProducer*>(producer.get());
-
-    p->attachToOperationContext(opCtx);
+void ExchangeProducer::run(ServiceContext::UniqueOperationContext opCtx) {
+    bool done = true;
+    Status status = Status::OK();
 
+    attachToOperationContext(opCtx.get());
     try {
-        p->prepare(ctx);
-        p->open(false);
+        if (!_opened) {
+            prepare(_state->producerCompileCtxs()[_tid]);
+            open(false);
+            _opened = true;
+        } else {
+            restoreState();
+        }
 
-        auto status = p->getNext();
-        if (status != PlanState::IS_EOF) {
-            uasserted(4822837, "producer returned invalid state");
+        done = _state->registerProducerOpCtx(_tid, opCtx.get()) && produce();
+    } catch (const ExceptionFor<ErrorCodes::Interrupted>& ex) {
+        // The consumers interrupt the operation context of a producer to pause it.
+        if (_opened && _state->pauseRequested()) {
+            done = false;
+        } else {
+            status = ex.toStatus();
         }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
 
-        p->close();
-    } catch (...) {
-        // This is a bit sketchy but close the pipes as minimum.
-        p->closePipes();
-        throw;
+    try {
+        if (!status.isOK()) {
+            closePipes();
+        } else if (!done) {
+            saveState();
+        } else {
+            close();
+        }
+    } catch (const DBException& ex) {
+        done = true;
+        status = ex.toStatus();
+        closePipes();
     }
+
+    _state->setProducerStats(_tid, getStats(true /* includeDebugInfo */));
+    detachFromOperationContext();
+
+    // Release the storage snapshot before the consumers may go on.
+    opCtx.reset();
+    _state->producerStopped(_tid, done || !status.isOK(), std::move(status));
 }
 
 std::unique_ptr<PlanStage> ExchangeProducer::clone() const {
@@ -504,42 +706,41 @@ void ExchangeProducer::open(bool reOpen) {
     }
     _children[0]->open(reOpen);
 }
-bool ExchangeProducer::appendData(size_t consumerId) {
-    auto buffer = getBuffer(consumerId);
-    // Detect early out.
-    if (!buffer) {
-        return false;
-    }
+void ExchangeProducer::appendData(size_t consumerId) {
+    auto buffer = _emptyBuffers[consumerId].get();
+    invariant(buffer);
 
     // Copy data to buffer.
     if (buffer->appendData(_incoming)) {
         // Send it off to consumer when full.
         putBuffer(consumerId);
     }
-
-    return true;
 }
 
-PlanState ExchangeProducer::getNext() {
+bool ExchangeProducer::produce() {
     auto optTimer(getOptTimer(_opCtx));
 
-    while (_children[0]->getNext() == PlanState::ADVANCED) {
-        // Push to the correct pipe.
+    while (!_childEof) {
+        if (_state->pauseRequested()) {
+            return false;
+        }
+
+        // Get hold of the buffers the next row goes to before asking for the row, so that a
+        // producer which waits for the consumers has no row in flight when it is paused.
         switch (_state->policy()) {
             case ExchangePolicy::broadcast: {
                 for (size_t idx = 0; idx < _pipes.size(); ++idx) {
                     // Detect early out in the loop.
-                    if (!appendData(idx)) {
-                        return trackPlanState(PlanState::IS_EOF);
+                    if (!getBuffer(idx)) {
+                        return true;
                     }
                 }
             } break;
             case ExchangePolicy::roundrobin: {
                 // Detect early out.
-                if (!appendData(_roundRobinCounter)) {
-                    return trackPlanState(PlanState::IS_EOF);
+                if (!getBuffer(_roundRobinCounter)) {
+                    return true;
                 }
-                _roundRobinCounter = (_roundRobinCounter + 1) % _pipes.size();
             } break;
             case ExchangePolicy::partition: {
                 uasserted(4822840, "policy not yet implemented");
@@ -548,20 +749,40 @@ PlanState ExchangeProducer::getNext() {
                 MONGO_UNREACHABLE;
                 break;
         }
+
+        if (_children[0]->getNext() != PlanState::ADVANCED) {
+            _childEof = true;
+            break;
+        }
+
+        // Push to the correct pipe.
+        if (_state->policy() == ExchangePolicy::broadcast) {
+            for (size_t idx = 0; idx < _pipes.size(); ++idx) {
+                appendData(idx);
+            }
+        } else {
+            appendData(_roundRobinCounter);
+            _roundRobinCounter = (_roundRobinCounter + 1) % _pipes.size();
+        }
     }
 
     // Send off partially filled buffers and the eof marker.
-    for (size_t idx = 0; idx < _pipes.size(); ++idx) {
-        auto buffer = getBuffer(idx);
+    for (; _eofsSent < _pipes.size(); ++_eofsSent) {
+        auto buffer = getBuffer(_eofsSent);
         // Detect early out in the loop.
         if (!buffer) {
-            return trackPlanState(PlanState::IS_EOF);
+            return true;
         }
         buffer->markEof();
         // Send it off to consumer.
-        putBuffer(idx);
+        putBuffer(_eofsSent);
     }
-    return trackPlanState(PlanState::IS_EOF);
+    trackPlanState(PlanState::IS_EOF);
+    return true;
+}
+
+PlanState ExchangeProducer::getNext() {
+    uasserted(6179066, "exchange producers are run by their consumers");
 }
 void ExchangeProducer::close() {
     auto optTimer(getOptTimer(_opCtx));
@@ -33,10 +33,9 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/db/service_context.h"
 #include "mongo/stdx/condition_variable.h"
-#include "mongo/stdx/future.h"
-#include "mongo/util/concurrency/thread_pool.h"
-#include "mongo/util/future.h"
 
 namespace mongo::sbe {
 class ExchangeConsumer;
@@ -122,8 +121,13 @@ public:
     ExchangePipe(size_t size);
 
     void close();
-    std::unique_ptr<ExchangeBuffer> getEmptyBuffer();
-    std::unique_ptr<ExchangeBuffer> getFullBuffer();
+
+    /**
+     * Wait until a buffer is available, or the pipe is closed in which case nullptr is returned.
+     * The wait is interrupted along with 'opCtx'.
+     */
+    std::unique_ptr<ExchangeBuffer> getEmptyBuffer(OperationContext* opCtx);
+    std::unique_ptr<ExchangeBuffer> getFullBuffer(OperationContext* opCtx);
     void putEmptyBuffer(std::unique_ptr<ExchangeBuffer>);
     void putFullBuffer(std::unique_ptr<ExchangeBuffer>);
 
@@ -169,10 +173,6 @@ public:
         return _producers.size() - 1;
     }
 
-    void addProducerFuture(Future<void> f) {
-        _producerResults.emplace_back(std::move(f));
-    }
-
     auto& consumerOpenMutex() {
         return _consumerOpenMutex;
     }
@@ -201,8 +201,79 @@ public:
         return _producerCompileCtxs;
     }
 
-    auto& producerResults() {
-        return _producerResults;
+    /**
+     * Forgets the producers of a previous open of the exchange so that a new set can be started.
+     * Must only be called while no producer is running.
+     */
+    void resetProducers();
+
+    /**
+     * Producers only run while the consumers do. The consumers pause them whenever they save their
+     * state, which they do on every yield and at the end of every getMore batch, and resume them
+     * once they are asked for the next row. A paused producer has saved its plan and given up its
+     * operation context and its thread, so that it holds no storage snapshot, cursor or thread
+     * while the query is not running.
+     *
+     * Marks every producer which has not finished yet as running, and returns their ids.
+     */
+    std::vector<size_t> beginProducerRun();
+
+    /**
+     * Called by a running producer once it is about to produce rows on 'opCtx', which the
+     * consumers then interrupt to pause the producer. Returns false if the producers are being
+     * paused already.
+     */
+    bool registerProducerOpCtx(size_t producerTid, OperationContext* opCtx);
+
+    /**
+     * Called by a producer when it stops running, either because it is paused or because it is
+     * done, in which case a non-OK 'status' is the error it failed with.
+     */
+    void producerStopped(size_t producerTid, bool done, Status status);
+
+    /**
+     * Pauses every running producer, and waits for all of them to stop.
+     */
+    void pauseProducers();
+
+    bool pauseRequested() const {
+        return _pauseRequested.load();
+    }
+
+    /**
+     * Returns true if the producers have been started but some of them have been paused before
+     * they finished.
+     */
+    bool producersPaused() const;
+
+    /**
+     * Returns the error the first failed producer failed with, or OK if none did.
+     */
+    Status producerStatus() const;
+
+    void setProducerStats(size_t producerTid, std::unique_ptr<PlanStageStats> stats) {
+        stdx::lock_guard lock(_producerStatsMutex);
+        _producerStats[producerTid] = std::move(stats);
+    }
+
+    /**
+     * Returns a copy of the stats of every producer as of when it last stopped running.
+     */
+    std::vector<std::unique_ptr<PlanStageStats>> getProducerStats() const;
+
+    /**
+     * The timestamp the consumers read at, if any. Producers run under operation contexts of their
+     * own and read at the same timestamp, so that the exchange sees a single point in time.
+     */
+    const boost::optional<Timestamp>& readTimestamp() const {
+        return _readTimestamp;
+    }
+    void setReadTimestamp(boost::optional<Timestamp> readTimestamp) {
+        _readTimestamp = readTimestamp;
+    }
+
+    auto& workers() {
+        return _workers;
     }
 
     auto numOfConsumers() const {
@@ -215,6 +286,12 @@ public:
     auto& fields() const {
         return _fields;
     }
+    auto& partition() const {
+        return _partition;
+    }
+    auto& orderLess() const {
+        return _orderLess;
+    }
     ExchangePipe* pipe(size_t consumerTid, size_t producerTid);
 
 private:
@@ -224,7 +301,24 @@ private:
     std::vector<ExchangeProducer*> _producers;
     std::vector<std::unique_ptr<PlanStage>> _producerPlans;
     std::vector<CompileCtx> _producerCompileCtxs;
-    std::vector<Future<void>> _producerResults;
+
+    mutable Mutex _producerRunMutex = MONGO_MAKE_LATCH("ExchangeState::_producerRunMutex");
+    stdx::condition_variable _producerRunCond;
+    bool _producersStarted{false};
+    size_t _numOfRunningProducers{0};
+    AtomicWord<bool> _pauseRequested{false};
+    // The operation context of every producer which is producing rows, or nullptr.
+    std::vector<OperationContext*> _producerOpCtxs;
+    std::vector<bool> _producerDone;
+    Status _producerStatus = Status::OK();
+
+    mutable Mutex _producerStatsMutex = MONGO_MAKE_LATCH("ExchangeState::_producerStatsMutex");
+    std::vector<std::unique_ptr<PlanStageStats>> _producerStats;
+
+    boost::optional<Timestamp> _readTimestamp;
+
+    // The threads the producers run on, reserved for as long as the exchange exists.
+    boost::optional<QueryWorkerPool::Reservation> _workers;
 
     // Variables (fields) that pass through the exchange.
     const value::SlotVector _fields;
@@ -248,16 +342,28 @@ private:
 
 class ExchangeConsumer final : public PlanStage {
 public:
+    /**
+     * The producers run on the threads of 'workers'. If none are given, the exchange reserves
+     * threads of the query worker pool for them when it is first opened.
+     */
     ExchangeConsumer(std::unique_ptr<PlanStage> input,
                      size_t numOfProducers,
                      value::SlotVector fields,
                      ExchangePolicy policy,
                      std::unique_ptr<EExpression> partition,
                      std::unique_ptr<EExpression> orderLess,
-                     PlanNodeId planNodeId);
+                     PlanNodeId planNodeId,
+                     PlanYieldPolicy* yieldPolicy = nullptr,
+                     boost::optional<QueryWorkerPool::Reservation> workers = boost::none);
 
     ExchangeConsumer(std::shared_ptr<ExchangeState> state, PlanNodeId planNodeId);
 
+    ~ExchangeConsumer();
+
+    /**
+     * A clone is an exchange of its own, with a clone of the subtree the producers run and no
+     * reserved threads.
+     */
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -272,10 +378,18 @@ public:
 
     ExchangePipe* pipe(size_t producerTid);
 
+protected:
+    void doSaveState() final;
+
 private:
     ExchangeBuffer* getBuffer(size_t producerId);
     void putBuffer(size_t producerId);
 
+    /**
+     * Schedules every producer which has not finished yet to run on a thread of its own.
+     */
+    void startProducers();
+
     std::shared_ptr<ExchangeState> _state;
     size_t _tid{0};
 
@@ -305,9 +419,21 @@ public:
                      std::shared_ptr<ExchangeState> state,
                      PlanNodeId planNodeId);
 
-    static void start(OperationContext* opCtx,
-                      CompileCtx& ctx,
-                      std::unique_ptr<PlanStage> producer);
+    /**
+     * Runs the producer on 'opCtx' until it has sent all of its rows to the consumers, or until the
+     * consumers pause it, and destroys 'opCtx' before it reports that it stopped. A paused
+     * producer is run again, with another operation context, when the consumers resume it. Never
+     * throws: an error is reported to the consumers instead.
+     *
+     * Pausing a producer interrupts 'opCtx', so the stages it runs must be able to carry on after
+     * getNext() was interrupted, as a scan interrupted before it moved its cursor does.
+     */
+    void run(ServiceContext::UniqueOperationContext opCtx);
+
+    /**
+     * Closes the pipes to the consumers, so that they stop waiting for this producer.
+     */
+    void closePipes();
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -324,8 +450,12 @@ private:
     ExchangeBuffer* getBuffer(size_t consumerId);
     void putBuffer(size_t consumerId);
 
-    void closePipes();
-    bool appendData(size_t consumerId);
+    /**
+     * Sends rows to the consumers. Returns true once all of the rows have been sent or the
+     * consumers closed the pipes, and false if the producer is paused before that.
+     */
+    bool produce();
+    void appendData(size_t consumerId);
 
     std::shared_ptr<ExchangeState> _state;
     size_t _tid{0};
@@ -337,5 +467,11 @@ private:
 
     // Current empty buffers that this producer is processing.
     std::vector<std::unique_ptr<ExchangeBuffer>> _emptyBuffers;
+
+    bool _opened{false};
+    bool _childEof{false};
+
+    // The number of consumers the eof marker has been sent to.
+    size_t _eofsSent{0};
 };
 }  // namespace mongo::sbe
@@ -31,29 +31,49 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/stats/resource_consumption_metrics.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
                            value::SlotMap<std::unique_ptr<EExpression>> aggs,
                            boost::optional<value::SlotId> collatorSlot,
+                           bool allowDiskUse,
                            PlanNodeId planNodeId)
     : PlanStage("group"_sd, planNodeId),
       _gbs(std::move(gbs)),
       _aggs(std::move(aggs)),
-      _collatorSlot(collatorSlot) {
+      _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse) {
     _children.emplace_back(std::move(input));
 }
 
+HashAggStage::~HashAggStage() {}
+
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
     value::SlotMap<std::unique_ptr<EExpression>> aggs;
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(
-        _children[0]->clone(), _gbs, std::move(aggs), _collatorSlot, _commonStats.nodeId);
+    return std::make_unique<HashAggStage>(_children[0]->clone(),
+                                          _gbs,
+                                          std::move(aggs),
+                                          _collatorSlot,
+                                          _allowDiskUse,
+                                          _commonStats.nodeId);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
@@ -94,7 +114,9 @@ void HashAggStage::prepare(CompileCtx& ctx) {
         ctx.aggExpression = true;
         ctx.accumulator = _outAggAccessors.back().get();
 
+        _compilingAggs = true;
         _aggCodes.emplace_back(expr->compile(ctx));
+        _compilingAggs = false;
         ctx.aggExpression = false;
     }
     _compiled = true;
@@ -105,6 +127,8 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
         if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
             return it->second;
         }
+    } else if (_compilingAggs) {
+        return getAggInputAccessor(ctx, slot);
     } else {
         return _children[0]->getAccessor(ctx, slot);
     }
@@ -112,6 +136,104 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
     return ctx.getAccessor(slot);
 }
 
+value::SlotAccessor* HashAggStage::getAggInputAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _aggInputAccessors.find(slot); it != _aggInputAccessors.end()) {
+        return it->second.get();
+    }
+
+    auto inAccessor = _children[0]->getAccessor(ctx, slot);
+    _spilledAggInputAccessors.emplace_back(
+        std::make_unique<SpilledRowAccessor>(_spilledRowIt, _inAggInputAccessors.size()));
+    _inAggInputAccessors.emplace_back(inAccessor);
+
+    auto [it, inserted] = _aggInputAccessors.emplace(
+        slot,
+        std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+            inAccessor, _spilledAggInputAccessors.back().get()}));
+    return it->second.get();
+}
+
+void HashAggStage::spillRow(value::MaterializedRow key) {
+    uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+            "Exceeded memory limit for $group, but didn't allow external sort."
+            " Pass allowDiskUse:true to opt in.",
+            _allowDiskUse);
+
+    if (!_spillSorter) {
+        SortOptions opts;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        opts.maxMemoryUsageBytes = _memoryUseInBytesBeforeSpill;
+        opts.extSortAllowed = true;
+        opts.moveSortedDataIntoIterator = true;
+
+        // Rows of the same group must be adjacent in the sorted output, so the keys are compared
+        // with the same collation the hash table uses to determine their equality.
+        auto comp = [collator = _collator](const SpilledRow& lhs, const SpilledRow& rhs) {
+            auto& left = lhs.first;
+            auto& right = rhs.first;
+            for (size_t idx = 0; idx < left.size(); ++idx) {
+                auto [lhsTag, lhsVal] = left.getViewOfValue(idx);
+                auto [rhsTag, rhsVal] = right.getViewOfValue(idx);
+                auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal, collator);
+                auto result = value::bitcastTo<int32_t>(val);
+                if (result) {
+                    return result;
+                }
+            }
+            return 0;
+        };
+        _spillSorter.reset(SpillSorter::make(opts, comp, {}));
+    }
+
+    key.makeOwned();
+    value::MaterializedRow vals{_inAggInputAccessors.size()};
+    size_t idx = 0;
+    for (auto accessor : _inAggInputAccessors) {
+        auto [tag, val] = accessor->getViewOfValue();
+        auto [cTag, cVal] = value::copyValue(tag, val);
+        vals.reset(idx++, true, cTag, cVal);
+    }
+    _spillSorter->emplace(std::move(key), std::move(vals));
+    ++_specificStats.spilledRecords;
+}
+
+bool HashAggStage::readSpilledGroup() {
+    _ht->clear();
+
+    if (!_spilledRowPending) {
+        if (!_spillIt->more()) {
+            _htIt = _ht->end();
+            return false;
+        }
+        _spilledRow = _spillIt->next();
+    }
+    _spilledRowPending = false;
+
+    auto [it, inserted] =
+        _ht->try_emplace(std::move(_spilledRow.first), value::MaterializedRow{_aggCodes.size()});
+    invariant(inserted);
+    _htIt = it;
+
+    while (true) {
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, tag, val);
+        }
+
+        if (!_spillIt->more()) {
+            break;
+        }
+        _spilledRow = _spillIt->next();
+        if (_ht->find(_spilledRow.first) == _ht->end()) {
+            // This row starts the next group.
+            _spilledRowPending = true;
+            break;
+        }
+    }
+
+    return true;
+}
+
 void HashAggStage::open(bool reOpen) {
     auto optTimer(getOptTimer(_opCtx));
 
@@ -121,14 +243,26 @@ void HashAggStage::open(bool reOpen) {
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402503, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
-        auto collatorView = value::getCollatorView(collatorVal);
-        const value::MaterializedRowHasher hasher(collatorView);
-        const value::MaterializedRowEq equator(collatorView);
+        _collator = value::getCollatorView(collatorVal);
+        const value::MaterializedRowHasher hasher(_collator);
+        const value::MaterializedRowEq equator(_collator);
         _ht.emplace(0, hasher, equator);
     } else {
         _ht.emplace();
     }
 
+    _memoryUseInBytes = 0;
+    _sampledGroupBytes = 0;
+    _memoryCheckInterval = 1;
+    _rowsUntilMemoryCheck = 1;
+    _memoryUseInBytesBeforeSpill = internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load();
+    _spillIt.reset();
+    _spillSorter.reset();
+    _spilledRowPending = false;
+    for (auto& [_, accessor] : _aggInputAccessors) {
+        accessor->setIndex(0);
+    }
+
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inKeyAccessors.size()};
         // Copy keys in order to do the lookup.
@@ -138,12 +272,23 @@ void HashAggStage::open(bool reOpen) {
             key.reset(idx++, false, tag, val);
         }
 
-        auto [it, inserted] = _ht->try_emplace(std::move(key), value::MaterializedRow{0});
-        if (inserted) {
-            // Copy keys.
-            const_cast<value::MaterializedRow&>(it->first).makeOwned();
-            // Initialize accumulators.
-            it->second.resize(_outAggAccessors.size());
+        TableType::iterator it;
+        bool inserted = false;
+        if (_memoryUseInBytes < _memoryUseInBytesBeforeSpill) {
+            std::tie(it, inserted) = _ht->try_emplace(std::move(key), value::MaterializedRow{0});
+            if (inserted) {
+                // Copy keys.
+                const_cast<value::MaterializedRow&>(it->first).makeOwned();
+                // Initialize accumulators.
+                it->second.resize(_outAggAccessors.size());
+            }
+        } else {
+            // The hash table is full, only groups it already holds are aggregated in memory.
+            it = _ht->find(key);
+            if (it == _ht->end()) {
+                spillRow(std::move(key));
+                continue;
+            }
         }
 
         // Accumulate.
@@ -152,10 +297,42 @@ void HashAggStage::open(bool reOpen) {
             auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
             _outAggAccessors[idx]->reset(owned, tag, val);
         }
+
+        if (inserted) {
+            _memoryUseInBytes += it->first.memUsageForSorter() + it->second.memUsageForSorter();
+        }
+
+        // Accumulators keep growing after their group has been inserted, for instance those
+        // collecting values into an array. As estimating the size of a group takes time linear in
+        // its size, the updated group is only sampled at exponentially growing intervals, and the
+        // size of the table is extrapolated from the samples.
+        if (--_rowsUntilMemoryCheck == 0) {
+            const long long groupBytes =
+                it->first.memUsageForSorter() + it->second.memUsageForSorter();
+            _sampledGroupBytes = _sampledGroupBytes ? (_sampledGroupBytes + groupBytes) / 2
+                                                    : groupBytes;
+            _memoryUseInBytes = std::max(
+                _memoryUseInBytes, _sampledGroupBytes * static_cast<long long>(_ht->size()));
+            _memoryCheckInterval = std::min(_memoryCheckInterval * 2, kMaxMemoryCheckInterval);
+            _rowsUntilMemoryCheck = _memoryCheckInterval;
+        }
     }
 
     _children[0]->close();
 
+    if (_spillSorter) {
+        _spillIt.reset(_spillSorter->done());
+        _specificStats.spills += _spillSorter->numSpills();
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementSorterSpills(_spillSorter->numSpills());
+        _spillSorter.reset();
+
+        // From now on the aggregate expressions are replayed against the spilled rows.
+        for (auto& [_, accessor] : _aggInputAccessors) {
+            accessor->setIndex(1);
+        }
+    }
+
     _htIt = _ht->end();
 }
 
@@ -169,7 +346,10 @@ PlanState HashAggStage::getNext() {
     }
 
     if (_htIt == _ht->end()) {
-        return trackPlanState(PlanState::IS_EOF);
+        // All groups held in memory have been returned, continue with the spilled ones.
+        if (!_spillIt || !readSpilledGroup()) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
     }
 
     return trackPlanState(PlanState::ADVANCED);
@@ -177,11 +357,15 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
 
     if (includeDebugInfo) {
         DebugPrinter printer;
         BSONObjBuilder bob;
         bob.append("groupBySlots", _gbs);
+        bob.appendBool("usedDisk", _specificStats.spills > 0);
+        bob.appendNumber("spilledRecords", static_cast<long long>(_specificStats.spilledRecords));
+        bob.appendNumber("spills", static_cast<long long>(_specificStats.spills));
         if (!_aggs.empty()) {
             BSONObjBuilder childrenBob(bob.subobjStart("expressions"));
             for (auto&& [slot, expr] : _aggs) {
@@ -196,7 +380,7 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
@@ -204,6 +388,8 @@ void HashAggStage::close() {
 
     trackClose();
     _ht = boost::none;
+    _spillIt.reset();
+    _spillSorter.reset();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
@@ -237,6 +423,10 @@ std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
         DebugPrinter::addIdentifier(ret, *_collatorSlot);
     }
 
+    if (_allowDiskUse) {
+        ret.emplace_back("spill");
+    }
+
     DebugPrinter::addNewLine(ret);
     DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
 
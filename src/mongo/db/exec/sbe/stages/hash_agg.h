@@ -32,11 +32,17 @@
 #include <unordered_map>
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class Sorter;
+
 namespace sbe {
 /**
  * Performs a hash-based aggregation. Appears as the "group" stage in debug output. Groups the input
@@ -53,9 +59,20 @@ namespace sbe {
  * determining whether two group-by keys are equal. For instance, the plan may require us to do a
  * case-insensitive group on a string field.
  *
+ * The hash table is limited to 'internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill' bytes. Its
+ * size accounts for the groups when they are inserted, and for the growth of their accumulators as
+ * estimated from groups sampled while the input is consumed. Once it is full, input rows of groups
+ * which are not in the table yet are not aggregated right away. If 'allowDiskUse' is false this is
+ * a query-fatal error. Otherwise the group-by keys of such rows, together with the slots read by
+ * the aggregate expressions, are handed to a sorter which spills them to disk. After the groups of
+ * the hash table have been returned, the sorted rows are read back and aggregated one group at a
+ * time by replaying them through the aggregate expressions. Groups already in the table keep being
+ * aggregated in memory, so a stage without group-by keys never spills.
+ *
  * Debug string representation:
  *
- *  group [<group by slots>] [slot_1 = expr_1, ..., slot_n = expr_n] collatorSlot? childStage
+ *  group [<group by slots>] [slot_1 = expr_1, ..., slot_n = expr_n] collatorSlot? spill?
+ *      childStage
  */
 class HashAggStage final : public PlanStage {
 public:
@@ -63,8 +80,11 @@ public:
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
                  boost::optional<value::SlotId> collatorSlot,
+                 bool allowDiskUse,
                  PlanNodeId planNodeId);
 
+    ~HashAggStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -86,9 +106,32 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpillSorter = Sorter<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpilledRowAccessor = value::MaterializedRowValueAccessor<SpilledRow*>;
+
+    /**
+     * Returns the accessor through which the aggregate expressions read the input 'slot'. It reads
+     * from the child while consuming the input, and from the spilled row when replaying it.
+     */
+    value::SlotAccessor* getAggInputAccessor(CompileCtx& ctx, value::SlotId slot);
+
+    /**
+     * Hands the current input row with the given group-by 'key' over to the spill sorter.
+     */
+    void spillRow(value::MaterializedRow key);
+
+    /**
+     * Replaces the content of the hash table with the next group aggregated from the spilled rows.
+     * Returns false if all spilled rows have been consumed.
+     */
+    bool readSpilledGroup();
+
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
@@ -99,13 +142,42 @@ private:
 
     // Only set if collator slot provided on construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
+
+    // Accessors of the child for the slots read by the aggregate expressions, and the accessors
+    // the aggregate expressions were compiled against, switching between the child and
+    // '_spilledRow'.
+    std::vector<value::SlotAccessor*> _inAggInputAccessors;
+    std::vector<std::unique_ptr<SpilledRowAccessor>> _spilledAggInputAccessors;
+    value::SlotMap<std::unique_ptr<value::SwitchAccessor>> _aggInputAccessors;
 
     boost::optional<TableType> _ht;
     TableType::iterator _htIt;
 
+    // Upper bound on the number of input rows between two samples of the size of a group.
+    static constexpr long long kMaxMemoryCheckInterval = 4096;
+
+    // Approximate memory used by the groups in '_ht' while consuming the input.
+    long long _memoryUseInBytes{0};
+    long long _memoryUseInBytesBeforeSpill{0};
+    // Running estimate of the size of a group, from the groups sampled while consuming the input.
+    long long _sampledGroupBytes{0};
+    long long _memoryCheckInterval{1};
+    long long _rowsUntilMemoryCheck{1};
+
+    std::unique_ptr<SpillSorter> _spillSorter;
+    std::unique_ptr<SpillIterator> _spillIt;
+    SpilledRow _spilledRow;
+    SpilledRow* _spilledRowIt{&_spilledRow};
+    // Set if '_spilledRow' was read from '_spillIt' but belongs to a group not yet returned.
+    bool _spilledRowPending{false};
+
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+    bool _compilingAggs{false};
+
+    HashAggStats _specificStats;
 };
 }  // namespace sbe
 }  // namespace mongo
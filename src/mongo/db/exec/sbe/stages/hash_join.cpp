@@ -32,8 +32,19 @@
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashJoinFileCounter;
+    return "extsort-hash-join-sbe." + std::to_string(hashJoinFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
@@ -43,6 +54,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
                              boost::optional<value::SlotId> collatorSlot,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
@@ -50,6 +62,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
       _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse),
       _probeKey(0) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
@@ -59,6 +72,37 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
     _children.emplace_back(std::move(inner));
 }
 
+HashJoinStage::~HashJoinStage() {}
+
+HashJoinStage::SpillFile::~SpillFile() {
+    writer.reset();
+    if (!path.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(path));
+    }
+}
+
+void HashJoinStage::SpillFile::add(const value::MaterializedRow& key,
+                                   const value::MaterializedRow& project) {
+    if (!writer) {
+        SortOptions opts;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        path = opts.tempDir + "/" + nextFileName();
+        writer = std::make_unique<SpillWriter>(opts, path, 0);
+    }
+    writer->addAlreadySorted(key, project);
+}
+
+std::unique_ptr<HashJoinStage::SpillIterator> HashJoinStage::SpillFile::done() {
+    if (!writer) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SpillIterator> it{writer->done()};
+    writer.reset();
+    it->openSource();
+    return it;
+}
+
 std::unique_ptr<PlanStage> HashJoinStage::clone() const {
     return std::make_unique<HashJoinStage>(_children[0]->clone(),
                                            _children[1]->clone(),
@@ -67,6 +111,7 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _innerCond,
                                            _innerProjects,
                                            _collatorSlot,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
@@ -97,7 +142,28 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         auto [it, inserted] = dupCheck.emplace(slot);
         uassert(4822825, str::stream() << "duplicate field: " << slot, inserted);
 
-        _inInnerKeyAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+        _spilledInnerKeyAccessors.emplace_back(
+            std::make_unique<SpilledKeyAccessor>(_spilledProbeRowIt, counter++));
+        auto [switchIt, _] = _outInnerAccessors.emplace(
+            slot,
+            std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+                _children[1]->getAccessor(ctx, slot), _spilledInnerKeyAccessors.back().get()}));
+        _outInnerKeyAccessors.emplace_back(switchIt->second.get());
+    }
+
+    counter = 0;
+    for (auto& slot : _innerProjects) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        uassert(6179038, str::stream() << "duplicate field: " << slot, inserted);
+
+        _spilledInnerProjectAccessors.emplace_back(
+            std::make_unique<SpilledProjectAccessor>(_spilledProbeRowIt, counter++));
+        auto [switchIt, _] = _outInnerAccessors.emplace(
+            slot,
+            std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+                _children[1]->getAccessor(ctx, slot),
+                _spilledInnerProjectAccessors.back().get()}));
+        _outInnerProjectAccessors.emplace_back(switchIt->second.get());
     }
 
     counter = 0;
@@ -111,7 +177,7 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         _outOuterAccessors[slot] = _outOuterProjectAccessors.back().get();
     }
 
-    _probeKey.resize(_inInnerKeyAccessors.size());
+    _probeKey.resize(_outInnerKeyAccessors.size());
 
     _compiled = true;
 }
@@ -121,6 +187,9 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
         if (auto it = _outOuterAccessors.find(slot); it != _outOuterAccessors.end()) {
             return it->second;
         }
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second.get();
+        }
 
         return _children[1]->getAccessor(ctx, slot);
     }
@@ -128,18 +197,186 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
     return ctx.getAccessor(slot);
 }
 
+size_t HashJoinStage::getPartition(const value::MaterializedRow& key) const {
+    // Every recursion depth partitions by a different group of bits of the hash, so that the rows
+    // of a spilled partition are spread over all partitions when it is partitioned again.
+    static_assert((kNumPartitions & (kNumPartitions - 1)) == 0);
+    static constexpr size_t kBitsPerDepth = 4;
+    static_assert(kNumPartitions <= (size_t{1} << kBitsPerDepth));
+    static_assert((kMaxRecursionDepth + 1) * kBitsPerDepth <= sizeof(size_t) * 8);
+
+    return (_ht->hash_function()(key) >> (_depth * kBitsPerDepth)) & (kNumPartitions - 1);
+}
+
+void HashJoinStage::insertBuildRow(value::MaterializedRow key, value::MaterializedRow project) {
+    auto& partition = _partitions[getPartition(key)];
+    if (partition.build) {
+        partition.build->add(key, project);
+        ++_specificStats.spilledBuildRecords;
+        return;
+    }
+
+    auto memoryUseInBytes = key.memUsageForSorter() + project.memUsageForSorter();
+    _ht->emplace(std::move(key), std::move(project));
+    partition.memoryUseInBytes += memoryUseInBytes;
+    _memoryUseInBytes += memoryUseInBytes;
+
+    // Past the maximum recursion depth the remaining rows most likely share a few keys, which
+    // cannot be split up by partitioning them again. Without disk use the table is unbounded, as
+    // it was before spilling existed, rather than failing plans which used to succeed.
+    while (_allowDiskUse && _memoryUseInBytes > _memoryUseInBytesBeforeSpill &&
+           _depth < kMaxRecursionDepth) {
+        spillLargestPartition();
+    }
+}
+
+void HashJoinStage::spillLargestPartition() {
+    invariant(_allowDiskUse);
+
+    size_t largest = 0;
+    for (size_t idx = 1; idx < kNumPartitions; ++idx) {
+        if (_partitions[idx].memoryUseInBytes > _partitions[largest].memoryUseInBytes) {
+            largest = idx;
+        }
+    }
+
+    auto& partition = _partitions[largest];
+    invariant(!partition.build && partition.memoryUseInBytes > 0);
+    partition.build = std::make_unique<SpillFile>();
+    partition.probe = std::make_unique<SpillFile>();
+
+    for (auto it = _ht->begin(); it != _ht->end();) {
+        if (getPartition(it->first) == largest) {
+            partition.build->add(it->first, it->second);
+            ++_specificStats.spilledBuildRecords;
+            it = _ht->erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    _memoryUseInBytes -= partition.memoryUseInBytes;
+    partition.memoryUseInBytes = 0;
+
+    ++_specificStats.spilledPartitions;
+    _specificStats.maxRecursionDepth = std::max(_specificStats.maxRecursionDepth, _depth);
+}
+
+bool HashJoinStage::nextProbeRow() {
+    while (true) {
+        if (_probeIt) {
+            if (!_probeIt->more()) {
+                return false;
+            }
+            _spilledProbeRow = _probeIt->next();
+        } else if (_children[1]->getNext() == PlanState::IS_EOF) {
+            return false;
+        }
+
+        // Copy keys in order to do the lookup.
+        size_t idx = 0;
+        for (auto& p : _outInnerKeyAccessors) {
+            auto [tag, val] = p->getViewOfValue();
+            _probeKey.reset(idx++, false, tag, val);
+        }
+
+        auto& partition = _partitions[getPartition(_probeKey)];
+        if (!partition.probe) {
+            return true;
+        }
+
+        // The matching outer rows have been spilled, so the inner row is too.
+        value::MaterializedRow key{_outInnerKeyAccessors.size()};
+        idx = 0;
+        for (auto& p : _outInnerKeyAccessors) {
+            auto [tag, val] = p->copyOrMoveValue();
+            key.reset(idx++, true, tag, val);
+        }
+        value::MaterializedRow project{_outInnerProjectAccessors.size()};
+        idx = 0;
+        for (auto& p : _outInnerProjectAccessors) {
+            auto [tag, val] = p->copyOrMoveValue();
+            project.reset(idx++, true, tag, val);
+        }
+        partition.probe->add(key, project);
+        ++_specificStats.spilledProbeRecords;
+    }
+}
+
+bool HashJoinStage::joinNextSpilledPartition() {
+    for (auto& partition : _partitions) {
+        if (partition.build) {
+            _spilledPartitions.push_back(
+                {std::move(partition.build), std::move(partition.probe), _depth + 1});
+        }
+    }
+    _probeIt.reset();
+    _joinedPartition = {};
+
+    while (!_spilledPartitions.empty()) {
+        auto partition = std::move(_spilledPartitions.back());
+        _spilledPartitions.pop_back();
+
+        // Without rows on both sides the partition has no matches.
+        auto buildIt = partition.build->done();
+        auto probeIt = partition.probe->done();
+        if (!buildIt || !probeIt) {
+            continue;
+        }
+
+        _depth = partition.depth;
+        resetHashTable();
+        for (auto& [_, accessor] : _outInnerAccessors) {
+            accessor->setIndex(1);
+        }
+
+        while (buildIt->more()) {
+            auto [key, project] = buildIt->next();
+            insertBuildRow(std::move(key), std::move(project));
+        }
+
+        _joinedPartition = std::move(partition);
+        _probeIt = std::move(probeIt);
+        return true;
+    }
+
+    return false;
+}
+
+void HashJoinStage::resetHashTable() {
+    if (_collator) {
+        const value::MaterializedRowHasher hasher(_collator);
+        const value::MaterializedRowEq equator(_collator);
+        _ht.emplace(0, hasher, equator);
+    } else {
+        _ht.emplace();
+    }
+    _htIt = _ht->end();
+    _htItEnd = _ht->end();
+
+    _memoryUseInBytes = 0;
+    for (auto& partition : _partitions) {
+        partition = {};
+    }
+}
+
 void HashJoinStage::open(bool reOpen) {
     auto optTimer(getOptTimer(_opCtx));
 
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402504, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
-        auto collatorView = value::getCollatorView(collatorVal);
-        const value::MaterializedRowHasher hasher(collatorView);
-        const value::MaterializedRowEq equator(collatorView);
-        _ht.emplace(0, hasher, equator);
-    } else {
-        _ht.emplace();
+        _collator = value::getCollatorView(collatorVal);
+    }
+
+    _depth = 0;
+    _memoryUseInBytesBeforeSpill = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    _probeIt.reset();
+    _joinedPartition = {};
+    _spilledPartitions.clear();
+    resetHashTable();
+    for (auto& [_, accessor] : _outInnerAccessors) {
+        accessor->setIndex(0);
     }
 
     _commonStats.opens++;
@@ -163,7 +400,7 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
-        _ht->emplace(std::move(key), std::move(project));
+        insertBuildRow(std::move(key), std::move(project));
     }
 
     _children[0]->close();
@@ -181,27 +418,21 @@ PlanState HashJoinStage::getNext() {
         ++_htIt;
     }
 
-    if (_htIt == _htItEnd) {
-        while (_htIt == _htItEnd) {
-            auto state = _children[1]->getNext();
-            if (state == PlanState::IS_EOF) {
+    while (_htIt == _htItEnd) {
+        if (!nextProbeRow()) {
+            // Once the inner side is exhausted, join the spilled partitions.
+            if (!joinNextSpilledPartition()) {
                 // LEFT and OUTER joins should enumerate "non-returned" rows here.
-                return trackPlanState(state);
-            }
-
-            // Copy keys in order to do the lookup.
-            size_t idx = 0;
-            for (auto& p : _inInnerKeyAccessors) {
-                auto [tag, val] = p->getViewOfValue();
-                _probeKey.reset(idx++, false, tag, val);
+                return trackPlanState(PlanState::IS_EOF);
             }
-
-            auto [low, hi] = _ht->equal_range(_probeKey);
-            _htIt = low;
-            _htItEnd = hi;
-            // If _htIt == _htItEnd (i.e. no match) then RIGHT and OUTER joins
-            // should enumerate "non-returned" rows here.
+            continue;
         }
+
+        auto [low, hi] = _ht->equal_range(_probeKey);
+        _htIt = low;
+        _htItEnd = hi;
+        // If _htIt == _htItEnd (i.e. no match) then RIGHT and OUTER joins
+        // should enumerate "non-returned" rows here.
     }
 
     return trackPlanState(PlanState::ADVANCED);
@@ -212,18 +443,40 @@ void HashJoinStage::close() {
 
     trackClose();
     _children[1]->close();
+    _probeIt.reset();
+    _joinedPartition = {};
+    _spilledPartitions.clear();
+    for (auto& partition : _partitions) {
+        partition = {};
+    }
     _ht = boost::none;
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.appendBool("usedDisk", _specificStats.spilledPartitions > 0);
+        bob.appendNumber("spilledPartitions",
+                         static_cast<long long>(_specificStats.spilledPartitions));
+        bob.appendNumber("spilledBuildRecords",
+                         static_cast<long long>(_specificStats.spilledBuildRecords));
+        bob.appendNumber("spilledProbeRecords",
+                         static_cast<long long>(_specificStats.spilledProbeRecords));
+        bob.appendNumber("maxRecursionDepth",
+                         static_cast<long long>(_specificStats.maxRecursionDepth));
+        ret->debugInfo = bob.obj();
+    }
+
     ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
     ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
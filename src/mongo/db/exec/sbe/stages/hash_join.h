@@ -29,11 +29,20 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
 
+#include "mongo/db/exec/sbe/stages/plan_stats.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 
+namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class SortedFileWriter;
+}  // namespace mongo
+
 namespace mongo::sbe {
 /**
  * Performs a traditional hash join. All rows from the 'outer' side are used to construct a hash
@@ -51,6 +60,21 @@ namespace mongo::sbe {
  * for string equality. For example, this can be used to perform a case-insensitive join on string
  * values.
  *
+ * The hash table is limited to 'internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill' bytes.
+ * Both sides are split into partitions by the hash of their keys. When the hash table outgrows its
+ * budget the largest partition held in memory is written to a temporary file, together with every
+ * outer row of that partition still to come, and inner rows falling into a spilled partition are
+ * written to a second file instead of probing the hash table. If 'allowDiskUse' is false the budget
+ * is not enforced and the whole outer side is kept in memory. Once the inner side is exhausted, the
+ * spilled partitions are joined one at a time by building the hash table from the outer file and
+ * probing it with the inner file. Should a spilled partition not fit in memory either, it is
+ * partitioned again with a different hash, up to a fixed depth after which the partition is kept in
+ * memory regardless of the budget (e.g. when most rows share a single key).
+ *
+ * Since spilled inner rows are read back from disk, only the 'innerCond' and 'innerProjects' slots
+ * are guaranteed to hold the values of the inner row matching the current output row. Other slots
+ * of the inner side must not be read above this stage.
+ *
  * Debug string representation:
  *
  *   hj collatorSlot?
@@ -66,8 +90,11 @@ public:
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
                   boost::optional<value::SlotId> collatorSlot,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
+    ~HashJoinStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -89,11 +116,93 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpilledKeyAccessor = value::MaterializedRowKeyAccessor<SpilledRow*>;
+    using SpilledProjectAccessor = value::MaterializedRowValueAccessor<SpilledRow*>;
+    using SpillWriter = SortedFileWriter<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
+    // Number of partitions the rows of each side are split into.
+    static constexpr size_t kNumPartitions = 16;
+    // Number of times a spilled partition may be partitioned again before it is kept in memory
+    // regardless of the memory budget.
+    static constexpr size_t kMaxRecursionDepth = 4;
+
+    /**
+     * A temporary file holding the rows of one side of a spilled partition. The file is only
+     * created once the first row is added.
+     */
+    struct SpillFile {
+        ~SpillFile();
+
+        void add(const value::MaterializedRow& key, const value::MaterializedRow& project);
+
+        /**
+         * Finishes writing and returns an iterator over the rows added, or nullptr if there were
+         * none.
+         */
+        std::unique_ptr<SpillIterator> done();
+
+        std::string path;
+        std::unique_ptr<SpillWriter> writer;
+    };
+
+    /**
+     * A spilled partition waiting to be joined once the inner side has been exhausted.
+     */
+    struct SpilledPartition {
+        std::unique_ptr<SpillFile> build;
+        std::unique_ptr<SpillFile> probe;
+        // Recursion depth at which the partition is joined.
+        size_t depth{0};
+    };
+
+    /**
+     * Per partition state of the hash table being built at the current recursion depth.
+     */
+    struct Partition {
+        // Approximate memory used by the rows of this partition held in the hash table.
+        long long memoryUseInBytes{0};
+        // Set once the partition has been spilled, in which case it has no rows in the hash table.
+        std::unique_ptr<SpillFile> build;
+        std::unique_ptr<SpillFile> probe;
+    };
+
+    size_t getPartition(const value::MaterializedRow& key) const;
+
+    /**
+     * Inserts a row of the outer side into the hash table, or into the spill file of its partition
+     * if that has been spilled. Spills partitions until the hash table fits within its budget.
+     */
+    void insertBuildRow(value::MaterializedRow key, value::MaterializedRow project);
+
+    /**
+     * Moves the rows of the largest partition held in memory from the hash table to a spill file.
+     */
+    void spillLargestPartition();
+
+    /**
+     * Advances to the next inner row not belonging to a spilled partition and sets '_probeKey' to
+     * its key. Inner rows belonging to spilled partitions are written to their spill files. Returns
+     * false once the current inner input has been exhausted.
+     */
+    bool nextProbeRow();
+
+    /**
+     * Queues the partitions spilled at the current depth and resets the hash table. Then builds
+     * the hash table from the next queued partition and switches the inner input over to its
+     * probe file. Returns false if no partition is left to join.
+     */
+    bool joinNextSpilledPartition();
+
+    void resetHashTable();
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -110,11 +219,17 @@ private:
     // Accessors of output projections.
     std::vector<std::unique_ptr<HashProjectAccessor>> _outOuterProjectAccessors;
 
-    // Accessors of input condition values (keys) that are being inserted into the hash table.
-    std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
+    // Accessors of the inner keys and projections, switching between the inner child and
+    // '_spilledProbeRow'.
+    value::SlotMap<std::unique_ptr<value::SwitchAccessor>> _outInnerAccessors;
+    std::vector<value::SwitchAccessor*> _outInnerKeyAccessors;
+    std::vector<value::SwitchAccessor*> _outInnerProjectAccessors;
+    std::vector<std::unique_ptr<SpilledKeyAccessor>> _spilledInnerKeyAccessors;
+    std::vector<std::unique_ptr<SpilledProjectAccessor>> _spilledInnerProjectAccessors;
 
     // Accessor for collator. Only set if collatorSlot provided during construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
 
     // Key used to probe inside the hash table.
     value::MaterializedRow _probeKey;
@@ -123,8 +238,26 @@ private:
     TableType::iterator _htIt;
     TableType::iterator _htItEnd;
 
+    // Approximate memory used by the rows in '_ht'.
+    long long _memoryUseInBytes{0};
+    long long _memoryUseInBytesBeforeSpill{0};
+
+    // Recursion depth of the partitions currently being joined, 0 while joining the children.
+    size_t _depth{0};
+    std::array<Partition, kNumPartitions> _partitions;
+    std::vector<SpilledPartition> _spilledPartitions;
+    SpilledPartition _joinedPartition;
+
+    // Iterator over the probe file of the spilled partition being joined. Not set while probing
+    // with the inner child.
+    std::unique_ptr<SpillIterator> _probeIt;
+    SpilledRow _spilledProbeRow;
+    SpilledRow* _spilledProbeRowIt{&_spilledProbeRow};
+
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    HashJoinStats _specificStats;
 };
 }  // namespace mongo::sbe
@@ -158,6 +158,40 @@ struct BranchStats final : public SpecificStats {
     size_t elseBranchCloses{0};
 };
 
+struct HashAggStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashAggStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    // Number of input rows handed to the spill sorter because their group did not fit in memory.
+    size_t spilledRecords{0};
+    // Number of times the spill sorter wrote to disk.
+    size_t spills{0};
+};
+
+struct HashJoinStats final : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashJoinStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    // Number of partitions written to disk because the hash table exceeded its memory budget.
+    size_t spilledPartitions{0};
+    // Number of outer and inner rows written to disk.
+    size_t spilledBuildRecords{0};
+    size_t spilledProbeRecords{0};
+    // Deepest recursion level at which a partition was spilled, 0 if only the partitions of the
+    // children were.
+    size_t maxRecursionDepth{0};
+};
+
 struct CheckBoundsStats final : public SpecificStats {
     std::unique_ptr<SpecificStats> clone() const final {
         return std::make_unique<CheckBoundsStats>(*this);
@@ -507,41 +507,10 @@ ParallelScanStage::ParallelScanStage(CollectionUUID collectionUuid,
       _vars(std::move(vars)),
       _scanCallbacks(std::move(callbacks)) {
     invariant(_fields.size() == _vars.size());
-
-    _state = std::make_shared<ParallelState>();
-}
-
-ParallelScanStage::ParallelScanStage(const std::shared_ptr<ParallelState>& state,
-                                     CollectionUUID collectionUuid,
-                                     boost::optional<value::SlotId> recordSlot,
-                                     boost::optional<value::SlotId> recordIdSlot,
-                                     boost::optional<value::SlotId> snapshotIdSlot,
-                                     boost::optional<value::SlotId> indexIdSlot,
-                                     boost::optional<value::SlotId> indexKeySlot,
-                                     boost::optional<value::SlotId> indexKeyPatternSlot,
-                                     std::vector<std::string> fields,
-                                     value::SlotVector vars,
-                                     PlanYieldPolicy* yieldPolicy,
-                                     PlanNodeId nodeId,
-                                     ScanCallbacks callbacks)
-    : PlanStage("pscan"_sd, yieldPolicy, nodeId),
-      _collUuid(collectionUuid),
-      _recordSlot(recordSlot),
-      _recordIdSlot(recordIdSlot),
-      _snapshotIdSlot(snapshotIdSlot),
-      _indexIdSlot(indexIdSlot),
-      _indexKeySlot(indexKeySlot),
-      _indexKeyPatternSlot(indexKeyPatternSlot),
-      _fields(std::move(fields)),
-      _vars(std::move(vars)),
-      _state(state),
-      _scanCallbacks(std::move(callbacks)) {
-    invariant(_fields.size() == _vars.size());
 }
 
 std::unique_ptr<PlanStage> ParallelScanStage::clone() const {
-    return std::make_unique<ParallelScanStage>(_state,
-                                               _collUuid,
+    return std::make_unique<ParallelScanStage>(_collUuid,
                                                _recordSlot,
                                                _recordIdSlot,
                                                _snapshotIdSlot,
@@ -588,6 +557,10 @@ void ParallelScanStage::prepare(CompileCtx& ctx) {
         _indexKeyPatternAccessor = ctx.getAccessor(*_indexKeyPatternSlot);
     }
 
+    // The scans in the producers of an exchange split the collection between them. A scan which
+    // runs on its own scans all of it.
+    _state = ctx.parallelScanState ? ctx.parallelScanState : std::make_shared<ParallelScanState>();
+
     tassert(5709601, "'_coll' should not be initialized prior to 'acquireCollection()'", !_coll);
     std::tie(_coll, _collName, _catalogEpoch) = acquireCollection(_opCtx, _collUuid);
 }
@@ -717,8 +690,18 @@ boost::optional<Record> ParallelScanStage::nextRange() {
     _currentRange = _state->currentRange.fetchAndAdd(1);
     if (_currentRange < _state->ranges.size()) {
         _range = _state->ranges[_currentRange];
+        if (_range.begin.isNull()) {
+            return _cursor->next();
+        }
 
-        return _range.begin.isNull() ? _cursor->next() : _cursor->seekExact(_range.begin);
+        // The ranges are sampled by whichever scan opens first, and unless all of the scans read
+        // at the same timestamp the record a range starts at may be gone from this scan's
+        // snapshot. Position on the first record at or after the start of the range instead.
+        auto record = _cursor->seekNear(_range.begin);
+        while (record && record->id < _range.begin) {
+            record = _cursor->next();
+        }
+        return record;
     } else {
         return boost::none;
     }
@@ -760,7 +743,7 @@ PlanState ParallelScanStage::getNext() {
             return trackPlanState(PlanState::IS_EOF);
         }
 
-        if (!_range.end.isNull() && nextRecord->id == _range.end) {
+        if (!_range.end.isNull() && nextRecord->id >= _range.end) {
             setNeedsRange();
             nextRecord = boost::none;
             continue;
@@ -778,6 +761,8 @@ PlanState ParallelScanStage::getNext() {
         }
     } while (!nextRecord);
 
+    ++_specificStats.numReads;
+
     if (_recordAccessor) {
         _recordAccessor->reset(false,
                                value::TypeTags::bsonObject,
@@ -831,11 +816,18 @@ void ParallelScanStage::close() {
 
 std::unique_ptr<PlanStageStats> ParallelScanStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<ScanStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.appendNumber("numReads", static_cast<long long>(_specificStats.numReads));
+        ret->debugInfo = bob.obj();
+    }
     return ret;
 }
 
 const SpecificStats* ParallelScanStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> ParallelScanStage::debugPrint() const {
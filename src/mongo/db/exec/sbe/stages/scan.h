@@ -178,16 +178,24 @@ private:
     ScanStats _specificStats;
 };
 
-class ParallelScanStage final : public PlanStage {
+/**
+ * The state shared by the parallel scans which the producers of an exchange run: the ranges of
+ * RecordIds the collection is split into, and the next range to be handed out. The exchange passes
+ * it to the scans through the 'CompileCtx' it prepares its producers with.
+ */
+struct ParallelScanState {
     struct Range {
         RecordId begin;
         RecordId end;
     };
-    struct ParallelState {
-        Mutex mutex = MONGO_MAKE_LATCH("ParallelScanStage::ParallelState::mutex");
-        std::vector<Range> ranges;
-        AtomicWord<size_t> currentRange{0};
-    };
+
+    Mutex mutex = MONGO_MAKE_LATCH("ParallelScanState::mutex");
+    std::vector<Range> ranges;
+    AtomicWord<size_t> currentRange{0};
+};
+
+class ParallelScanStage final : public PlanStage {
+    using Range = ParallelScanState::Range;
 
 public:
     ParallelScanStage(CollectionUUID collectionUuid,
@@ -203,20 +211,6 @@ public:
                       PlanNodeId nodeId,
                       ScanCallbacks callbacks);
 
-    ParallelScanStage(const std::shared_ptr<ParallelState>& state,
-                      CollectionUUID collectionUuid,
-                      boost::optional<value::SlotId> recordSlot,
-                      boost::optional<value::SlotId> recordIdSlot,
-                      boost::optional<value::SlotId> snapshotIdSlot,
-                      boost::optional<value::SlotId> indexIdSlot,
-                      boost::optional<value::SlotId> indexKeySlot,
-                      boost::optional<value::SlotId> indexKeyPatternSlot,
-                      std::vector<std::string> fields,
-                      value::SlotVector vars,
-                      PlanYieldPolicy* yieldPolicy,
-                      PlanNodeId nodeId,
-                      ScanCallbacks callbacks);
-
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -261,7 +255,11 @@ private:
 
     CollectionPtr _coll;
 
-    std::shared_ptr<ParallelState> _state;
+    // A parallel scan running in an exchange producer has an operation context of its own, which
+    // holds none of the locks taken by the query that started the exchange. It takes no locks
+    // either: the producers only run while the query holds its locks, and look the collection up
+    // in the catalog the query sees, which is stashed on their operation contexts.
+    std::shared_ptr<ParallelScanState> _state;
 
     const ScanCallbacks _scanCallbacks;
 
@@ -281,6 +279,8 @@ private:
     bool _open{false};
 
     std::unique_ptr<SeekableRecordCursor> _cursor;
+
+    ScanStats _specificStats;
 };
 }  // namespace sbe
 }  // namespace mongo
@@ -343,7 +343,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -371,6 +371,24 @@ public:
      */
     virtual std::unique_ptr<PlanStage> clone() const = 0;
 
+    /**
+     * Replaces the yield policy of every stage in this tree which was constructed with one, so that
+     * the tree yields according to the policy of the operation which executes it, such as a query
+     * executing a clone of a tree built for another query, or a worker thread trialing a candidate
+     * plan. Stages constructed without a yield policy are left without one.
+     */
+    void setYieldPolicy(PlanYieldPolicy* yieldPolicy) {
+        invariant(yieldPolicy);
+
+        if (_yieldPolicy) {
+            _yieldPolicy = yieldPolicy;
+        }
+
+        for (auto&& child : _children) {
+            child->setYieldPolicy(yieldPolicy);
+        }
+    }
+
     /**
      * Prepare this SBE PlanStage tree for execution. Must be called once, and must be called
      * prior to open(), getNext(), close(), saveState(), or restoreState(),
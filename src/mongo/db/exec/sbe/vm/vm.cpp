@@ -100,7 +100,9 @@ int Instruction::stackOffset[Instruction::Tags::lastInstruction] = {
     -2,  // collCmp3w
 
     -1,  // fillEmpty
+    0,   // fillEmptyImm
     -1,  // getField
+    0,   // getFieldImm
     -1,  // getElement
     -1,  // collComparisonKey
 
@@ -308,10 +310,36 @@ void CodeFragment::appendSimpleInstruction(Instruction::Tags tag) {
     offset += writeToMemory(offset, i);
 }
 
+void CodeFragment::appendFillEmpty(Instruction::Constants k) {
+    Instruction i;
+    i.tag = Instruction::fillEmptyImm;
+    adjustStackSimple(i);
+
+    auto offset = allocateSpace(sizeof(Instruction) + sizeof(k));
+
+    offset += writeToMemory(offset, i);
+    offset += writeToMemory(offset, k);
+}
+
 void CodeFragment::appendGetField() {
     appendSimpleInstruction(Instruction::getField);
 }
 
+void CodeFragment::appendGetField(StringData fieldName) {
+    auto size = fieldName.size();
+    invariant(size <= std::numeric_limits<uint8_t>::max());
+
+    Instruction i;
+    i.tag = Instruction::getFieldImm;
+    adjustStackSimple(i);
+
+    auto offset = allocateSpace(sizeof(Instruction) + sizeof(uint8_t) + size);
+
+    offset += writeToMemory(offset, i);
+    offset += writeToMemory(offset, static_cast<uint8_t>(size));
+    memcpy(offset, fieldName.rawData(), size);
+}
+
 void CodeFragment::appendGetElement() {
     appendSimpleInstruction(Instruction::getElement);
 }
@@ -470,8 +498,12 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::getField(value::TypeTa
         return {false, value::TypeTags::Nothing, 0};
     }
 
-    auto fieldStr = value::getStringView(fieldTag, fieldValue);
+    return getField(objTag, objValue, value::getStringView(fieldTag, fieldValue));
+}
 
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::getField(value::TypeTags objTag,
+                                                                   value::Value objValue,
+                                                                   StringData fieldStr) {
     if (MONGO_unlikely(failOnPoisonedFieldLookup.shouldFail())) {
         uassert(4623399, "Lookup of $POISON", fieldStr != "POISON");
     }
@@ -3816,6 +3848,32 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
                     }
                     break;
                 }
+                case Instruction::fillEmptyImm: {
+                    auto k = readFromMemory<Instruction::Constants>(pcPointer);
+                    pcPointer += sizeof(k);
+
+                    auto [owned, tag, val] = getFromStack(0);
+                    if (tag == value::TypeTags::Nothing) {
+                        switch (k) {
+                            case Instruction::Null:
+                                topStack(false, value::TypeTags::Null, 0);
+                                break;
+                            case Instruction::False:
+                                topStack(false,
+                                         value::TypeTags::Boolean,
+                                         value::bitcastFrom<bool>(false));
+                                break;
+                            case Instruction::True:
+                                topStack(false,
+                                         value::TypeTags::Boolean,
+                                         value::bitcastFrom<bool>(true));
+                                break;
+                            default:
+                                MONGO_UNREACHABLE;
+                        }
+                    }
+                    break;
+                }
                 case Instruction::getField: {
                     auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
                     popStack();
@@ -3833,6 +3891,23 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
                     }
                     break;
                 }
+                case Instruction::getFieldImm: {
+                    auto size = readFromMemory<uint8_t>(pcPointer);
+                    pcPointer += sizeof(size);
+                    StringData fieldName(reinterpret_cast<const char*>(pcPointer), size);
+                    pcPointer += size;
+
+                    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                    auto [owned, tag, val] = getField(lhsTag, lhsVal, fieldName);
+
+                    topStack(owned, tag, val);
+
+                    if (lhsOwned) {
+                        value::releaseValue(lhsTag, lhsVal);
+                    }
+                    break;
+                }
                 case Instruction::getElement: {
                     auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
                     popStack();
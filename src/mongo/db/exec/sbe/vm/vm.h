@@ -235,7 +235,9 @@ struct Instruction {
         collCmp3w,
 
         fillEmpty,
+        fillEmptyImm,  // fillEmpty with one of the Constants below carried in the instruction
         getField,
+        getFieldImm,  // getField with the field name carried in the instruction
         getElement,
         collComparisonKey,
 
@@ -275,6 +277,15 @@ struct Instruction {
         lastInstruction  // this is just a marker used to calculate number of instructions
     };
 
+    /**
+     * Constants which can be carried by an instruction rather than pushed on the stack.
+     */
+    enum Constants : uint8_t {
+        Null,
+        False,
+        True,
+    };
+
     // Make sure that values in this arrays are always in-sync with the enum.
     static int stackOffset[];
 
@@ -449,7 +460,9 @@ public:
     void appendFillEmpty() {
         appendSimpleInstruction(Instruction::fillEmpty);
     }
+    void appendFillEmpty(Instruction::Constants k);
     void appendGetField();
+    void appendGetField(StringData fieldName);
     void appendGetElement();
     void appendCollComparisonKey();
     void appendSum();
@@ -605,6 +618,10 @@ private:
                                                              value::TypeTags fieldTag,
                                                              value::Value fieldValue);
 
+    std::tuple<bool, value::TypeTags, value::Value> getField(value::TypeTags objTag,
+                                                             value::Value objValue,
+                                                             StringData fieldStr);
+
     std::tuple<bool, value::TypeTags, value::Value> getElement(value::TypeTags objTag,
                                                                value::Value objValue,
                                                                value::TypeTags fieldTag,
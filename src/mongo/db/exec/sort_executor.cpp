@@ -33,6 +33,7 @@
 
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/sorter/sorter_read_ahead_gen.h"
 
 namespace mongo {
 namespace {
@@ -50,6 +51,27 @@ std::string nextFileName() {
     return "extsort-sort-executor." + std::to_string(sortExecutorFileCounter.fetchAndAdd(1));
 }
 }  // namespace
+
+template <typename T>
+SortOptions SortExecutor<T>::makeSortOptions() const {
+    SortOptions opts;
+    if (_stats.limit) {
+        opts.limit = _stats.limit;
+    }
+
+    opts.maxMemoryUsageBytes = _stats.maxMemoryUsageBytes;
+    if (_diskUseAllowed) {
+        opts.extSortAllowed = true;
+        opts.tempDir = _tempDir;
+        opts.readAhead = enableSorterReadAhead.load();
+    }
+
+    return opts;
+}
+
+template SortOptions SortExecutor<Document>::makeSortOptions() const;
+template SortOptions SortExecutor<SortableWorkingSetMember>::makeSortOptions() const;
+template SortOptions SortExecutor<BSONObj>::makeSortOptions() const;
 }  // namespace mongo
 
 #include "mongo/db/sorter/sorter.cpp"
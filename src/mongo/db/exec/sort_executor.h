@@ -172,20 +172,10 @@ public:
     }
 
 private:
-    SortOptions makeSortOptions() const {
-        SortOptions opts;
-        if (_stats.limit) {
-            opts.limit = _stats.limit;
-        }
-
-        opts.maxMemoryUsageBytes = _stats.maxMemoryUsageBytes;
-        if (_diskUseAllowed) {
-            opts.extSortAllowed = true;
-            opts.tempDir = _tempDir;
-        }
-
-        return opts;
-    }
+    /**
+     * Defined in sort_executor.cpp, which instantiates it for every supported type.
+     */
+    SortOptions makeSortOptions() const;
 
     const SortPattern _sortPattern;
     const std::string _tempDir;
@@ -33,6 +33,8 @@
 #include <cstdint>
 #include <type_traits>
 
+#include "mongo/platform/atomic_word.h"
+
 namespace mongo {
 /**
  * During the runtime planning phase this tracker is used to track the progress of the work done
@@ -75,6 +77,11 @@ public:
             return true;
         }
 
+        if (_stopFlag && _stopFlag->load()) {
+            _done = true;
+            return true;
+        }
+
         _metrics[metric] += metricIncrement;
         if (_metrics[metric] >= _maxMetrics[metric]) {
             _done = true;
@@ -82,9 +89,19 @@ public:
         return _done;
     }
 
+    /**
+     * Makes the trial run end once '*stopFlag' is set, even if no metric has reached its maximum.
+     * This lets candidate plans trialed concurrently stop each other. Passing nullptr removes the
+     * flag, which must otherwise outlive the tracker.
+     */
+    void setStopFlag(const AtomicWord<bool>* stopFlag) {
+        _stopFlag = stopFlag;
+    }
+
 private:
     const size_t _maxMetrics[TrialRunMetric::kLastElem];
     size_t _metrics[TrialRunMetric::kLastElem]{0};
     bool _done{false};
+    const AtomicWord<bool>* _stopFlag{nullptr};
 };
 }  // namespace mongo
@@ -146,6 +146,24 @@ void FcvOpObserver::_onInsertOrUpdate(OperationContext* opCtx, const BSONObj& do
         LOGV2(20459, "Setting featureCompatibilityVersion", attrs);
     }
 
+    // The primary refuses to finish a downgrade while it has indexes storing their keys in
+    // KeyString V2, but every node chooses the format of its own indexes. A node replicating the
+    // end of the downgrade must not go on with such indexes, which the earlier binary cannot open.
+    // (Generic FCV reference): This FCV check should exist across LTS binary versions.
+    const bool isFullyDowngraded = newVersion == FeatureCompatibilityParams::kLastLTS ||
+        newVersion == FeatureCompatibilityParams::kLastContinuous;
+    if (isDifferent && isFullyDowngraded && !opCtx->writesAreReplicated()) {
+        if (auto keyStringV2Index = FeatureCompatibilityVersion::findKeyStringV2Index(opCtx)) {
+            LOGV2_FATAL_NOTRACE(
+                6179069,
+                "Cannot downgrade the featureCompatibilityVersion while this node has indexes "
+                "storing their keys in KeyString V2. Resync this node, which rebuilds its indexes "
+                "in the format of the downgraded featureCompatibilityVersion",
+                "index"_attr = *keyStringV2Index,
+                "newVersion"_attr = FeatureCompatibilityVersionParser::toString(newVersion));
+        }
+    }
+
     opCtx->recoveryUnit()->onCommit(
         [opCtx, newVersion](boost::optional<Timestamp> ts) { _setVersion(opCtx, newVersion, ts); });
 }
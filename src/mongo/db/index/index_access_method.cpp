@@ -36,6 +36,7 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/timestamp_block.h"
+#include "mongo/db/sorter/sorter_read_ahead_gen.h"
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/logv2/log.h"
@@ -84,7 +86,9 @@ SortOptions makeSortOptions(size_t maxMemoryUsageBytes, StringData dbName) {
         .TempDir(storageGlobalParams.dbpath + "/_tmp")
         .ExtSortAllowed()
         .MaxMemoryUsageBytes(maxMemoryUsageBytes)
-        .DBName(dbName.toString());
+        .DBName(dbName.toString())
+        .ReadAhead(enableSorterReadAhead.load())
+        .TrainSpillDictionary();
 }
 
 MultikeyPaths createMultikeyPaths(const std::vector<MultikeyPath>& multikeyPathsVec) {
@@ -194,8 +198,19 @@ Status AbstractIndexAccessMethod::insertKeys(OperationContext* opCtx,
         *numInserted = 0;
     }
     // Add all new keys into the index. The RecordId for each is already encoded in the KeyString.
+    bool unique = _descriptor->unique();
+    if (!unique) {
+        // No key can be a duplicate, so all of them can go through the same cursor.
+        Status status = _newInterface->insertMany(opCtx, keys, true /* dupsAllowed */);
+        if (!status.isOK())
+            return status;
+        if (numInserted) {
+            *numInserted = keys.size();
+        }
+        return Status::OK();
+    }
+
     for (const auto& keyString : keys) {
-        bool unique = _descriptor->unique();
         Status status = _newInterface->insert(opCtx, keyString, !unique /* dupsAllowed */);
 
         // When duplicates are encountered and allowed, retry with dupsAllowed. Call
@@ -514,9 +529,13 @@ public:
 
     Sorter::PersistedState persistDataForShutdown() final;
 
+    void absorb(std::unique_ptr<BulkBuilder> other) final;
+
 private:
     void _insertMultikeyMetadataKeysIntoSorter();
 
+    void _mergeMultikeyPaths(const MultikeyPaths& multikeyPaths);
+
     Sorter* _makeSorter(
         size_t maxMemoryUsageBytes,
         StringData dbName,
@@ -540,6 +559,10 @@ private:
     // These are inserted into the sorter after all normal data keys have been added, just
     // before the bulk build is committed.
     KeyStringSet _multikeyMetadataKeys;
+
+    // Sorters taken over from other BulkBuilders through absorb(). Their keys are merged with the
+    // keys of '_sorter' when the build is finalized.
+    std::vector<std::unique_ptr<Sorter>> _absorbedSorters;
 };
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
@@ -609,18 +632,7 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
         return exceptionToStatus();
     }
 
-    if (!multikeyPaths->empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = *multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths->size());
-            for (size_t i = 0; i < multikeyPaths->size(); ++i) {
-                _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
-                                              (*multikeyPaths)[i].begin(),
-                                              (*multikeyPaths)[i].end());
-            }
-        }
-    }
+    _mergeMultikeyPaths(*multikeyPaths);
 
     for (const auto& keyString : *keys) {
         _sorter->add(keyString, mongo::NullValue());
@@ -645,7 +657,16 @@ bool AbstractIndexAccessMethod::BulkBuilderImpl::isMultikey() const {
 IndexAccessMethod::BulkBuilder::Sorter::Iterator*
 AbstractIndexAccessMethod::BulkBuilderImpl::done() {
     _insertMultikeyMetadataKeysIntoSorter();
-    return _sorter->done();
+    if (_absorbedSorters.empty()) {
+        return _sorter->done();
+    }
+
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    iters.emplace_back(_sorter->done());
+    for (auto& sorter : _absorbedSorters) {
+        iters.emplace_back(sorter->done());
+    }
+    return Sorter::Iterator::merge(iters, SortOptions(), BtreeExternalSortComparison());
 }
 
 int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
@@ -655,9 +676,37 @@ int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
 AbstractIndexAccessMethod::BulkBuilder::Sorter::PersistedState
 AbstractIndexAccessMethod::BulkBuilderImpl::persistDataForShutdown() {
     _insertMultikeyMetadataKeysIntoSorter();
+
+    // The persisted state only describes a single sorter, so move the keys of any absorbed sorters
+    // into '_sorter' first. These keys are already accounted for in '_keysInserted'.
+    for (auto& sorter : _absorbedSorters) {
+        std::unique_ptr<Sorter::Iterator> it(sorter->done());
+        while (it->more()) {
+            auto data = it->next();
+            _sorter->add(data.first, data.second);
+        }
+    }
+    _absorbedSorters.clear();
+
     return _sorter->persistDataForShutdown();
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::absorb(std::unique_ptr<BulkBuilder> other) {
+    auto otherImpl = checked_cast<BulkBuilderImpl*>(other.get());
+    invariant(otherImpl->_indexCatalogEntry == _indexCatalogEntry);
+
+    _mergeMultikeyPaths(otherImpl->_indexMultikeyPaths);
+    _isMultiKey = _isMultiKey || otherImpl->_isMultiKey;
+    _multikeyMetadataKeys.insert(otherImpl->_multikeyMetadataKeys.begin(),
+                                 otherImpl->_multikeyMetadataKeys.end());
+    _keysInserted += otherImpl->_keysInserted;
+
+    _absorbedSorters.push_back(std::move(otherImpl->_sorter));
+    for (auto& sorter : otherImpl->_absorbedSorters) {
+        _absorbedSorters.push_back(std::move(sorter));
+    }
+}
+
 void AbstractIndexAccessMethod::BulkBuilderImpl::_insertMultikeyMetadataKeysIntoSorter() {
     for (const auto& keyString : _multikeyMetadataKeys) {
         _sorter->add(keyString, mongo::NullValue());
@@ -669,6 +718,25 @@ void AbstractIndexAccessMethod::BulkBuilderImpl::_insertMultikeyMetadataKeysInto
     _multikeyMetadataKeys.clear();
 }
 
+void AbstractIndexAccessMethod::BulkBuilderImpl::_mergeMultikeyPaths(
+    const MultikeyPaths& multikeyPaths) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+
+    if (_indexMultikeyPaths.empty()) {
+        _indexMultikeyPaths = multikeyPaths;
+        return;
+    }
+
+    invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
+    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+        _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
+                                      multikeyPaths[i].begin(),
+                                      multikeyPaths[i].end());
+    }
+}
+
 AbstractIndexAccessMethod::BulkBuilderImpl::Sorter::Settings
 AbstractIndexAccessMethod::BulkBuilderImpl::_makeSorterSettings() const {
     return std::pair<KeyString::Value::SorterDeserializeSettings,
@@ -268,6 +268,12 @@ public:
          * state of the underlying Sorter.
          */
         virtual Sorter::PersistedState persistDataForShutdown() = 0;
+
+        /**
+         * Takes over the keys and multikey state accumulated by 'other', which must have been
+         * initiated on the same index. The keys of both builders are merged in order by done().
+         */
+        virtual void absorb(std::unique_ptr<BulkBuilder> other) = 0;
     };
 
     /**
@@ -130,6 +130,9 @@ const NamespaceString NamespaceString::kForceOplogBatchBoundaryNamespace(
 const NamespaceString NamespaceString::kConfigImagesNamespace(NamespaceString::kConfigDb,
                                                               "image_collection");
 
+const NamespaceString NamespaceString::kCollectionStatisticsNamespace(
+    NamespaceString::kLocalDb, "system.collectionStatistics");
+
 bool NamespaceString::isListCollectionsCursorNS() const {
     return coll() == listCollectionsCursorCol;
 }
@@ -163,6 +166,8 @@ bool NamespaceString::isLegalClientSystemNS(
             return true;
         if (coll() == "system.healthlog")
             return true;
+        if (coll() == kCollectionStatisticsNamespace.coll())
+            return true;
     }
 
     if (coll() == "system.users")
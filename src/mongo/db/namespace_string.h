@@ -181,6 +181,9 @@ public:
     // Namespace used for storing retryable findAndModify images.
     static const NamespaceString kConfigImagesNamespace;
 
+    // Namespace for the statistics built by the 'analyze' command, keyed by collection UUID.
+    static const NamespaceString kCollectionStatisticsNamespace;
+
     /**
      * Constructs an empty NamespaceString.
      */
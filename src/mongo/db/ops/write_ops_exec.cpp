@@ -71,10 +71,12 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/server_write_concern_metrics.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/db/storage/duplicate_key_error_info.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/update/document_diff_applier.h"
 #include "mongo/db/update/path_support.h"
@@ -1310,6 +1312,73 @@ Status performAtomicTimeseriesWrites(
     return ex.toStatus();
 }
 
+Status performTimeseriesBucketCompression(OperationContext* opCtx,
+                                          const NamespaceString& ns,
+                                          const OID& bucketId,
+                                          StringData timeField) try {
+    invariant(!opCtx->lockState()->inAWriteUnitOfWork());
+    invariant(!opCtx->inMultiDocumentTransaction());
+
+    DisableDocumentValidation disableDocumentValidation{opCtx};
+
+    LastOpFixer lastOpFixer{opCtx, ns};
+    lastOpFixer.startingOp();
+
+    writeConflictRetry(opCtx, "timeseriesBucketCompression", ns.ns(), [&] {
+        AutoGetCollection coll{opCtx, ns, MODE_IX};
+        if (!coll) {
+            assertTimeseriesBucketsCollectionNotFound(ns);
+        }
+
+        assertCanWrite_inlock(opCtx, ns);
+        invariant(coll->isClustered());
+
+        // Earlier versions of the server cannot read compressed buckets, so they are only written
+        // while the FCV is fully upgraded. Checking under the collection lock means a downgrade,
+        // which waits for the writes that started before the FCV change, only has to check once
+        // for compressed buckets.
+        const auto& fcv = serverGlobalParams.featureCompatibility;
+        if (!fcv.isVersionInitialized() ||
+            !fcv.isGreaterThanOrEqualTo(ServerGlobalParams::FeatureCompatibility::kLatest)) {
+            return;
+        }
+
+        // Reading and rewriting the bucket in the same storage transaction makes any concurrent
+        // write to the bucket surface as a write conflict rather than being overwritten.
+        WriteUnitOfWork wuow{opCtx};
+        auto recordId = record_id_helpers::keyForOID(bucketId);
+        Snapshotted<BSONObj> original;
+        if (!coll->findDoc(opCtx, recordId, &original)) {
+            return;
+        }
+
+        auto compressed = timeseries::compressBucket(original.value(), timeField);
+        if (!compressed) {
+            return;
+        }
+
+        CollectionUpdateArgs args;
+        args.preImageDoc = original.value();
+        args.updatedDoc = *compressed;
+        args.update = *compressed;
+        args.criteria = BSON("_id" << bucketId);
+        args.source = OperationSource::kTimeseries;
+        coll->updateDocument(opCtx,
+                             recordId,
+                             original,
+                             *compressed,
+                             true /* indexesAffected */,
+                             &CurOp::get(opCtx)->debug(),
+                             &args);
+        wuow.commit();
+    });
+
+    lastOpFixer.finishedOpSuccessfully();
+    return Status::OK();
+} catch (const DBException& ex) {
+    return ex.toStatus();
+}
+
 void recordUpdateResultInOpDebug(const UpdateResult& updateResult, OpDebug* opDebug) {
     invariant(opDebug);
     opDebug->additiveMetrics.nMatched = updateResult.numMatched;
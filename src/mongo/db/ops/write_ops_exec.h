@@ -88,6 +88,15 @@ Status performAtomicTimeseriesWrites(OperationContext* opCtx,
                                      const std::vector<write_ops::InsertCommandRequest>& insertOps,
                                      const std::vector<write_ops::UpdateCommandRequest>& updateOps);
 
+/**
+ * Replaces the closed time-series bucket with id 'bucketId' in the buckets collection 'ns' with
+ * its compressed form. Does nothing if the bucket no longer exists or cannot be compressed.
+ */
+Status performTimeseriesBucketCompression(OperationContext* opCtx,
+                                          const NamespaceString& ns,
+                                          const OID& bucketId,
+                                          StringData timeField);
+
 /**
  * Populate 'opDebug' with stats describing the execution of an update operation. Illegal to call
  * with a null OpDebug pointer.
@@ -109,7 +109,9 @@ DocumentSource::GetNextResult DocumentSourceExchange::doGetNext() {
     return _exchange->getNext(pExpCtx->opCtx, _consumerId, _resourceYielder.get());
 }
 
-Exchange::Exchange(ExchangeSpec spec, std::unique_ptr<Pipeline, PipelineDeleter> pipeline)
+Exchange::Exchange(ExchangeSpec spec,
+                   std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+                   boost::optional<size_t> loadingConsumerId)
     : _spec(std::move(spec)),
       _keyPattern(_spec.getKey().getOwned()),
       _ordering(extractOrdering(_keyPattern)),
@@ -119,7 +121,8 @@ Exchange::Exchange(ExchangeSpec spec, std::unique_ptr<Pipeline, PipelineDeleter>
       _policy(_spec.getPolicy()),
       _orderPreserving(_spec.getOrderPreserving()),
       _maxBufferSize(_spec.getBufferSize()),
-      _pipeline(std::move(pipeline)) {
+      _pipeline(std::move(pipeline)),
+      _loadingConsumerId(loadingConsumerId) {
     uassert(50901, "Exchange must have at least one consumer", _spec.getConsumers() > 0);
 
     uassert(50951,
@@ -131,6 +134,10 @@ Exchange::Exchange(ExchangeSpec spec, std::unique_ptr<Pipeline, PipelineDeleter>
         _consumers.emplace_back(std::make_unique<ExchangeBuffer>());
     }
 
+    tassert(6179039,
+            "The exchange loading consumer must be one of its consumers",
+            !_loadingConsumerId || *_loadingConsumerId < _consumers.size());
+
     if (_policy == ExchangePolicyEnum::kKeyRange) {
         uassert(50900,
                 "Exchange boundaries do not match number of consumers.",
@@ -301,7 +308,8 @@ DocumentSource::GetNextResult Exchange::getNext(OperationContext* opCtx,
         }
 
         // There is not any document so try to load more from the source.
-        if (_loadingThreadId == kInvalidThreadId) {
+        if (_loadingThreadId == kInvalidThreadId &&
+            (!_loadingConsumerId || *_loadingConsumerId == consumerId)) {
             LOGV2_DEBUG(
                 20896, 3, "A consumer {consumerId} begins loading", "consumerId"_attr = consumerId);
 
@@ -340,6 +348,11 @@ DocumentSource::GetNextResult Exchange::getNext(OperationContext* opCtx,
                 throw;
             }
         } else {
+            // If the only consumer allowed to load is gone, nothing will ever be loaded again.
+            uassert(ErrorCodes::ExchangePassthrough,
+                    "Exchange failed because its loading consumer was disposed of.",
+                    !_loadingConsumerId || !_consumers[*_loadingConsumerId]->isDisposed());
+
             // Some other consumer is already loading the buffers. There is nothing else we can do
             // but wait.
             MutexAndResourceLock mutexAndResourceLock(opCtx, std::move(lk), resourceYielder);
@@ -445,9 +458,16 @@ void Exchange::dispose(OperationContext* opCtx, size_t consumerId) {
 
     ++_disposeRunDown;
 
-    // If _errorInLoadNextBatch status is not OK then an exception was thrown. In that case the
-    // throwing thread will do the dispose.
-    if (!_errorInLoadNextBatch.isOK()) {
+    if (_loadingConsumerId) {
+        // Only the loading consumer has ever used the input, so it is the one to dispose of it.
+        // Consumers waiting on it to load must find out that it never will.
+        if (*_loadingConsumerId == consumerId) {
+            _pipeline->dispose(opCtx);
+            _haveBufferSpace.notify_all();
+        }
+    } else if (!_errorInLoadNextBatch.isOK()) {
+        // If _errorInLoadNextBatch status is not OK then an exception was thrown. In that case the
+        // throwing thread will do the dispose.
         if (_loadingThreadId == consumerId) {
             _pipeline->dispose(opCtx);
         }
@@ -74,8 +74,15 @@ public:
     /**
      * Create an exchange. 'pipeline' represents the input to the exchange operator and must not be
      * nullptr.
+     *
+     * By default whichever consumer runs out of documents first loads the next batch from
+     * 'pipeline'. If 'loadingConsumerId' is set, only that consumer ever loads and it is the one to
+     * dispose of 'pipeline', so that the input only ever runs on the thread of that consumer. The
+     * other consumers wait for it to load.
      **/
-    Exchange(ExchangeSpec spec, std::unique_ptr<Pipeline, PipelineDeleter> pipeline);
+    Exchange(ExchangeSpec spec,
+             std::unique_ptr<Pipeline, PipelineDeleter> pipeline,
+             boost::optional<size_t> loadingConsumerId = boost::none);
 
     /**
      * Interface for retrieving the next document. 'resourceYielder' is optional, and if provided,
@@ -116,6 +123,9 @@ private:
         bool isEmpty() const {
             return _buffer.empty();
         }
+        bool isDisposed() const {
+            return _disposed;
+        }
         /**
          * Mark the buffer associated with a consumer as disposed. After calling this method,
          * subsequent results that are appended to this buffer are instead discarded to prevent this
@@ -176,6 +186,9 @@ private:
     // A thread that is currently loading the exchange buffers.
     size_t _loadingThreadId{kInvalidThreadId};
 
+    // The only consumer allowed to load the exchange buffers, if any.
+    const boost::optional<size_t> _loadingConsumerId;
+
     // A status indicating that the exception was thrown during loadNextBatch(). Once in the failed
     // state all other producing threads will fail too.
     Status _errorInLoadNextBatch{Status::OK()};
@@ -470,9 +470,17 @@ void DocumentSourceGroup::setIdExpression(const boost::intrusive_ptr<Expression>
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
     BSONElement elem, const intrusive_ptr<ExpressionContext>& expCtx) {
+    return createFromBsonWithMaxMemoryUsage(std::move(elem), expCtx, boost::none);
+}
+
+intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBsonWithMaxMemoryUsage(
+    BSONElement elem,
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    boost::optional<size_t> maxMemoryUsageBytes) {
     uassert(15947, "a group's fields must be specified in an object", elem.type() == Object);
 
-    intrusive_ptr<DocumentSourceGroup> groupStage(new DocumentSourceGroup(expCtx));
+    intrusive_ptr<DocumentSourceGroup> groupStage(
+        new DocumentSourceGroup(expCtx, maxMemoryUsageBytes));
 
     BSONObj groupObj(elem.Obj());
     BSONObjIterator groupIterator(groupObj);
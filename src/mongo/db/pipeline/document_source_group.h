@@ -119,6 +119,15 @@ public:
     static boost::intrusive_ptr<DocumentSource> createFromBson(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
+    /**
+     * Same as createFromBson(), but the stage may use at most 'maxMemoryUsageBytes' of memory
+     * before spilling, or internalDocumentSourceGroupMaxMemoryBytes if it is boost::none.
+     */
+    static boost::intrusive_ptr<DocumentSource> createFromBsonWithMaxMemoryUsage(
+        BSONElement elem,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        boost::optional<size_t> maxMemoryUsageBytes);
+
     StageConstraints constraints(Pipeline::SplitState pipeState) const final {
         StageConstraints constraints(StreamType::kBlocking,
                                      PositionRequirement::kNone,
@@ -42,6 +42,8 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/matcher/expression_internal_expr_comparison.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/pipeline/document_source_add_fields.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -51,6 +53,7 @@
 #include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/util/make_data_structure.h"
 #include "mongo/db/timeseries/timeseries_constants.h"
 #include "mongo/logv2/log.h"
@@ -305,6 +308,7 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
     auto hasBucketMaxSpanSeconds = false;
     auto bucketMaxSpanSeconds = 0;
     std::vector<std::string> computedMetaProjFields;
+    boost::optional<BSONObj> eventFilter;
     for (auto&& elem : specElem.embeddedObject()) {
         auto fieldName = elem.fieldNameStringData();
         if (fieldName == kInclude || fieldName == kExclude) {
@@ -375,6 +379,11 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
                         field.find('.') == std::string::npos);
                 bucketSpec.computedMetaProjFields.emplace_back(field);
             }
+        } else if (fieldName == kEventFilter) {
+            uassert(6179034,
+                    str::stream() << "eventFilter field must be an object, got: " << elem.type(),
+                    elem.type() == BSONType::Object);
+            eventFilter = elem.Obj();
         } else if (fieldName == "includeBucketIdAndRowIndex") {
             uassert(5809600,
                     str::stream() << "includeBucketIdAndRowIndex field must be a boolean, got: "
@@ -395,8 +404,17 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
             "The $_internalUnpackBucket stage requires a bucketMaxSpanSeconds parameter",
             hasBucketMaxSpanSeconds);
 
-    return make_intrusive<DocumentSourceInternalUnpackBucket>(
+    uassert(6179035,
+            "The $_internalUnpackBucket stage does not support an eventFilter together with "
+            "includeBucketIdAndRowIndex",
+            !eventFilter || !bucketSpec.includeBucketIdAndRowIndex);
+
+    auto unpackStage = make_intrusive<DocumentSourceInternalUnpackBucket>(
         expCtx, BucketUnpacker{std::move(bucketSpec), unpackerBehavior}, bucketMaxSpanSeconds);
+    if (eventFilter) {
+        unpackStage->setEventFilter(*eventFilter);
+    }
+    return unpackStage;
 }
 
 boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createFromBsonExternal(
@@ -478,6 +496,10 @@ void DocumentSourceInternalUnpackBucket::serializeToArray(
                          return compFields;
                      }()});
 
+    if (_eventFilter) {
+        out.addField(kEventFilter, Value{_eventFilterBson});
+    }
+
     if (!explain) {
         array.push_back(Value(DOC(getSourceName() << out.freeze())));
         if (_sampleSize) {
@@ -496,14 +518,39 @@ void DocumentSourceInternalUnpackBucket::serializeToArray(
 DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::doGetNext() {
     tassert(5521502, "calling doGetNext() when '_sampleSize' is set is disallowed", !_sampleSize);
 
-    // Otherwise, fallback to unpacking every measurement in all buckets until the child stage is
-    // exhausted.
-    if (_bucketUnpacker.hasNext()) {
-        return _bucketUnpacker.getNext();
-    }
+    while (true) {
+        if (_emptyMeasurementsRemaining > 0) {
+            --_emptyMeasurementsRemaining;
+            return Document{};
+        }
+
+        while (_measurementBatchPos < _measurementBatch.size()) {
+            auto pos = _measurementBatchPos++;
+            if (matchesEventFilter(_measurementBatch.timeElements[pos])) {
+                return _measurementBatch.getMeasurement(pos);
+            }
+        }
+
+        // Otherwise, fallback to unpacking every measurement in all buckets until the child stage
+        // is exhausted. Decoding a block of measurements column by column is cheaper than
+        // advancing every column iterator in lockstep for each measurement.
+        if (_bucketUnpacker.hasNext()) {
+            auto batchSize = internalQueryTimeseriesUnpackBatchSize.load();
+            if (_bucketUnpacker.bucketSpec().includeBucketIdAndRowIndex ||
+                (batchSize <= 1 && !_eventFilter)) {
+                return _bucketUnpacker.getNext();
+            }
+
+            _measurementBatch = _bucketUnpacker.getNextBatch(std::max(batchSize, 1));
+            _measurementBatchPos = 0;
+            continue;
+        }
+
+        auto nextResult = pSource->getNext();
+        if (!nextResult.isAdvanced()) {
+            return nextResult;
+        }
 
-    auto nextResult = pSource->getNext();
-    if (nextResult.isAdvanced()) {
         auto bucket = nextResult.getDocument().toBson();
         _bucketUnpacker.reset(std::move(bucket));
         uassert(5346509,
@@ -511,10 +558,27 @@ DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::doGetNext() {
                               << _bucketUnpacker.bucket()[timeseries::kBucketIdFieldName].toString()
                               << " contains an empty data region",
                 _bucketUnpacker.hasNext());
-        return _bucketUnpacker.getNext();
+
+        _bucketMatchesWholly =
+            _wholeBucketFilter && _wholeBucketFilter->matchesBSON(_bucketUnpacker.bucket());
+        if ((!_eventFilter || _bucketMatchesWholly) &&
+            _bucketUnpacker.producesEmptyMeasurements()) {
+            // Every measurement of this bucket is returned and none of their fields are needed,
+            // for example for a $count, so there is nothing to decode.
+            _emptyMeasurementsRemaining = _bucketUnpacker.skipRemaining();
+        }
     }
+}
 
-    return nextResult;
+void DocumentSourceInternalUnpackBucket::setEventFilter(const BSONObj& filter) {
+    _eventFilterBson = filter.getOwned();
+    _eventFilter = uassertStatusOK(MatchExpressionParser::parse(
+        _eventFilterBson, pExpCtx, ExtensionsCallbackNoop(), Pipeline::kAllowedMatcherFeatures));
+    _wholeBucketFilter = createWholeBucketPredicate(_eventFilter.get());
+    uassert(6179036,
+            "The eventFilter of $_internalUnpackBucket must be a conjunction of comparisons "
+            "against dates on the time field",
+            _wholeBucketFilter);
 }
 
 bool DocumentSourceInternalUnpackBucket::pushDownComputedMetaProjection(
@@ -746,6 +810,61 @@ DocumentSourceInternalUnpackBucket::createPredicatesOnBucketLevelField(
     return nullptr;
 }
 
+std::unique_ptr<MatchExpression> DocumentSourceInternalUnpackBucket::createWholeBucketPredicate(
+    const MatchExpression* matchExpr) const {
+    using namespace timeseries;
+
+    if (matchExpr->matchType() == MatchExpression::AND) {
+        // Every conjunct must hold for the whole bucket, otherwise some measurement may not match.
+        auto andMatchExpr = std::make_unique<AndMatchExpression>();
+        for (size_t i = 0; i < matchExpr->numChildren(); i++) {
+            auto child = createWholeBucketPredicate(matchExpr->getChild(i));
+            if (!child) {
+                return nullptr;
+            }
+            andMatchExpr->add(std::move(child));
+        }
+        if (andMatchExpr->numChildren() > 0) {
+            return andMatchExpr;
+        }
+        return nullptr;
+    }
+
+    if (!ComparisonMatchExpression::isComparisonMatchExpression(matchExpr)) {
+        return nullptr;
+    }
+
+    // The time field is present in every measurement and always holds a date, so a comparison
+    // against a date on it can be decided from the bucket's control.min and control.max. The
+    // control.min time may be rounded down, which only makes the predicate more conservative.
+    auto comparison = static_cast<const ComparisonMatchExpression*>(matchExpr);
+    auto&& timeField = _bucketUnpacker.bucketSpec().timeField;
+    if (comparison->path() != timeField || comparison->getData().type() != BSONType::Date) {
+        return nullptr;
+    }
+
+    auto controlMinPath = std::string{kControlMinFieldNamePrefix} + timeField;
+    auto controlMaxPath = std::string{kControlMaxFieldNamePrefix} + timeField;
+    auto rhs = comparison->getData();
+    switch (comparison->matchType()) {
+        case MatchExpression::EQ:
+            return std::make_unique<AndMatchExpression>(
+                makeVector<std::unique_ptr<MatchExpression>>(
+                    std::make_unique<InternalExprGTEMatchExpression>(controlMinPath, rhs),
+                    std::make_unique<InternalExprLTEMatchExpression>(controlMaxPath, rhs)));
+        case MatchExpression::GT:
+            return std::make_unique<InternalExprGTMatchExpression>(controlMinPath, rhs);
+        case MatchExpression::GTE:
+            return std::make_unique<InternalExprGTEMatchExpression>(controlMinPath, rhs);
+        case MatchExpression::LT:
+            return std::make_unique<InternalExprLTMatchExpression>(controlMaxPath, rhs);
+        case MatchExpression::LTE:
+            return std::make_unique<InternalExprLTEMatchExpression>(controlMaxPath, rhs);
+        default:
+            MONGO_UNREACHABLE_TASSERT(6179037);
+    }
+}
+
 std::pair<boost::intrusive_ptr<DocumentSourceMatch>, boost::intrusive_ptr<DocumentSourceMatch>>
 DocumentSourceInternalUnpackBucket::splitMatchOnMetaAndRename(
     boost::intrusive_ptr<DocumentSourceMatch> match) {
@@ -776,21 +895,31 @@ DocumentSourceInternalUnpackBucket::rewriteGroupByMinMax(Pipeline::SourceContain
         return {};
     }
 
+    // The control fields cover every measurement of a bucket, not only those that pass the event
+    // filter.
+    if (_eventFilter) {
+        return {};
+    }
+
     const auto& idFields = groupPtr->getIdFields();
-    if (idFields.size() != 1 || !_bucketUnpacker.bucketSpec().metaField.has_value()) {
+    if (idFields.size() != 1) {
         return {};
     }
 
+    // The group key must be the same for every measurement in a bucket, that is either a constant
+    // or a path on the metaField.
     const auto& exprId = idFields.cbegin()->second;
     const auto* exprIdPath = dynamic_cast<const ExpressionFieldPath*>(exprId.get());
-    if (exprIdPath == nullptr) {
+    if (exprIdPath == nullptr && dynamic_cast<const ExpressionConstant*>(exprId.get()) == nullptr) {
         return {};
     }
 
-    const auto& idPath = exprIdPath->getFieldPath();
-    if (idPath.getPathLength() < 2 ||
-        idPath.getFieldName(1) != _bucketUnpacker.bucketSpec().metaField.get()) {
-        return {};
+    if (exprIdPath) {
+        const auto& idPath = exprIdPath->getFieldPath();
+        if (!_bucketUnpacker.bucketSpec().metaField.has_value() || idPath.getPathLength() < 2 ||
+            idPath.getFieldName(1) != _bucketUnpacker.bucketSpec().metaField.get()) {
+            return {};
+        }
     }
 
     bool suitable = true;
@@ -838,17 +967,25 @@ DocumentSourceInternalUnpackBucket::rewriteGroupByMinMax(Pipeline::SourceContain
             AccumulationExpression accExpr = stmt.expr;
             accExpr.argument = newExpr;
             accumulationStatements.emplace_back(stmt.fieldName, std::move(accExpr));
+        } else {
+            // Only aggregates of a single field can be answered from the control fields.
+            suitable = false;
+            break;
         }
     }
 
     if (suitable) {
-        std::ostringstream os;
-        os << timeseries::kBucketMetaFieldName;
-        for (size_t index = 2; index < idPath.getPathLength(); index++) {
-            os << "." << idPath.getFieldName(index);
+        boost::intrusive_ptr<Expression> exprId1 = exprId;
+        if (exprIdPath) {
+            const auto& idPath = exprIdPath->getFieldPath();
+            std::ostringstream os;
+            os << timeseries::kBucketMetaFieldName;
+            for (size_t index = 2; index < idPath.getPathLength(); index++) {
+                os << "." << idPath.getFieldName(index);
+            }
+            exprId1 = ExpressionFieldPath::createPathFromString(
+                pExpCtx.get(), os.str(), pExpCtx->variablesParseState);
         }
-        auto exprId1 = ExpressionFieldPath::createPathFromString(
-            pExpCtx.get(), os.str(), pExpCtx->variablesParseState);
 
         auto newGroup = DocumentSourceGroup::create(pExpCtx,
                                                     std::move(exprId1),
@@ -976,6 +1113,21 @@ Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimi
         }
     }
 
+    // Absorb a $match on the time field into this stage, so that buckets whose control fields
+    // prove that every measurement matches are unpacked without filtering each measurement. This
+    // must come after the predicates on the control fields have been created from the $match.
+    if (auto nextMatch = dynamic_cast<DocumentSourceMatch*>(std::next(itr)->get()); nextMatch &&
+        _triedBucketLevelFieldsPredicatesPushdown && !_eventFilter && !_sampleSize &&
+        !_bucketUnpacker.bucketSpec().includeBucketIdAndRowIndex &&
+        !fieldIsComputed(_bucketUnpacker.bucketSpec(), _bucketUnpacker.bucketSpec().timeField) &&
+        createWholeBucketPredicate(nextMatch->getMatchExpression())) {
+        setEventFilter(nextMatch->getQuery());
+        container->erase(std::next(itr));
+
+        // The rest of the pipeline has changed, so try to optimize this stage again.
+        return itr;
+    }
+
     // Attempt to push down a $project on the metaField past $_internalUnpackBucket.
     if (!haveComputedMetaField) {
         if (auto [metaProject, deleteRemainder] = extractProjectForPushDown(std::next(itr)->get());
@@ -44,6 +44,7 @@ public:
     static constexpr StringData kInclude = "include"_sd;
     static constexpr StringData kExclude = "exclude"_sd;
     static constexpr StringData kBucketMaxSpanSeconds = "bucketMaxSpanSeconds"_sd;
+    static constexpr StringData kEventFilter = "eventFilter"_sd;
 
     static boost::intrusive_ptr<DocumentSource> createFromBsonInternal(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
@@ -160,6 +161,26 @@ public:
     std::unique_ptr<MatchExpression> createPredicatesOnBucketLevelField(
         const MatchExpression* matchExpr) const;
 
+    /**
+     * Returns a predicate on the control fields of a bucket which holds only if every measurement
+     * in the bucket matches 'matchExpr', or nullptr if no such predicate can be built. Only
+     * conjunctions of comparisons against dates on the time field are supported, since the time
+     * field is the only field present in every measurement.
+     */
+    std::unique_ptr<MatchExpression> createWholeBucketPredicate(
+        const MatchExpression* matchExpr) const;
+
+    /**
+     * Makes this stage only return measurements that match 'filter', a predicate on the time field
+     * for which createWholeBucketPredicate() succeeds. Buckets that match the whole bucket
+     * predicate are unpacked without evaluating 'filter' on each of their measurements.
+     */
+    void setEventFilter(const BSONObj& filter);
+
+    const MatchExpression* eventFilter() const {
+        return _eventFilter.get();
+    }
+
     /**
      * Sets the sample size to 'n' and the maximum number of measurements in a bucket to be
      * 'bucketMaxCount'. Calling this method implicitly changes the behavior from having the stage
@@ -202,9 +223,32 @@ public:
 private:
     GetNextResult doGetNext() final;
 
+    bool matchesEventFilter(const BSONElement& timeElem) const {
+        return !_eventFilter || _bucketMatchesWholly ||
+            _eventFilter->matchesSingleElement(timeElem);
+    }
+
     BucketUnpacker _bucketUnpacker;
     int _bucketMaxSpanSeconds;
 
+    // Measurements decoded from the current bucket that have not been returned yet, and the
+    // position of the next one to return.
+    BucketUnpacker::MeasurementBatch _measurementBatch;
+    size_t _measurementBatchPos = 0;
+
+    // The number of measurements of the current bucket that are returned as empty documents
+    // without being unpacked, because the rest of the pipeline does not depend on any field.
+    int32_t _emptyMeasurementsRemaining = 0;
+
+    // A filter on the time field absorbed from a $match following this stage, and a predicate on
+    // the control fields which proves that every measurement of a bucket passes '_eventFilter'.
+    BSONObj _eventFilterBson;
+    std::unique_ptr<MatchExpression> _eventFilter;
+    std::unique_ptr<MatchExpression> _wholeBucketFilter;
+
+    // Whether the bucket being unpacked matches '_wholeBucketFilter'.
+    bool _bucketMatchesWholly = false;
+
     int _bucketMaxCount = 0;
     boost::optional<long long> _sampleSize;
 
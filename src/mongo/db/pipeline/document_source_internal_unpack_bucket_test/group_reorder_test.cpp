@@ -126,5 +126,39 @@ TEST_F(InternalUnpackBucketGroupReorder, MinMaxGroupOnMetadataNegative1) {
     ASSERT_BSONOBJ_EQ(groupSpecObj, serialized[1]);
 }
 
+TEST_F(InternalUnpackBucketGroupReorder, MinMaxGroupOnConstantId) {
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: { include: ['a', 'b', 'c'], metaField: 'meta1', timeField: 't', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto groupSpecObj =
+        fromjson("{$group: {_id: null, accmin: {$min: '$b'}, accmax: {$max: '$c'}}}");
+
+    auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(1, serialized.size());
+
+    auto optimized = fromjson(
+        "{$group: {_id: {$const: null}, accmin: {$min: '$control.min.b'}, accmax: {$max: "
+        "'$control.max.c'}}}");
+    ASSERT_BSONOBJ_EQ(optimized, serialized[0]);
+}
+
+TEST_F(InternalUnpackBucketGroupReorder, MinMaxGroupOnComputedArgumentNegative) {
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: { include: ['a', 'b', 'c'], timeField: 't', metaField: 'meta', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto groupSpecObj = fromjson("{$group: {_id: '$meta', accmin: {$min: {$add: ['$b', 1]}}}}");
+
+    auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    // The argument of $min is not a single field, so it cannot be read from the control fields.
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(2, serialized.size());
+    ASSERT_BSONOBJ_EQ(unpackSpecObj, serialized[0]);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -65,6 +65,42 @@ TEST_F(OptimizePipeline, MixedMatchPushedDown) {
     ASSERT_BSONOBJ_EQ(fromjson("{$match: {a: {$lte: 4}}}"), stages[2].getDocument().toBson());
 }
 
+TEST_F(OptimizePipeline, TimeMatchAbsorbedAsEventFilter) {
+    auto unpack = fromjson(
+        "{$_internalUnpackBucket: { exclude: [], timeField: 'time', metaField: 'myMeta', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto match = fromjson("{$match: {time: {$gte: {$date: '2021-07-01T00:00:00Z'}}}}");
+    auto pipeline = Pipeline::parse(makeVector(unpack, match), getExpCtx());
+    ASSERT_EQ(2u, pipeline->getSources().size());
+
+    pipeline->optimizePipeline();
+
+    // The predicates on the control field are still pushed down, and the $match itself becomes the
+    // event filter of $_internalUnpackBucket.
+    auto stages = pipeline->writeExplainOps(ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_EQ(2u, stages.size());
+    ASSERT_EQ(stages[0].getDocument().toBson().firstElementFieldNameStringData(), "$match"_sd);
+    ASSERT_BSONOBJ_EQ(fromjson("{$_internalUnpackBucket: { exclude: [], timeField: 'time', "
+                               "metaField: 'myMeta', bucketMaxSpanSeconds: 3600, eventFilter: "
+                               "{time: {$gte: {$date: '2021-07-01T00:00:00Z'}}}}}"),
+                      stages[1].getDocument().toBson());
+}
+
+TEST_F(OptimizePipeline, MatchOnTimeAndOtherFieldNotAbsorbed) {
+    auto unpack = fromjson(
+        "{$_internalUnpackBucket: { exclude: [], timeField: 'time', metaField: 'myMeta', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto match = fromjson("{$match: {time: {$gte: {$date: '2021-07-01T00:00:00Z'}}, a: 1}}");
+    auto pipeline = Pipeline::parse(makeVector(unpack, match), getExpCtx());
+
+    pipeline->optimizePipeline();
+
+    // Not every measurement has the field 'a', so the $match cannot be decided per bucket.
+    auto stages = pipeline->writeExplainOps(ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_EQ(3u, stages.size());
+    ASSERT_BSONOBJ_EQ(unpack, stages[1].getDocument().toBson());
+}
+
 TEST_F(OptimizePipeline, MetaMatchPushedDown) {
     auto unpack = fromjson(
         "{$_internalUnpackBucket: { exclude: [], timeField: 'foo', metaField: 'myMeta', "
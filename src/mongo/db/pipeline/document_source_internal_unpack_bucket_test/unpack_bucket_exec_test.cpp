@@ -90,6 +90,78 @@ TEST_F(InternalUnpackBucketExecTest, UnpackBasicIncludeAllMeasurementFields) {
     ASSERT_TRUE(next.isEOF());
 }
 
+// Produces two buckets for a filter on time >= 00:00:01. The first one matches the filter as a
+// whole according to its control fields, the second one only partially.
+auto makeEventFilterBucketSource(const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return DocumentSourceMock::createForTest(
+        {"{control: {min: {time: {$date: '2021-07-01T00:00:01Z'}}, max: {time: {$date: "
+         "'2021-07-01T00:00:03Z'}}}, data: {time: {'0': {$date: '2021-07-01T00:00:01Z'}, '1': "
+         "{$date: '2021-07-01T00:00:02Z'}, '2': {$date: '2021-07-01T00:00:03Z'}}, a: {'0': 1, "
+         "'1': 2, '2': 3}}}",
+         "{control: {min: {time: {$date: '2021-07-01T00:00:00Z'}}, max: {time: {$date: "
+         "'2021-07-01T00:00:02Z'}}}, data: {time: {'0': {$date: '2021-07-01T00:00:00Z'}, '1': "
+         "{$date: '2021-07-01T00:00:02Z'}}, a: {'0': 4, '1': 5}}}"},
+        expCtx);
+}
+
+TEST_F(InternalUnpackBucketExecTest, UnpackWithEventFilter) {
+    auto expCtx = getExpCtx();
+    auto spec = fromjson(
+        "{$_internalUnpackBucket: {include: ['a'], timeField: 'time', bucketMaxSpanSeconds: 3600, "
+        "eventFilter: {time: {$gte: {$date: '2021-07-01T00:00:01Z'}}}}}");
+    auto unpack =
+        DocumentSourceInternalUnpackBucket::createFromBsonInternal(spec.firstElement(), expCtx);
+    auto source = makeEventFilterBucketSource(expCtx);
+    unpack->setSource(source.get());
+
+    for (auto a : {1, 2, 3, 5}) {
+        auto next = unpack->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.getDocument(), Document(BSON("a" << a)));
+    }
+    ASSERT_TRUE(unpack->getNext().isEOF());
+}
+
+TEST_F(InternalUnpackBucketExecTest, UnpackEmptyMeasurementsWithEventFilter) {
+    auto expCtx = getExpCtx();
+    auto spec = fromjson(
+        "{$_internalUnpackBucket: {include: [], timeField: 'time', bucketMaxSpanSeconds: 3600, "
+        "eventFilter: {time: {$gte: {$date: '2021-07-01T00:00:01Z'}}}}}");
+    auto unpack =
+        DocumentSourceInternalUnpackBucket::createFromBsonInternal(spec.firstElement(), expCtx);
+    auto source = makeEventFilterBucketSource(expCtx);
+    unpack->setSource(source.get());
+
+    // All measurements of the first bucket and one of the second bucket pass the filter.
+    for (auto i = 0; i < 4; ++i) {
+        auto next = unpack->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(next.getDocument(), Document());
+    }
+    ASSERT_TRUE(unpack->getNext().isEOF());
+}
+
+TEST_F(InternalUnpackBucketExecTest, ParserRoundtripsEventFilter) {
+    auto bson = fromjson(
+        "{$_internalUnpackBucket: {exclude: [], timeField: 'time', metaField: 'meta', "
+        "bucketMaxSpanSeconds: 3600, eventFilter: {time: {$lt: {$date: "
+        "'2021-07-01T00:00:01Z'}}}}}");
+    auto array = std::vector<Value>{};
+    DocumentSourceInternalUnpackBucket::createFromBsonInternal(bson.firstElement(), getExpCtx())
+        ->serializeToArray(array);
+    ASSERT_BSONOBJ_EQ(array[0].getDocument().toBson(), bson);
+}
+
+TEST_F(InternalUnpackBucketExecTest, ParserRejectsEventFilterOnOtherFields) {
+    ASSERT_THROWS_CODE(DocumentSourceInternalUnpackBucket::createFromBsonInternal(
+                           fromjson("{$_internalUnpackBucket: {exclude: [], timeField: 'time', "
+                                    "bucketMaxSpanSeconds: 3600, eventFilter: {a: {$gt: 1}}}}")
+                               .firstElement(),
+                           getExpCtx()),
+                       AssertionException,
+                       6179036);
+}
+
 TEST_F(InternalUnpackBucketExecTest, UnpackIncludeBucketIdRowIndexInvalidRowIndex) {
     auto expCtx = getExpCtx();
 
@@ -144,6 +144,43 @@ bool checkModifiedPathsSortReorder(const SortPattern& sortPattern,
     return true;
 }
 
+/**
+ * Returns whether a local value can be looked up in a hash table of the foreign values. Such a
+ * value matches exactly the foreign values comparing equal to it. Unlike e.g. null, which also
+ * matches missing foreign fields, or a regular expression, which has to be queried for.
+ */
+bool isHashJoinable(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::EOO:
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::RegEx:
+        case BSONType::Array:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Returns the values of 'doc' at 'path' to join on, or boost::none if any of them is not hashable.
+ */
+boost::optional<std::vector<Value>> getHashJoinableValues(const Document& doc,
+                                                          const FieldPath& path) {
+    std::vector<Value> values;
+    bool hashJoinable = true;
+    document_path_support::visitAllValuesAtPath(doc, path, [&](const Value& value) {
+        hashJoinable = hashJoinable && isHashJoinable(value);
+        values.push_back(value);
+    });
+
+    // A missing local value is joined on as null.
+    if (!hashJoinable || values.empty()) {
+        return boost::none;
+    }
+    return values;
+}
+
 }  // namespace
 
 DocumentSourceLookUp::DocumentSourceLookUp(
@@ -358,6 +395,14 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
+    if (_joinStrategy == JoinStrategy::kHashJoin) {
+        if (auto results = probeHashTable(inputDoc)) {
+            MutableDocument output(std::move(inputDoc));
+            output.setNestedField(_as, Value(std::move(*results)));
+            return output.freeze();
+        }
+    }
+
     if (hasLocalFieldForeignFieldJoin()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -400,11 +445,147 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     }
 
     recordPlanSummaryStats(*pipeline);
+
+    if (_joinStrategy == JoinStrategy::kUndecided) {
+        if (!canUseHashJoin()) {
+            _joinStrategy = JoinStrategy::kNestedLoop;
+        } else if (getHashJoinableValues(inputDoc, *_localField)) {
+            chooseJoinStrategy(*pipeline);
+        }
+    }
+
     MutableDocument output(std::move(inputDoc));
     output.setNestedField(_as, Value(std::move(results)));
     return output.freeze();
 }
 
+StringData DocumentSourceLookUp::joinStrategyToString(JoinStrategy strategy) {
+    switch (strategy) {
+        case JoinStrategy::kUndecided:
+            return "undecided"_sd;
+        case JoinStrategy::kNestedLoop:
+            return "nestedLoopJoin"_sd;
+        case JoinStrategy::kHashJoin:
+            return "hashJoin"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+bool DocumentSourceLookUp::canUseHashJoin() const {
+    // A sub-pipeline may refer to the input document through 'let' variables, and an absorbed
+    // $unwind consumes the foreign documents as a stream.
+    if (!hasLocalFieldForeignFieldJoin() || hasPipeline() || _unwindSrc ||
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load() == 0) {
+        return false;
+    }
+
+    // A query treats numeric path components both as array positions and as field names, which
+    // the values collected from the foreign documents would not account for.
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (str::parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DocumentSourceLookUp::chooseJoinStrategy(const Pipeline& pipeline) {
+    PlanSummaryStats stats;
+    for (auto&& source : pipeline.getSources()) {
+        if (auto specificStats = source->getSpecificStats()) {
+            specificStats->accumulate(stats);
+        }
+    }
+
+    // Querying through an index only reads the matching foreign documents, whereas a collection
+    // scan reads all of them for every input document.
+    const bool scannedForeignCollection = stats.collectionScans > 0 && stats.indexesUsed.empty();
+    _joinStrategy = scannedForeignCollection && buildHashTable() ? JoinStrategy::kHashJoin
+                                                                 : JoinStrategy::kNestedLoop;
+}
+
+bool DocumentSourceLookUp::buildHashTable() {
+    // Read all foreign documents by matching on an empty filter.
+    _resolvedPipeline[*_fieldMatchPipelineIdx] = BSON("$match" << BSONObj());
+    auto pipeline = buildPipeline(Document());
+
+    const auto maxBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    long long memUsageBytes = 0;
+    auto hashTable = _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<Document> foreignDocs;
+    while (auto result = pipeline->getNext()) {
+        const auto position = foreignDocs.size();
+        bool hashed = false;
+        document_path_support::visitAllValuesAtPath(
+            *result, *_foreignField, [&](const Value& value) {
+                if (!isHashJoinable(value)) {
+                    return;
+                }
+                auto& positions = hashTable[value];
+                if (positions.empty() || positions.back() != position) {
+                    positions.push_back(position);
+                    memUsageBytes += value.getApproximateSize() + sizeof(position);
+                }
+                hashed = true;
+            });
+
+        // A document without hashable values is only matched by input documents which are not
+        // looked up in the hash table.
+        if (!hashed) {
+            continue;
+        }
+
+        memUsageBytes += result->getApproximateSize();
+        if (memUsageBytes > maxBytes) {
+            recordPlanSummaryStats(*pipeline);
+            return false;
+        }
+        foreignDocs.push_back(std::move(*result));
+    }
+
+    recordPlanSummaryStats(*pipeline);
+    _hashJoinForeignDocs = std::move(foreignDocs);
+    _hashTable.emplace(std::move(hashTable));
+    return true;
+}
+
+boost::optional<std::vector<Value>> DocumentSourceLookUp::probeHashTable(
+    const Document& inputDoc) const {
+    auto localValues = getHashJoinableValues(inputDoc, *_localField);
+    if (!localValues) {
+        return boost::none;
+    }
+
+    std::vector<size_t> positions;
+    for (auto&& value : *localValues) {
+        if (auto it = _hashTable->find(value); it != _hashTable->end()) {
+            positions.insert(positions.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    // A foreign document matching several local values is returned once, in the order the foreign
+    // collection returned it.
+    if (localValues->size() > 1) {
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    }
+
+    std::vector<Value> results;
+    long long objsize = 0;
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    for (auto position : positions) {
+        const auto& foreignDoc = _hashJoinForeignDocs[position];
+        objsize += foreignDoc.getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline's $lookup stage exceeds " << maxBytes
+                              << " bytes",
+                objsize <= maxBytes);
+        results.emplace_back(foreignDoc);
+    }
+    return results;
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -642,6 +823,8 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashTable.reset();
+    _hashJoinForeignDocs.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -832,6 +1015,9 @@ void DocumentSourceLookUp::appendSpecificExecStats(MutableDocument& doc) const {
                    std::back_inserter(indexesUsedVec),
                    [](std::string idx) -> Value { return Value(idx); });
     doc["indexesUsed"] = Value{std::move(indexesUsedVec)};
+    if (hasLocalFieldForeignFieldJoin()) {
+        doc["joinStrategy"] = Value(joinStrategyToString(_joinStrategy));
+    }
 }
 
 void DocumentSourceLookUp::serializeToArrayWithBothSyntaxes(
@@ -45,6 +45,14 @@ namespace mongo {
 /**
  * Queries separate collection for equality matches with documents in the pipeline collection.
  * Adds matching documents to a new array field in the input document.
+ *
+ * A $lookup specified with only localField/foreignField picks its join strategy from the plan the
+ * query planner chose for the first input document. If the foreign side could be answered through
+ * an index, the foreign collection keeps being queried per input document (an indexed nested loop
+ * join). If it took a collection scan, the foreign collection is read once into a hash table keyed
+ * by the values of 'foreignField', which the following input documents probe (a hash join). Input
+ * documents whose local values do not have plain equality semantics (e.g. null, missing, regular
+ * expressions) are still answered by querying the foreign collection.
  */
 class DocumentSourceLookUp final : public DocumentSource {
 public:
@@ -269,8 +277,44 @@ private:
         MONGO_UNREACHABLE;
     }
 
+    enum class JoinStrategy {
+        // No strategy has been picked yet, the foreign collection is queried per input document.
+        kUndecided,
+        // The foreign collection is queried per input document, possibly through an index.
+        kNestedLoop,
+        // The foreign documents are read once into '_hashTable'.
+        kHashJoin,
+    };
+
+    static StringData joinStrategyToString(JoinStrategy strategy);
+
     GetNextResult unwindResult();
 
+    /**
+     * Whether the hash join strategy could produce the same results as querying the foreign
+     * collection per input document for this stage.
+     */
+    bool canUseHashJoin() const;
+
+    /**
+     * Picks the join strategy once 'pipeline', built for an input document with only hashable
+     * local values, has been exhausted. Uses a hash join if the query planner had to resort to a
+     * collection scan for the foreign side and the foreign collection fits in memory.
+     */
+    void chooseJoinStrategy(const Pipeline& pipeline);
+
+    /**
+     * Reads the foreign collection into '_hashTable'. Returns false, leaving '_hashTable' empty, if
+     * it exceeds 'internalDocumentSourceLookupHashJoinMaxMemoryBytes'.
+     */
+    bool buildHashTable();
+
+    /**
+     * Returns the foreign documents matching 'inputDoc' from '_hashTable', or boost::none if any
+     * of its local values cannot be looked up by hash.
+     */
+    boost::optional<std::vector<Value>> probeHashTable(const Document& inputDoc) const;
+
     /**
      * Resolves let defined variables against 'localDoc' and stores the results in 'variables'.
      */
@@ -366,6 +410,14 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    JoinStrategy _joinStrategy = JoinStrategy::kUndecided;
+
+    // For the hash join strategy, the foreign documents with a hashable value at 'foreignField' in
+    // the order the foreign collection returned them, and a map from each such value to the
+    // positions of the documents holding it.
+    std::vector<Document> _hashJoinForeignDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _hashTable;
 };
 
 }  // namespace mongo
@@ -50,6 +50,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -948,6 +949,167 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+/**
+ * A mock foreign collection which reports a collection scan, as a cursor over a foreign collection
+ * without an index on 'foreignField' does.
+ */
+class DocumentSourceMockCollectionScan final : public DocumentSourceMock {
+public:
+    DocumentSourceMockCollectionScan(deque<GetNextResult> results,
+                                     const boost::intrusive_ptr<ExpressionContext>& expCtx)
+        : DocumentSourceMock(std::move(results), expCtx) {
+        _stats.planSummaryStats.collectionScans = 1;
+    }
+
+    const SpecificStats* getSpecificStats() const final {
+        return &_stats;
+    }
+
+private:
+    DocumentSourceLookupStats _stats;
+};
+
+class MockCollectionScanMongoInterface final : public StubMongoProcessInterface {
+public:
+    MockCollectionScanMongoInterface(deque<DocumentSource::GetNextResult> mockResults)
+        : _mockResults(std::move(mockResults)) {}
+
+    bool isSharded(OperationContext* opCtx, const NamespaceString& ns) final {
+        return false;
+    }
+
+    std::unique_ptr<Pipeline, PipelineDeleter> attachCursorSourceToPipeline(
+        Pipeline* ownedPipeline,
+        ShardTargetingPolicy shardTargetingPolicy = ShardTargetingPolicy::kAllowed,
+        boost::optional<BSONObj> readConcern = boost::none) final {
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline(
+            ownedPipeline, PipelineDeleter(ownedPipeline->getContext()->opCtx));
+        pipeline->addInitialSource(
+            make_intrusive<DocumentSourceMockCollectionScan>(_mockResults, pipeline->getContext()));
+        ++numPipelinesAttached;
+        return pipeline;
+    }
+
+    int numPipelinesAttached = 0;
+
+private:
+    deque<DocumentSource::GetNextResult> _mockResults;
+};
+
+TEST_F(DocumentSourceLookUpTest, ShouldSwitchToHashJoinAfterForeignCollectionScan) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"key", 1}},
+        Document{{"_id", 1}, {"key", 2}},
+        Document{{"_id", 2}, {"key", Value(vector<Value>{Value(1), Value(3)})}},
+        Document{{"_id", 3}, {"key", BSONNULL}},
+        Document{{"_id", 4}}};
+    auto mongoInterface =
+        std::make_shared<MockCollectionScanMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "local"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest(
+        {Document{{"local", 2}},
+         Document{{"local", 1.0}},
+         Document{{"local", Value(vector<Value>{Value(3), Value(1), Value(4)})}},
+         Document{{"local", 5}},
+         Document{{"local", BSONNULL}}},
+        expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    // The first input document is looked up with a query, which reports a collection scan.
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"],
+                    Value(vector<Value>{Value(Document{{"_id", 1}, {"key", 2}})}));
+    ASSERT_EQ(mongoInterface->numPipelinesAttached, 2);
+
+    // The following ones are answered from the hash table built from the foreign collection.
+    const auto expectedMatchesForOne = Value(vector<Value>{
+        Value(Document{{"_id", 0}, {"key", 1}}),
+        Value(Document{{"_id", 2}, {"key", Value(vector<Value>{Value(1), Value(3)})}})});
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"], expectedMatchesForOne);
+
+    // A foreign document matching several local values is returned once.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"], expectedMatchesForOne);
+
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"], Value(vector<Value>{}));
+    ASSERT_EQ(mongoInterface->numPipelinesAttached, 2);
+
+    // A null local value also matches missing foreign fields, so it is still looked up with a
+    // query.
+    next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"],
+                    Value(vector<Value>{Value(Document{{"_id", 3}, {"key", BSONNULL}}),
+                                        Value(Document{{"_id", 4}})}));
+    ASSERT_EQ(mongoInterface->numPipelinesAttached, 3);
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
+TEST_F(DocumentSourceLookUpTest, ShouldKeepQueryingForeignCollectionIfItExceedsHashJoinMemory) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    auto maxMemory = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(maxMemory); });
+
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}, {"key", 0}},
+                                                             Document{{"_id", 1}, {"key", 1}}};
+    auto mongoInterface =
+        std::make_shared<MockCollectionScanMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "local"_sd},
+                                         {"foreignField", "key"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::createForTest(
+        {Document{{"local", 0}}, Document{{"local", 1}}, Document{{"local", 1}}}, expCtx);
+    lookup->setSource(mockLocalSource.get());
+
+    for (int key : {0, 1, 1}) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.releaseDocument()["foreignDocs"],
+                        Value(vector<Value>{Value(Document{{"_id", key}, {"key", key}})}));
+    }
+    // One query per input document, plus the abandoned attempt to build the hash table.
+    ASSERT_EQ(mongoInterface->numPipelinesAttached, 4);
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
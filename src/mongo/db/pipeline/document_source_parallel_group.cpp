@@ -0,0 +1,272 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+
+#include <algorithm>
+#include <set>
+
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+Counter64 parallelExecutionsCounter;
+ServerStatusMetricField<Counter64> parallelExecutionsMetric("query.group.parallelExecutions",
+                                                            &parallelExecutionsCounter);
+
+/**
+ * Returns true if every accumulator of 'group' produces the same result no matter how its input is
+ * split into partial groups and in which order those are merged.
+ */
+bool hasOnlyOrderInsensitiveAccumulators(const DocumentSourceGroup& group) {
+    static const std::set<StringData> kOrderInsensitiveAccumulators{
+        "$sum"_sd,
+        "$avg"_sd,
+        "$min"_sd,
+        "$max"_sd,
+        "$addToSet"_sd,
+        "$stdDevPop"_sd,
+        "$stdDevSamp"_sd};
+
+    const auto& accumulators = group.getAccumulatedFields();
+    return std::all_of(accumulators.begin(), accumulators.end(), [](const auto& accumulator) {
+        return kOrderInsensitiveAccumulators.count(accumulator.expr.name);
+    });
+}
+
+/**
+ * Returns a copy of 'expCtx' which can be used by a pipeline running on another thread.
+ */
+boost::intrusive_ptr<ExpressionContext> copyExpCtxForThread(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return expCtx->copyWith(expCtx->ns,
+                            expCtx->uuid,
+                            expCtx->getCollator() ? expCtx->getCollator()->clone() : nullptr);
+}
+}  // namespace
+
+void DocumentSourceParallelGroup::parallelizeGroupIfPossible(Pipeline* pipeline) {
+    const auto parallelism = internalDocumentSourceGroupParallelism.load();
+    const auto& expCtx = pipeline->getContext();
+    auto& sources = pipeline->getSources();
+    if (parallelism <= 1 || sources.size() < 2 || expCtx->explain || expCtx->needsMerge ||
+        expCtx->tailableMode != TailableModeEnum::kNormal ||
+        expCtx->opCtx->inMultiDocumentTransaction()) {
+        return;
+    }
+
+    auto inputCursor = dynamic_cast<DocumentSourceCursor*>(sources.front().get());
+    auto group = dynamic_cast<DocumentSourceGroup*>(std::next(sources.begin())->get());
+    if (!inputCursor || !group || group->doingMerge() ||
+        !hasOnlyOrderInsensitiveAccumulators(*group)) {
+        return;
+    }
+
+    // The partial groups of all consumers but the first run on the query worker pool. The $group
+    // stays on the calling thread if the pool is too busy to give it all of them.
+    auto workerThreads = QueryWorkerPool::tryReserve(parallelism - 1);
+    if (!workerThreads) {
+        return;
+    }
+
+    // Only the calling thread reads from the $cursor, so that all storage access stays on its
+    // operation context. The Exchange detaches its input from the operation context, hence the
+    // input gets an ExpressionContext of its own.
+    boost::intrusive_ptr<DocumentSourceCursor> cursorStage = inputCursor;
+    pipeline->popFront();
+    auto input = Pipeline::create({cursorStage}, copyExpCtxForThread(expCtx));
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kRoundRobin);
+    spec.setConsumers(parallelism);
+    boost::intrusive_ptr<Exchange> exchange =
+        new Exchange(std::move(spec), std::move(input), 0 /* loadingConsumerId */);
+
+    // Every consumer computes partial groups over its share of the input under an
+    // ExpressionContext of its own, as the context cannot be shared between threads. Together they
+    // get the memory budget of the $group they replace.
+    const auto groupSpec = group->serialize().getDocument().toBson();
+    const auto maxMemoryUsageBytes = group->getMaxMemoryUsageBytes() / parallelism;
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> partialGroups;
+    for (int idx = 0; idx < parallelism; ++idx) {
+        auto partialExpCtx = copyExpCtxForThread(expCtx);
+        partialExpCtx->needsMerge = true;
+
+        boost::intrusive_ptr<DocumentSource> consumer = new DocumentSourceExchange(
+            partialExpCtx,
+            exchange,
+            idx,
+            idx == 0 ? partialExpCtx->mongoProcessInterface->getResourceYielder() : nullptr);
+        auto partialGroup = DocumentSourceGroup::createFromBsonWithMaxMemoryUsage(
+            groupSpec.firstElement(), partialExpCtx, maxMemoryUsageBytes);
+
+        partialGroups.emplace_back(Pipeline::create({consumer, partialGroup}, partialExpCtx));
+        partialGroups.back().get_deleter().dismissDisposal();
+    }
+
+    auto mergingGroup = group->distributedPlanLogic()->mergingStage;
+    pipeline->popFront();
+    pipeline->addInitialSource(std::move(mergingGroup));
+    pipeline->addInitialSource(new DocumentSourceParallelGroup(expCtx,
+                                                               std::move(cursorStage),
+                                                               std::move(partialGroups),
+                                                               std::move(*workerThreads)));
+}
+
+DocumentSourceParallelGroup::DocumentSourceParallelGroup(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    boost::intrusive_ptr<DocumentSourceCursor> inputCursor,
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> partialGroups,
+    QueryWorkerPool::Reservation workerThreads)
+    : DocumentSource(kStageName, expCtx),
+      _inputCursor(std::move(inputCursor)),
+      _partialGroups(std::move(partialGroups)),
+      _partialResults(_partialGroups.size()),
+      _workerThreads(std::move(workerThreads)) {}
+
+const char* DocumentSourceParallelGroup::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceParallelGroup::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    std::vector<Value> input;
+    _inputCursor->serializeToArray(input, explain);
+
+    std::vector<Value> partialGroups;
+    for (auto&& partialGroup : _partialGroups) {
+        partialGroup->getSources().back()->serializeToArray(partialGroups, explain);
+    }
+    return Value(
+        DOC(getSourceName() << DOC("input" << input << "partialGroups" << partialGroups)));
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelGroup::doGetNext() {
+    if (!_executed) {
+        execute();
+        _executed = true;
+    }
+
+    for (; _currentPipeline < _partialResults.size(); ++_currentPipeline, _currentResult = 0) {
+        auto& results = _partialResults[_currentPipeline];
+        if (_currentResult < results.size()) {
+            return std::move(results[_currentResult++]);
+        }
+        results.clear();
+    }
+
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceParallelGroup::execute() {
+    for (size_t idx = 1; idx < _partialGroups.size(); ++idx) {
+        auto pf = makePromiseFuture<void>();
+        auto pipeline = _partialGroups[idx].get();
+        auto results = &_partialResults[idx];
+        pipeline->detachFromOperationContext();
+
+        _workerThreads->schedule(
+            [pipeline, results, promise = std::move(pf.promise)](auto status) mutable {
+                invariant(status);
+
+                auto opCtx = cc().makeOperationContext();
+                promise.setWith([&] {
+                    pipeline->reattachToOperationContext(opCtx.get());
+                    ON_BLOCK_EXIT([&] {
+                        pipeline->dispose(opCtx.get());
+                        pipeline->detachFromOperationContext();
+                    });
+
+                    while (auto next = pipeline->getNext()) {
+                        results->push_back(std::move(*next));
+                    }
+                });
+            });
+        _workers.emplace_back(std::move(pf.future));
+    }
+    _workersScheduled = true;
+    parallelExecutionsCounter.increment();
+
+    // The first consumer is the one loading the Exchange, so this thread ends up reading the whole
+    // input while computing its own share of the partial groups. Once it is exhausted so is the
+    // input, and the workers only have their buffers left to drain.
+    auto& localGroup = _partialGroups.front();
+    localGroup->reattachToOperationContext(pExpCtx->opCtx);
+    while (auto next = localGroup->getNext()) {
+        _partialResults.front().push_back(std::move(*next));
+    }
+    uassertStatusOK(waitForWorkers());
+
+    _usedDisk = std::any_of(_partialGroups.begin(),
+                            _partialGroups.end(),
+                            [](const auto& partialGroup) { return partialGroup->usedDisk(); });
+
+    localGroup->dispose(pExpCtx->opCtx);
+    _localDisposed = true;
+}
+
+Status DocumentSourceParallelGroup::waitForWorkers() {
+    Status status = Status::OK();
+    for (auto&& worker : _workers) {
+        auto workerStatus = std::move(worker).getNoThrow();
+        if (status.isOK()) {
+            status = std::move(workerStatus);
+        }
+    }
+    _workers.clear();
+
+    // The partial groups are only ever run once.
+    _workerThreads.reset();
+    return status;
+}
+
+void DocumentSourceParallelGroup::doDispose() {
+    // Disposing of the loading consumer first wakes up any worker still waiting for it to load.
+    if (!_localDisposed) {
+        _partialGroups.front()->dispose(pExpCtx->opCtx);
+        _localDisposed = true;
+    }
+
+    if (_workersScheduled) {
+        waitForWorkers().ignore();
+    } else if (!_workersDisposed) {
+        for (size_t idx = 1; idx < _partialGroups.size(); ++idx) {
+            _partialGroups[idx]->dispose(pExpCtx->opCtx);
+        }
+        _workersDisposed = true;
+    }
+}
+
+}  // namespace mongo
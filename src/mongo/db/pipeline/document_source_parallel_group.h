@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/util/future.h"
+
+namespace mongo {
+
+/**
+ * Computes a $group which reads directly from a $cursor on several threads at once. The $cursor is
+ * the input of an Exchange which deals its documents out round robin to a number of partial
+ * $group pipelines. The partial pipeline of the first consumer runs on the calling thread, which is
+ * also the only one ever to read from the $cursor, and the rest run on the query worker pool. Once
+ * all of them are exhausted this stage returns their partial results, which are expected to be
+ * combined by a merging $group stage following it. The partial groups share the memory budget of
+ * the $group they replace, and every run is counted by the query.group.parallelExecutions metric.
+ *
+ * This stage is never parsed; it is only created by the rewrite in parallelizeGroupIfPossible().
+ */
+class DocumentSourceParallelGroup final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelGroup"_sd;
+
+    /**
+     * Replaces a leading [$cursor, $group] pair of 'pipeline' by [$_internalParallelGroup, merging
+     * $group] if internalDocumentSourceGroupParallelism allows more than one thread, the query
+     * worker pool has enough threads left and the $group only uses accumulators whose result does
+     * not depend on the order of their input. Otherwise leaves 'pipeline' untouched.
+     */
+    static void parallelizeGroupIfPossible(Pipeline* pipeline);
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kBlocking,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kWritesTmpData,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     UnionRequirement::kNotAllowed);
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    bool usedDisk() final {
+        return _usedDisk;
+    }
+
+    /**
+     * Returns the $cursor stage feeding the partial groups, so that plan summaries can be reported
+     * as if it were still at the front of the pipeline.
+     */
+    DocumentSourceCursor* getInputCursor() const {
+        return _inputCursor.get();
+    }
+
+protected:
+    void doDispose() final;
+
+private:
+    DocumentSourceParallelGroup(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        boost::intrusive_ptr<DocumentSourceCursor> inputCursor,
+        std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> partialGroups,
+        QueryWorkerPool::Reservation workerThreads);
+
+    GetNextResult doGetNext() final;
+
+    /**
+     * Runs all partial group pipelines to completion, collecting their results.
+     */
+    void execute();
+
+    /**
+     * Waits for all partial group pipelines scheduled on the worker threads, then gives the threads
+     * back to the pool. Returns the first error any of them hit.
+     */
+    Status waitForWorkers();
+
+    // Owned by the input pipeline of the Exchange; kept to report the plan summary.
+    boost::intrusive_ptr<DocumentSourceCursor> _inputCursor;
+
+    // One pipeline per Exchange consumer. The first is run by the thread executing this stage, the
+    // rest on '_workerThreads'. Each of them is disposed of by the thread which runs it.
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> _partialGroups;
+
+    // The documents produced by each of '_partialGroups'.
+    std::vector<std::vector<Document>> _partialResults;
+
+    // Reserved from the query worker pool until the partial groups have run.
+    boost::optional<QueryWorkerPool::Reservation> _workerThreads;
+
+    std::vector<Future<void>> _workers;
+
+    bool _executed = false;
+    bool _workersScheduled = false;
+    bool _workersDisposed = false;
+    bool _localDisposed = false;
+    bool _usedDisk = false;
+    size_t _currentPipeline = 0;
+    size_t _currentResult = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,170 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_query_stats.h"
+#include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Subclass AggregationContextFixture to set the ExpressionContext's namespace to 'admin' with
+ * {aggregate: 1} by default, as $queryStats may only be run against it.
+ */
+class DocumentSourceQueryStatsTest : public AggregationContextFixture {
+public:
+    DocumentSourceQueryStatsTest()
+        : AggregationContextFixture(NamespaceString::makeCollectionlessAggregateNSS("admin")) {}
+};
+
+/**
+ * A MongoProcessInterface used for testing which returns artificial query shape statistics.
+ */
+class QueryStatsMongoProcessInterface final : public StubMongoProcessInterface {
+public:
+    QueryStatsMongoProcessInterface(std::vector<BSONObj> queryStats)
+        : _queryStats(std::move(queryStats)) {}
+
+    std::vector<BSONObj> getQueryShapeStats(OperationContext* opCtx) const override {
+        return _queryStats;
+    }
+
+    std::string getShardName(OperationContext* opCtx) const override {
+        return "testShardName";
+    }
+
+    std::string getHostAndPort(OperationContext* opCtx) const override {
+        return "testHostName";
+    }
+
+private:
+    std::vector<BSONObj> _queryStats;
+};
+
+TEST_F(DocumentSourceQueryStatsTest, ShouldFailToParseIfSpecIsNotObject) {
+    const auto specObj = fromjson("{$queryStats: 1}");
+    ASSERT_THROWS_CODE(
+        DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx()),
+        AssertionException,
+        ErrorCodes::FailedToParse);
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ShouldFailToParseIfSpecIsANonEmptyObject) {
+    const auto specObj = fromjson("{$queryStats: {unknownOption: 1}}");
+    ASSERT_THROWS_CODE(
+        DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx()),
+        AssertionException,
+        ErrorCodes::FailedToParse);
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ShouldFailToParseIfNotRunOnAdmin) {
+    getExpCtx()->ns = NamespaceString::makeCollectionlessAggregateNSS("foo");
+    const auto specObj = fromjson("{$queryStats: {}}");
+    ASSERT_THROWS_CODE(
+        DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx()),
+        AssertionException,
+        ErrorCodes::InvalidNamespace);
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ShouldFailToParseIfNotRunWithAggregateOne) {
+    getExpCtx()->ns = NamespaceString("admin.foo");
+    const auto specObj = fromjson("{$queryStats: {}}");
+    ASSERT_THROWS_CODE(
+        DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx()),
+        AssertionException,
+        ErrorCodes::InvalidNamespace);
+}
+
+TEST_F(DocumentSourceQueryStatsTest, CanParseAndSerializeSuccessfully) {
+    const auto specObj = fromjson("{$queryStats: {}}");
+    auto stage = DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx());
+    std::vector<Value> serialized;
+    stage->serializeToArray(serialized);
+    ASSERT_EQ(1u, serialized.size());
+    ASSERT_BSONOBJ_EQ(specObj, serialized[0].getDocument().toBson());
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ReturnsImmediateEOFWithEmptyStore) {
+    getExpCtx()->mongoProcessInterface =
+        std::make_shared<QueryStatsMongoProcessInterface>(std::vector<BSONObj>{});
+    const auto specObj = fromjson("{$queryStats: {}}");
+    auto stage = DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx());
+    ASSERT(stage->getNext().isEOF());
+    ASSERT(stage->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ReturnsHostNameWhenNotFromMongos) {
+    std::vector<BSONObj> stats{BSON("ns"
+                                    << "test.foo"),
+                               BSON("ns"
+                                    << "test.bar")};
+    getExpCtx()->mongoProcessInterface = std::make_shared<QueryStatsMongoProcessInterface>(stats);
+
+    const auto specObj = fromjson("{$queryStats: {}}");
+    auto stage = DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx());
+    auto pipeline = Pipeline::create({stage}, getExpCtx());
+    ASSERT_BSONOBJ_EQ(pipeline->getNext()->toBson(),
+                      BSON("ns"
+                           << "test.foo"
+                           << "host"
+                           << "testHostName"));
+    ASSERT_BSONOBJ_EQ(pipeline->getNext()->toBson(),
+                      BSON("ns"
+                           << "test.bar"
+                           << "host"
+                           << "testHostName"));
+    ASSERT(!pipeline->getNext());
+}
+
+TEST_F(DocumentSourceQueryStatsTest, ReturnsShardAndHostNameWhenFromMongos) {
+    std::vector<BSONObj> stats{BSON("ns"
+                                    << "test.foo")};
+    getExpCtx()->mongoProcessInterface = std::make_shared<QueryStatsMongoProcessInterface>(stats);
+    getExpCtx()->fromMongos = true;
+
+    const auto specObj = fromjson("{$queryStats: {}}");
+    auto stage = DocumentSourceQueryStats::createFromBson(specObj.firstElement(), getExpCtx());
+    auto pipeline = Pipeline::create({stage}, getExpCtx());
+    ASSERT_BSONOBJ_EQ(pipeline->getNext()->toBson(),
+                      BSON("ns"
+                           << "test.foo"
+                           << "host"
+                           << "testHostName"
+                           << "shard"
+                           << "testShardName"));
+    ASSERT(!pipeline->getNext());
+}
+
+}  // namespace
+}  // namespace mongo
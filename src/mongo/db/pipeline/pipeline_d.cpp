@@ -434,7 +434,8 @@ std::pair<DocumentSourceSample*, DocumentSourceInternalUnpackBucket*> extractSam
         unpackStage = dynamic_cast<DocumentSourceInternalUnpackBucket*>(sourcesIt->get());
         ++sourcesIt;
 
-        if (unpackStage && sourcesIt != sources.end()) {
+        // Sampling buckets does not apply a filter that was absorbed by the unpack stage.
+        if (unpackStage && !unpackStage->eventFilter() && sourcesIt != sources.end()) {
             sampleStage = dynamic_cast<DocumentSourceSample*>(sourcesIt->get());
             return std::pair{sampleStage, unpackStage};
         }
@@ -33,6 +33,7 @@
 
 #include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/document_source_lookup.h"
+#include "mongo/db/pipeline/document_source_parallel_group.h"
 #include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/document_source_union_with.h"
 #include "mongo/db/pipeline/plan_executor_pipeline.h"
@@ -50,19 +51,31 @@ void collectPlanSummaryStats(const DocSourceType& source, PlanSummaryStats* stat
     statsOut->accumulate(docSpecificStats.planSummaryStats);
 }
 
+namespace {
+/**
+ * Returns the $cursor stage the pipeline reads from, if any. It is either at the front of the
+ * pipeline or is the input of a $group split across threads.
+ */
+DocumentSourceCursor* getDocSourceCursor(const Pipeline& pipeline) {
+    auto front = pipeline.getSources().front().get();
+    if (auto parallelGroup = dynamic_cast<DocumentSourceParallelGroup*>(front)) {
+        return parallelGroup->getInputCursor();
+    }
+    return dynamic_cast<DocumentSourceCursor*>(front);
+}
+}  // namespace
+
 const PlanExplainer::ExplainVersion& PlanExplainerPipeline::getVersion() const {
     static const ExplainVersion kExplainVersion = "1";
 
-    if (auto docSourceCursor =
-            dynamic_cast<DocumentSourceCursor*>(_pipeline->getSources().front().get())) {
+    if (auto docSourceCursor = getDocSourceCursor(*_pipeline)) {
         return docSourceCursor->getExplainVersion();
     }
     return kExplainVersion;
 }
 
 std::string PlanExplainerPipeline::getPlanSummary() const {
-    if (auto docSourceCursor =
-            dynamic_cast<DocumentSourceCursor*>(_pipeline->getSources().front().get())) {
+    if (auto docSourceCursor = getDocSourceCursor(*_pipeline)) {
         return docSourceCursor->getPlanSummaryStr();
     }
 
@@ -72,8 +85,7 @@ std::string PlanExplainerPipeline::getPlanSummary() const {
 void PlanExplainerPipeline::getSummaryStats(PlanSummaryStats* statsOut) const {
     invariant(statsOut);
 
-    if (auto docSourceCursor =
-            dynamic_cast<DocumentSourceCursor*>(_pipeline->getSources().front().get())) {
+    if (auto docSourceCursor = getDocSourceCursor(*_pipeline)) {
         *statsOut = docSourceCursor->getPlanSummaryStats();
     }
 
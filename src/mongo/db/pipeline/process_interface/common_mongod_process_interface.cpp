@@ -54,6 +54,7 @@
 #include "mongo/db/pipeline/pipeline_d.h"
 #include "mongo/db/query/collection_index_usage_tracker_decoration.h"
 #include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/repl/primary_only_service.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
@@ -407,6 +408,17 @@ std::vector<BSONObj> CommonMongodProcessInterface::getMatchingPlanCacheEntryStat
     return planCache->getMatchingStats(serializer, predicate);
 }
 
+std::vector<BSONObj> CommonMongodProcessInterface::getQueryShapeStats(
+    OperationContext* opCtx) const {
+    const auto& queryShapeStats = QueryShapeStats::get(opCtx->getServiceContext());
+    uassert(6179061,
+            "The query shape statistics store is disabled; set the "
+            "'internalQueryShapeStatsMaxEntries' server parameter at startup to enable it",
+            queryShapeStats.isEnabled());
+
+    return queryShapeStats.getStats();
+}
+
 bool CommonMongodProcessInterface::fieldsHaveSupportingUniqueIndex(
     const boost::intrusive_ptr<ExpressionContext>& expCtx,
     const NamespaceString& nss,
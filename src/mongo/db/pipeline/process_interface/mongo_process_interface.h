@@ -394,6 +394,12 @@ public:
                                                                 const NamespaceString&,
                                                                 const MatchExpression*) const = 0;
 
+    /**
+     * Returns a vector of BSON objects, where each entry in the vector describes the execution
+     * statistics of a query shape held by the query shape statistics store of this process.
+     */
+    virtual std::vector<BSONObj> getQueryShapeStats(OperationContext* opCtx) const = 0;
+
     /**
      * Returns true if there is an index on 'nss' with properties that will guarantee that a
      * document with non-array values for each of 'fieldPaths' will have at most one matching
@@ -200,6 +200,14 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    /**
+     * Mongos does not record query shape statistics, so this method should never be called on
+     * mongos. The $queryStats stage is always forwarded to the shards.
+     */
+    std::vector<BSONObj> getQueryShapeStats(OperationContext* opCtx) const final {
+        MONGO_UNREACHABLE;
+    }
+
     bool fieldsHaveSupportingUniqueIndex(const boost::intrusive_ptr<ExpressionContext>&,
                                          const NamespaceString&,
                                          const std::set<FieldPath>& fieldPaths) const;
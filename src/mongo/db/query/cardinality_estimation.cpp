@@ -0,0 +1,193 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cardinality_estimation.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo::cardinality_estimation {
+namespace {
+
+bool isAllValues(const OrderedIntervalList& oil) {
+    return oil.intervals.size() == 1 &&
+        (oil.intervals[0].isMinToMax() || oil.intervals[0].isMaxToMin());
+}
+
+double estimateIntervals(const Histogram& histogram, const OrderedIntervalList& oil) {
+    double estimate = 0;
+    for (auto&& interval : oil.intervals) {
+        estimate += interval.getDirection() == Interval::Direction::kDirectionDescending
+            ? histogram.estimate(interval.reverseClone())
+            : histogram.estimate(interval);
+    }
+    return estimate;
+}
+
+/**
+ * Estimates the cost of a skip scan, which covers all the values of the leading field of the
+ * index and constrains the second one. The scan seeks to each distinct value of the leading field
+ * and then examines the keys within the bounds of the second field.
+ */
+boost::optional<double> estimateSkipScan(const IndexBounds& bounds,
+                                         const Histogram& prefixHistogram,
+                                         const CollectionStatistics& stats) {
+    auto histogram = stats.getHistogram(bounds.fields[1].name);
+    if (!histogram) {
+        return boost::none;
+    }
+    // Each distinct prefix value costs a seek, in addition to the keys within the bounds.
+    return prefixHistogram.estimateDistinctCount() +
+        estimateIntervals(*histogram, bounds.fields[1]);
+}
+
+boost::optional<double> estimateIndexScan(const IndexScanNode& ixn,
+                                          const CollectionStatistics& stats) {
+    const auto& index = ixn.index;
+    if (index.type != INDEX_BTREE || index.collator || index.filterExpr) {
+        return boost::none;
+    }
+
+    auto histogram = stats.getHistogram(index.keyPattern.firstElementFieldNameStringData());
+    if (!histogram) {
+        return boost::none;
+    }
+
+    const auto& bounds = ixn.bounds;
+    if (bounds.isSimpleRange) {
+        BSONObjBuilder bob;
+        bob.appendAs(bounds.startKey.firstElement(), "");
+        bob.appendAs(bounds.endKey.firstElement(), "");
+        Interval interval(bob.obj(),
+                          IndexBounds::isStartIncludedInBound(bounds.boundInclusion),
+                          IndexBounds::isEndIncludedInBound(bounds.boundInclusion));
+        if (interval.getDirection() == Interval::Direction::kDirectionDescending) {
+            interval = interval.reverseClone();
+        }
+        return histogram->estimate(interval);
+    }
+
+    if (bounds.fields.empty()) {
+        return boost::none;
+    }
+
+    if (bounds.fields.size() > 1 && isAllValues(bounds.fields[0]) &&
+        !isAllValues(bounds.fields[1])) {
+        return estimateSkipScan(bounds, *histogram, stats);
+    }
+
+    return estimateIntervals(*histogram, bounds.fields[0]);
+}
+
+}  // namespace
+
+boost::optional<double> estimateCost(const QuerySolutionNode* node,
+                                     const CollectionStatistics& stats) {
+    switch (node->getType()) {
+        case STAGE_IXSCAN:
+            return estimateIndexScan(static_cast<const IndexScanNode&>(*node), stats);
+        case STAGE_COLLSCAN:
+            return stats.getNumRecords();
+        default:
+            break;
+    }
+
+    // Any other leaf, such as a count or distinct scan, is not estimated.
+    if (node->children.empty()) {
+        return boost::none;
+    }
+
+    double cost = 0;
+    for (auto&& child : node->children) {
+        auto childCost = estimateCost(child, stats);
+        if (!childCost) {
+            return boost::none;
+        }
+        cost += *childCost;
+    }
+    return cost;
+}
+
+void rankAndPruneSolutions(const CanonicalQuery& query,
+                           const CollectionStatistics& stats,
+                           std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    const auto& findCommand = query.getFindCommandRequest();
+    if (!findCommand.getSort().isEmpty() || findCommand.getLimit() ||
+        findCommand.getNtoreturn()) {
+        return;
+    }
+
+    std::vector<double> costs;
+    costs.reserve(solutions->size());
+    for (auto&& solution : *solutions) {
+        auto cost = estimateCost(solution->root(), stats);
+        if (!cost) {
+            return;
+        }
+        costs.push_back(*cost);
+    }
+
+    std::vector<size_t> order(solutions->size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return costs[lhs] < costs[rhs];
+    });
+
+    const double minCost = costs[order.front()];
+    const double maxCost =
+        std::max(minCost, 1.0) * internalQueryCardinalityEstimationPruneRatio.load();
+
+    std::vector<std::unique_ptr<QuerySolution>> ranked;
+    for (auto i : order) {
+        if (costs[i] > maxCost) {
+            break;
+        }
+        ranked.push_back(std::move((*solutions)[i]));
+    }
+
+    LOGV2_DEBUG(6179055,
+                2,
+                "Ranked candidate query solutions by estimated cost",
+                "query"_attr = redact(query.toStringShort()),
+                "numSolutions"_attr = solutions->size(),
+                "numPrunedSolutions"_attr = solutions->size() - ranked.size(),
+                "minEstimatedCost"_attr = minCost);
+
+    *solutions = std::move(ranked);
+}
+
+}  // namespace mongo::cardinality_estimation
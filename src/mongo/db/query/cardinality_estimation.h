@@ -0,0 +1,63 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo::cardinality_estimation {
+
+/**
+ * Returns the estimated number of index keys and documents the plan rooted at 'node' examines,
+ * based on the statistics of the collection in 'stats', or boost::none if it cannot be estimated.
+ * Only the leading field of the bounds of an index scan is taken into account, unless it covers
+ * all values and the second field is constrained, in which case the scan is estimated as a skip
+ * scan seeking to each distinct value of the leading field.
+ */
+boost::optional<double> estimateCost(const QuerySolutionNode* node,
+                                     const CollectionStatistics& stats);
+
+/**
+ * Orders the candidate 'solutions' for 'query' by increasing estimated cost, so that the cheapest
+ * one wins ties during plan ranking, and drops the ones whose cost exceeds that of the cheapest
+ * one by more than internalQueryCardinalityEstimationPruneRatio. Leaves 'solutions' untouched if
+ * the cost of any of them cannot be estimated, or if the query has a sort or a limit, since the
+ * productivity of a plan then depends on more than the number of keys and documents it examines.
+ */
+void rankAndPruneSolutions(const CanonicalQuery& query,
+                           const CollectionStatistics& stats,
+                           std::vector<std::unique_ptr<QuerySolution>>* solutions);
+
+}  // namespace mongo::cardinality_estimation
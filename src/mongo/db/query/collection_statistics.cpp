@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+void CollectionStatistics::setHistogram(const std::string& path,
+                                        std::shared_ptr<const Histogram> histogram,
+                                        double numRecords) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _histograms[path] = std::move(histogram);
+    _numRecords = numRecords;
+}
+
+std::shared_ptr<const Histogram> CollectionStatistics::getHistogram(StringData path) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _histograms.find(path);
+    return it != _histograms.end() ? it->second : nullptr;
+}
+
+boost::optional<double> CollectionStatistics::getNumRecords() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _numRecords;
+}
+
+void CollectionStatistics::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _histograms.clear();
+    _numRecords = boost::none;
+}
+
+void CollectionStatistics::load(const BSONObj& persisted) {
+    StringMap<std::shared_ptr<const Histogram>> histograms;
+    boost::optional<double> numRecords;
+    if (!persisted.isEmpty()) {
+        auto numRecordsElt = persisted["numRecords"];
+        uassert(6179073,
+                str::stream() << "Collection statistics field 'numRecords' must be a number: "
+                              << persisted,
+                numRecordsElt.isNumber());
+        numRecords = numRecordsElt.numberDouble();
+
+        auto histogramsElt = persisted["histograms"];
+        uassert(6179073,
+                str::stream() << "Collection statistics field 'histograms' must be an array: "
+                              << persisted,
+                histogramsElt.type() == Array);
+        for (auto&& elt : histogramsElt.Obj()) {
+            uassert(6179073,
+                    str::stream() << "Collection statistics histograms must be objects with a "
+                                     "string 'key' and an object 'histogram': "
+                                  << persisted,
+                    elt.type() == Object && elt["key"].type() == String &&
+                        elt["histogram"].type() == Object);
+            histograms[elt["key"].str()] =
+                std::make_shared<const Histogram>(Histogram::parse(elt["histogram"].Obj()));
+        }
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_loaded.load()) {
+        return;
+    }
+    _histograms = std::move(histograms);
+    _numRecords = numRecords;
+    _loaded.store(true);
+}
+
+BSONObj CollectionStatistics::toBSON() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    BSONObjBuilder builder;
+    if (_numRecords) {
+        builder.append("numRecords", *_numRecords);
+    }
+    BSONArrayBuilder histogramsBuilder(builder.subarrayStart("histograms"));
+    for (auto&& [path, histogram] : _histograms) {
+        histogramsBuilder.append(BSON("key" << path << "histogram" << histogram->toBSON()));
+    }
+    histogramsBuilder.doneFast();
+    return builder.obj();
+}
+
+}  // namespace mongo
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/histogram.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * The statistics the 'analyze' command gathered about the data of a collection: the number of
+ * documents it held and histograms of the values of some of its fields, keyed by field path. The
+ * query planner uses them to estimate the cost of candidate query solutions.
+ *
+ * The statistics reflect the data at the time they were gathered. They are persisted in
+ * NamespaceString::kCollectionStatisticsNamespace, and read back from there the first time they are
+ * needed after startup. See collection_statistics_store.h.
+ *
+ * This class is thread-safe.
+ */
+class CollectionStatistics {
+public:
+    /**
+     * Replaces the histogram of the field 'path' and the number of documents of the collection.
+     */
+    void setHistogram(const std::string& path,
+                      std::shared_ptr<const Histogram> histogram,
+                      double numRecords);
+
+    /**
+     * Returns the histogram of the field 'path', or nullptr if there is none.
+     */
+    std::shared_ptr<const Histogram> getHistogram(StringData path) const;
+
+    /**
+     * Returns the number of documents of the collection when its statistics were last gathered, or
+     * boost::none if they never were.
+     */
+    boost::optional<double> getNumRecords() const;
+
+    void clear();
+
+    /**
+     * Returns whether the persisted statistics have been loaded, or there were none.
+     */
+    bool isLoaded() const {
+        return _loaded.load();
+    }
+
+    /**
+     * Replaces the statistics with the persisted ones in 'persisted', as serialized by toBSON(),
+     * or with no statistics if 'persisted' is empty, and marks them loaded. Does nothing if they
+     * already are. Throws if 'persisted' is invalid.
+     */
+    void load(const BSONObj& persisted);
+
+    /**
+     * Serializes the statistics to be persisted.
+     */
+    BSONObj toBSON() const;
+
+private:
+    // Protects all of the members below.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("CollectionStatistics::_mutex");
+
+    StringMap<std::shared_ptr<const Histogram>> _histograms;
+
+    boost::optional<double> _numRecords;
+
+    // Set once the persisted statistics have been loaded. Only written while '_mutex' is held.
+    AtomicWord<bool> _loaded{false};
+};
+
+}  // namespace mongo
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics_store.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/ops/write_ops_gen.h"
+#include "mongo/db/query/collection_statistics_decoration.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/logv2/log.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+
+namespace mongo::collection_statistics_store {
+
+CollectionStatistics* get(OperationContext* opCtx, const CollectionPtr& collection) {
+    auto stats = CollectionStatisticsDecoration::get(collection->getSharedDecorations());
+    if (stats->isLoaded() || opCtx->inMultiDocumentTransaction()) {
+        return stats;
+    }
+
+    // The persisted statistics are read through a query, which must not need them itself.
+    if (collection->ns() == NamespaceString::kCollectionStatisticsNamespace) {
+        stats->load(BSONObj());
+        return stats;
+    }
+
+    DBDirectClient client(opCtx);
+    auto persisted = client.findOne(NamespaceString::kCollectionStatisticsNamespace.ns(),
+                                    BSON("_id" << collection->uuid()));
+    try {
+        stats->load(persisted.removeField("_id"));
+    } catch (const DBException& ex) {
+        // The statistics only guide the query planner, so queries go on without them.
+        LOGV2_WARNING(6179074,
+                      "Ignoring invalid persisted collection statistics",
+                      "namespace"_attr = collection->ns(),
+                      "uuid"_attr = collection->uuid(),
+                      "error"_attr = ex.toStatus());
+        stats->load(BSONObj());
+    }
+    return stats;
+}
+
+void persist(OperationContext* opCtx, const UUID& uuid, const BSONObj& stats) {
+    invariant(!opCtx->lockState()->isLocked());
+
+    // The caller may have read at a timestamp, which the untimestamped write must not do.
+    opCtx->recoveryUnit()->abandonSnapshot();
+    opCtx->recoveryUnit()->setTimestampReadSource(RecoveryUnit::ReadSource::kNoTimestamp);
+
+    DBDirectClient client(opCtx);
+    const auto commandResponse = client.runCommand([&] {
+        write_ops::UpdateCommandRequest updateOp(NamespaceString::kCollectionStatisticsNamespace);
+        write_ops::UpdateOpEntry updateEntry(
+            BSON("_id" << uuid), write_ops::UpdateModification::parseFromClassicUpdate(stats));
+        updateEntry.setUpsert(true);
+        updateOp.setUpdates({updateEntry});
+        return updateOp.serialize({});
+    }());
+    uassertStatusOK(getStatusFromWriteCommandReply(commandResponse->getCommandReply()));
+}
+
+}  // namespace mongo::collection_statistics_store
@@ -0,0 +1,65 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class CollectionPtr;
+class OperationContext;
+
+/**
+ * Persistence of the statistics gathered by the 'analyze' command. The statistics of a collection
+ * are stored in one document of NamespaceString::kCollectionStatisticsNamespace, whose _id is the
+ * UUID of the collection. That collection is not replicated, as each node gathers its own
+ * statistics.
+ */
+namespace collection_statistics_store {
+
+/**
+ * Returns the statistics of 'collection'. The first time they are needed after startup, they are
+ * read from their persisted document. Operations in a multi-document transaction do not read it,
+ * and see no statistics until another operation has.
+ */
+CollectionStatistics* get(OperationContext* opCtx, const CollectionPtr& collection);
+
+/**
+ * Replaces the persisted statistics of the collection with UUID 'uuid' with 'stats', as serialized
+ * by CollectionStatistics::toBSON(). Must not be called while holding locks, and resets the read
+ * source of the operation.
+ */
+void persist(OperationContext* opCtx, const UUID& uuid, const BSONObj& stats);
+
+}  // namespace collection_statistics_store
+}  // namespace mongo
@@ -68,6 +68,7 @@
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/collection_statistics_store.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
@@ -84,6 +85,7 @@
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/query_settings_decoration.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 #include "mongo/db/query/sbe_multi_planner.h"
 #include "mongo/db/query/sbe_sub_planner.h"
@@ -361,6 +363,10 @@ void fillOutPlannerParams(OperationContext* opCtx,
     if (collection->isClustered()) {
         plannerParams->allowRIDRange = true;
     }
+
+    if (internalQueryEnableCardinalityEstimation.load()) {
+        plannerParams->collectionStats = collection_statistics_store::get(opCtx, collection);
+    }
 }
 
 bool shouldWaitForOplogVisibility(OperationContext* opCtx,
@@ -561,6 +567,8 @@ public:
     }
 
     StatusWith<std::unique_ptr<ResultType>> prepare() {
+        registerQueryShape();
+
         if (!_collection) {
             LOGV2_DEBUG(20921,
                         2,
@@ -629,6 +637,7 @@ public:
                 auto statusWithQs = QueryPlanner::planFromCache(*_cq, plannerParams, *cs);
 
                 if (statusWithQs.isOK()) {
+                    CurOp::get(_opCtx)->debug().fromPlanCache = true;
                     auto querySolution = std::move(statusWithQs.getValue());
                     if ((plannerParams.options & QueryPlannerParams::IS_COUNT) &&
                         turnIxscanIntoCount(querySolution.get())) {
@@ -756,6 +765,23 @@ protected:
         std::vector<std::unique_ptr<QuerySolution>> solutions,
         const QueryPlannerParams& plannerParams) = 0;
 
+    /**
+     * Registers the shape of the query with the query shape statistics store, so that the
+     * statistics of the operation are recorded against it once it completes. Only the first query
+     * planned by an operation of a user connection is registered.
+     */
+    void registerQueryShape() {
+        auto& queryShapeStats = QueryShapeStats::get(_opCtx->getServiceContext());
+        auto& opDebug = CurOp::get(_opCtx)->debug();
+        if (!queryShapeStats.isEnabled() || opDebug.queryShapeStatsKey ||
+            !_opCtx->getClient()->isFromUserConnection()) {
+            return;
+        }
+
+        opDebug.queryShapeStatsKey = queryShapeStats.registerShape(
+            *_cq, _opCtx->getServiceContext()->getFastClockSource()->now());
+    }
+
     OperationContext* _opCtx;
     const CollectionPtr& _collection;
     CanonicalQuery* _cq;
@@ -919,8 +945,14 @@ public:
 protected:
     std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData> buildExecutableTree(
         const QuerySolution& solution) const final {
+        // The base class only builds trees which are the sole plan of their query.
+        return buildExecutableTree(solution, true /* allowParallelScan */);
+    }
+
+    std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData> buildExecutableTree(
+        const QuerySolution& solution, bool allowParallelScan) const {
         return stage_builder::buildSlotBasedExecutableTree(
-            _opCtx, _collection, *_cq, solution, _yieldPolicy);
+            _opCtx, _collection, *_cq, solution, _yieldPolicy, allowParallelScan);
     }
 
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildIdHackPlan(
@@ -990,7 +1022,7 @@ protected:
         const QueryPlannerParams& plannerParams,
         size_t decisionWorks) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution);
+        auto execTree = buildExecutableTree(*solution, false /* allowParallelScan */);
         result->emplace(std::move(execTree), std::move(solution));
         result->setDecisionWorks(decisionWorks);
         return result;
@@ -1013,7 +1045,7 @@ protected:
                 solutions[ix]->cacheData->indexFilterApplied = plannerParams.indexFiltersApplied;
             }
 
-            auto execTree = buildExecutableTree(*solutions[ix]);
+            auto execTree = buildExecutableTree(*solutions[ix], false /* allowParallelScan */);
             result->emplace(std::move(execTree), std::move(solutions[ix]));
         }
         return result;
@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Compares values the way a btree index orders them, ignoring field names.
+int compareValues(BSONElement lhs, BSONElement rhs) {
+    return lhs.woCompare(rhs, 0);
+}
+
+// Returns a single-field object holding the value of 'elt', as histograms keep their values.
+BSONObj toValueObj(BSONElement elt) {
+    BSONObjBuilder builder;
+    builder.appendAs(elt, "");
+    return builder.obj();
+}
+
+double parseCount(const BSONObj& obj, StringData fieldName) {
+    auto elt = obj[fieldName];
+    uassert(6179070,
+            str::stream() << "Histogram field '" << fieldName << "' must be a number: " << obj,
+            elt.isNumber());
+    return elt.numberDouble();
+}
+
+bool isWithinInterval(const Interval& interval, BSONElement value) {
+    const int cmpStart = compareValues(value, interval.start);
+    const int cmpEnd = compareValues(value, interval.end);
+    return (cmpStart > 0 || (cmpStart == 0 && interval.startInclusive)) &&
+        (cmpEnd < 0 || (cmpEnd == 0 && interval.endInclusive));
+}
+
+/**
+ * Returns the estimated fraction of the values between 'lowerBound' and 'upperBound', of which
+ * there are 'distincts' distinct ones, that are within 'interval'. The range excludes
+ * 'upperBound', and also 'lowerBound' unless 'lowerBoundInclusive' is set.
+ */
+double estimateRangeFraction(const Interval& interval,
+                             BSONElement lowerBound,
+                             bool lowerBoundInclusive,
+                             BSONElement upperBound,
+                             double distincts) {
+    const int cmpEndToLowerBound = compareValues(interval.end, lowerBound);
+    if (cmpEndToLowerBound < 0 ||
+        (cmpEndToLowerBound == 0 && !(lowerBoundInclusive && interval.endInclusive)) ||
+        compareValues(interval.start, upperBound) >= 0) {
+        return 0.0;
+    }
+
+    const bool coversLowerBound = compareValues(interval.start, lowerBound) <= 0;
+    const bool coversUpperBound = compareValues(interval.end, upperBound) >= 0;
+    if (coversLowerBound && coversUpperBound) {
+        return 1.0;
+    }
+
+    if (interval.isPoint()) {
+        return 1.0 / std::max(distincts, 1.0);
+    }
+
+    auto start = coversLowerBound ? lowerBound : interval.start;
+    auto end = coversUpperBound ? upperBound : interval.end;
+    if (lowerBound.isNumber() && upperBound.isNumber() && start.isNumber() && end.isNumber()) {
+        const double width = upperBound.numberDouble() - lowerBound.numberDouble();
+        if (width > 0 && std::isfinite(width)) {
+            const double fraction = (end.numberDouble() - start.numberDouble()) / width;
+            return std::clamp(fraction, 0.0, 1.0);
+        }
+    }
+
+    return 0.5;
+}
+
+}  // namespace
+
+Histogram::Histogram(BSONObj minValue, std::vector<Bucket> buckets, double totalCount)
+    : _minValue(std::move(minValue)), _buckets(std::move(buckets)), _totalCount(totalCount) {}
+
+Histogram Histogram::parse(const BSONObj& obj) {
+    const double totalCount = parseCount(obj, "totalCount");
+
+    auto bucketsElt = obj["buckets"];
+    uassert(6179071,
+            str::stream() << "Histogram field 'buckets' must be an array: " << obj,
+            bucketsElt.type() == Array);
+    std::vector<Bucket> buckets;
+    for (auto&& bucketElt : bucketsElt.Obj()) {
+        uassert(6179071,
+                str::stream() << "Histogram buckets must be objects: " << obj,
+                bucketElt.type() == Object);
+        auto bucketObj = bucketElt.Obj();
+        auto upperBound = bucketObj["upperBound"];
+        uassert(6179071,
+                str::stream() << "Histogram buckets must have an 'upperBound': " << obj,
+                !upperBound.eoo());
+        buckets.push_back({toValueObj(upperBound),
+                           parseCount(bucketObj, "equalCount"),
+                           parseCount(bucketObj, "rangeCount"),
+                           parseCount(bucketObj, "rangeDistincts")});
+    }
+
+    auto minValueElt = obj["minValue"];
+    uassert(6179072,
+            str::stream() << "Histogram with buckets must have a 'minValue': " << obj,
+            buckets.empty() || !minValueElt.eoo());
+    return Histogram(
+        minValueElt.eoo() ? BSONObj() : toValueObj(minValueElt), std::move(buckets), totalCount);
+}
+
+Histogram Histogram::make(std::vector<BSONObj> values, size_t maxBuckets, double scale) {
+    invariant(maxBuckets > 0);
+    if (values.empty()) {
+        return Histogram(BSONObj(), {}, 0.0);
+    }
+
+    std::sort(values.begin(), values.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return compareValues(lhs.firstElement(), rhs.firstElement()) < 0;
+    });
+
+    // Close a bucket at the first distinct value which brings it to the target depth, unless it is
+    // the last bucket allowed, which takes all remaining values.
+    const double targetDepth = std::ceil(static_cast<double>(values.size()) / maxBuckets);
+    std::vector<Bucket> buckets;
+    double rangeCount = 0;
+    double rangeDistincts = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t end = i + 1;
+        while (end < values.size() &&
+               compareValues(values[end].firstElement(), values[i].firstElement()) == 0) {
+            ++end;
+        }
+
+        const double equalCount = end - i;
+        const bool isLastValue = end == values.size();
+        if (isLastValue ||
+            (rangeCount + equalCount >= targetDepth && buckets.size() + 1 < maxBuckets)) {
+            buckets.push_back(
+                {values[i].getOwned(), equalCount * scale, rangeCount * scale, rangeDistincts});
+            rangeCount = 0;
+            rangeDistincts = 0;
+        } else {
+            rangeCount += equalCount;
+            ++rangeDistincts;
+        }
+        i = end;
+    }
+
+    return Histogram(values.front().getOwned(), std::move(buckets), values.size() * scale);
+}
+
+double Histogram::estimate(const Interval& interval) const {
+    double estimate = 0;
+
+    // The range of the first bucket starts at the smallest sampled value, those of the others
+    // right after the upper bound of the previous bucket.
+    auto lowerBound = _minValue.firstElement();
+    bool lowerBoundInclusive = true;
+    for (auto&& bucket : _buckets) {
+        auto upperBound = bucket.upperBound.firstElement();
+        if (isWithinInterval(interval, upperBound)) {
+            estimate += bucket.equalCount;
+        }
+
+        if (bucket.rangeCount > 0) {
+            estimate += bucket.rangeCount *
+                estimateRangeFraction(interval,
+                                      lowerBound,
+                                      lowerBoundInclusive,
+                                      upperBound,
+                                      bucket.rangeDistincts);
+        }
+        lowerBound = upperBound;
+        lowerBoundInclusive = false;
+    }
+    return estimate;
+}
+
+double Histogram::estimateDistinctCount() const {
+    // The upper bound of each bucket is a distinct value of its own.
+    return std::accumulate(
+        _buckets.begin(), _buckets.end(), 0.0, [](double count, const Bucket& bucket) {
+            return count + bucket.rangeDistincts + 1;
+        });
+}
+
+BSONObj Histogram::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("totalCount", _totalCount);
+    if (!_minValue.isEmpty()) {
+        builder.appendAs(_minValue.firstElement(), "minValue");
+    }
+
+    BSONArrayBuilder bucketsBuilder(builder.subarrayStart("buckets"));
+    for (auto&& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.upperBound.firstElement(), "upperBound");
+        bucketBuilder.append("equalCount", bucket.equalCount);
+        bucketBuilder.append("rangeCount", bucket.rangeCount);
+        bucketBuilder.append("rangeDistincts", bucket.rangeDistincts);
+    }
+    bucketsBuilder.doneFast();
+
+    return builder.obj();
+}
+
+}  // namespace mongo
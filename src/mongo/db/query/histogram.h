@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/interval.h"
+
+namespace mongo {
+
+/**
+ * An equi-depth histogram of the values of a single field of a collection, built from a sample of
+ * its documents by the 'analyze' command. Values are ordered the way a btree index orders them,
+ * i.e. by canonical type and then by value, ignoring collation. Each bucket covers the values
+ * greater than the upper bound of the previous bucket and less than or equal to its own upper
+ * bound, and records how many of them are equal to the upper bound and how many, of how many
+ * distinct values, lie strictly below it.
+ *
+ * The counts are scaled from the sample to the whole collection, so estimates are numbers of
+ * values in the collection. Documents with several values for the field, as in arrays, contribute
+ * all of them, like they contribute several keys to a multikey index.
+ */
+class Histogram {
+public:
+    struct Bucket {
+        // A single-field object holding the upper bound of the bucket.
+        BSONObj upperBound;
+
+        // The estimated number of values equal to 'upperBound'.
+        double equalCount;
+
+        // The estimated number of values between the previous upper bound and 'upperBound'.
+        double rangeCount;
+
+        // The number of distinct values between the previous upper bound and 'upperBound' in the
+        // sample.
+        double rangeDistincts;
+    };
+
+    /**
+     * Builds a histogram of at most 'maxBuckets' buckets from the sampled 'values', each of which
+     * is held as the only field of an object. All counts are multiplied by 'scale', the ratio of
+     * the size of the collection to the size of the sample.
+     */
+    static Histogram make(std::vector<BSONObj> values, size_t maxBuckets, double scale);
+
+    /**
+     * Parses a histogram serialized by toBSON(). Throws if 'obj' is not a valid histogram.
+     */
+    static Histogram parse(const BSONObj& obj);
+
+    /**
+     * Returns the estimated number of values within 'interval', which must not be descending.
+     * Values of a bucket partially covered by 'interval' are interpolated for numbers and assumed
+     * to be evenly split between the distinct values of the bucket for point intervals. Otherwise
+     * half of them are assumed to be within 'interval'.
+     */
+    double estimate(const Interval& interval) const;
+
+    /**
+     * Returns the estimated number of distinct values of the field. This is the number of distinct
+     * values in the sample, which is accurate for fields of low cardinality.
+     */
+    double estimateDistinctCount() const;
+
+    double getTotalCount() const {
+        return _totalCount;
+    }
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    BSONObj toBSON() const;
+
+private:
+    Histogram(BSONObj minValue, std::vector<Bucket> buckets, double totalCount);
+
+    // A single-field object holding the smallest sampled value, which serves as the lower bound
+    // of the first bucket. Empty if the sample was empty.
+    BSONObj _minValue;
+
+    std::vector<Bucket> _buckets;
+
+    double _totalCount;
+};
+
+}  // namespace mongo
@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/histogram.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::vector<BSONObj> makeValues(int begin, int end) {
+    std::vector<BSONObj> values;
+    for (int i = begin; i < end; ++i) {
+        values.push_back(BSON("" << i));
+    }
+    return values;
+}
+
+TEST(HistogramTest, EmptySample) {
+    auto histogram = Histogram::make({}, 10, 1.0);
+    ASSERT_EQ(histogram.getTotalCount(), 0.0);
+    ASSERT(histogram.getBuckets().empty());
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true)), 0.0);
+}
+
+TEST(HistogramTest, UniformValuesFillEquiDepthBuckets) {
+    auto histogram = Histogram::make(makeValues(0, 100), 10, 1.0);
+    ASSERT_EQ(histogram.getTotalCount(), 100.0);
+
+    const auto& buckets = histogram.getBuckets();
+    ASSERT_EQ(buckets.size(), 10U);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(buckets[i].upperBound, BSON("" << static_cast<int>(i * 10 + 9)));
+        ASSERT_EQ(buckets[i].equalCount, 1.0);
+        ASSERT_EQ(buckets[i].rangeCount, 9.0);
+        ASSERT_EQ(buckets[i].rangeDistincts, 9.0);
+    }
+}
+
+TEST(HistogramTest, EstimatePointAndRangeIntervals) {
+    auto histogram = Histogram::make(makeValues(0, 100), 10, 1.0);
+
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 50 << "" << 50), true, true)), 1.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 0 << "" << 49), true, true)), 50.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true)),
+              100.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 1000 << "" << 2000), true, true)), 0.0);
+
+    // Ranges partially covering a bucket of numbers are interpolated.
+    ASSERT_APPROX_EQUAL(
+        histogram.estimate(Interval(BSON("" << 0 << "" << 4.5), true, true)), 4.5, 0.01);
+}
+
+TEST(HistogramTest, EstimateDistinctCount) {
+    ASSERT_EQ(Histogram::make({}, 10, 1.0).estimateDistinctCount(), 0.0);
+    ASSERT_EQ(Histogram::make(makeValues(0, 100), 10, 1.0).estimateDistinctCount(), 100.0);
+
+    // The number of distinct values is not scaled from the sample to the collection.
+    std::vector<BSONObj> values;
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(BSON("" << i % 5));
+    }
+    ASSERT_EQ(Histogram::make(std::move(values), 10, 10.0).estimateDistinctCount(), 5.0);
+}
+
+TEST(HistogramTest, ScalesCountsToCollection) {
+    auto histogram = Histogram::make(makeValues(0, 100), 10, 10.0);
+    ASSERT_EQ(histogram.getTotalCount(), 1000.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 50 << "" << 50), true, true)), 10.0);
+}
+
+TEST(HistogramTest, FrequentValueGetsItsOwnBucket) {
+    std::vector<BSONObj> values(90, BSON("" << 1));
+    auto others = makeValues(2, 12);
+    values.insert(values.end(), others.begin(), others.end());
+
+    auto histogram = Histogram::make(std::move(values), 10, 1.0);
+    const auto& buckets = histogram.getBuckets();
+    ASSERT_EQ(buckets.size(), 2U);
+    ASSERT_BSONOBJ_EQ(buckets[0].upperBound, BSON("" << 1));
+    ASSERT_EQ(buckets[0].equalCount, 90.0);
+
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 1 << "" << 1), true, true)), 90.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 5 << "" << 5), true, true)), 1.0);
+}
+
+TEST(HistogramTest, ValuesAreOrderedByCanonicalType) {
+    auto values = makeValues(0, 10);
+    for (int i = 0; i < 10; ++i) {
+        values.push_back(BSON("" << std::to_string(i)));
+    }
+
+    auto histogram = Histogram::make(std::move(values), 2, 1.0);
+    const auto& buckets = histogram.getBuckets();
+    ASSERT_EQ(buckets.size(), 2U);
+    ASSERT_BSONOBJ_EQ(buckets[0].upperBound, BSON("" << 9));
+    ASSERT_BSONOBJ_EQ(buckets[1].upperBound, BSON(""
+                                                  << "9"));
+
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true)), 20.0);
+    ASSERT_EQ(histogram.estimate(Interval(BSON("" << 0 << "" << 9), true, true)), 10.0);
+}
+
+TEST(HistogramTest, ParsesItsSerialization) {
+    auto histogram = Histogram::make(makeValues(0, 100), 10, 2.0);
+    auto parsed = Histogram::parse(histogram.toBSON());
+    ASSERT_BSONOBJ_EQ(parsed.toBSON(), histogram.toBSON());
+    ASSERT_EQ(parsed.getTotalCount(), 200.0);
+    for (auto&& interval : {Interval(BSON("" << 0 << "" << 0), true, true),
+                            Interval(BSON("" << 5 << "" << 42), true, false),
+                            Interval(BSON("" << MINKEY << "" << MAXKEY), true, true)}) {
+        ASSERT_EQ(parsed.estimate(interval), histogram.estimate(interval));
+    }
+
+    auto empty = Histogram::parse(Histogram::make({}, 10, 1.0).toBSON());
+    ASSERT_EQ(empty.getTotalCount(), 0.0);
+    ASSERT(empty.getBuckets().empty());
+}
+
+TEST(HistogramTest, ParseRejectsInvalidHistograms) {
+    ASSERT_THROWS_CODE(Histogram::parse(BSONObj()), DBException, 6179070);
+    ASSERT_THROWS_CODE(Histogram::parse(BSON("totalCount" << 1)), DBException, 6179071);
+    ASSERT_THROWS_CODE(Histogram::parse(BSON("totalCount" << 1 << "buckets"
+                                                          << BSON_ARRAY(BSON("equalCount" << 1)))),
+                       DBException,
+                       6179071);
+    ASSERT_THROWS_CODE(Histogram::parse(BSON("totalCount"
+                                             << 1 << "buckets"
+                                             << BSON_ARRAY(BSON("upperBound"
+                                                                << 1 << "equalCount" << 1
+                                                                << "rangeCount" << 0
+                                                                << "rangeDistincts" << 0)))),
+                       DBException,
+                       6179072);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -63,6 +63,13 @@ namespace {
 ServerStatusMetricField<Counter64> totalPlanCacheSizeEstimateBytesMetric(
     "query.planCacheTotalSizeEstimateBytes", &PlanCacheEntry::planCacheTotalSizeEstimateBytes);
 
+// Source of the generation numbers of all plan caches in the process.
+AtomicWord<uint64_t> planCacheGenerationCounter{0};
+
+uint64_t nextPlanCacheGeneration() {
+    return planCacheGenerationCounter.addAndFetch(1);
+}
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -433,7 +440,7 @@ std::string SolutionCacheData::toString() const {
 
 PlanCache::PlanCache() : PlanCache(internalQueryCacheMaxEntriesPerCollection.load()) {}
 
-PlanCache::PlanCache(size_t size) : _cache(size) {}
+PlanCache::PlanCache(size_t size) : _cache(size), _generation(nextPlanCacheGeneration()) {}
 
 PlanCache::~PlanCache() {}
 
@@ -683,6 +690,7 @@ Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
 void PlanCache::clear() {
     stdx::lock_guard<Latch> cacheLock(_cacheMutex);
     _cache.clear();
+    _generation.store(nextPlanCacheGeneration());
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -728,6 +736,7 @@ size_t PlanCache::size() const {
 
 void PlanCache::notifyOfIndexUpdates(const std::vector<CoreIndexInfo>& indexCores) {
     _indexabilityState.updateDiscriminators(indexCores);
+    _generation.store(nextPlanCacheGeneration());
 }
 
 std::vector<BSONObj> PlanCache::getMatchingStats(
@@ -554,6 +554,15 @@ public:
      */
     void clear();
 
+    /**
+     * Returns a number, unique among all plan caches in the process, which changes whenever this
+     * cache is cleared or notified of index updates. Caches of artifacts derived from the plans of
+     * the associated collection, such as the SBE plan tree cache, use it to detect stale entries.
+     */
+    uint64_t getGeneration() const {
+        return _generation.load();
+    }
+
     /**
      * Get the cache key corresponding to the given canonical query.  The query need not already
      * be cached.
@@ -624,5 +633,8 @@ private:
     // Concurrent access is synchronized by the collection lock.  Multiple concurrent readers
     // are allowed.
     PlanCacheIndexabilityState _indexabilityState;
+
+    // Bumped from a process-wide counter by clear() and notifyOfIndexUpdates().
+    AtomicWord<uint64_t> _generation;
 };
 }  // namespace mongo
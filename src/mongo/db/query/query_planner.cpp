@@ -44,14 +44,18 @@
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_text.h"
+#include "mongo/db/query/cardinality_estimation.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/index_tag.h"
+#include "mongo/db/query/indexability.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_enumerator.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/logv2/log.h"
@@ -337,6 +341,111 @@ std::unique_ptr<QuerySolution> buildWholeIXSoln(const IndexEntry& index,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+/**
+ * Builds a solution skip scanning 'index', a compound index whose leading field the query does not
+ * constrain. The scan covers all values of the fields before the first field the query constrains,
+ * and the index scan stage seeks from each distinct value of them directly to the bounds of the
+ * constrained fields, rather than examining every key. Only predicates which are the root of the
+ * query or children of a top-level AND are used to constrain the scan.
+ *
+ * Returns nullptr if the index cannot be skip scanned for the query.
+ */
+std::unique_ptr<QuerySolution> buildSkipScanSoln(const IndexEntry& index,
+                                                 const CanonicalQuery& query,
+                                                 const QueryPlannerParams& params) {
+    // Bounds on several fields of a multikey index cannot always be compounded, so skip scans are
+    // restricted to indexes which are not multikey.
+    if (index.type != INDEX_BTREE || index.multikey || index.keyPattern.nFields() < 2 ||
+        (index.filterExpr && !expression::isSubsetOf(query.root(), index.filterExpr))) {
+        return nullptr;
+    }
+
+    const std::vector<IndexEntry> indices{index};
+    std::unique_ptr<MatchExpression> taggedTree = query.root()->shallowClone();
+    QueryPlannerIXSelect::rateIndices(taggedTree.get(), "", indices, query.getCollator());
+    QueryPlannerIXSelect::stripInvalidAssignments(taggedTree.get(), indices);
+
+    std::vector<MatchExpression*> predicates;
+    if (MatchExpression::AND == taggedTree->matchType()) {
+        for (size_t i = 0; i < taggedTree->numChildren(); ++i) {
+            predicates.push_back(taggedTree->getChild(i));
+        }
+    } else {
+        predicates.push_back(taggedTree.get());
+    }
+
+    // Find the position in the index of the field of each predicate the index can be used for.
+    // The predicates over the leading field, if any, cannot be, as the normal planning would
+    // otherwise have used the index.
+    std::vector<std::pair<MatchExpression*, size_t>> assignments;
+    for (auto predicate : predicates) {
+        auto tag = static_cast<RelevantTag*>(predicate->getTag());
+        if (!tag || tag->notFirst.empty() || !Indexability::isBoundsGenerating(predicate)) {
+            continue;
+        }
+
+        size_t pos = 0;
+        for (auto&& keyElt : index.keyPattern) {
+            if (keyElt.fieldNameStringData() == tag->path) {
+                break;
+            }
+            ++pos;
+        }
+        if (pos > 0 && pos < static_cast<size_t>(index.keyPattern.nFields())) {
+            assignments.emplace_back(predicate, pos);
+        }
+    }
+
+    if (assignments.empty()) {
+        return nullptr;
+    }
+
+    taggedTree->resetTag();
+    for (auto&& [predicate, pos] : assignments) {
+        predicate->setTag(new IndexTag(0, pos, true /* canCombineBounds */));
+    }
+
+    std::unique_ptr<MatchExpression> clone(taggedTree->shallowClone());
+    auto statusWithCacheData = QueryPlanner::cacheDataFromTaggedTree(clone.get(), indices);
+
+    prepareForAccessPlanning(taggedTree.get());
+    std::unique_ptr<QuerySolutionNode> solnRoot(
+        QueryPlannerAccess::buildIndexedDataAccess(query, std::move(taggedTree), indices, params));
+    if (!solnRoot) {
+        return nullptr;
+    }
+
+    auto soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+    if (soln && statusWithCacheData.isOK()) {
+        SolutionCacheData* scd = new SolutionCacheData();
+        scd->tree = std::move(statusWithCacheData.getValue());
+        soln->cacheData.reset(scd);
+    }
+    return soln;
+}
+
+/**
+ * Returns true if the planner may consider skip scanning 'index' for 'query', that is if the query
+ * does not refer to the leading field of the index and, if the 'analyze' command gathered a
+ * histogram of the leading field, the field has few enough distinct values.
+ */
+bool shouldConsiderSkipScan(const IndexEntry& index,
+                            const stdx::unordered_set<std::string>& fields,
+                            const QueryPlannerParams& params) {
+    const auto leadingField = index.keyPattern.firstElementFieldName();
+    if (fields.count(leadingField)) {
+        return false;
+    }
+
+    if (params.collectionStats) {
+        if (auto histogram = params.collectionStats->getHistogram(leadingField)) {
+            return histogram->estimateDistinctCount() <=
+                internalQueryPlannerSkipScanMaxPrefixDistinctValues.load();
+        }
+    }
+    return true;
+}
+
 bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
     return query.getFindCommandRequest().getSort().isPrefixOf(
         kp, SimpleBSONElementComparator::kInstance);
@@ -940,6 +1049,31 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         }
     }
 
+    // No index has the fields of the query as a prefix. A compound index constraining the query
+    // fields after its leading field may still be skip scanned, if the leading field has few
+    // distinct values.
+    bool outputSkipScans = false;
+    if (out.empty() && hintedIndex.isEmpty() && !isTailable &&
+        internalQueryPlannerEnableIndexSkipScan.load()) {
+        for (auto&& index : fullIndexList) {
+            if (out.size() >= params.maxIndexedSolutions) {
+                break;
+            }
+            if (!shouldConsiderSkipScan(index, fields, params)) {
+                continue;
+            }
+            if (auto soln = buildSkipScanSoln(index, query, params)) {
+                LOGV2_DEBUG(6179064,
+                            5,
+                            "Planner: outputting a skip scan solution",
+                            "index"_attr = index.keyPattern,
+                            "solution"_attr = redact(soln->toString()));
+                out.push_back(std::move(soln));
+                outputSkipScans = true;
+            }
+        }
+    }
+
     // An index was hinted. If there are any solutions, they use the hinted index.  If not, we
     // scan the entire index to provide results and output that as our plan.  This is the
     // desired behavior when an index is hinted that is not relevant to the query. In the case that
@@ -953,8 +1087,15 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
                 ErrorCodes::NoQueryExecutionPlans,
                 "$hint: refusing to build whole-index solution, because it's a wildcard index");
         }
-        // Return hinted index solution if found.
-        auto soln = buildWholeIXSoln(relevantIndices.front(), query, params);
+        // Return hinted index solution if found. Skip scanning the hinted index, when allowed, is
+        // never worse than scanning all of it.
+        std::unique_ptr<QuerySolution> soln;
+        if (internalQueryPlannerEnableIndexSkipScan.load() && !isTailable) {
+            soln = buildSkipScanSoln(relevantIndices.front(), query, params);
+        }
+        if (!soln) {
+            soln = buildWholeIXSoln(relevantIndices.front(), query, params);
+        }
         if (!soln) {
             return Status(ErrorCodes::NoQueryExecutionPlans,
                           "Failed to build whole-index solution for $hint");
@@ -1093,6 +1234,10 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
     // The caller can explicitly ask for a collscan.
     bool collscanRequested = (params.options & QueryPlannerParams::INCLUDE_COLLSCAN);
 
+    // A skip scan only beats a collection scan when the prefix fields of the index have few
+    // distinct values, which is not known without a histogram. Let the multi-planner decide.
+    collscanRequested = collscanRequested || (outputSkipScans && canTableScan);
+
     // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
     bool collScanRequired = 0 == out.size();
     if (collScanRequired && !canTableScan) {
@@ -1127,6 +1272,12 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         }
     }
 
+    // Rank the candidates by their estimated cost, if the collection has been analyzed, so that
+    // obviously worse ones need not be tried out by the multi-planner.
+    if (params.collectionStats && out.size() > 1) {
+        cardinality_estimation::rankAndPruneSolutions(query, *params.collectionStats, &out);
+    }
+
     invariant(out.size() > 0);
     return {std::move(out)};
 }
@@ -33,6 +33,7 @@
 #include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -1501,5 +1502,70 @@ TEST_F(QueryPlannerTest, PlansForWholeIndexScanWithSortAreGenerated) {
         "{proj: {spec: {'b': 1, _id: 0}, node: {fetch: {node: {ixscan: {pattern: {a: 1}}}}}}}");
 }
 
+//
+// Skip scan tests.
+//
+
+TEST_F(QueryPlannerTest, SkipScanIsNotPlannedByDefault) {
+    params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+    addIndex(BSON("region" << 1 << "ts" << 1));
+
+    runQuery(fromjson("{ts: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {ts: 5}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanOverUnconstrainedLeadingField) {
+    RAIIServerParameterControllerForTest controller{"internalQueryPlannerEnableIndexSkipScan",
+                                                    true};
+    params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+    addIndex(BSON("region" << 1 << "ts" << 1 << "v" << 1));
+
+    // The collection scan competes with the skip scan, even though it was not requested.
+    runQuery(fromjson("{ts: {$gte: 5, $lt: 10}, x: 1}"));
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{fetch: {filter: {x: 1}, node: {ixscan: {pattern: {region: 1, ts: 1, v: 1}, bounds: "
+        "{region: [['MinKey','MaxKey',true,true]], ts: [[5,10,true,false]], "
+        "v: [['MinKey','MaxKey',true,true]]}}}}}");
+    assertSolutionExists("{cscan: {dir: 1, filter: {ts: {$gte: 5, $lt: 10}, x: 1}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanIsNotPlannedWhenLeadingFieldIsConstrained) {
+    RAIIServerParameterControllerForTest controller{"internalQueryPlannerEnableIndexSkipScan",
+                                                    true};
+    params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+    addIndex(BSON("region" << 1 << "ts" << 1));
+
+    runQuery(fromjson("{region: 'eu', ts: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {region: 1, ts: 1}, bounds: "
+        "{region: [['eu','eu',true,true]], ts: [[5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanIsNotPlannedOverMultikeyIndex) {
+    RAIIServerParameterControllerForTest controller{"internalQueryPlannerEnableIndexSkipScan",
+                                                    true};
+    params.options &= ~QueryPlannerParams::INCLUDE_COLLSCAN;
+    addIndex(BSON("region" << 1 << "ts" << 1), true /* multikey */);
+
+    runQuery(fromjson("{ts: 5}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {ts: 5}}}");
+}
+
+TEST_F(QueryPlannerTest, HintedIndexIsSkipScanned) {
+    RAIIServerParameterControllerForTest controller{"internalQueryPlannerEnableIndexSkipScan",
+                                                    true};
+    addIndex(BSON("region" << 1 << "ts" << 1));
+
+    runQueryHint(fromjson("{ts: 5}"), BSON("region" << 1 << "ts" << 1));
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {region: 1, ts: 1}, bounds: "
+        "{region: [['MinKey','MaxKey',true,true]], ts: [[5,5,true,true]]}}}}}");
+}
+
 }  // namespace
 }  // namespace mongo
@@ -37,6 +37,8 @@
 
 namespace mongo {
 
+class CollectionStatistics;
+
 struct QueryPlannerParams {
     QueryPlannerParams()
         : options(DEFAULT),
@@ -147,6 +149,10 @@ struct QueryPlannerParams {
     // Set if we allow optimization which converts "_id" predicates into range collection scan using
     // minRecord and maxRecord.
     bool allowRIDRange;
+
+    // If set, the statistics of the collection used to rank the candidate solutions by estimated
+    // cost. Only valid while the collection is locked.
+    const CollectionStatistics* collectionStats = nullptr;
 };
 
 }  // namespace mongo
@@ -0,0 +1,306 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/canonical_query_encoder.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+const auto getQueryShapeStats = ServiceContext::declareDecoration<QueryShapeStats>();
+
+/**
+ * Returns the index of the bucket of the $collStats latency histograms containing 'latency'.
+ */
+size_t getLatencyBucket(Microseconds latency) {
+    const auto& bounds = OperationLatencyHistogram::kLowerBounds;
+    const auto micros = static_cast<uint64_t>(std::max(durationCount<Microseconds>(latency), 0LL));
+    return std::upper_bound(bounds.begin(), bounds.end(), micros) - bounds.begin() - 1;
+}
+
+void appendFilterShape(const BSONObj& filter, BSONObjBuilder* builder);
+
+/**
+ * Appends a placeholder naming the type of the literal 'elem' under the name of 'elem'.
+ */
+void appendLiteralShape(const BSONElement& elem, BSONObjBuilder* builder) {
+    builder->append(elem.fieldNameStringData(), str::stream() << "?" << typeName(elem.type()));
+}
+
+/**
+ * Returns whether 'elem' is an object of match operators such as {$gte: 1, $lt: 5}, rather than a
+ * literal document compared for equality.
+ */
+bool isOperatorObject(const BSONElement& elem) {
+    return elem.type() == BSONType::Object && !elem.Obj().isEmpty() &&
+        elem.Obj().firstElementFieldNameStringData().startsWith("$");
+}
+
+/**
+ * Appends the operators of the path predicate 'operators', with their operands replaced by
+ * placeholders, except for the predicates nested in $elemMatch and $not.
+ */
+void appendOperatorsShape(const BSONElement& operators, BSONObjBuilder* builder) {
+    BSONObjBuilder operatorsBuilder(builder->subobjStart(operators.fieldNameStringData()));
+    for (auto&& op : operators.Obj()) {
+        const auto name = op.fieldNameStringData();
+        if ((name == "$elemMatch" || name == "$not") && isOperatorObject(op)) {
+            appendOperatorsShape(op, &operatorsBuilder);
+        } else if (name == "$elemMatch" && op.type() == BSONType::Object) {
+            BSONObjBuilder elemMatchBuilder(operatorsBuilder.subobjStart(name));
+            appendFilterShape(op.Obj(), &elemMatchBuilder);
+        } else {
+            appendLiteralShape(op, &operatorsBuilder);
+        }
+    }
+}
+
+/**
+ * Appends the shape of the match expression 'filter' to 'builder': its paths, operators and
+ * logical structure, with every literal replaced by a placeholder naming its type.
+ */
+void appendFilterShape(const BSONObj& filter, BSONObjBuilder* builder) {
+    for (auto&& elem : filter) {
+        const auto name = elem.fieldNameStringData();
+        if ((name == "$and" || name == "$or" || name == "$nor") &&
+            elem.type() == BSONType::Array) {
+            BSONArrayBuilder clausesBuilder(builder->subarrayStart(name));
+            for (auto&& clause : elem.Obj()) {
+                if (clause.type() == BSONType::Object) {
+                    BSONObjBuilder clauseBuilder(clausesBuilder.subobjStart());
+                    appendFilterShape(clause.Obj(), &clauseBuilder);
+                }
+            }
+        } else if (!name.startsWith("$") && isOperatorObject(elem)) {
+            appendOperatorsShape(elem, builder);
+        } else {
+            appendLiteralShape(elem, builder);
+        }
+    }
+}
+
+/**
+ * Appends the fields of the projection or sort 'spec', keeping the numbers and booleans which
+ * include, exclude or order a field and replacing any other value by a placeholder.
+ */
+void appendSpecShape(const BSONObj& spec, BSONObjBuilder* builder) {
+    for (auto&& elem : spec) {
+        if (elem.isNumber() || elem.isBoolean()) {
+            builder->append(elem);
+        } else {
+            appendLiteralShape(elem, builder);
+        }
+    }
+}
+
+/**
+ * Returns the literal-free shape of the query, sort, projection and collation of 'cq', or an empty
+ * object if the shape is larger than 'QueryShapeStats::kMaxShapeSize' bytes.
+ */
+BSONObj makeShape(const CanonicalQuery& cq) {
+    const auto& findCommand = cq.getFindCommandRequest();
+    BSONObjBuilder shapeBuilder;
+    {
+        BSONObjBuilder queryBuilder(shapeBuilder.subobjStart("query"));
+        appendFilterShape(findCommand.getFilter(), &queryBuilder);
+    }
+    {
+        BSONObjBuilder sortBuilder(shapeBuilder.subobjStart("sort"));
+        appendSpecShape(findCommand.getSort(), &sortBuilder);
+    }
+    {
+        BSONObjBuilder projectionBuilder(shapeBuilder.subobjStart("projection"));
+        appendSpecShape(findCommand.getProjection(), &projectionBuilder);
+    }
+    if (cq.getCollator()) {
+        shapeBuilder.append("collation", cq.getCollator()->getSpec().toBSON());
+    }
+
+    if (shapeBuilder.len() > QueryShapeStats::kMaxShapeSize) {
+        return BSONObj();
+    }
+    return shapeBuilder.obj();
+}
+
+}  // namespace
+
+QueryShapeStats& QueryShapeStats::get(ServiceContext* serviceContext) {
+    return getQueryShapeStats(serviceContext);
+}
+
+QueryShapeStats::QueryShapeStats()
+    : QueryShapeStats(static_cast<size_t>(internalQueryShapeStatsMaxEntries.load())) {}
+
+QueryShapeStats::QueryShapeStats(size_t maxEntries) : _maxEntries(maxEntries) {
+    // Each partition is given its share of the entries, rounded up, so that it can hold at least
+    // one entry.
+    const size_t maxEntriesPerPartition = std::max<size_t>(
+        (_maxEntries + kNumPartitions - 1) / kNumPartitions, 1);
+    for (size_t i = 0; i < kNumPartitions; ++i) {
+        _partitions.push_back(std::make_unique<Partition>(maxEntriesPerPartition));
+    }
+}
+
+QueryShapeStats::Partition& QueryShapeStats::_getPartition(const std::string& key) const {
+    return *_partitions[std::hash<std::string>{}(key) % kNumPartitions];
+}
+
+std::string QueryShapeStats::registerShape(const CanonicalQuery& cq, Date_t now) {
+    invariant(isEnabled());
+
+    const auto shapeKey = cq.encodeKey();
+
+    // The namespace is separated from the shape by a character which cannot appear in it.
+    std::string key = cq.ns();
+    key.push_back('\0');
+    key.append(shapeKey);
+
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> lk(partition.mutex);
+    if (partition.entries.hasKey(key)) {
+        return key;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->ns = cq.ns();
+    entry->queryHash = canonical_query_encoder::computeHash(shapeKey);
+    entry->shape = makeShape(cq);
+    entry->firstSeen = now;
+    entry->lastExecuted = now;
+
+    // The evicted entry, if any, is destroyed along with the returned pointer.
+    partition.entries.add(key, entry.release());
+    return key;
+}
+
+void QueryShapeStats::recordExecution(const std::string& key,
+                                      const OpDebug& opDebug,
+                                      Microseconds latency,
+                                      bool isGetMore,
+                                      Date_t now) {
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<Latch> lk(partition.mutex);
+
+    Entry* entry;
+    if (!partition.entries.get(key, &entry).isOK()) {
+        return;
+    }
+
+    if (isGetMore) {
+        ++entry->getMoreCount;
+    } else {
+        ++entry->execCount;
+        // An execution whose cached plan was replanned is not considered to be a plan cache hit.
+        if (opDebug.fromPlanCache && !opDebug.replanReason) {
+            ++entry->planCacheHits;
+        }
+    }
+
+    entry->lastExecuted = now;
+    entry->totalExecMicros += durationCount<Microseconds>(latency);
+    entry->docsExamined += opDebug.additiveMetrics.docsExamined.value_or(0);
+    entry->keysExamined += opDebug.additiveMetrics.keysExamined.value_or(0);
+    entry->nReturned += std::max(opDebug.nreturned, 0LL);
+    ++entry->latencyBuckets[getLatencyBucket(latency)];
+}
+
+BSONObj QueryShapeStats::Entry::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("ns", ns);
+    builder.append("queryHash", zeroPaddedHex(queryHash));
+    if (!shape.isEmpty()) {
+        builder.append("shape", shape);
+    }
+    builder.append("firstSeen", firstSeen);
+    builder.append("lastExecuted", lastExecuted);
+    builder.append("execCount", execCount);
+    builder.append("getMoreCount", getMoreCount);
+    builder.append("totalExecMicros", totalExecMicros);
+    builder.append("docsExamined", docsExamined);
+    builder.append("keysExamined", keysExamined);
+    builder.append("nReturned", nReturned);
+    builder.append("planCacheHits", planCacheHits);
+
+    BSONArrayBuilder histogramBuilder(builder.subarrayStart("latencyHistogram"));
+    for (size_t i = 0; i < latencyBuckets.size(); ++i) {
+        if (latencyBuckets[i] == 0) {
+            continue;
+        }
+        BSONObjBuilder bucketBuilder(histogramBuilder.subobjStart());
+        bucketBuilder.append("micros",
+                             static_cast<long long>(OperationLatencyHistogram::kLowerBounds[i]));
+        bucketBuilder.append("count", latencyBuckets[i]);
+    }
+    histogramBuilder.doneFast();
+
+    return builder.obj();
+}
+
+std::vector<BSONObj> QueryShapeStats::getStats() const {
+    std::vector<BSONObj> stats;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> lk(partition->mutex);
+        for (auto&& [key, entry] : partition->entries) {
+            stats.push_back(entry->toBSON());
+        }
+    }
+    return stats;
+}
+
+size_t QueryShapeStats::size() const {
+    size_t size = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> lk(partition->mutex);
+        size += partition->entries.size();
+    }
+    return size;
+}
+
+void QueryShapeStats::clear() {
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<Latch> lk(partition->mutex);
+        partition->entries.clear();
+    }
+}
+
+}  // namespace mongo
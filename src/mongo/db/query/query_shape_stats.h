@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+class CanonicalQuery;
+class OpDebug;
+class ServiceContext;
+
+/**
+ * A process-wide store of execution statistics aggregated per query shape, which makes it possible
+ * to find the shapes consuming the most resources without enabling the profiler.
+ *
+ * Shapes are identified by the namespace and the stable key of the query computed by the
+ * canonical_query_encoder, that is the part of the plan cache key which does not depend on the
+ * indexes of the collection. The statistics of a shape are the number of operations which ran it,
+ * a histogram of their latencies, the documents and keys examined, the documents returned and the
+ * number of executions which used a plan from the plan cache without replanning. The getMore
+ * operations of a cursor are attributed to the shape of the operation which created the cursor.
+ *
+ * The store is partitioned by the hash of the key into 'kNumPartitions' partitions, each guarded
+ * by its own mutex and holding at most its share of 'internalQueryShapeStatsMaxEntries' entries.
+ * The least recently used shapes of a partition are evicted when it is full.
+ *
+ * This class is thread-safe.
+ */
+class QueryShapeStats {
+    QueryShapeStats(const QueryShapeStats&) = delete;
+    QueryShapeStats& operator=(const QueryShapeStats&) = delete;
+
+public:
+    static constexpr size_t kNumPartitions = 16;
+    static constexpr int kMaxShapeSize = 4 * 1024;
+
+    static QueryShapeStats& get(ServiceContext* serviceContext);
+
+    /**
+     * Constructs a store holding at most 'internalQueryShapeStatsMaxEntries' shapes.
+     */
+    QueryShapeStats();
+
+    explicit QueryShapeStats(size_t maxEntries);
+
+    bool isEnabled() const {
+        return _maxEntries > 0;
+    }
+
+    /**
+     * Creates an entry for the shape of 'cq' unless there is one already, and returns the key
+     * under which the executions of the shape are to be recorded. The shape is reported with the
+     * paths and operators of the query, sort, projection and collation of its first query, and
+     * every literal replaced by a placeholder naming its type, e.g. {a: {$gte: '?int'}}. A shape
+     * larger than 'kMaxShapeSize' bytes is only reported through its hash.
+     */
+    std::string registerShape(const CanonicalQuery& cq, Date_t now);
+
+    /**
+     * Adds the execution of the operation described by 'opDebug', which took 'latency', to the
+     * statistics of the shape registered under 'key'. A getMore operation is accounted for in the
+     * totals of the shape but does not count as an execution. Does nothing if the shape has been
+     * evicted since it was registered.
+     */
+    void recordExecution(const std::string& key,
+                         const OpDebug& opDebug,
+                         Microseconds latency,
+                         bool isGetMore,
+                         Date_t now);
+
+    /**
+     * Returns a document describing the statistics of each shape in the store.
+     */
+    std::vector<BSONObj> getStats() const;
+
+    size_t size() const;
+
+    void clear();
+
+private:
+    struct Entry {
+        BSONObj toBSON() const;
+
+        std::string ns;
+        uint32_t queryHash;
+        // Empty if the shape is larger than 'kMaxShapeSize'.
+        BSONObj shape;
+        Date_t firstSeen;
+        Date_t lastExecuted;
+
+        long long execCount = 0;
+        long long getMoreCount = 0;
+        long long totalExecMicros = 0;
+        long long docsExamined = 0;
+        long long keysExamined = 0;
+        long long nReturned = 0;
+        long long planCacheHits = 0;
+
+        // Counts of operations per latency bucket, using the bucket bounds of the latency
+        // histograms reported by $collStats.
+        std::array<long long, OperationLatencyHistogram::kMaxBuckets> latencyBuckets{};
+    };
+
+    struct Partition {
+        explicit Partition(size_t maxEntries) : entries(maxEntries) {}
+
+        LRUKeyValue<std::string, Entry> entries;
+
+        // Protects 'entries' and the statistics of the entries.
+        mutable Mutex mutex = MONGO_MAKE_LATCH("QueryShapeStats::Partition::mutex");
+    };
+
+    Partition& _getPartition(const std::string& key) const;
+
+    const size_t _maxEntries;
+
+    std::vector<std::unique_ptr<Partition>> _partitions;
+};
+}  // namespace mongo
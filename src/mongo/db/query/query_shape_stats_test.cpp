@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include "mongo/db/curop.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/canonical_query_encoder.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString nss("testdb.testcoll");
+
+std::unique_ptr<CanonicalQuery> canonicalize(const NamespaceString& ns, const char* queryStr) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    auto findCommand = std::make_unique<FindCommandRequest>(ns);
+    findCommand->setFilter(fromjson(queryStr));
+    auto statusWithCQ = CanonicalQuery::canonicalize(opCtx.get(), std::move(findCommand));
+    ASSERT_OK(statusWithCQ.getStatus());
+    return std::move(statusWithCQ.getValue());
+}
+
+std::unique_ptr<CanonicalQuery> canonicalize(const char* queryStr) {
+    return canonicalize(nss, queryStr);
+}
+
+TEST(QueryShapeStatsTest, IsDisabledWithoutEntries) {
+    ASSERT_FALSE(QueryShapeStats(0).isEnabled());
+    ASSERT_TRUE(QueryShapeStats(1).isEnabled());
+}
+
+TEST(QueryShapeStatsTest, QueriesOfSameShapeShareAnEntry) {
+    QueryShapeStats stats(100);
+    const auto now = Date_t::fromMillisSinceEpoch(5000);
+
+    auto key = stats.registerShape(*canonicalize("{a: 1, b: 'foo'}"), now);
+    ASSERT_EQ(key, stats.registerShape(*canonicalize("{a: 2, b: 'bar'}"), now));
+    ASSERT_EQ(1U, stats.size());
+
+    ASSERT_NE(key, stats.registerShape(*canonicalize("{a: 1}"), now));
+    ASSERT_NE(key,
+              stats.registerShape(
+                  *canonicalize(NamespaceString("testdb.othercoll"), "{a: 1, b: 'foo'}"), now));
+    ASSERT_EQ(3U, stats.size());
+}
+
+TEST(QueryShapeStatsTest, KeepsFirstQueryAsExample) {
+    QueryShapeStats stats(100);
+    const auto now = Date_t::fromMillisSinceEpoch(5000);
+    auto cq = canonicalize("{a: 1}");
+    stats.registerShape(*cq, now);
+    stats.registerShape(*canonicalize("{a: 2}"), now);
+
+    auto entries = stats.getStats();
+    ASSERT_EQ(1U, entries.size());
+    ASSERT_EQ(nss.ns(), entries[0]["ns"].String());
+    ASSERT_EQ(zeroPaddedHex(canonical_query_encoder::computeHash(cq->encodeKey())),
+              entries[0]["queryHash"].String());
+    ASSERT_BSONOBJ_EQ(fromjson("{query: {a: '?int'}, sort: {}, projection: {}}"),
+                      entries[0]["shape"].Obj());
+    ASSERT_EQ(0, entries[0]["execCount"].numberLong());
+}
+
+TEST(QueryShapeStatsTest, ShapeDoesNotContainLiterals) {
+    QueryShapeStats stats(100);
+    stats.registerShape(
+        *canonicalize("{$or: [{a: {$gte: 1, $lt: 'secret'}}, {b: {c: 'secret'}}], "
+                      "d: {$elemMatch: {e: 'secret', f: {$not: {$in: [1, 2]}}}}}"),
+        Date_t::fromMillisSinceEpoch(5000));
+
+    auto entries = stats.getStats();
+    ASSERT_EQ(1U, entries.size());
+    ASSERT_BSONOBJ_EQ(fromjson("{$or: [{a: {$gte: '?int', $lt: '?string'}}, {b: '?object'}], "
+                               "d: {$elemMatch: {e: '?string', f: {$not: {$in: '?array'}}}}}"),
+                      entries[0]["shape"]["query"].Obj());
+}
+
+TEST(QueryShapeStatsTest, LargeShapeIsOnlyReportedThroughItsHash) {
+    QueryShapeStats stats(100);
+    BSONObjBuilder filterBuilder;
+    for (int i = 0; i < QueryShapeStats::kMaxShapeSize / 8; ++i) {
+        filterBuilder.append(str::stream() << "field" << i, i);
+    }
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+    auto findCommand = std::make_unique<FindCommandRequest>(nss);
+    findCommand->setFilter(filterBuilder.obj());
+    auto cq = uassertStatusOK(CanonicalQuery::canonicalize(opCtx.get(), std::move(findCommand)));
+    stats.registerShape(*cq, Date_t::fromMillisSinceEpoch(5000));
+
+    auto entries = stats.getStats();
+    ASSERT_EQ(1U, entries.size());
+    ASSERT_FALSE(entries[0].hasField("shape"));
+    ASSERT_EQ(zeroPaddedHex(canonical_query_encoder::computeHash(cq->encodeKey())),
+              entries[0]["queryHash"].String());
+}
+
+TEST(QueryShapeStatsTest, AccumulatesExecutionStatistics) {
+    QueryShapeStats stats(100);
+    const auto now = Date_t::fromMillisSinceEpoch(5000);
+    auto key = stats.registerShape(*canonicalize("{a: 1}"), now);
+
+    OpDebug cachedPlanOp;
+    cachedPlanOp.fromPlanCache = true;
+    cachedPlanOp.nreturned = 2;
+    cachedPlanOp.additiveMetrics.keysExamined = 3;
+    cachedPlanOp.additiveMetrics.docsExamined = 2;
+    stats.recordExecution(key, cachedPlanOp, Microseconds(1), false, now);
+
+    OpDebug replannedOp;
+    replannedOp.fromPlanCache = true;
+    replannedOp.replanReason = "replanned";
+    replannedOp.nreturned = 5;
+    replannedOp.additiveMetrics.docsExamined = 100;
+    stats.recordExecution(key, replannedOp, Microseconds(3000), false, now + Seconds(1));
+
+    OpDebug getMoreOp;
+    getMoreOp.nreturned = 10;
+    getMoreOp.additiveMetrics.keysExamined = 10;
+    getMoreOp.additiveMetrics.docsExamined = 10;
+    stats.recordExecution(key, getMoreOp, Microseconds(3500), true, now + Seconds(2));
+
+    auto entries = stats.getStats();
+    ASSERT_EQ(1U, entries.size());
+    const auto& entry = entries[0];
+    ASSERT_EQ(2, entry["execCount"].numberLong());
+    ASSERT_EQ(1, entry["getMoreCount"].numberLong());
+    ASSERT_EQ(1, entry["planCacheHits"].numberLong());
+    ASSERT_EQ(6501, entry["totalExecMicros"].numberLong());
+    ASSERT_EQ(13, entry["keysExamined"].numberLong());
+    ASSERT_EQ(112, entry["docsExamined"].numberLong());
+    ASSERT_EQ(17, entry["nReturned"].numberLong());
+    ASSERT_EQ(now, entry["firstSeen"].date());
+    ASSERT_EQ(now + Seconds(2), entry["lastExecuted"].date());
+    ASSERT_BSONOBJ_EQ(fromjson("{latencyHistogram: [{micros: 0, count: 1}, "
+                               "{micros: 2048, count: 1}, {micros: 3072, count: 1}]}"),
+                      BSON("latencyHistogram" << entry["latencyHistogram"]));
+}
+
+TEST(QueryShapeStatsTest, EvictsLeastRecentlyUsedShapes) {
+    QueryShapeStats stats(QueryShapeStats::kNumPartitions);
+    const auto now = Date_t::fromMillisSinceEpoch(5000);
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i) {
+        auto query = BSON(("f" + std::to_string(i)) << 1);
+        keys.push_back(stats.registerShape(*canonicalize(tojson(query).c_str()), now));
+    }
+    ASSERT_LTE(stats.size(), QueryShapeStats::kNumPartitions);
+
+    // Recording the execution of an evicted shape does nothing.
+    for (auto&& key : keys) {
+        stats.recordExecution(key, OpDebug{}, Microseconds(1), false, now);
+    }
+    long long execCount = 0;
+    for (auto&& entry : stats.getStats()) {
+        execCount += entry["execCount"].numberLong();
+    }
+    ASSERT_EQ(static_cast<long long>(stats.size()), execCount);
+
+    stats.clear();
+    ASSERT_EQ(0U, stats.size());
+}
+
+}  // namespace
+}  // namespace mongo
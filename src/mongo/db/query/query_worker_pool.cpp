@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_worker_pool.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/static_immortal.h"
+
+namespace mongo {
+namespace {
+/**
+ * The threads of the pool are only started once needed, and the pool is created on first use so
+ * that it is sized by the value the knob was given at startup.
+ */
+struct Pool {
+    Pool() : maxThreads(static_cast<size_t>(internalQueryWorkerPoolMaxThreads)) {
+        ThreadPool::Options options;
+        options.poolName = "query worker pool";
+        options.threadNamePrefix = "QueryWorker";
+        options.minThreads = 0;
+        options.maxThreads = maxThreads;
+        options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+        threadPool = std::make_unique<ThreadPool>(options);
+        threadPool->startup();
+    }
+
+    const size_t maxThreads;
+    AtomicWord<size_t> numReservedThreads{0};
+    std::unique_ptr<ThreadPool> threadPool;
+};
+
+Pool& getPool() {
+    static StaticImmortal<Pool> pool;
+    return *pool;
+}
+}  // namespace
+
+QueryWorkerPool::Reservation::Reservation(Reservation&& other)
+    : _numThreads(std::exchange(other._numThreads, 0)) {}
+
+QueryWorkerPool::Reservation& QueryWorkerPool::Reservation::operator=(Reservation&& other) {
+    if (this != &other) {
+        getPool().numReservedThreads.subtractAndFetch(_numThreads);
+        _numThreads = std::exchange(other._numThreads, 0);
+    }
+    return *this;
+}
+
+QueryWorkerPool::Reservation::~Reservation() {
+    if (_numThreads > 0) {
+        getPool().numReservedThreads.subtractAndFetch(_numThreads);
+    }
+}
+
+void QueryWorkerPool::Reservation::schedule(ThreadPool::Task task) {
+    invariant(_numThreads > 0);
+    getPool().threadPool->schedule(std::move(task));
+}
+
+boost::optional<QueryWorkerPool::Reservation> QueryWorkerPool::tryReserve(size_t numThreads) {
+    auto& pool = getPool();
+    auto numReserved = pool.numReservedThreads.load();
+    do {
+        if (numReserved + numThreads > pool.maxThreads) {
+            return boost::none;
+        }
+    } while (!pool.numReservedThreads.compareAndSwap(&numReserved, numReserved + numThreads));
+    return Reservation(numThreads);
+}
+
+}  // namespace mongo
@@ -0,0 +1,89 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstddef>
+#include <utility>
+
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+/**
+ * The pool of threads on which queries, aggregations and index builds do work in parallel. It
+ * has at most 'internalQueryWorkerPoolMaxThreads' threads, shared by all of them.
+ *
+ * Work is only ever scheduled on threads reserved for it beforehand, so that it never waits for
+ * a thread to become available. Parallel work often waits on the thread which scheduled it, or on
+ * the other tasks it was scheduled with, and queuing it behind other such work could deadlock.
+ * Callers which cannot reserve the threads they would like do their work on their own thread.
+ */
+class QueryWorkerPool {
+public:
+    /**
+     * A number of threads of the pool, reserved until the reservation is destroyed. At most that
+     * many tasks scheduled through the reservation may be running or queued at any time.
+     */
+    class Reservation {
+    public:
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+
+        Reservation(Reservation&& other);
+        Reservation& operator=(Reservation&& other);
+
+        ~Reservation();
+
+        size_t numThreads() const {
+            return _numThreads;
+        }
+
+        /**
+         * Schedules 'task' on one of the reserved threads.
+         */
+        void schedule(ThreadPool::Task task);
+
+    private:
+        friend class QueryWorkerPool;
+
+        explicit Reservation(size_t numThreads) : _numThreads(numThreads) {}
+
+        size_t _numThreads;
+    };
+
+    /**
+     * Reserves 'numThreads' threads of the pool, or returns boost::none if fewer than that are
+     * left unreserved.
+     */
+    static boost::optional<Reservation> tryReserve(size_t numThreads);
+};
+
+}  // namespace mongo
@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_worker_pool.h"
+
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/future.h"
+
+namespace mongo {
+namespace {
+
+class QueryWorkerPoolTest : public ServiceContextTest {};
+
+TEST_F(QueryWorkerPoolTest, ReservesNoMoreThreadsThanThePoolHas) {
+    const size_t maxThreads = internalQueryWorkerPoolMaxThreads;
+
+    auto all = QueryWorkerPool::tryReserve(maxThreads);
+    ASSERT(all);
+    ASSERT_EQ(all->numThreads(), maxThreads);
+    ASSERT_FALSE(QueryWorkerPool::tryReserve(1));
+
+    all.reset();
+    auto some = QueryWorkerPool::tryReserve(maxThreads - 1);
+    ASSERT(some);
+    ASSERT(QueryWorkerPool::tryReserve(1));
+    ASSERT_FALSE(QueryWorkerPool::tryReserve(2));
+}
+
+TEST_F(QueryWorkerPoolTest, MovedReservationKeepsItsThreads) {
+    const size_t maxThreads = internalQueryWorkerPoolMaxThreads;
+
+    auto reservation = QueryWorkerPool::tryReserve(maxThreads);
+    ASSERT(reservation);
+    auto moved = std::move(*reservation);
+    reservation.reset();
+    ASSERT_EQ(moved.numThreads(), maxThreads);
+    ASSERT_FALSE(QueryWorkerPool::tryReserve(1));
+
+    auto other = QueryWorkerPool::tryReserve(0);
+    ASSERT(other);
+    moved = std::move(*other);
+    ASSERT(QueryWorkerPool::tryReserve(maxThreads));
+}
+
+TEST_F(QueryWorkerPoolTest, RunsScheduledTasks) {
+    auto reservation = QueryWorkerPool::tryReserve(2);
+    ASSERT(reservation);
+
+    std::vector<Future<void>> futures;
+    AtomicWord<int> numRun{0};
+    for (int i = 0; i < 2; ++i) {
+        auto pf = makePromiseFuture<void>();
+        futures.push_back(std::move(pf.future));
+        reservation->schedule([&, promise = std::move(pf.promise)](auto status) mutable {
+            ASSERT_OK(status);
+            numRun.addAndFetch(1);
+            promise.emplaceValue();
+        });
+    }
+
+    for (auto& future : futures) {
+        future.get();
+    }
+    ASSERT_EQ(numRun.load(), 2);
+}
+
+}  // namespace
+}  // namespace mongo
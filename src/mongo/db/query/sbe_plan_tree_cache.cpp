@@ -0,0 +1,310 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_plan_tree_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "mongo/base/init.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sbe_plan_tree_cache_parameter.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+#include "mongo/db/query/sbe_stage_builder_index_scan.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo::sbe {
+namespace {
+
+const auto getPlanTreeCache = ServiceContext::declareDecoration<PlanTreeCache>();
+
+Counter64 planTreeCacheHits;
+Counter64 planTreeCacheMisses;
+
+ServerStatusMetricField<Counter64> planTreeCacheHitsMetric("query.planTreeCache.hits",
+                                                           &planTreeCacheHits);
+ServerStatusMetricField<Counter64> planTreeCacheMissesMetric("query.planTreeCache.misses",
+                                                             &planTreeCacheMisses);
+
+bool isCacheableNode(const QuerySolutionNode* node) {
+    switch (node->getType()) {
+        case STAGE_IXSCAN:
+            return !static_cast<const IndexScanNode*>(node)->filter;
+        case STAGE_FETCH:
+            return !static_cast<const FetchNode*>(node)->filter;
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_PROJECTION_COVERED:
+            break;
+        default:
+            return false;
+    }
+
+    return std::all_of(node->children.begin(), node->children.end(), isCacheableNode);
+}
+
+void collectIndexScanNodes(const QuerySolutionNode* node,
+                           std::vector<const IndexScanNode*>* indexScans) {
+    if (node->getType() == STAGE_IXSCAN) {
+        indexScans->push_back(static_cast<const IndexScanNode*>(node));
+    }
+
+    for (auto&& child : node->children) {
+        collectIndexScanNodes(child, indexScans);
+    }
+}
+
+std::vector<const IndexScanNode*> getIndexScanNodes(const QuerySolution& solution) {
+    std::vector<const IndexScanNode*> indexScans;
+    collectIndexScanNodes(solution.root(), &indexScans);
+    return indexScans;
+}
+
+/**
+ * Encodes everything the stage builder takes from the nodes of a cacheable query solution, apart
+ * from the index bounds and what is already encoded in the shape of the query.
+ */
+void encodeSolutionShape(const QuerySolutionNode* node, StringBuilder* keyBuilder) {
+    *keyBuilder << '(' << static_cast<int>(node->getType());
+    if (node->getType() == STAGE_IXSCAN) {
+        auto ixn = static_cast<const IndexScanNode*>(node);
+        const auto& indexName = ixn->index.identifier.catalogName;
+        *keyBuilder << ' ' << indexName.size() << ':' << indexName << ' ' << ixn->direction << ' '
+                    << ixn->shouldDedup << ' ' << ixn->addKeyMetadata;
+    }
+
+    for (auto&& child : node->children) {
+        encodeSolutionShape(child, keyBuilder);
+    }
+    *keyBuilder << ')';
+}
+
+/**
+ * Returns a copy of 'data' which refers to the runtime environment 'env'.
+ */
+stage_builder::PlanStageData copyPlanStageData(const stage_builder::PlanStageData& data,
+                                               std::unique_ptr<RuntimeEnvironment> env) {
+    stage_builder::PlanStageData copy{std::move(env)};
+    copy.outputs = data.outputs;
+    copy.iamMap = data.iamMap;
+    copy.shouldTrackLatestOplogTimestamp = data.shouldTrackLatestOplogTimestamp;
+    copy.shouldTrackResumeToken = data.shouldTrackResumeToken;
+    copy.shouldUseTailableScan = data.shouldUseTailableScan;
+    return copy;
+}
+
+/**
+ * Binds the slots of 'env' which hold query constants to the values of the query 'cq' and its
+ * query solution 'solution'. Returns false if some of the values cannot be bound, in which case
+ * the plan tree using 'env' cannot execute the query.
+ */
+bool bindParameters(OperationContext* opCtx,
+                    const CollectionPtr& collection,
+                    const CanonicalQuery& cq,
+                    const QuerySolution& solution,
+                    RuntimeEnvironment* env) {
+    for (auto&& ixn : getIndexScanNodes(solution)) {
+        auto bounds = stage_builder::makeIndexBoundsArray(opCtx, collection, ixn);
+        if (!bounds) {
+            return false;
+        }
+
+        auto slot = env->getSlot(stage_builder::makeIndexBoundsSlotName(ixn->nodeId()));
+        env->resetSlot(slot, bounds->first, bounds->second, true);
+    }
+
+    // These slots are registered by 'makeRuntimeEnvironment()'.
+    if (auto slot = env->getSlotIfExists("collator"_sd); slot) {
+        env->resetSlot(*slot,
+                       value::TypeTags::collator,
+                       value::bitcastFrom<const CollatorInterface*>(cq.getCollator()),
+                       false);
+    }
+
+    const auto& variables = cq.getExpCtx()->variables;
+    for (auto&& [id, name] : Variables::kIdToBuiltinVarName) {
+        if (auto slot = env->getSlotIfExists(name); slot) {
+            if (variables.hasValue(id)) {
+                auto [tag, val] = stage_builder::makeValue(variables.getValue(id));
+                env->resetSlot(*slot, tag, val, true);
+            } else {
+                env->resetSlot(*slot, value::TypeTags::Nothing, 0, false);
+            }
+        }
+    }
+
+    return true;
+}
+
+MONGO_INITIALIZER(SetPlanTreeCacheMaxEntriesUpdater)(InitializerContext*) {
+    setPlanTreeCacheMaxEntriesUpdater([](int maxEntries) {
+        if (hasGlobalServiceContext()) {
+            PlanTreeCache::get(getGlobalServiceContext())
+                .setMaxEntries(static_cast<size_t>(std::max(maxEntries, 0)));
+        }
+    });
+}
+}  // namespace
+
+PlanTreeCache& PlanTreeCache::get(ServiceContext* serviceContext) {
+    return getPlanTreeCache(serviceContext);
+}
+
+PlanTreeCache::PlanTreeCache() : _cache(std::numeric_limits<size_t>::max()) {}
+
+bool PlanTreeCache::isEnabled() const {
+    return internalQuerySlotBasedPlanTreeCacheMaxEntries.load() > 0;
+}
+
+bool PlanTreeCache::isCacheable(const QuerySolution& solution) {
+    return solution.root() && isCacheableNode(solution.root());
+}
+
+std::string PlanTreeCache::computeKey(const CollectionPtr& collection,
+                                      const CanonicalQuery& cq,
+                                      const QuerySolution& solution) {
+    StringBuilder keyBuilder;
+    keyBuilder << collection->uuid().toString() << ' '
+               << CollectionQueryInfo::get(collection).getPlanCache()->getGeneration() << ' ';
+    encodeSolutionShape(solution.root(), &keyBuilder);
+    keyBuilder << ' ' << cq.encodeKey();
+    return keyBuilder.str();
+}
+
+boost::optional<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>>
+PlanTreeCache::lookup(OperationContext* opCtx,
+                      const CollectionPtr& collection,
+                      const CanonicalQuery& cq,
+                      const QuerySolution& solution,
+                      PlanYieldPolicySBE* yieldPolicy,
+                      const std::string& key) {
+    std::shared_ptr<const Entry> entry;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        std::shared_ptr<const Entry>* found;
+        if (_cache.get(key, &found).isOK()) {
+            entry = *found;
+        }
+    }
+
+    auto isUsable = [&] {
+        if (!entry) {
+            return false;
+        }
+
+        // The fetch stages of the cached tree have the access methods of the indexes they check
+        // the consistency of the index keys against bound in, so they must still be current.
+        for (auto&& [indexName, accessMethod] : entry->data.iamMap) {
+            auto descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
+            if (!descriptor ||
+                collection->getIndexCatalog()->getEntry(descriptor)->accessMethod() !=
+                    accessMethod) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!isUsable()) {
+        planTreeCacheMisses.increment();
+        return boost::none;
+    }
+
+    auto env = entry->data.env->makeDeepCopy();
+    if (!bindParameters(opCtx, collection, cq, solution, env.get())) {
+        planTreeCacheMisses.increment();
+        return boost::none;
+    }
+
+    auto root = entry->root->clone();
+    root->setYieldPolicy(yieldPolicy);
+
+    planTreeCacheHits.increment();
+    return std::make_pair(std::move(root), copyPlanStageData(entry->data, std::move(env)));
+}
+
+void PlanTreeCache::add(const QuerySolution& solution,
+                        const PlanStage& root,
+                        const stage_builder::PlanStageData& data,
+                        const std::string& key) {
+    // A tree with an index scan whose bounds were embedded as constants can only execute the
+    // query it was built for.
+    for (auto&& ixn : getIndexScanNodes(solution)) {
+        if (!data.env->getSlotIfExists(stage_builder::makeIndexBoundsSlotName(ixn->nodeId()))) {
+            return;
+        }
+    }
+
+    auto entry = std::make_shared<const Entry>(
+        Entry{root.clone(), copyPlanStageData(data, data.env->makeDeepCopy())});
+
+    // The size of the cache is read on every insertion, as it can be changed at runtime.
+    // Destroy the evicted entries, if any, only once the lock has been released.
+    const auto maxEntries =
+        static_cast<size_t>(std::max(internalQuerySlotBasedPlanTreeCacheMaxEntries.load(), 0));
+    std::vector<std::shared_ptr<const Entry>> evictedEntries;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _cache.add(key, new std::shared_ptr<const Entry>(std::move(entry)));
+        _evict(lk, maxEntries, &evictedEntries);
+    }
+}
+
+void PlanTreeCache::setMaxEntries(size_t maxEntries) {
+    std::vector<std::shared_ptr<const Entry>> evictedEntries;
+    stdx::lock_guard<Latch> lk(_mutex);
+    _evict(lk, maxEntries, &evictedEntries);
+}
+
+void PlanTreeCache::_evict(WithLock,
+                           size_t maxEntries,
+                           std::vector<std::shared_ptr<const Entry>>* evictedEntries) {
+    while (_cache.size() > maxEntries) {
+        const auto oldest = *std::prev(_cache.end());
+        evictedEntries->push_back(*oldest.second);
+        invariant(_cache.remove(oldest.first).isOK());
+    }
+}
+
+size_t PlanTreeCache::size() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _cache.size();
+}
+
+void PlanTreeCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _cache.clear();
+}
+}  // namespace mongo::sbe
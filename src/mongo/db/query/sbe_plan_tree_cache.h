@@ -0,0 +1,162 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+
+namespace mongo {
+class CollectionPtr;
+class ServiceContext;
+
+namespace sbe {
+/**
+ * A process-wide cache of SBE plan trees whose query constants are held in runtime environment
+ * slots rather than embedded into the trees. On a cache hit the tree and its runtime environment
+ * are cloned and the slots are bound to the values of the query being executed, which saves
+ * building the tree from the query solution.
+ *
+ * Currently the only parameterized constants are index bounds which can be decomposed into single
+ * intervals, so only trees built from index scans and fetches without filters, and from simple or
+ * covered projections, are cached. Filters are not parameterized, as the code generated for them
+ * depends on the types of the constants they compare with. As collection scans are not cached,
+ * neither are the trees which scan a collection in parallel.
+ *
+ * The trees are cached before they are prepared, so a cache hit only saves building the tree: the
+ * bytecode of its expressions is still compiled when the clone is prepared.
+ *
+ * Entries are keyed by the collection, the generation of the collection's plan cache, the shape of
+ * the query and the shape of the query solution. As the generation changes whenever the indexes of
+ * the collection or their multikeyness change, stale entries are never looked up again and are
+ * left to be evicted by the LRU policy.
+ *
+ * This class is thread-safe.
+ */
+class PlanTreeCache {
+    PlanTreeCache(const PlanTreeCache&) = delete;
+    PlanTreeCache& operator=(const PlanTreeCache&) = delete;
+
+public:
+    static PlanTreeCache& get(ServiceContext* serviceContext);
+
+    /**
+     * Constructs a cache holding at most 'internalQuerySlotBasedPlanTreeCacheMaxEntries' trees.
+     */
+    PlanTreeCache();
+
+    /**
+     * Returns true if an SBE plan tree built from 'solution' with parameterized index bounds can be
+     * cloned to execute other queries of the same shape.
+     */
+    static bool isCacheable(const QuerySolution& solution);
+
+    /**
+     * Computes the key under which the plan tree built from 'solution' for the query 'cq' is
+     * cached. The 'solution' must be cacheable.
+     */
+    static std::string computeKey(const CollectionPtr& collection,
+                                  const CanonicalQuery& cq,
+                                  const QuerySolution& solution);
+
+    /**
+     * Returns true unless 'internalQuerySlotBasedPlanTreeCacheMaxEntries' is 0.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Looks up the plan tree cached under 'key' and, if there is one, returns a clone of it bound
+     * to the index bounds of 'solution' and to the collator and variables of 'cq', which yields
+     * according to 'yieldPolicy'. Returns boost::none if there is no usable tree for 'key'.
+     *
+     * The returned tree is neither attached to an OperationContext nor prepared.
+     */
+    boost::optional<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>> lookup(
+        OperationContext* opCtx,
+        const CollectionPtr& collection,
+        const CanonicalQuery& cq,
+        const QuerySolution& solution,
+        PlanYieldPolicySBE* yieldPolicy,
+        const std::string& key);
+
+    /**
+     * Caches a copy of the plan tree 'root' and its 'data', built from 'solution' with
+     * parameterized index bounds, under 'key', evicting the least recently used trees beyond the
+     * size of the cache. Does nothing if the bounds of some index scan could not be
+     * parameterized. Must be called before 'root' is attached to an OperationContext.
+     */
+    void add(const QuerySolution& solution,
+             const PlanStage& root,
+             const stage_builder::PlanStageData& data,
+             const std::string& key);
+
+    /**
+     * Evicts the least recently used trees beyond 'maxEntries'. Called when
+     * 'internalQuerySlotBasedPlanTreeCacheMaxEntries' is set, so that a cache which is disabled or
+     * shrunk at runtime does not keep holding the trees it will no longer serve.
+     */
+    void setMaxEntries(size_t maxEntries);
+
+    size_t size() const;
+
+    void clear();
+
+private:
+    struct Entry {
+        std::unique_ptr<PlanStage> root;
+        stage_builder::PlanStageData data;
+    };
+
+    /**
+     * Removes the least recently used entries beyond 'maxEntries' and appends them to
+     * 'evictedEntries', to be destroyed once '_mutex' is released.
+     */
+    void _evict(WithLock,
+                size_t maxEntries,
+                std::vector<std::shared_ptr<const Entry>>* evictedEntries);
+
+    // Entries are shared with the lookups cloning them, so that the clones can be made without
+    // holding '_mutex'.
+    LRUKeyValue<std::string, std::shared_ptr<const Entry>> _cache;
+
+    // Protects '_cache'.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("PlanTreeCache::_mutex");
+};
+}  // namespace sbe
+}  // namespace mongo
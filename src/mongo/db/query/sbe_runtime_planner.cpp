@@ -31,13 +31,38 @@
 #include "mongo/db/query/sbe_runtime_planner.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/trial_period_utils.h"
 #include "mongo/db/exec/trial_run_tracker.h"
 #include "mongo/db/query/plan_executor_sbe.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_worker_pool.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/fail_point.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo::sbe {
+MONGO_FAIL_POINT_DEFINE(hangDuringParallelTrial);
+
 namespace {
+// How long the worker threads of a parallel trial run may take to lock the collection before the
+// candidate plans are trialed in turn instead. A worker thread may have to wait behind a pending
+// exclusive lock request, which cannot be granted before the planning operation completes.
+constexpr Milliseconds kParallelTrialSetupTimeout{100};
+
+Counter64 parallelTrialsCounter;
+ServerStatusMetricField<Counter64> parallelTrialsMetric("query.multiPlanner.parallelTrials",
+                                                        &parallelTrialsCounter);
+
+Counter64 parallelTrialsAbandonedCounter;
+ServerStatusMetricField<Counter64> parallelTrialsAbandonedMetric(
+    "query.multiPlanner.parallelTrialsAbandoned", &parallelTrialsAbandonedCounter);
+
 /**
  * Fetches a next document form the given plan stage tree and returns 'true' if the plan stage
  * returns EOF, or throws 'TrialRunTracker::EarlyExitException' exception. Otherwise, the
@@ -78,14 +103,13 @@ bool fetchNextDocument(plan_ranker::CandidatePlan* candidate,
     }
     return false;
 }
-}  // namespace
-
-StatusWith<std::tuple<value::SlotAccessor*, value::SlotAccessor*, bool>>
-BaseRuntimePlanner::prepareExecutionPlan(PlanStage* root,
-                                         stage_builder::PlanStageData* data) const {
-    invariant(root);
-    invariant(data);
 
+/**
+ * Prepares the given plan stage tree for execution and returns the slot accessors for its result
+ * and recordId slots.
+ */
+std::pair<value::SlotAccessor*, value::SlotAccessor*> prepareSlotAccessors(
+    PlanStage* root, stage_builder::PlanStageData* data) {
     root->prepare(data->ctx);
 
     value::SlotAccessor* resultSlot{nullptr};
@@ -100,17 +124,305 @@ BaseRuntimePlanner::prepareExecutionPlan(PlanStage* root,
         tassert(4822872, "Query does not have a recordId slot.", recordIdSlot);
     }
 
-    auto exitedEarly{false};
+    return {resultSlot, recordIdSlot};
+}
+
+/**
+ * Opens the given prepared plan stage tree and returns whether it has exited early from the trial
+ * period, or a non-OK status if it has failed in a recoverable fashion.
+ */
+StatusWith<bool> openExecutionPlan(PlanStage* root) {
     try {
         root->open(false);
     } catch (const ExceptionFor<ErrorCodes::QueryTrialRunCompleted>&) {
-        exitedEarly = true;
+        return true;
     } catch (const ExceptionFor<ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed>& ex) {
         root->close();
         return ex.toStatus();
     }
+    return false;
+}
+
+/**
+ * The state shared by the planning thread and the worker threads of a parallel trial run. Every
+ * worker thread first locks the collection, then waits for the planning thread to either start or
+ * abandon the trial run. The trial run starts once all worker threads are ready, and is abandoned
+ * if any of them fails to get ready in time, before any candidate plan has been touched.
+ */
+struct ParallelTrialRun {
+    enum class Phase { kSettingUp, kRunning, kAbandoned };
+
+    /**
+     * Abandons the trial run unless it has already started.
+     */
+    void abandon() {
+        stdx::lock_guard<Latch> lk(mutex);
+        if (phase == Phase::kSettingUp) {
+            phase = Phase::kAbandoned;
+            cv.notify_all();
+        }
+    }
+
+    Mutex mutex = MONGO_MAKE_LATCH("ParallelTrialRun::mutex");
+    stdx::condition_variable cv;
+
+    // Protected by 'mutex'.
+    Phase phase{Phase::kSettingUp};
+    size_t numReady{0};
+    size_t numFinished{0};
+
+    // Set once the trial period of all candidate plans is over.
+    AtomicWord<bool> stop{false};
+
+    // The error each worker thread failed with, if any. Written by the worker threads before they
+    // report that they have finished.
+    std::vector<Status> statuses;
+
+    // The threads of the worker pool the worker threads run on. Every worker thread holds on to the
+    // trial run, so they stay reserved until the last of them has returned, even if the planning
+    // thread abandoned the trial run and moved on while some were still waiting for their locks.
+    boost::optional<QueryWorkerPool::Reservation> workerThreads;
+};
+
+bool isKillPending(OperationContext* opCtx) {
+    stdx::lock_guard<Client> lk(*opCtx->getClient());
+    return opCtx->isKillPending();
+}
+
+/**
+ * Executes the given candidate plan, already attached to the worker thread's operation context,
+ * until it hits EOF, returns 'maxNumResults' documents, fails or exits early, or until the trial
+ * run is stopped by another candidate plan or the planning operation is interrupted.
+ */
+void runCandidateTrial(plan_ranker::CandidatePlan* candidate,
+                       const std::pair<value::SlotAccessor*, value::SlotAccessor*>& slots,
+                       size_t maxNumResults,
+                       ParallelTrialRun* trialRun,
+                       OperationContext* planningOpCtx) {
+    auto status = openExecutionPlan(candidate->root.get());
+    if (!status.isOK()) {
+        candidate->status = status.getStatus();
+        return;
+    }
+
+    // As when trialing the candidate plans in turn, a plan which exits early while being opened
+    // leaves the other plans to complete their trial period.
+    candidate->exitedEarly = status.getValue();
+    if (candidate->exitedEarly) {
+        return;
+    }
+
+    for (size_t it = 0; it < maxNumResults; ++it) {
+        if (trialRun->stop.load()) {
+            return;
+        }
 
-    return std::make_tuple(resultSlot, recordIdSlot, exitedEarly);
+        while (MONGO_unlikely(hangDuringParallelTrial.shouldFail()) &&
+               !isKillPending(planningOpCtx)) {
+            sleepmillis(10);
+        }
+
+        if (isKillPending(planningOpCtx)) {
+            return;
+        }
+
+        if (fetchNextDocument(candidate, slots)) {
+            break;
+        }
+
+        if (!candidate->status.isOK()) {
+            return;
+        }
+    }
+    trialRun->stop.store(true);
+}
+}  // namespace
+
+StatusWith<std::tuple<value::SlotAccessor*, value::SlotAccessor*, bool>>
+BaseRuntimePlanner::prepareExecutionPlan(PlanStage* root,
+                                         stage_builder::PlanStageData* data) const {
+    invariant(root);
+    invariant(data);
+
+    auto [resultSlot, recordIdSlot] = prepareSlotAccessors(root, data);
+    auto exitedEarly = openExecutionPlan(root);
+    if (!exitedEarly.isOK()) {
+        return exitedEarly.getStatus();
+    }
+
+    return std::make_tuple(resultSlot, recordIdSlot, exitedEarly.getValue());
+}
+
+bool BaseRuntimePlanner::trialCandidatesInParallel(
+    std::vector<plan_ranker::CandidatePlan>* candidates,
+    const std::vector<std::pair<value::SlotAccessor*, value::SlotAccessor*>>& slots,
+    const std::vector<TrialRunTracker*>& trackers,
+    size_t maxNumResults) {
+    const auto numCandidates = candidates->size();
+    const auto maxParallelTrials = internalQueryPlanEvaluationMaxParallelTrials.load();
+    if (numCandidates < 2 || numCandidates > static_cast<size_t>(maxParallelTrials) ||
+        !_collection || !_yieldPolicy || _opCtx->inMultiDocumentTransaction() ||
+        _opCtx->lockState()->inAWriteUnitOfWork()) {
+        return false;
+    }
+
+    // The worker threads read from the same point in time as the planning operation, if it reads
+    // at a timestamp. Otherwise moving a plan to the planning operation after its trial is
+    // equivalent to a yield, which only queries allowed to yield can go through.
+    auto recoveryUnit = _opCtx->recoveryUnit();
+    const auto readTimestamp = recoveryUnit->getPointInTimeReadTimestamp(_opCtx);
+    if (!readTimestamp && !_yieldPolicy->canReleaseLocksDuringExecution()) {
+        return false;
+    }
+
+    auto workerThreads = QueryWorkerPool::tryReserve(numCandidates);
+    if (!workerThreads) {
+        return false;
+    }
+    const auto prepareConflictBehavior = recoveryUnit->getPrepareConflictBehavior();
+    const auto deadline = _opCtx->getDeadline();
+    const auto timeoutError = _opCtx->getTimeoutError();
+    const auto nss = _collection->ns();
+
+    auto trialRun = std::make_shared<ParallelTrialRun>();
+    trialRun->workerThreads = std::move(workerThreads);
+    trialRun->statuses.resize(numCandidates, Status::OK());
+    for (auto&& tracker : trackers) {
+        tracker->setStopFlag(&trialRun->stop);
+    }
+    ON_BLOCK_EXIT([&] {
+        for (auto&& tracker : trackers) {
+            tracker->setStopFlag(nullptr);
+        }
+    });
+
+    for (auto&& candidate : *candidates) {
+        candidate.root->saveState();
+        candidate.root->detachFromOperationContext();
+    }
+
+    auto runWorker = [=, &slots, planningOpCtx = _opCtx](size_t ix) {
+        auto opCtx = cc().makeOperationContext();
+        if (deadline != Date_t::max()) {
+            opCtx->setDeadlineByDate(deadline, timeoutError);
+        }
+        if (readTimestamp) {
+            opCtx->recoveryUnit()->setTimestampReadSource(RecoveryUnit::ReadSource::kProvided,
+                                                          readTimestamp);
+        }
+        opCtx->recoveryUnit()->setPrepareConflictBehavior(prepareConflictBehavior);
+
+        boost::optional<Lock::DBLock> dbLock;
+        boost::optional<Lock::CollectionLock> collLock;
+        try {
+            const auto lockDeadline = Date_t::now() + kParallelTrialSetupTimeout;
+            dbLock.emplace(opCtx.get(), nss.db(), MODE_IS, lockDeadline);
+            collLock.emplace(opCtx.get(), nss, MODE_IS, lockDeadline);
+        } catch (const DBException&) {
+            trialRun->abandon();
+            return;
+        }
+
+        {
+            stdx::unique_lock<Latch> lk(trialRun->mutex);
+            ++trialRun->numReady;
+            trialRun->cv.notify_all();
+            trialRun->cv.wait(
+                lk, [&] { return trialRun->phase != ParallelTrialRun::Phase::kSettingUp; });
+            if (trialRun->phase == ParallelTrialRun::Phase::kAbandoned) {
+                return;
+            }
+        }
+
+        // The trial run has started, so the candidate plans are owned by the worker threads until
+        // they report that they have finished.
+        auto& candidate = (*candidates)[ix];
+        PlanYieldPolicySBE yieldPolicy(PlanYieldPolicy::YieldPolicy::INTERRUPT_ONLY,
+                                       opCtx->getServiceContext()->getFastClockSource(),
+                                       internalQueryExecYieldIterations.load(),
+                                       Milliseconds{internalQueryExecYieldPeriodMS.load()},
+                                       nullptr,
+                                       nullptr);
+        candidate.root->attachToOperationContext(opCtx.get());
+        candidate.root->setYieldPolicy(&yieldPolicy);
+        try {
+            candidate.root->restoreState();
+            runCandidateTrial(&candidate, slots[ix], maxNumResults, trialRun.get(), planningOpCtx);
+        } catch (const DBException& ex) {
+            trialRun->statuses[ix] = ex.toStatus();
+            trialRun->stop.store(true);
+        }
+        candidate.root->saveState();
+        candidate.root->detachFromOperationContext();
+
+        stdx::lock_guard<Latch> lk(trialRun->mutex);
+        ++trialRun->numFinished;
+        trialRun->cv.notify_all();
+    };
+
+    const auto setupDeadline = Date_t::now() + kParallelTrialSetupTimeout;
+    for (size_t ix = 0; ix < numCandidates; ++ix) {
+        trialRun->workerThreads->schedule([trialRun, runWorker, ix](auto status) {
+            if (!status.isOK()) {
+                trialRun->abandon();
+                return;
+            }
+            {
+                stdx::lock_guard<Latch> lk(trialRun->mutex);
+                if (trialRun->phase != ParallelTrialRun::Phase::kSettingUp) {
+                    return;
+                }
+            }
+            runWorker(ix);
+        });
+    }
+
+    bool started = false;
+    {
+        stdx::unique_lock<Latch> lk(trialRun->mutex);
+        trialRun->cv.wait_until(lk, setupDeadline.toSystemTimePoint(), [&] {
+            return trialRun->phase != ParallelTrialRun::Phase::kSettingUp ||
+                trialRun->numReady == numCandidates;
+        });
+        started = trialRun->phase == ParallelTrialRun::Phase::kSettingUp &&
+            trialRun->numReady == numCandidates;
+        trialRun->phase =
+            started ? ParallelTrialRun::Phase::kRunning : ParallelTrialRun::Phase::kAbandoned;
+        trialRun->cv.notify_all();
+
+        // The worker threads are bounded by the trial period, and stop once the planning operation
+        // is interrupted, so there is no need to interrupt this wait.
+        if (started) {
+            trialRun->cv.wait(lk, [&] { return trialRun->numFinished == numCandidates; });
+        }
+    }
+
+    // The worker threads opened their snapshots after the planning operation did. Unless they all
+    // read at the timestamp of the planning operation, it must not go back to its older snapshot
+    // and continue the plans from where newer snapshots left them, so it gets a new one as it would
+    // after a yield.
+    if (started && !readTimestamp) {
+        recoveryUnit->abandonSnapshot();
+    }
+
+    // Hand the candidate plans back to the planning operation.
+    for (auto&& candidate : *candidates) {
+        candidate.root->attachToOperationContext(_opCtx);
+        candidate.root->setYieldPolicy(_yieldPolicy);
+        candidate.root->restoreState();
+    }
+
+    if (!started) {
+        parallelTrialsAbandonedCounter.increment();
+        return false;
+    }
+
+    parallelTrialsCounter.increment();
+    for (auto&& status : trialRun->statuses) {
+        uassertStatusOK(status);
+    }
+    _opCtx->checkForInterrupt();
+    return true;
 }
 
 std::vector<plan_ranker::CandidatePlan> BaseRuntimePlanner::collectExecutionStats(
@@ -133,31 +445,35 @@ std::vector<plan_ranker::CandidatePlan> BaseRuntimePlanner::collectExecutionStat
 
     const auto maxNumResults{trial_period::getTrialPeriodNumToReturn(_cq)};
 
+    std::vector<TrialRunTracker*> trackers;
     for (size_t ix = 0; ix < roots.size(); ++ix) {
         auto&& [root, data] = roots[ix];
 
         // Attach a unique TrialRunTracker to each SBE plan.
         auto tracker = std::make_unique<TrialRunTracker>(maxNumResults, maxTrialPeriodNumReads);
         root->attachToTrialRunTracker(tracker.get());
+        trackers.push_back(tracker.get());
         trialRunTrackers.emplace_back(root.get(), std::move(tracker));
 
-        auto status = prepareExecutionPlan(root.get(), &data);
-        auto [resultSlot, recordIdSlot, exitedEarly] =
-            [&]() -> std::tuple<value::SlotAccessor*, value::SlotAccessor*, bool> {
-            if (status.isOK()) {
-                return status.getValue();
-            }
+        slots.push_back(prepareSlotAccessors(root.get(), &data));
+        candidates.push_back(
+            {std::move(solutions[ix]), std::move(root), std::move(data), false, Status::OK()});
+    }
+
+    if (trialCandidatesInParallel(&candidates, slots, trackers, maxNumResults)) {
+        return candidates;
+    }
+
+    for (auto&& candidate : candidates) {
+        auto status = openExecutionPlan(candidate.root.get());
+        if (status.isOK()) {
+            candidate.exitedEarly = status.getValue();
+        } else {
             // The candidate plan returned a failure that is not fatal to the execution of the
             // query, as long as we have other candidates that haven't failed. We will mark the
             // candidate as failed and keep preparing any remaining candidate plans.
-            return {};
-        }();
-        candidates.push_back({std::move(solutions[ix]),
-                              std::move(root),
-                              std::move(data),
-                              exitedEarly,
-                              status.getStatus()});
-        slots.push_back({resultSlot, recordIdSlot});
+            candidate.status = status.getStatus();
+        }
     }
 
     auto done{false};
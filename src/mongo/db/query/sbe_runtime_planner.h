@@ -31,6 +31,7 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/trial_run_tracker.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/plan_yield_policy_sbe.h"
 #include "mongo/db/query/query_solution.h"
@@ -107,6 +108,10 @@ protected:
      *
      * The number of reads allowed for a trial execution period is bounded by
      * 'maxTrialPeriodNumReads'.
+     *
+     * If internalQueryPlanEvaluationMaxParallelTrials allows, the plans are executed concurrently
+     * instead, each on a worker thread until any of them hits EOF or returns the pre-defined number
+     * of results.
      */
     std::vector<plan_ranker::CandidatePlan> collectExecutionStats(
         std::vector<std::unique_ptr<QuerySolution>> solutions,
@@ -117,5 +122,23 @@ protected:
     const CollectionPtr& _collection;
     const CanonicalQuery& _cq;
     PlanYieldPolicySBE* const _yieldPolicy;
+
+private:
+    /**
+     * Executes each of the prepared, but not yet opened, 'candidates' on a worker thread of its
+     * own, with an operation context of its own reading at the same timestamp as '_opCtx'. If
+     * '_opCtx' does not read at a timestamp, it abandons its snapshot once the candidates are
+     * handed back, as after a yield. Stops all of them as soon as any hits EOF, returns
+     * 'maxNumResults' documents or exits early.
+     *
+     * Returns false without executing any plan if the candidates cannot be trialed concurrently,
+     * e.g. because the query worker pool has too few threads left or a worker thread could not
+     * lock the collection in time.
+     */
+    bool trialCandidatesInParallel(
+        std::vector<plan_ranker::CandidatePlan>* candidates,
+        const std::vector<std::pair<value::SlotAccessor*, value::SlotAccessor*>>& slots,
+        const std::vector<TrialRunTracker*>& trackers,
+        size_t maxNumResults);
 };
 }  // namespace mongo::sbe
@@ -633,7 +633,9 @@ SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
                                              const CanonicalQuery& cq,
                                              const QuerySolution& solution,
                                              PlanYieldPolicySBE* yieldPolicy,
-                                             ShardFiltererFactoryInterface* shardFiltererFactory)
+                                             ShardFiltererFactoryInterface* shardFiltererFactory,
+                                             bool parameterizeIndexBounds,
+                                             bool allowParallelScan)
     : StageBuilder(opCtx, collection, cq, solution),
       _yieldPolicy(yieldPolicy),
       _data(makeRuntimeEnvironment(_cq, _opCtx, &_slotIdGenerator)),
@@ -644,6 +646,10 @@ SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
              &_slotIdGenerator,
              &_frameIdGenerator,
              &_spoolIdGenerator) {
+    _state.parameterizeIndexBounds = parameterizeIndexBounds;
+    _state.allowParallelScan = allowParallelScan;
+    _state.allowDiskUse = _cq.getExpCtx()->allowDiskUse;
+
     // SERVER-52803: In the future if we need to gather more information from the QuerySolutionNode
     // tree, rather than doing one-off scans for each piece of information, we should add a formal
     // analysis pass here.
@@ -696,8 +702,17 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
 
     auto csn = static_cast<const CollectionScanNode*>(root);
 
-    auto [stage, outputs] = generateCollScan(
-        _state, _collection, csn, _yieldPolicy, reqs.getIsTailableCollScanResumeBranch());
+    // A parallel scan returns the documents in no particular order, which is not an option if the
+    // query asks for them in natural order.
+    const bool allowParallelScan = _state.allowParallelScan &&
+        !_cq.getFindCommandRequest().getHint()[query_request_helper::kNaturalSortField];
+
+    auto [stage, outputs] = generateCollScan(_state,
+                                             _collection,
+                                             csn,
+                                             _yieldPolicy,
+                                             reqs.getIsTailableCollScanResumeBranch(),
+                                             allowParallelScan);
 
     if (reqs.has(kReturnKey)) {
         // Assign the 'returnKeySlot' to be the empty object.
@@ -1905,6 +1920,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                         innerCondSlots,
                                                         innerProjectSlots,
                                                         collatorSlot,
+                                                        _cq.getExpCtx()->allowDiskUse,
                                                         root->nodeId());
 
     // If there are more than 2 children, iterate all remaining children and hash
@@ -1927,6 +1943,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                        innerCondSlots,
                                                        innerProjectSlots,
                                                        collatorSlot,
+                                                       _cq.getExpCtx()->allowDiskUse,
                                                        root->nodeId());
     }
 
@@ -262,12 +262,19 @@ public:
     static constexpr StringData kIndexKey = PlanStageSlots::kIndexKey;
     static constexpr StringData kIndexKeyPattern = PlanStageSlots::kIndexKeyPattern;
 
+    /**
+     * If 'parameterizeIndexBounds' is set, the built tree reads the bounds of its index scans from
+     * runtime environment slots where possible, see 'generateIndexScan()'. If 'allowParallelScan'
+     * is set, the tree may split collection scans across several threads, see 'generateCollScan()'.
+     */
     SlotBasedStageBuilder(OperationContext* opCtx,
                           const CollectionPtr& collection,
                           const CanonicalQuery& cq,
                           const QuerySolution& solution,
                           PlanYieldPolicySBE* yieldPolicy,
-                          ShardFiltererFactoryInterface* shardFilterer);
+                          ShardFiltererFactoryInterface* shardFilterer,
+                          bool parameterizeIndexBounds = false,
+                          bool allowParallelScan = false);
 
     std::unique_ptr<sbe::PlanStage> build(const QuerySolutionNode* root) final;
 
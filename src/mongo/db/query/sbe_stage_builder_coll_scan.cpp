@@ -42,6 +42,8 @@
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_worker_pool.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/util/make_data_structure.h"
@@ -615,6 +617,86 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
 
     return {std::move(stage), std::move(outputs)};
 }
+
+/**
+ * Returns true if the collection scan may be split across several threads. The parallel scan only
+ * supports a plain forward scan of a whole collection whose RecordIds are integers. It also cannot
+ * see the writes of a multi-document transaction, as it reads through operation contexts of its
+ * own.
+ */
+bool canUseParallelCollScan(const StageBuilderState& state,
+                            const CollectionPtr& collection,
+                            const CollectionScanNode* csn,
+                            bool isTailableResumeBranch) {
+    return csn->direction == CollectionScanParams::FORWARD && !csn->tailable &&
+        !isTailableResumeBranch && !csn->resumeAfterRecordId && !csn->requestResumeToken &&
+        !csn->shouldTrackLatestOplogTimestamp && !csn->shouldWaitForOplogVisibility &&
+        !collection->isCapped() && !collection->isClustered() &&
+        !state.opCtx->inMultiDocumentTransaction();
+}
+
+/**
+ * Generates a collection scan split across the threads of 'workers'. Every thread runs a copy of
+ * the 'pscan' sub-tree, which claims ranges of RecordIds one at a time and scans them through a
+ * cursor of its own. The filter, if any, is applied by the scanning threads as well:
+ *
+ *     exchange [resultSlot, recordIdSlot] degree round
+ *         filter {...}
+ *         pscan resultSlot recordIdSlot [] @uuid
+ */
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateParallelCollScan(
+    StageBuilderState& state,
+    const CollectionPtr& collection,
+    const CollectionScanNode* csn,
+    PlanYieldPolicy* yieldPolicy,
+    QueryWorkerPool::Reservation workers) {
+    const auto degree = workers.numThreads();
+    auto resultSlot = state.slotId();
+    auto recordIdSlot = state.slotId();
+
+    // The scanning threads do not yield themselves. They are paused whenever the exchange yields,
+    // so only the exchange is given the yield policy of the query.
+    std::unique_ptr<sbe::PlanStage> stage =
+        sbe::makeS<sbe::ParallelScanStage>(collection->uuid(),
+                                           resultSlot,
+                                           recordIdSlot,
+                                           boost::none /* snapshotIdSlot */,
+                                           boost::none /* indexIdSlot */,
+                                           boost::none /* indexKeySlot */,
+                                           boost::none /* keyPatternSlot */,
+                                           std::vector<std::string>{},
+                                           sbe::makeSV(),
+                                           nullptr /* yieldPolicy */,
+                                           csn->nodeId(),
+                                           sbe::ScanCallbacks{});
+
+    if (csn->filter) {
+        auto relevantSlots = sbe::makeSV(resultSlot, recordIdSlot);
+
+        auto [_, outputStage] = generateFilter(state,
+                                               csn->filter.get(),
+                                               {std::move(stage), std::move(relevantSlots)},
+                                               resultSlot,
+                                               csn->nodeId());
+        stage = std::move(outputStage.stage);
+    }
+
+    stage = sbe::makeS<sbe::ExchangeConsumer>(std::move(stage),
+                                              degree,
+                                              sbe::makeSV(resultSlot, recordIdSlot),
+                                              sbe::ExchangePolicy::roundrobin,
+                                              nullptr /* partition */,
+                                              nullptr /* orderLess */,
+                                              csn->nodeId(),
+                                              yieldPolicy,
+                                              std::move(workers));
+
+    PlanStageSlots outputs;
+    outputs.set(PlanStageSlots::kResult, resultSlot);
+    outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
+
+    return {std::move(stage), std::move(outputs)};
+}
 }  // namespace
 
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -622,12 +704,24 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     const CollectionPtr& collection,
     const CollectionScanNode* csn,
     PlanYieldPolicy* yieldPolicy,
-    bool isTailableResumeBranch) {
+    bool isTailableResumeBranch,
+    bool allowParallelScan) {
+    const size_t parallelScanDegree = internalQuerySBEParallelCollectionScanDegree.load();
+
     if (csn->minRecord || csn->maxRecord || csn->stopApplyingFilterAfterFirstMatch) {
         return generateOptimizedOplogScan(
             state, collection, csn, yieldPolicy, isTailableResumeBranch);
-    } else {
-        return generateGenericCollScan(state, collection, csn, yieldPolicy, isTailableResumeBranch);
     }
+
+    if (allowParallelScan && parallelScanDegree > 1 &&
+        canUseParallelCollScan(state, collection, csn, isTailableResumeBranch)) {
+        // The scan stays on this thread if the worker pool is too busy to give it its threads.
+        if (auto workers = QueryWorkerPool::tryReserve(parallelScanDegree)) {
+            return generateParallelCollScan(
+                state, collection, csn, yieldPolicy, std::move(*workers));
+        }
+    }
+
+    return generateGenericCollScan(state, collection, csn, yieldPolicy, isTailableResumeBranch);
 }
 }  // namespace mongo::stage_builder
@@ -50,6 +50,10 @@ class PlanStageSlots;
  *     were requested to track this data.
  *   * A generated PlanStage sub-tree.
  *
+ * If 'allowParallelScan' is true, the documents do not need to be returned in natural order and
+ * the scan may be split across several threads, as per the
+ * 'internalQuerySBEParallelCollectionScanDegree' knob.
+ *
  * In cases of an error, throws.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -57,6 +61,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     const CollectionPtr& collection,
     const CollectionScanNode* csn,
     PlanYieldPolicy* yieldPolicy,
-    bool isTailableResumeBranch);
+    bool isTailableResumeBranch,
+    bool allowParallelScan = false);
 
 }  // namespace mongo::stage_builder
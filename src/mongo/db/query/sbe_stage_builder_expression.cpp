@@ -1135,10 +1135,12 @@ public:
         auto addToArrayExpr =
             makeFunction("addToArray", sbe::makeE<sbe::EVariable>(unionWithNullSlot));
         auto groupSlot = _context->state.slotId();
+        // This group has no group-by keys and thus never spills.
         auto groupStage = makeHashAgg(std::move(limitNumChildren),
                                       sbe::makeSV(),
                                       sbe::makeEM(groupSlot, std::move(addToArrayExpr)),
                                       collatorSlot,
+                                      _context->state.allowDiskUse,
                                       _context->planNodeId);
 
         // Build subtree to handle nulls. If an input is null, return null. Otherwise, unwind the
@@ -1167,6 +1169,7 @@ public:
                         sbe::makeSV(),
                         sbe::makeEM(finalGroupSlot, std::move(finalAddToArrayExpr)),
                         collatorSlot,
+                        _context->state.allowDiskUse,
                         _context->planNodeId);
 
         // Create a branch stage to select between the branch that produces one null if any elements
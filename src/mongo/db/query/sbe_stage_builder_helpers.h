@@ -337,6 +337,7 @@ EvalStage makeHashAgg(EvalStage stage,
                       sbe::value::SlotVector gbs,
                       sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs,
                       boost::optional<sbe::value::SlotId> collatorSlot,
+                      bool allowDiskUse,
                       PlanNodeId planNodeId);
 
 EvalStage makeMkBsonObj(EvalStage stage,
@@ -827,6 +828,18 @@ struct StageBuilderState {
 
     const Variables& variables;
     stdx::unordered_map<Variables::Id, sbe::value::SlotId> globalVariables;
+
+    // If set, index scans read their bounds from runtime environment slots rather than from
+    // constants, whenever the bounds can be decomposed into single intervals.
+    bool parameterizeIndexBounds{false};
+
+    // Whether stages which exceed their memory budget may spill to disk rather than fail the query.
+    bool allowDiskUse{false};
+
+    // Whether collection scans may be split across several threads. Only set for a tree which is
+    // the sole plan of its query: the producer threads of a parallel scan run no longer than the
+    // tree does, so it must not be trialed by a planner, cached or cloned.
+    bool allowParallelScan{false};
 };
 
 }  // namespace mongo::stage_builder
@@ -250,6 +250,33 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+/**
+ * Constructs an array containing objects with the low and high keys for each of the given
+ * 'intervals'. E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeIntervalsArray(
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+        intervals) {
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    sbe::value::ValueGuard guard{boundsTag, boundsVal};
+    auto arr = sbe::value::getArrayView(boundsVal);
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        obj->push_back("l"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        obj->push_back("h"_sd,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+        arr->push_back(tag, val);
+    }
+    guard.reset();
+    return {boundsTag, boundsVal};
+}
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -275,6 +302,10 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * This subtree is similar to the single-interval subtree with the only difference that instead
  * of projecting a single pair of the low/high keys, we project an array of such pairs and then
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
+ *
+ * The array is produced by the 'boundsExpr' expression, which is either a constant built by
+ * 'makeIntervalsArray()' or, when the index bounds are parameterized, a variable referring to a
+ * runtime environment slot holding such an array.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
 generateOptimizedMultiIntervalIndexScan(
@@ -282,8 +313,7 @@ generateOptimizedMultiIntervalIndexScan(
     const std::string& indexName,
     const BSONObj& keyPattern,
     bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
+    std::unique_ptr<sbe::EExpression> boundsExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     boost::optional<sbe::value::SlotId> snapshotIdSlot,
@@ -299,35 +329,17 @@ generateOptimizedMultiIntervalIndexScan(
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
 
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->push_back("l"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
-        obj->push_back("h"_sd,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
-    // Project out the constructed array as a constant value and add an unwind stage on top to
-    // flatten the array.
+    // Project out the array of intervals and add an unwind stage on top to flatten the array.
     auto unwind = sbe::makeS<sbe::UnwindStage>(
         sbe::makeProjectStage(
             sbe::makeS<sbe::LimitSkipStage>(
                 sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
             planNodeId,
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(boundsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -882,6 +894,30 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
                                            planNodeId)};
 }
 
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId) {
+    return str::stream() << "indexBounds" << nodeId;
+}
+
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexBoundsArray(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn) {
+    auto descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
+    if (!descriptor) {
+        return boost::none;
+    }
+
+    auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+    auto intervals =
+        makeIntervalsFromIndexBounds(ixn->bounds,
+                                     ixn->direction == 1,
+                                     accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+                                     accessMethod->getSortedDataInterface()->getOrdering());
+    if (intervals.empty()) {
+        return boost::none;
+    }
+    return makeIntervalsArray(std::move(intervals));
+}
+
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     StageBuilderState& state,
     const CollectionPtr& collection,
@@ -956,7 +992,36 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
         relevantSlots.push_back(*indexKeyPatternSlot);
     }
 
-    if (intervals.size() == 1) {
+    if (state.parameterizeIndexBounds && !intervals.empty()) {
+        // Bind the intervals to a runtime environment slot rather than to a constant, so that a
+        // clone of this tree can be executed with the index bounds of another query of the same
+        // shape. Even a single interval goes through the multi-interval sub-tree, as the number of
+        // intervals may differ between such queries.
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
+        auto boundsSlot = state.env->registerSlot(makeIndexBoundsSlotName(ixn->nodeId()),
+                                                  boundsTag,
+                                                  boundsVal,
+                                                  true,
+                                                  state.slotIdGenerator);
+        sbe::value::SlotId recordIdSlot;
+        std::tie(recordIdSlot, stage) =
+            generateOptimizedMultiIntervalIndexScan(collection,
+                                                    indexName,
+                                                    keyPattern,
+                                                    ixn->direction == 1,
+                                                    makeVariable(boundsSlot),
+                                                    indexKeyBitset,
+                                                    indexKeySlots,
+                                                    snapshotIdSlot,
+                                                    indexIdSlot,
+                                                    indexKeySlot,
+                                                    indexKeyPatternSlot,
+                                                    state.slotIdGenerator,
+                                                    yieldPolicy,
+                                                    ixn->nodeId());
+
+        outputs.set(PlanStageSlots::kRecordId, recordIdSlot);
+    } else if (intervals.size() == 1) {
         // If we have just a single interval, we can construct a simplified sub-tree.
         auto&& [lowKey, highKey] = intervals[0];
         sbe::value::SlotId recordIdSlot;
@@ -982,12 +1047,13 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
         // If we were able to decompose multi-interval index bounds into a number of single-interval
         // bounds, we can also built an optimized sub-tree to perform an index scan.
         sbe::value::SlotId recordIdSlot;
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
         std::tie(recordIdSlot, stage) =
             generateOptimizedMultiIntervalIndexScan(collection,
                                                     indexName,
                                                     keyPattern,
                                                     ixn->direction == 1,
-                                                    std::move(intervals),
+                                                    makeConstant(boundsTag, boundsVal),
                                                     indexKeyBitset,
                                                     indexKeySlots,
                                                     snapshotIdSlot,
@@ -50,6 +50,10 @@ class PlanStageSlots;
  *
  * If the caller provides a slot ID for the 'returnKeySlot' parameter, this method will populate
  * the specified slot with the rehydrated index key for each record.
+ *
+ * If 'state.parameterizeIndexBounds' is set and the index bounds can be decomposed into single
+ * intervals, the intervals are held in a runtime environment slot named by
+ * 'makeIndexBoundsSlotName()' instead of being embedded into the tree as constants.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     StageBuilderState& state,
@@ -60,6 +64,22 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateIndexScan(
     StringMap<const IndexAccessMethod*>* iamMap,
     bool needsCorruptionCheck);
 
+/**
+ * Returns the name of the runtime environment slot which holds the index bounds of the index scan
+ * with the given 'nodeId' when the stage builder parameterizes index bounds.
+ */
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId);
+
+/**
+ * Constructs the value a parameterized index bounds slot of the index scan 'ixn' must hold to scan
+ * the bounds of 'ixn': an array with a {l: KS(...), h: KS(...)} object per interval. Returns
+ * boost::none if the index no longer exists or its bounds cannot be decomposed into single
+ * intervals, in which case the index scan cannot be parameterized. The caller owns the returned
+ * value.
+ */
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexBoundsArray(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn);
+
 /**
  * Constructs the most simple version of an index scan from the single interval index bounds. The
  * generated subtree will have the following form:
@@ -33,6 +33,7 @@
 
 #include "mongo/db/query/classic_stage_builder.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/sbe_plan_tree_cache.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/shard_filterer_factory_impl.h"
 
@@ -58,7 +59,8 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const CollectionPtr& collection,
                              const CanonicalQuery& cq,
                              const QuerySolution& solution,
-                             PlanYieldPolicy* yieldPolicy) {
+                             PlanYieldPolicy* yieldPolicy,
+                             bool allowParallelScan) {
     // Only QuerySolutions derived from queries parsed with context, or QuerySolutions derived from
     // queries that disallow extensions, can be properly executed. If the query does not have
     // $text/$where context (and $text/$where are allowed), then no attempt should be made to
@@ -69,12 +71,40 @@ buildSlotBasedExecutableTree(OperationContext* opCtx,
     auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(yieldPolicy);
     invariant(sbeYieldPolicy);
 
-    auto shardFilterer = std::make_unique<ShardFiltererFactoryImpl>(collection);
+    // Queries of a shape whose plan trees can be executed with the constants of another query
+    // clone the tree cached for their shape, if any, instead of building a new one.
+    auto& planTreeCache = sbe::PlanTreeCache::get(opCtx->getServiceContext());
+    boost::optional<std::string> planTreeCacheKey;
+    if (planTreeCache.isEnabled() && sbe::PlanTreeCache::isCacheable(solution)) {
+        planTreeCacheKey = sbe::PlanTreeCache::computeKey(collection, cq, solution);
+    }
+
+    auto [root, data] = [&]() -> std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageData> {
+        if (planTreeCacheKey) {
+            if (auto cachedTree = planTreeCache.lookup(
+                    opCtx, collection, cq, solution, sbeYieldPolicy, *planTreeCacheKey)) {
+                return std::move(*cachedTree);
+            }
+        }
+
+        auto shardFilterer = std::make_unique<ShardFiltererFactoryImpl>(collection);
 
-    auto builder = std::make_unique<SlotBasedStageBuilder>(
-        opCtx, collection, cq, solution, sbeYieldPolicy, shardFilterer.get());
-    auto root = builder->build(solution.root());
-    auto data = builder->getPlanStageData();
+        auto builder = std::make_unique<SlotBasedStageBuilder>(opCtx,
+                                                               collection,
+                                                               cq,
+                                                               solution,
+                                                               sbeYieldPolicy,
+                                                               shardFilterer.get(),
+                                                               planTreeCacheKey.has_value(),
+                                                               allowParallelScan &&
+                                                                   !planTreeCacheKey);
+        auto root = builder->build(solution.root());
+        auto data = builder->getPlanStageData();
+        if (planTreeCacheKey) {
+            planTreeCache.add(solution, *root, data, *planTreeCacheKey);
+        }
+        return {std::move(root), std::move(data)};
+    }();
 
     root->attachToOperationContext(opCtx);
 
@@ -50,11 +50,17 @@ std::unique_ptr<PlanStage> buildClassicExecutableTree(OperationContext* opCtx,
                                                       const QuerySolution& solution,
                                                       WorkingSet* ws);
 
+/**
+ * Turns 'solution' into an executable tree of slot-based PlanStages. Collection scans may be split
+ * across several threads if 'allowParallelScan' is set, which is only allowed for the sole plan of
+ * a query: a tree which is trialed against other plans or cached must not set it.
+ */
 std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
 buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const CollectionPtr& collection,
                              const CanonicalQuery& cq,
                              const QuerySolution& solution,
-                             PlanYieldPolicy* yieldPolicy);
+                             PlanYieldPolicy* yieldPolicy,
+                             bool allowParallelScan = false);
 
 }  // namespace mongo::stage_builder
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/adaptive_batch_sizer.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+AdaptiveBatchSizer::AdaptiveBatchSizer(int initialBatchSize,
+                                       int maxBatchSize,
+                                       long long maxBatchBytes)
+    : _maxBatchSize(maxBatchSize), _maxBatchBytes(maxBatchBytes), _batchSize(initialBatchSize) {
+    invariant(maxBatchBytes >= kMinBatchBytes);
+}
+
+int AdaptiveBatchSizer::recordBatch(int numDocuments, long long numBytes, Microseconds roundTrip) {
+    if (numDocuments <= 0) {
+        return _batchSize;
+    }
+
+    auto documentBytes = static_cast<double>(numBytes) / numDocuments;
+    _avgDocumentBytes = _avgDocumentBytes == 0
+        ? documentBytes
+        : (1 - kSmoothingFactor) * _avgDocumentBytes + kSmoothingFactor * documentBytes;
+
+    // The source fills a batch up to the requested number of documents or until the next document
+    // would not fit, so a batch at least half the maximum size was limited by its size.
+    bool fullBatch =
+        (_batchSize > 0 && numDocuments >= _batchSize) || numBytes * 2 >= _maxBatchBytes;
+    if (!fullBatch || roundTrip <= Microseconds(0)) {
+        return _batchSize;
+    }
+
+    auto x = static_cast<double>(numBytes);
+    auto y = static_cast<double>(durationCount<Microseconds>(roundTrip));
+    auto decay = 1 - kSmoothingFactor;
+    _weight = decay * _weight + 1;
+    _sumX = decay * _sumX + x;
+    _sumY = decay * _sumY + y;
+    _sumXX = decay * _sumXX + x * x;
+    _sumXY = decay * _sumXY + x * y;
+
+    auto meanX = _sumX / _weight;
+    auto meanY = _sumY / _weight;
+    auto varianceX = _sumXX / _weight - meanX * meanX;
+    auto covarianceXY = _sumXY / _weight - meanX * meanY;
+
+    // When the recent batches were all about the same size, they do not tell latency apart from
+    // transfer time, so keep the transfer time last fitted.
+    if (varianceX > (0.01 * meanX) * (0.01 * meanX)) {
+        auto microsPerByte = covarianceXY / varianceX;
+        if (microsPerByte <= 0) {
+            // Noise dominates the transfer time of the batches. Keep the batch size.
+            return _batchSize;
+        }
+        _microsPerByte = microsPerByte;
+    }
+
+    double targetBytes;
+    if (_microsPerByte == 0) {
+        // Probe with a batch of a different size, to be able to fit the model.
+        bool canGrow =
+            x * 2 <= _maxBatchBytes && (_maxBatchSize == 0 || numDocuments * 2 <= _maxBatchSize);
+        targetBytes = canGrow ? x * 2 : x / 2;
+    } else {
+        auto latencyMicros = std::max(0.0, meanY - _microsPerByte * meanX);
+        targetBytes = kBandwidthDelayGain * latencyMicros / _microsPerByte;
+    }
+    targetBytes = std::clamp(
+        targetBytes, static_cast<double>(kMinBatchBytes), static_cast<double>(_maxBatchBytes));
+    auto targetBatchSize = std::max(1.0, targetBytes / _avgDocumentBytes);
+
+    // Change by at most a factor of two per batch, so that a single slow or fast round trip does
+    // not swing the batch size.
+    if (_batchSize > 0) {
+        targetBatchSize = std::clamp(targetBatchSize, _batchSize / 2.0, _batchSize * 2.0);
+    }
+    if (_maxBatchSize > 0) {
+        targetBatchSize = std::min(targetBatchSize, static_cast<double>(_maxBatchSize));
+    }
+
+    _batchSize = std::max(1, static_cast<int>(targetBatchSize));
+    return _batchSize;
+}
+
+void AdaptiveBatchSizeStats::record(int previousBatchSize, int batchSize) {
+    _batchSize.store(batchSize);
+    if (batchSize != previousBatchSize) {
+        _resizes.increment();
+    }
+}
+
+BSONObj AdaptiveBatchSizeStats::getReport() const {
+    BSONObjBuilder b;
+    b.append("batchSize", _batchSize.load());
+    b.append("resizes", _resizes.get());
+    return b.obj();
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/counter.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Chooses the batch size of a cursor which is drained by getMore round trips, so that each batch
+ * carries enough data to hide the latency of the round trip which fetched it.
+ *
+ * The sizer models the round trip of a batch of B bytes as 'latency + B / bandwidth', and fits
+ * that line to the recent full batches by least squares. It then asks for kBandwidthDelayGain
+ * times the bandwidth-delay product per batch, converted to a number of documents with the
+ * average document size. Until the batches differ enough in size for the fit, the sizer probes by
+ * doubling the batch size, or halving it when it is already as large as it can be.
+ *
+ * A batch which came back with fewer documents than requested, and was not limited by its size
+ * either, says nothing about the link (the source simply had nothing more to return yet) and only
+ * updates the average document size.
+ *
+ * A batch size of 0 stands for "as many documents as fit in a batch", as it does for cursors.
+ *
+ * Not thread-safe.
+ */
+class AdaptiveBatchSizer {
+public:
+    // Multiple of the bandwidth-delay product requested per batch. With a gain of 4, the latency
+    // of a round trip is a fifth of the time spent on each batch.
+    static constexpr double kBandwidthDelayGain = 4.0;
+
+    // Weight of the newest batch in the moving averages of the document size and the round-trip
+    // model.
+    static constexpr double kSmoothingFactor = 0.25;
+
+    // Batches are never sized below this many bytes, to avoid spending more time processing tiny
+    // batches than transferring them on fast links.
+    static constexpr long long kMinBatchBytes = 256 * 1024;
+
+    /**
+     * Starts out with 'initialBatchSize' and never chooses more than 'maxBatchSize' documents
+     * (0 for no limit) or batches expected to be larger than 'maxBatchBytes'.
+     */
+    AdaptiveBatchSizer(int initialBatchSize,
+                       int maxBatchSize,
+                       long long maxBatchBytes = BSONObjMaxUserSize);
+
+    /**
+     * Records a batch of 'numDocuments' documents totalling 'numBytes', 'roundTrip' after it was
+     * requested, and returns the batch size to request next.
+     */
+    int recordBatch(int numDocuments, long long numBytes, Microseconds roundTrip);
+
+    /**
+     * Returns the batch size to request next.
+     */
+    int getBatchSize() const {
+        return _batchSize;
+    }
+
+private:
+    const int _maxBatchSize;
+    const long long _maxBatchBytes;
+
+    int _batchSize;
+
+    // Moving average of the size of the documents received.
+    double _avgDocumentBytes = 0;
+
+    // Exponentially weighted sums over the full batches of their size in bytes (x) and round trip
+    // in microseconds (y), from which the round-trip model is fitted.
+    double _weight = 0;
+    double _sumX = 0;
+    double _sumY = 0;
+    double _sumXX = 0;
+    double _sumXY = 0;
+
+    // Transfer time per byte of the last fit of the round-trip model, or 0 before the first fit.
+    double _microsPerByte = 0;
+};
+
+/**
+ * serverStatus metric for the batch sizes chosen by the AdaptiveBatchSizers of a component.
+ */
+class AdaptiveBatchSizeStats {
+public:
+    /**
+     * Records that a sizer chose 'batchSize' after a batch requested with 'previousBatchSize'.
+     */
+    void record(int previousBatchSize, int batchSize);
+
+    BSONObj getReport() const;
+    operator BSONObj() const {
+        return getReport();
+    }
+
+private:
+    AtomicWord<int> _batchSize;
+    Counter64 _resizes;
+};
+
+}  // namespace repl
+}  // namespace mongo
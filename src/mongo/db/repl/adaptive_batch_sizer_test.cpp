@@ -0,0 +1,105 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/adaptive_batch_sizer.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const long long kDocumentBytes = 1000;
+
+/**
+ * Simulates a link with the given latency and bandwidth, returning full batches of
+ * 'kDocumentBytes' documents, and returns the batch size the sizer settles on.
+ */
+int runBatches(AdaptiveBatchSizer* sizer,
+               Microseconds latency,
+               long long bytesPerMicros,
+               int numBatches = 50) {
+    for (int i = 0; i < numBatches; ++i) {
+        auto numDocuments = sizer->getBatchSize();
+        if (numDocuments == 0 || numDocuments * kDocumentBytes > BSONObjMaxUserSize) {
+            numDocuments = BSONObjMaxUserSize / kDocumentBytes;
+        }
+        auto numBytes = numDocuments * kDocumentBytes;
+        sizer->recordBatch(
+            numDocuments, numBytes, latency + Microseconds(numBytes / bytesPerMicros));
+    }
+    return sizer->getBatchSize();
+}
+
+TEST(AdaptiveBatchSizerTest, GrowsBatchesOnHighLatencyLink) {
+    // 2ms latency at 100MB/s is a bandwidth-delay product of 200KB, or 200 documents.
+    AdaptiveBatchSizer sizer(10, 0 /* maxBatchSize */);
+    auto batchSize = runBatches(&sizer, Milliseconds(2), 100);
+    ASSERT_GTE(batchSize, 700);
+    ASSERT_LTE(batchSize, 900);
+}
+
+TEST(AdaptiveBatchSizerTest, ShrinksBatchesOnLowLatencyLink) {
+    // 100us latency at 1GB/s is a bandwidth-delay product of 100KB, or 100 documents.
+    AdaptiveBatchSizer sizer(10000, 0 /* maxBatchSize */);
+    auto batchSize = runBatches(&sizer, Microseconds(100), 1000);
+    ASSERT_GTE(batchSize, 350);
+    ASSERT_LTE(batchSize, 450);
+}
+
+TEST(AdaptiveBatchSizerTest, BatchesNeverGoBelowTheMinimumSize) {
+    // 10us latency at 1GB/s is a bandwidth-delay product of 10KB.
+    AdaptiveBatchSizer sizer(10000, 0 /* maxBatchSize */);
+    ASSERT_EQ(AdaptiveBatchSizer::kMinBatchBytes / kDocumentBytes,
+              runBatches(&sizer, Microseconds(10), 1000));
+}
+
+TEST(AdaptiveBatchSizerTest, BatchesNeverExceedTheMaximumSize) {
+    AdaptiveBatchSizer sizer(0, 0 /* maxBatchSize */);
+    auto batchSize = runBatches(&sizer, Milliseconds(100), 100);
+    ASSERT_LTE(batchSize * kDocumentBytes, BSONObjMaxUserSize);
+    ASSERT_GTE(batchSize * kDocumentBytes, BSONObjMaxUserSize / 2);
+
+    AdaptiveBatchSizer limitedSizer(100, 500 /* maxBatchSize */);
+    ASSERT_EQ(500, runBatches(&limitedSizer, Milliseconds(100), 100));
+}
+
+TEST(AdaptiveBatchSizerTest, PartialBatchesDoNotChangeTheBatchSize) {
+    AdaptiveBatchSizer sizer(1000, 0 /* maxBatchSize */);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(1000, sizer.recordBatch(10, 10 * kDocumentBytes, Seconds(1)));
+        ASSERT_EQ(1000, sizer.recordBatch(0, 0, Seconds(1)));
+    }
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
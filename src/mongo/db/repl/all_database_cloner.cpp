@@ -215,6 +215,7 @@ void AllDatabaseCloner::postStage() {
                                                                       getClient(),
                                                                       getStorageInterface(),
                                                                       getDBPool());
+            _currentDatabaseCloner->setExecutor(getExecutor());
         }
         auto dbStatus = _currentDatabaseCloner->run();
         if (dbStatus.isOK()) {
@@ -222,6 +222,7 @@ std::pair<Future<void>, TaskExecutor::EventHandle> BaseCloner::runOnExecutorEven
         invariant(!_active && !_startedAsync);
         _startedAsync = true;
     }
+    setExecutor(executor);
     auto pf = makePromiseFuture<void>();
     // The promise has to be a class variable to correctly return the error code in the case
     // where executor->scheduleWork fails (i.e. when shutting down)
@@ -79,6 +79,14 @@ public:
     std::pair<Future<void>, executor::TaskExecutor::EventHandle> runOnExecutorEvent(
         executor::TaskExecutor* executor);
 
+    /**
+     * Sets the executor on which the cloner may schedule work of its own. A cloner run by
+     * runOnExecutorEvent() uses the executor it runs on, and passes it to the cloners it runs.
+     */
+    void setExecutor(executor::TaskExecutor* executor) {
+        _executor = executor;
+    }
+
     /**
      * For unit testing, allow stopping after any given stage.
      */
@@ -174,6 +182,13 @@ protected:
         return _client;
     }
 
+    /**
+     * Returns the executor set by setExecutor(), or nullptr if the cloner is run without one.
+     */
+    executor::TaskExecutor* getExecutor() const {
+        return _executor;
+    }
+
     StorageInterface* getStorageInterface() const {
         return _storageInterface;
     }
@@ -276,11 +291,12 @@ private:
     // (S)  Self-synchronizing; access according to classes own rules
     // (M)  Reads and writes guarded by _mutex
     // (X)  Access only allowed from the main flow of control called from run() or constructor.
-    ReplSyncSharedData* _sharedData;      // (S)
-    DBClientConnection* _client;          // (X)
-    StorageInterface* _storageInterface;  // (X)
-    ThreadPool* _dbPool;                  // (X)
-    HostAndPort _source;                  // (R)
+    ReplSyncSharedData* _sharedData;              // (S)
+    DBClientConnection* _client;                  // (X)
+    StorageInterface* _storageInterface;          // (X)
+    ThreadPool* _dbPool;                          // (X)
+    executor::TaskExecutor* _executor = nullptr;  // (X)
+    HostAndPort _source;                          // (R)
 
     // _active indicates this cloner is being run, and is used only for status reporting and
     // invariant checking.
@@ -33,17 +33,20 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/commands/list_collections_filter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/index_builds_coordinator.h"
 #include "mongo/db/repl/collection_bulk_loader.h"
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/database_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 
 #include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
@@ -56,6 +59,21 @@ MONGO_FAIL_POINT_DEFINE(initialSyncHangDuringCollectionClone);
 // DBClientConnection, optionally limited to a specific collection.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangCollectionClonerAfterHandlingBatchResponse);
 
+namespace {
+// The batch size chosen for the query when 'collectionClonerAdaptiveBatchSize' is enabled.
+AdaptiveBatchSizeStats adaptiveBatchSizeStats;
+ServerStatusMetricField<AdaptiveBatchSizeStats> displayAdaptiveBatchSize(
+    "repl.initialSync.adaptiveBatchSize", &adaptiveBatchSizeStats);
+
+// The number of documents sampled from the source collection per partition of a partitioned
+// query, to place the partition boundaries.
+constexpr int kSampledDocumentsPerQueryPartition = 32;
+
+// How often a partition query waiting for queued documents to be inserted checks whether initial
+// sync has failed.
+constexpr Milliseconds kQueuedPartitionBytesCheckInterval{100};
+}  // namespace
+
 CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
                                    const CollectionOptions& collectionOptions,
                                    InitialSyncSharedData* sharedData,
@@ -96,6 +114,8 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
+      _createClientFn(
+          [] { return std::make_unique<DBClientConnection>(false /* autoReconnect */); }),
       _dbWorkTaskRunner(dbPool) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
@@ -236,7 +256,11 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
 }
 
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    runQuery();
+    if (shouldPartitionQuery()) {
+        runPartitionedQuery();
+    } else {
+        runQuery();
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -323,6 +347,11 @@ void CollectionCloner::runQuery() {
     // the first time we get it.
     _firstBatchOfQueryRound = true;
 
+    if (!_batchSizer) {
+        _batchSizer.emplace(_collectionClonerBatchSize, 0 /* maxBatchSize */);
+    }
+    _batchTimer.reset();
+
     try {
         getClient()->query([this](DBClientCursorBatchIterator& iter) { handleNextBatch(iter); },
                            _sourceDbAndUuid,
@@ -330,7 +359,7 @@ void CollectionCloner::runQuery() {
                            nullptr /* fieldsToReturn */,
                            QueryOption_NoCursorTimeout | QueryOption_SecondaryOk |
                                (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
-                           _collectionClonerBatchSize,
+                           _batchSizer->getBatchSize(),
                            ReadConcernArgs::kImplicitDefault);
     } catch (...) {
         auto status = exceptionToStatus();
@@ -371,17 +400,19 @@ void CollectionCloner::runQuery() {
     }
 }
 
-void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
-    {
-        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
-        if (!getSharedData()->getStatus(lk).isOK()) {
-            static constexpr char message[] =
-                "Collection cloning cancelled due to initial sync failure";
-            LOGV2(21136, message, "error"_attr = getSharedData()->getStatus(lk));
-            uasserted(ErrorCodes::CallbackCanceled,
-                      str::stream() << message << ": " << getSharedData()->getStatus(lk));
-        }
+void CollectionCloner::checkInitialSyncNotFailed() {
+    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+    if (!getSharedData()->getStatus(lk).isOK()) {
+        static constexpr char message[] =
+            "Collection cloning cancelled due to initial sync failure";
+        LOGV2(21136, message, "error"_attr = getSharedData()->getStatus(lk));
+        uasserted(ErrorCodes::CallbackCanceled,
+                  str::stream() << message << ": " << getSharedData()->getStatus(lk));
     }
+}
+
+void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
+    checkInitialSyncNotFailed();
 
     // If this is 'true', it means that something happened to our remote cursor for a reason other
     // than the collection being dropped, all while we were running a non-resumable (4.2) clone.
@@ -397,14 +428,28 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
     }
     _firstBatchOfQueryRound = false;
 
+    auto roundTrip = Microseconds(_batchTimer.micros());
+    int numDocuments = 0;
+    long long batchBytes = 0;
     {
         stdx::lock_guard<Latch> lk(_mutex);
         _stats.receivedBatches++;
         while (iter.moreInCurrentBatch()) {
             _documentsToInsert.emplace_back(iter.nextSafe());
+            ++numDocuments;
+            batchBytes += _documentsToInsert.back().objsize();
         }
     }
 
+    // Exhaust queries stream their batches without waiting for a getMore round trip, so there is
+    // no latency to hide by resizing them.
+    if (collectionClonerAdaptiveBatchSize.load() && !collectionClonerUsesExhaust) {
+        auto previousBatchSize = _batchSizer->getBatchSize();
+        auto batchSize = _batchSizer->recordBatch(numDocuments, batchBytes, roundTrip);
+        adaptiveBatchSizeStats.record(previousBatchSize, batchSize);
+        iter.setBatchSize(batchSize);
+    }
+
     // Schedule the next document batch insertion.
     auto&& scheduleResult = _scheduleDbWorkFn(
         [=](const executor::TaskExecutor::CallbackArgs& cbd) { insertDocumentsCallback(cbd); });
@@ -421,6 +466,11 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         _resumeToken = iter.getPostBatchResumeToken();
     }
 
+    hangAfterHandlingBatchResponseIfNeeded();
+    _batchTimer.reset();
+}
+
+void CollectionCloner::hangAfterHandlingBatchResponseIfNeeded() {
     initialSyncHangCollectionClonerAfterHandlingBatchResponse.executeIf(
         [&](const BSONObj&) {
             while (MONGO_unlikely(
@@ -459,16 +509,41 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
             return;
         }
         _documentsToInsert.swap(docs);
-        _stats.documentsCopied += docs.size();
-        _stats.approxBytesCopied = ((long)_stats.documentsCopied) * _stats.avgObjSize;
-        _progressMeter.hit(int(docs.size()));
-        invariant(_collLoader);
+        insertDocuments(lk, docs);
+    }
+
+    hangDuringCollectionCloneIfNeeded();
+}
 
-        // The insert must be done within the lock, because CollectionBulkLoader is not
-        // thread safe.
-        uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+void CollectionCloner::insertPartitionDocumentsCallback(
+    const executor::TaskExecutor::CallbackArgs& cbd,
+    const std::vector<BSONObj>& docs,
+    long long docsBytes) {
+    // The documents leave the queue whether or not they get inserted.
+    ON_BLOCK_EXIT([&] { releaseQueuedPartitionBytes(docsBytes); });
+    uassertStatusOK(cbd.status);
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        ++_stats.fetchedBatches;
+        insertDocuments(lk, docs);
     }
 
+    hangDuringCollectionCloneIfNeeded();
+}
+
+void CollectionCloner::insertDocuments(WithLock, const std::vector<BSONObj>& docs) {
+    _stats.documentsCopied += docs.size();
+    _stats.approxBytesCopied = ((long)_stats.documentsCopied) * _stats.avgObjSize;
+    _progressMeter.hit(int(docs.size()));
+    invariant(_collLoader);
+
+    // The insert must be done within the lock, because CollectionBulkLoader is not
+    // thread safe.
+    uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+}
+
+void CollectionCloner::hangDuringCollectionCloneIfNeeded() {
     initialSyncHangDuringCollectionClone.executeIf(
         [&](const BSONObj&) {
             LOGV2(21138,
@@ -485,6 +560,268 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
         });
 }
 
+bool CollectionCloner::shouldPartitionQuery() const {
+    if (collectionClonerPartitions.load() <= 1) {
+        return false;
+    }
+
+    // Retried partition queries resume after the last _id received rather than from a resume
+    // token, but we only split collections for sync sources that can resume a natural order
+    // query too, so that a retry behaves the same either way.
+    if (!_resumeSupported) {
+        return false;
+    }
+
+    // Capped collections must be inserted in their natural order. The _id index bounds of the
+    // partitions are only meaningful for the simple collation.
+    if (_collectionOptions.capped || !_collectionOptions.collation.isEmpty() ||
+        _idIndexSpec.isEmpty()) {
+        return false;
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _stats.bytesToCopy >= collectionClonerPartitionMinBytes.load();
+}
+
+void CollectionCloner::initializeQueryPartitions() {
+    invariant(_queryPartitions.empty());
+    const int numPartitions = collectionClonerPartitions.load();
+    const int sampleSize = numPartitions * kSampledDocumentsPerQueryPartition;
+
+    // Have the source sort the sample, so that the boundaries are in the order of its _id index.
+    BSONObj res;
+    getClient()->runCommand(
+        _sourceNss.db().toString(),
+        BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                         << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                       << BSON("$project" << BSON("_id" << 1))
+                                       << BSON("$sort" << BSON("_id" << 1)))
+                         << "cursor" << BSON("batchSize" << sampleSize)),
+        res,
+        QueryOption_SecondaryOk);
+
+    std::vector<BSONObj> sample;
+    if (auto status = getStatusFromCommandResult(res); status.isOK()) {
+        for (auto&& doc : res["cursor"]["firstBatch"].Obj()) {
+            sample.push_back(BSON("_id" << doc.Obj()["_id"]));
+        }
+        if (auto cursorId = res["cursor"]["id"].numberLong(); cursorId != 0) {
+            getClient()->killCursor(_sourceNss, cursorId);
+        }
+    } else {
+        // Fall back to a single range covering the whole collection.
+        LOGV2_DEBUG(6179052,
+                    1,
+                    "Failed to sample the collection to partition its query",
+                    "namespace"_attr = _sourceNss,
+                    "error"_attr = status);
+    }
+
+    // Pick evenly spaced sampled _ids as the boundaries between partitions. The first and last
+    // partitions are open-ended so that the partitions cover all _ids, whatever the sample was.
+    BSONObj min;
+    for (int i = 1; i < numPartitions && !sample.empty(); ++i) {
+        const auto& boundary = sample[i * sample.size() / numPartitions];
+        if (!min.isEmpty() && boundary.binaryEqual(min)) {
+            continue;
+        }
+        _queryPartitions.push_back({min, boundary});
+        min = boundary;
+    }
+    _queryPartitions.push_back({min, BSONObj()});
+
+    LOGV2_DEBUG(6179053,
+                1,
+                "Collection cloner will query the collection in partitions",
+                "namespace"_attr = _sourceNss,
+                "partitions"_attr = _queryPartitions.size());
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _stats.queryPartitions = _queryPartitions.size();
+}
+
+void CollectionCloner::runPartitionedQuery() {
+    if (_queryPartitions.empty()) {
+        initializeQueryPartitions();
+    }
+
+    // The partitions never wait for each other, so they all finish however few of them the
+    // executor runs at a time.
+    std::vector<Status> statuses(_queryPartitions.size(), Status::OK());
+    std::vector<executor::TaskExecutor::CallbackHandle> handles;
+    for (size_t i = 0; i < _queryPartitions.size(); ++i) {
+        if (_queryPartitions[i].done) {
+            continue;
+        }
+        auto runPartition = [this, &partition = _queryPartitions[i], &status = statuses[i]](
+                                const executor::TaskExecutor::CallbackArgs& args) {
+            if (!args.status.isOK()) {
+                status = args.status;
+                return;
+            }
+            try {
+                runPartitionQuery(&partition);
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+        };
+        if (!getExecutor()) {
+            runPartition(executor::TaskExecutor::CallbackArgs(nullptr, {}, Status::OK()));
+            continue;
+        }
+        auto handle = getExecutor()->scheduleWork(std::move(runPartition));
+        if (!handle.isOK()) {
+            statuses[i] = handle.getStatus();
+            continue;
+        }
+        handles.push_back(std::move(handle.getValue()));
+    }
+    for (auto&& handle : handles) {
+        getExecutor()->wait(handle);
+    }
+
+    // A dropped collection ends the clone cleanly, so report that first. Otherwise prefer an
+    // error that fails the clone over one that only makes us retry the unfinished partitions.
+    auto severity = [&](const Status& status) {
+        if (status == ErrorCodes::NamespaceNotFound) {
+            return 3;
+        }
+        return status.isOK() ? 0 : (_queryStage.isTransientError(status) ? 1 : 2);
+    };
+    auto worst = std::max_element(
+        statuses.begin(), statuses.end(), [&](const Status& a, const Status& b) {
+            return severity(a) < severity(b);
+        });
+    if (worst != statuses.end()) {
+        uassertStatusOK(*worst);
+    }
+}
+
+void CollectionCloner::runPartitionQuery(QueryPartition* partition) {
+    auto client = _createClientFn();
+    {
+        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+        uassertStatusOK(getSharedData()->registerClient(lk, client.get()));
+    }
+    ON_BLOCK_EXIT([&] {
+        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+        getSharedData()->unregisterClient(lk, client.get());
+    });
+
+    uassertStatusOK(client->connect(getSource(), StringData(), boost::none));
+    uassertStatusOK(replAuthenticate(client.get())
+                        .withContext(str::stream() << "Failed to authenticate to " << getSource()));
+
+    Query query = QUERY("query" << BSONObj());
+    query.hint(BSON("_id" << 1));
+    const auto& min = partition->lastId.isEmpty() ? partition->min : partition->lastId;
+    if (!min.isEmpty()) {
+        query.minKey(min);
+    }
+    if (!partition->max.isEmpty()) {
+        query.maxKey(partition->max);
+    }
+
+    if (!partition->batchSizer) {
+        partition->batchSizer.emplace(_collectionClonerBatchSize, 0 /* maxBatchSize */);
+    }
+    partition->batchTimer.reset();
+
+    client->query(
+        [this, partition](DBClientCursorBatchIterator& iter) {
+            handleNextPartitionBatch(partition, iter);
+        },
+        _sourceDbAndUuid,
+        query,
+        nullptr /* fieldsToReturn */,
+        QueryOption_NoCursorTimeout | QueryOption_SecondaryOk |
+            (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+        partition->batchSizer->getBatchSize(),
+        ReadConcernArgs::kImplicitDefault);
+    partition->done = true;
+}
+
+void CollectionCloner::handleNextPartitionBatch(QueryPartition* partition,
+                                                DBClientCursorBatchIterator& iter) {
+    checkInitialSyncNotFailed();
+
+    auto roundTrip = Microseconds(partition->batchTimer.micros());
+    int numDocuments = 0;
+    long long batchBytes = 0;
+    long long docsBytes = 0;
+    std::vector<BSONObj> docs;
+    while (iter.moreInCurrentBatch()) {
+        auto doc = iter.nextSafe();
+        ++numDocuments;
+        batchBytes += doc.objsize();
+        // A resumed query starts at the last document we already received, if it still exists.
+        if (docs.empty() && !partition->lastId.isEmpty() &&
+            doc["_id"].binaryEqualValues(partition->lastId.firstElement())) {
+            continue;
+        }
+        docsBytes += doc.objsize();
+        docs.emplace_back(std::move(doc));
+    }
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.receivedBatches++;
+    }
+
+    if (collectionClonerAdaptiveBatchSize.load() && !collectionClonerUsesExhaust) {
+        auto previousBatchSize = partition->batchSizer->getBatchSize();
+        auto batchSize = partition->batchSizer->recordBatch(numDocuments, batchBytes, roundTrip);
+        adaptiveBatchSizeStats.record(previousBatchSize, batchSize);
+        iter.setBatchSize(batchSize);
+    }
+
+    if (!docs.empty()) {
+        partition->lastId = BSON("_id" << docs.back()["_id"]);
+
+        // Stop fetching while the other partitions have enough documents queued for insertion,
+        // so that fast queries cannot buffer an unbounded amount of data ahead of the inserts.
+        waitToQueuePartitionBytes(docsBytes);
+        auto&& scheduleResult = _scheduleDbWorkFn(
+            [this, docs = std::move(docs), docsBytes](
+                const executor::TaskExecutor::CallbackArgs& cbd) {
+                insertPartitionDocumentsCallback(cbd, docs, docsBytes);
+            });
+        if (!scheduleResult.isOK()) {
+            releaseQueuedPartitionBytes(docsBytes);
+            uassertStatusOK(scheduleResult.getStatus().withContext(
+                str::stream() << "Error cloning collection '" << _sourceNss.ns() << "'"));
+        }
+
+        hangAfterHandlingBatchResponseIfNeeded();
+    }
+    partition->batchTimer.reset();
+}
+
+void CollectionCloner::waitToQueuePartitionBytes(long long bytes) {
+    // A batch is always let through when nothing is queued, however large it is.
+    auto canQueue = [&] {
+        return _queuedPartitionBytes == 0 ||
+            _queuedPartitionBytes + bytes <= collectionClonerPartitionMaxQueuedBytes.load();
+    };
+    while (true) {
+        {
+            stdx::unique_lock<Latch> lk(_mutex);
+            if (_queuedPartitionBytesCond.wait_for(
+                    lk, kQueuedPartitionBytesCheckInterval.toSystemDuration(), canQueue)) {
+                _queuedPartitionBytes += bytes;
+                return;
+            }
+        }
+        checkInitialSyncNotFailed();
+    }
+}
+
+void CollectionCloner::releaseQueuedPartitionBytes(long long bytes) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _queuedPartitionBytes -= bytes;
+    _queuedPartitionBytesCond.notify_all();
+}
+
 bool CollectionCloner::isMyFailPoint(const BSONObj& data) const {
     auto nss = data["nss"].str();
     return (nss.empty() || nss == _sourceNss.toString()) && BaseCloner::isMyFailPoint(data);
@@ -542,6 +879,9 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", static_cast<long long>(receivedBatches));
+    if (queryPartitions) {
+        builder->appendNumber("queryPartitions", static_cast<long long>(queryPartitions));
+    }
 }
 
 }  // namespace repl
@@ -32,11 +32,14 @@
 #include <memory>
 #include <vector>
 
+#include "mongo/db/repl/adaptive_batch_sizer.h"
 #include "mongo/db/repl/base_cloner.h"
 #include "mongo/db/repl/initial_sync_base_cloner.h"
 #include "mongo/db/repl/initial_sync_shared_data.h"
 #include "mongo/db/repl/task_runner.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/progress_meter.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -60,6 +63,7 @@ public:
         size_t indexes{0};
         size_t fetchedBatches{0};  // This is actually inserted batches.
         size_t receivedBatches{0};
+        size_t queryPartitions{0};
         long long bytesToCopy{0};
         long long avgObjSize{0};
         long long approxBytesCopied{0};
@@ -77,6 +81,11 @@ public:
     using ScheduleDbWorkFn = unique_function<StatusWith<executor::TaskExecutor::CallbackHandle>(
         executor::TaskExecutor::CallbackFn)>;
 
+    /**
+     * Type of function to create the connections of a partitioned query.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     CollectionCloner(const NamespaceString& ns,
                      const CollectionOptions& collectionOptions,
                      InitialSyncSharedData* sharedData,
@@ -122,6 +131,15 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how the connections of a partitioned query are created.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(const CreateClientFn& createClientFn) {
+        _createClientFn = createClientFn;
+    }
+
 protected:
     ClonerStages getStages() final;
 
@@ -212,6 +230,69 @@ private:
      */
     void handleNextBatch(DBClientCursorBatchIterator& iter);
 
+    /**
+     * A range of the source collection's _id index which is fetched by its own query when the
+     * collection is cloned in partitions.
+     */
+    struct QueryPartition {
+        // Inclusive lower and exclusive upper bound of the range, as _id index keys. An empty
+        // bound leaves that side of the range open.
+        BSONObj min;
+        BSONObj max;
+
+        // The _id index key of the last document received for this range. A retried query
+        // resumes from here.
+        BSONObj lastId;
+
+        bool done = false;
+
+        // Chooses the batch size of this range's query when 'collectionClonerAdaptiveBatchSize'
+        // is enabled, as '_batchSizer' does for an unpartitioned query. Kept by the retries.
+        boost::optional<AdaptiveBatchSizer> batchSizer;
+
+        // Measures the round trip of each batch of this range's query.
+        Timer batchTimer;
+    };
+
+    /**
+     * Returns whether the collection should be fetched by several concurrent queries, one per
+     * range of _id values, rather than by a single query in natural order.
+     */
+    bool shouldPartitionQuery() const;
+
+    /**
+     * Splits the _id index of the source collection into ranges holding roughly the same number
+     * of documents, from a sample of the collection taken on the source.
+     */
+    void initializeQueryPartitions();
+
+    /**
+     * Runs one query per unfinished partition, each on its own connection, as work scheduled on
+     * the cloner's executor, and waits for all of them. Without an executor the queries run one
+     * after another. Throws the most severe error any of the queries failed with.
+     */
+    void runPartitionedQuery();
+
+    /**
+     * Connects to the source and fetches the documents of 'partition' which have not been
+     * received yet. The connection is registered with the shared data, so that canceling
+     * initial sync interrupts the query.
+     */
+    void runPartitionQuery(QueryPartition* partition);
+
+    /**
+     * Schedules the insertion of a batch of documents received for 'partition'. Unlike
+     * handleNextBatch, may be called concurrently for different partitions. Waits for earlier
+     * batches to be inserted first if the batch would take the documents queued for insertion
+     * over 'collectionClonerPartitionMaxQueuedBytes'.
+     */
+    void handleNextPartitionBatch(QueryPartition* partition, DBClientCursorBatchIterator& iter);
+
+    /**
+     * Throws if initial sync has failed, to stop the query that is running.
+     */
+    void checkInitialSyncNotFailed();
+
     /**
      * Called whenever there is a new batch of documents ready from the DBClientConnection.
      *
@@ -220,6 +301,39 @@ private:
      */
     void insertDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd);
 
+    /**
+     * Inserts the documents received for one partition of a partitioned query.
+     */
+    void insertPartitionDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd,
+                                          const std::vector<BSONObj>& docs,
+                                          long long docsBytes);
+
+    /**
+     * Waits until 'bytes' more bytes of documents can be queued for insertion, and accounts for
+     * them. Throws if initial sync fails meanwhile.
+     */
+    void waitToQueuePartitionBytes(long long bytes);
+
+    /**
+     * Accounts for 'bytes' bytes of queued documents having been inserted or dropped.
+     */
+    void releaseQueuedPartitionBytes(long long bytes);
+
+    /**
+     * Inserts 'docs' into the collection and accounts for them in the stats.
+     */
+    void insertDocuments(WithLock, const std::vector<BSONObj>& docs);
+
+    /**
+     * Implements the 'initialSyncHangCollectionClonerAfterHandlingBatchResponse' fail point.
+     */
+    void hangAfterHandlingBatchResponseIfNeeded();
+
+    /**
+     * Implements the 'initialSyncHangDuringCollectionClone' fail point.
+     */
+    void hangDuringCollectionCloneIfNeeded();
+
     /**
      * Sends a query command to the source. That query command with be parameterized based on
      * wire version and clone progress.
@@ -259,6 +373,8 @@ private:
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (X)
     //  Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;  // (R)
+    // Function for creating the connections of a partitioned query.
+    CreateClientFn _createClientFn;  // (R)
     // Documents read from source to insert.
     std::vector<BSONObj> _documentsToInsert;  // (M)
     Stats _stats;                             // (M)
@@ -278,10 +394,28 @@ private:
     // If true, it means we are starting a new query or resuming an interrupted one.
     bool _firstBatchOfQueryRound = true;  // (X)
 
+    // Chooses the batch size of the query when 'collectionClonerAdaptiveBatchSize' is enabled.
+    // Created by the first query round, from '_collectionClonerBatchSize', and kept by the
+    // retries.
+    boost::optional<AdaptiveBatchSizer> _batchSizer;  // (X)
+
+    // Measures the round trip of each batch of the query, from when the previous batch was
+    // handled.
+    Timer _batchTimer;  // (X)
+
     // Only set during non-resumable (4.2) queries.
     // Signifies that there were changes to the collection on the sync source that resulted in
     // our remote cursor getting killed.
     bool _lostNonResumableCursor = false;  // (X)
+
+    // The ranges of a partitioned query. Empty until the first partitioned query round. Each
+    // partition is only modified by the executor task running its query.
+    std::vector<QueryPartition> _queryPartitions;  // (X)
+
+    // The size of the documents received by the queries of a partitioned query and not inserted
+    // yet, and the condition the queries wait on for it to drop.
+    long long _queuedPartitionBytes = 0;                 // (M)
+    stdx::condition_variable _queuedPartitionBytesCond;  // (M)
 };
 
 }  // namespace repl
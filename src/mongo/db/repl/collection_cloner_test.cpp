@@ -39,8 +39,12 @@
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/executor/thread_pool_task_executor.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
@@ -123,6 +127,11 @@ protected:
         return cloner->_idIndexSpec;
     }
 
+    long long getQueuedPartitionBytes(CollectionCloner* cloner) {
+        stdx::lock_guard<Latch> lk(cloner->_mutex);
+        return cloner->_queuedPartitionBytes;
+    }
+
     std::shared_ptr<CollectionMockStats> _collectionStats;  // Used by the _loader.
     StorageInterfaceMock::CreateCollectionForBulkFn _standardCreateCollectionFn;
     CollectionBulkLoaderMock* _loader = nullptr;  // Owned by CollectionCloner.
@@ -1229,5 +1238,148 @@ TEST_F(CollectionClonerTestNonResumable, NonResumableCursorErrorThenSuccessEqual
     clonerThread.join();
 }
 
+TEST_F(CollectionClonerTestResumable, PartitionedQueryFailTransientlyAfterFirstBatchRetrySuccess) {
+    RAIIServerParameterControllerForTest partitions("collectionClonerPartitions", 2);
+    RAIIServerParameterControllerForTest partitionMinBytes("collectionClonerPartitionMinBytes", 0);
+    _mockServer->setCommandReply("replSetGetRBID", fromjson("{ok:1, rbid:1}"));
+
+    // Set up data for preliminary stages
+    auto idIndexSpec = BSON("v" << 1 << "key" << BSON("_id" << 1) << "name"
+                                << "_id_");
+    setMockServerReplies(BSON("size" << 60),
+                         createCountResponse(6),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(idIndexSpec)));
+
+    // The sample splits the collection into the partitions [MinKey, 3) and [3, MaxKey).
+    _mockServer->setCommandReply("aggregate",
+                                 createCursorResponse(_nss.ns(), BSON_ARRAY(BSON("_id" << 3))));
+
+    // Set up documents to be returned from upstream node.
+    for (int i = 1; i <= 6; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    // Run the partition queries on an executor, as initial sync does.
+    ThreadPool::Options options;
+    options.onCreateThread = [](StringData threadName) { Client::initThread(threadName); };
+    executor::ThreadPoolTaskExecutor executor(std::make_unique<ThreadPool>(options),
+                                              std::make_unique<executor::NetworkInterfaceMock>());
+    executor.startup();
+    ON_BLOCK_EXIT([&] {
+        executor.shutdown();
+        executor.join();
+    });
+
+    // Preliminary setup for hanging failpoint.
+    auto afterBatchFailpoint =
+        globalFailPointRegistry().find("initialSyncHangCollectionClonerAfterHandlingBatchResponse");
+    afterBatchFailpoint->setMode(FailPoint::alwaysOn, 0);
+
+    auto cloner = makeCollectionCloner();
+    cloner->setBatchSize_forTest(2);
+    cloner->setExecutor(&executor);
+    cloner->setCreateClientFn_forTest(
+        [this] { return std::make_unique<MockDBClientConnection>(_mockServer.get()); });
+
+    // Run the cloner in a separate thread.
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    // Wait for each partition to process its first batch.
+    while (cloner->getStats().receivedBatches < 2) {
+        sleepmillis(10);
+    }
+    ASSERT_EQUALS(2u, cloner->getStats().queryPartitions);
+
+    // This will cause the next batch of each partition to fail once (transiently).
+    auto failNextBatch = globalFailPointRegistry().find("mockCursorThrowErrorOnGetMore");
+    failNextBatch->setMode(FailPoint::nTimes, 2, fromjson("{errorType: 'HostUnreachable'}"));
+
+    // Let the query stage finish.
+    afterBatchFailpoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    // Each retried partition resumed at the last _id it received rather than at the start of its
+    // range, which would lead to insertCount=10.
+    ASSERT_EQUALS(6, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    auto stats = cloner->getStats();
+    ASSERT_EQUALS(6u, stats.documentsCopied);
+}
+
+TEST_F(CollectionClonerTestResumable, PartitionedQueryWaitsForQueuedDocumentsToBeInserted) {
+    RAIIServerParameterControllerForTest partitions("collectionClonerPartitions", 2);
+    RAIIServerParameterControllerForTest partitionMinBytes("collectionClonerPartitionMinBytes", 0);
+    RAIIServerParameterControllerForTest maxQueuedBytes("collectionClonerPartitionMaxQueuedBytes",
+                                                        1);
+    _mockServer->setCommandReply("replSetGetRBID", fromjson("{ok:1, rbid:1}"));
+
+    // Set up data for preliminary stages
+    auto idIndexSpec = BSON("v" << 1 << "key" << BSON("_id" << 1) << "name"
+                                << "_id_");
+    setMockServerReplies(BSON("size" << 60),
+                         createCountResponse(6),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(idIndexSpec)));
+
+    // The sample splits the collection into the partitions [MinKey, 3) and [3, MaxKey).
+    _mockServer->setCommandReply("aggregate",
+                                 createCursorResponse(_nss.ns(), BSON_ARRAY(BSON("_id" << 3))));
+
+    // Set up documents to be returned from upstream node.
+    for (int i = 1; i <= 6; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    ThreadPool::Options options;
+    options.onCreateThread = [](StringData threadName) { Client::initThread(threadName); };
+    executor::ThreadPoolTaskExecutor executor(std::make_unique<ThreadPool>(options),
+                                              std::make_unique<executor::NetworkInterfaceMock>());
+    executor.startup();
+    ON_BLOCK_EXIT([&] {
+        executor.shutdown();
+        executor.join();
+    });
+
+    // Hold up the insertion of the first batch, which keeps its documents queued.
+    auto duringCloneFailPoint =
+        globalFailPointRegistry().find("initialSyncHangDuringCollectionClone");
+    auto timesEntered = duringCloneFailPoint->setMode(
+        FailPoint::alwaysOn, 0, BSON("namespace" << _nss.ns() << "numDocsToClone" << 0));
+
+    auto cloner = makeCollectionCloner();
+    cloner->setBatchSize_forTest(2);
+    cloner->setExecutor(&executor);
+    cloner->setCreateClientFn_forTest(
+        [this] { return std::make_unique<MockDBClientConnection>(_mockServer.get()); });
+
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    // Wait for each partition to receive its first batch.
+    duringCloneFailPoint->waitForTimesEntered(timesEntered + 1);
+    while (cloner->getStats().receivedBatches < 2) {
+        sleepmillis(10);
+    }
+
+    // Only the first batch is queued: the other partition waits for it to be inserted rather than
+    // queue its own batch past the limit.
+    sleepmillis(100);
+    const long long batchBytes = 2 * BSON("_id" << 1).objsize();
+    ASSERT_EQUALS(batchBytes, getQueuedPartitionBytes(cloner.get()));
+    ASSERT_EQUALS(2u, cloner->getStats().documentsCopied);
+
+    duringCloneFailPoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    ASSERT_EQUALS(6, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(6u, cloner->getStats().documentsCopied);
+    ASSERT_EQUALS(0, getQueuedPartitionBytes(cloner.get()));
+}
+
 }  // namespace repl
 }  // namespace mongo
@@ -139,6 +139,7 @@ void DatabaseCloner::postStage() {
                                                                           getClient(),
                                                                           getStorageInterface(),
                                                                           getDBPool());
+            _currentCollectionCloner->setExecutor(getExecutor());
         }
         auto collStatus = _currentCollectionCloner->run();
         if (collStatus.isOK()) {
@@ -0,0 +1,410 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_based_initial_syncer.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/repl/data_replicator_external_state.h"
+#include "mongo/db/repl/initial_syncer_factory.h"
+#include "mongo/db/repl/sync_source_selector.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * Returns whether 'filename' names a file within the dbpath, like the files of a backup cursor do.
+ * The names come from the sync source, and must not lead out of the staging directory.
+ */
+bool isRelativePathWithinDirectory(const std::string& filename) {
+    const boost::filesystem::path path(filename);
+    return !path.empty() && path.is_relative() &&
+        std::none_of(path.begin(), path.end(), [](const boost::filesystem::path& component) {
+               return component == "..";
+           });
+}
+
+}  // namespace
+
+void FileCopyBasedInitialSyncer::registerInitialSyncer(ServiceContext* service,
+                                                       FileCopyOptions fileCopyOptions) {
+    InitialSyncerFactory::get(service)->registerInitialSyncer(
+        InitialSyncerFactory::kFileCopyBasedInitialSyncMethod.toString(),
+        [fileCopyOptions = std::move(fileCopyOptions)](
+            InitialSyncerOptions opts,
+            std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+            ThreadPool* writerPool,
+            StorageInterface* storage,
+            ReplicationProcess* replicationProcess,
+            const InitialSyncerInterface::OnCompletionFn& onCompletion) {
+            return std::make_shared<FileCopyBasedInitialSyncer>(
+                std::move(opts), fileCopyOptions, writerPool, onCompletion);
+        });
+}
+
+FileCopyBasedInitialSyncer::FileCopyBasedInitialSyncer(InitialSyncerOptions opts,
+                                                       FileCopyOptions fileCopyOptions,
+                                                       ThreadPool* writerPool,
+                                                       OnCompletionFn onCompletion)
+    : _opts(std::move(opts)),
+      _fileCopyOptions(std::move(fileCopyOptions)),
+      _writerPool(writerPool),
+      _onCompletion(std::move(onCompletion)) {
+    uassert(ErrorCodes::BadValue, "sync source selector cannot be null", _opts.syncSourceSelector);
+    uassert(ErrorCodes::BadValue, "writer pool cannot be null", _writerPool);
+    uassert(ErrorCodes::BadValue, "callback function cannot be null", _onCompletion);
+    uassert(ErrorCodes::BadValue,
+            "backup file source cannot be null",
+            _fileCopyOptions.makeBackupFileSource);
+    uassert(ErrorCodes::BadValue,
+            "function to switch to the copied files cannot be null",
+            _fileCopyOptions.switchToCopiedFiles);
+    uassert(ErrorCodes::BadValue,
+            "staging directory cannot be empty",
+            !_fileCopyOptions.stagingDirectory.empty());
+    uassert(ErrorCodes::BadValue,
+            "chunk size must be positive",
+            _fileCopyOptions.chunkSizeBytes > 0);
+}
+
+FileCopyBasedInitialSyncer::~FileCopyBasedInitialSyncer() {
+    DESTRUCTOR_GUARD({
+        shutdown().transitional_ignore();
+        join();
+    });
+}
+
+Status FileCopyBasedInitialSyncer::startup(OperationContext* opCtx,
+                                           std::uint32_t maxAttempts) noexcept {
+    invariant(maxAttempts > 0);
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        switch (_state) {
+            case State::kPreStart:
+                _state = State::kRunning;
+                break;
+            case State::kRunning:
+                return Status(ErrorCodes::IllegalOperation, "initial syncer already started");
+            case State::kShuttingDown:
+                return Status(ErrorCodes::ShutdownInProgress, "initial syncer shutting down");
+            case State::kComplete:
+                return Status(ErrorCodes::ShutdownInProgress, "initial syncer completed");
+        }
+        _maxAttempts = maxAttempts;
+        _startDate = Date_t::now();
+    }
+
+    _writerPool->schedule([this, maxAttempts](Status status) {
+        if (!status.isOK()) {
+            _finish(status);
+            return;
+        }
+        _run(maxAttempts);
+    });
+    return Status::OK();
+}
+
+Status FileCopyBasedInitialSyncer::shutdown() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    switch (_state) {
+        case State::kPreStart:
+            // Transition directly from PreStart to Complete if not started yet.
+            _state = State::kComplete;
+            return Status::OK();
+        case State::kRunning:
+            _state = State::kShuttingDown;
+            break;
+        case State::kShuttingDown:
+        case State::kComplete:
+            // Nothing to do if we are already in ShuttingDown or Complete state.
+            return Status::OK();
+    }
+    _stateCondition.notify_all();
+    return Status::OK();
+}
+
+void FileCopyBasedInitialSyncer::join() {
+    stdx::unique_lock<Latch> lk(_mutex);
+    _stateCondition.wait(lk, [this, &lk] { return !_isActive(lk); });
+}
+
+BSONObj FileCopyBasedInitialSyncer::getInitialSyncProgress() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (!_isActive(lk)) {
+        return BSONObj();
+    }
+
+    BSONObjBuilder bob;
+    bob.append("method", getInitialSyncMethod());
+    bob.appendNumber("failedInitialSyncAttempts", static_cast<long long>(_failedAttempts));
+    bob.appendNumber("maxFailedInitialSyncAttempts", static_cast<long long>(_maxAttempts));
+    bob.appendDate("initialSyncStart", _startDate);
+    if (!_syncSource.empty()) {
+        bob.append("syncSource", _syncSource.toString());
+    }
+    if (_checkpoint) {
+        _checkpoint->opTime.append(&bob, "backupCheckpoint");
+    }
+    bob.appendNumber("totalFiles", static_cast<long long>(_filesToCopy));
+    bob.appendNumber("copiedFiles", static_cast<long long>(_filesCopied));
+    bob.appendNumber("totalBytes", static_cast<long long>(_bytesToCopy));
+    bob.appendNumber("copiedBytes", static_cast<long long>(_bytesCopied));
+    return bob.obj();
+}
+
+void FileCopyBasedInitialSyncer::cancelCurrentAttempt() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_state == State::kRunning) {
+        _attemptCanceled = true;
+        _stateCondition.notify_all();
+    }
+}
+
+std::string FileCopyBasedInitialSyncer::getInitialSyncMethod() const {
+    return InitialSyncerFactory::kFileCopyBasedInitialSyncMethod.toString();
+}
+
+void FileCopyBasedInitialSyncer::_run(std::uint32_t maxAttempts) {
+    StatusWith<OpTimeAndWallTime> lastApplied =
+        Status(ErrorCodes::CallbackCanceled, "file copy based initial syncer is shutting down");
+    for (std::uint32_t attempt = 1; attempt <= maxAttempts; ++attempt) {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            if (_state != State::kRunning) {
+                break;
+            }
+            _attemptCanceled = false;
+        }
+
+        LOGV2(6179075,
+              "Starting file copy based initial sync attempt",
+              "attempt"_attr = attempt,
+              "maxAttempts"_attr = maxAttempts);
+        lastApplied = _runAttempt();
+        if (lastApplied.isOK()) {
+            break;
+        }
+
+        LOGV2(6179076,
+              "File copy based initial sync attempt failed",
+              "attempt"_attr = attempt,
+              "maxAttempts"_attr = maxAttempts,
+              "error"_attr = lastApplied.getStatus());
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        ++_failedAttempts;
+        if (attempt < maxAttempts) {
+            _stateCondition.wait_for(lk, _opts.initialSyncRetryWait.toSystemDuration(), [&] {
+                return _state != State::kRunning;
+            });
+        }
+    }
+    _finish(lastApplied);
+}
+
+StatusWith<OpTimeAndWallTime> FileCopyBasedInitialSyncer::_runAttempt() {
+    const auto syncSource = _opts.syncSourceSelector->chooseNewSyncSource(OpTime());
+    if (syncSource.empty()) {
+        return Status(ErrorCodes::InitialSyncOplogSourceMissing,
+                      "No valid sync source available to copy files from");
+    }
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _syncSource = syncSource;
+        _checkpoint = boost::none;
+        _filesToCopy = _filesCopied = 0;
+        _bytesToCopy = _bytesCopied = 0;
+    }
+
+    auto source = _fileCopyOptions.makeBackupFileSource(syncSource);
+    auto swBackupCursor = source->openBackupCursor();
+    if (!swBackupCursor.isOK()) {
+        return swBackupCursor.getStatus().withContext(
+            str::stream() << "Failed to open a backup cursor on " << syncSource);
+    }
+    const auto& backupCursor = swBackupCursor.getValue();
+    auto closeBackupCursor =
+        makeGuard([&] { source->closeBackupCursor(backupCursor.backupId); });
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _checkpoint = backupCursor.checkpoint;
+        _filesToCopy = backupCursor.files.size();
+        for (auto&& file : backupCursor.files) {
+            _bytesToCopy += file.size;
+        }
+    }
+
+    // The files are copied into an empty directory, so that none is left from an earlier attempt.
+    const boost::filesystem::path stagingDirectory(_fileCopyOptions.stagingDirectory);
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(stagingDirectory, ec);
+    if (!ec) {
+        boost::filesystem::create_directories(stagingDirectory, ec);
+    }
+    if (ec) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to empty the staging directory "
+                                    << stagingDirectory.string() << ": " << ec.message());
+    }
+
+    for (auto&& file : backupCursor.files) {
+        auto status = _copyFile(source.get(), backupCursor.backupId, file);
+        if (!status.isOK()) {
+            return status.withContext(str::stream() << "Failed to copy '" << file.filename
+                                                    << "' from " << syncSource);
+        }
+    }
+
+    closeBackupCursor.dismiss();
+    source->closeBackupCursor(backupCursor.backupId);
+
+    if (auto status = _checkForShutdownOrCancel(); !status.isOK()) {
+        return status;
+    }
+    if (auto status = _fileCopyOptions.switchToCopiedFiles(_fileCopyOptions.stagingDirectory,
+                                                           backupCursor.checkpoint);
+        !status.isOK()) {
+        return status.withContext("Failed to switch to the copied files");
+    }
+
+    LOGV2(6179077,
+          "Copied the data files of the sync source",
+          "syncSource"_attr = syncSource,
+          "numFiles"_attr = backupCursor.files.size(),
+          "checkpoint"_attr = backupCursor.checkpoint.opTime);
+    return backupCursor.checkpoint;
+}
+
+Status FileCopyBasedInitialSyncer::_copyFile(BackupFileSource* source,
+                                             const UUID& backupId,
+                                             const BackupCursorInfo::File& file) {
+    if (!isRelativePathWithinDirectory(file.filename)) {
+        return Status(ErrorCodes::InvalidPath,
+                      str::stream() << "Backup file '" << file.filename
+                                    << "' is not within the dbpath of the sync source");
+    }
+
+    const auto path = boost::filesystem::path(_fileCopyOptions.stagingDirectory) / file.filename;
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to create the directory of " << path.string()
+                                    << ": " << ec.message());
+    }
+
+    std::ofstream out(path.string(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return Status(ErrorCodes::FileOpenFailed,
+                      str::stream() << "Failed to open " << path.string() << " for writing");
+    }
+
+    std::int64_t offset = 0;
+    while (offset < file.size) {
+        if (auto status = _checkForShutdownOrCancel(); !status.isOK()) {
+            return status;
+        }
+
+        const auto length = std::min(_fileCopyOptions.chunkSizeBytes, file.size - offset);
+        auto swChunk = source->readFile(backupId, file.filename, offset, length);
+        if (!swChunk.isOK()) {
+            return swChunk.getStatus();
+        }
+        const auto& chunk = swChunk.getValue();
+        if (chunk.empty() || static_cast<std::int64_t>(chunk.size()) > length) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "Read " << chunk.size() << " bytes at offset " << offset
+                                        << " of a file of " << file.size << " bytes, instead of "
+                                        << length);
+        }
+
+        out.write(chunk.data(), chunk.size());
+        if (!out) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "Failed to write to " << path.string());
+        }
+        offset += chunk.size();
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        _bytesCopied += chunk.size();
+    }
+
+    out.close();
+    if (!out) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to write to " << path.string());
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    ++_filesCopied;
+    return Status::OK();
+}
+
+Status FileCopyBasedInitialSyncer::_checkForShutdownOrCancel() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_state != State::kRunning) {
+        return Status(ErrorCodes::CallbackCanceled,
+                      "file copy based initial syncer is shutting down");
+    }
+    if (_attemptCanceled) {
+        return Status(ErrorCodes::CallbackCanceled, "initial sync attempt canceled");
+    }
+    return Status::OK();
+}
+
+void FileCopyBasedInitialSyncer::_finish(const StatusWith<OpTimeAndWallTime>& lastApplied) {
+    _onCompletion(lastApplied);
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _state = State::kComplete;
+    _stateCondition.notify_all();
+}
+
+bool FileCopyBasedInitialSyncer::_isActive(WithLock) const {
+    return _state == State::kRunning || _state == State::kShuttingDown;
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,229 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/db/repl/initial_syncer_interface.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class ServiceContext;
+class ThreadPool;
+
+namespace repl {
+
+/**
+ * The data files of a sync source, as listed by a backup cursor opened on it.
+ */
+struct BackupCursorInfo {
+    struct File {
+        // The path of the file, relative to the dbpath of the sync source.
+        std::string filename;
+        std::int64_t size;
+    };
+
+    UUID backupId;
+
+    // The optime of the last oplog entry in the checkpoint the files hold. Oplog entries after it
+    // must be fetched from the sync source and applied to catch up.
+    OpTimeAndWallTime checkpoint;
+
+    std::vector<File> files;
+};
+
+/**
+ * Reads the data files of a sync source through a backup cursor. While the backup cursor is open,
+ * the sync source keeps the files of the checkpoint it was opened on unchanged.
+ */
+class BackupFileSource {
+public:
+    virtual ~BackupFileSource() = default;
+
+    virtual StatusWith<BackupCursorInfo> openBackupCursor() = 0;
+
+    /**
+     * Reads at most 'length' bytes of the file 'filename' of the backup cursor 'backupId',
+     * starting at 'offset'. Returns fewer bytes only at the end of the file.
+     */
+    virtual StatusWith<std::string> readFile(const UUID& backupId,
+                                             const std::string& filename,
+                                             std::int64_t offset,
+                                             std::int64_t length) = 0;
+
+    virtual void closeBackupCursor(const UUID& backupId) = 0;
+};
+
+/**
+ * Initial sync by copying the data files of the sync source, rather than cloning its documents
+ * and rebuilding its indexes:
+ *
+ *     1. Chooses a sync source, and opens a backup cursor on it.
+ *     2. Copies the files of the backup cursor into an empty staging directory, in chunks.
+ *     3. Closes the backup cursor.
+ *     4. Has this node switch to the copied files.
+ *     5. Reports the optime of the checkpoint of the backup cursor as the last applied optime, so
+ *        that steady state replication fetches and applies the oplog from there to catch up.
+ *
+ * Failed attempts are retried after InitialSyncerOptions::initialSyncRetryWait, each with a new
+ * backup cursor. The attempts run one after another on a thread of the writer pool.
+ *
+ * The storage engine cannot replace its files while it is running, and a sync source serves
+ * backup cursors only through BackupCursorHooks. So this initial syncer is only available once
+ * registerInitialSyncer() has been given a way to read the files of a sync source and to switch
+ * to the copied ones.
+ */
+class FileCopyBasedInitialSyncer final : public InitialSyncerInterface {
+    FileCopyBasedInitialSyncer(const FileCopyBasedInitialSyncer&) = delete;
+    FileCopyBasedInitialSyncer& operator=(const FileCopyBasedInitialSyncer&) = delete;
+
+public:
+    /**
+     * Returns a BackupFileSource reading from 'syncSource'.
+     */
+    using MakeBackupFileSourceFn =
+        std::function<std::unique_ptr<BackupFileSource>(const HostAndPort& syncSource)>;
+
+    /**
+     * Replaces the data of this node with the files copied into 'directory', which hold the data
+     * of the sync source as of 'checkpoint'.
+     */
+    using SwitchToCopiedFilesFn = std::function<Status(const std::string& directory,
+                                                       const OpTimeAndWallTime& checkpoint)>;
+
+    struct FileCopyOptions {
+        MakeBackupFileSourceFn makeBackupFileSource;
+        SwitchToCopiedFilesFn switchToCopiedFiles;
+
+        // The directory the files are copied into. It is emptied at the start of each attempt.
+        std::string stagingDirectory;
+
+        // The number of bytes read from the sync source at once.
+        std::int64_t chunkSizeBytes = 16 * 1024 * 1024;
+    };
+
+    /**
+     * Registers this initial syncer with the InitialSyncerFactory of 'service', under the
+     * 'fileCopyBased' initial sync method.
+     */
+    static void registerInitialSyncer(ServiceContext* service, FileCopyOptions fileCopyOptions);
+
+    FileCopyBasedInitialSyncer(InitialSyncerOptions opts,
+                               FileCopyOptions fileCopyOptions,
+                               ThreadPool* writerPool,
+                               OnCompletionFn onCompletion);
+
+    ~FileCopyBasedInitialSyncer();
+
+    Status startup(OperationContext* opCtx, std::uint32_t maxAttempts) noexcept final;
+
+    Status shutdown() final;
+
+    void join() final;
+
+    BSONObj getInitialSyncProgress() const final;
+
+    void cancelCurrentAttempt() final;
+
+    std::string getInitialSyncMethod() const final;
+
+private:
+    enum class State { kPreStart, kRunning, kShuttingDown, kComplete };
+
+    /**
+     * Runs up to 'maxAttempts' attempts, until one succeeds, and then reports the outcome.
+     */
+    void _run(std::uint32_t maxAttempts);
+
+    /**
+     * Returns the optime of the checkpoint of the copied files.
+     */
+    StatusWith<OpTimeAndWallTime> _runAttempt();
+
+    Status _copyFile(BackupFileSource* source,
+                     const UUID& backupId,
+                     const BackupCursorInfo::File& file);
+
+    /**
+     * Returns an error if the initial syncer is shutting down or the attempt was canceled.
+     */
+    Status _checkForShutdownOrCancel() const;
+
+    void _finish(const StatusWith<OpTimeAndWallTime>& lastApplied);
+
+    bool _isActive(WithLock) const;
+
+    // All member variables are labeled with one of the following codes indicating the
+    // synchronization rules for accessing them.
+    //
+    // (R)  Read-only in concurrent operation; no synchronization required.
+    // (S)  Self-synchronizing; access in any way from any context.
+    // (M)  Reads and writes guarded by _mutex.
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("FileCopyBasedInitialSyncer::_mutex");  // (S)
+    stdx::condition_variable _stateCondition;                                       // (M)
+
+    const InitialSyncerOptions _opts;                                               // (R)
+    const FileCopyOptions _fileCopyOptions;                                         // (R)
+    ThreadPool* const _writerPool;                                                  // (R)
+    const OnCompletionFn _onCompletion;                                             // (R)
+
+    State _state = State::kPreStart;                                                // (M)
+    bool _attemptCanceled = false;                                                  // (M)
+
+    // Progress of the initial sync, as reported by getInitialSyncProgress().
+    std::uint32_t _maxAttempts = 0;                                                 // (M)
+    std::uint32_t _failedAttempts = 0;                                              // (M)
+    Date_t _startDate;                                                              // (M)
+    HostAndPort _syncSource;                                                        // (M)
+    boost::optional<OpTimeAndWallTime> _checkpoint;                                 // (M)
+    std::size_t _filesToCopy = 0;                                                   // (M)
+    std::size_t _filesCopied = 0;                                                   // (M)
+    std::int64_t _bytesToCopy = 0;                                                  // (M)
+    std::int64_t _bytesCopied = 0;                                                  // (M)
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,262 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kTest
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "mongo/db/repl/data_replicator_external_state_mock.h"
+#include "mongo/db/repl/file_copy_based_initial_syncer.h"
+#include "mongo/db/repl/initial_syncer_factory.h"
+#include "mongo/db/repl/sync_source_selector_mock.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * Serves files from memory, as a sync source serves the files of a backup cursor.
+ */
+class BackupFileSourceMock : public BackupFileSource {
+public:
+    struct State {
+        std::map<std::string, std::string> files;
+        OpTimeAndWallTime checkpoint;
+
+        // The number of calls to openBackupCursor() to fail before serving the files.
+        int openFailures = 0;
+        int numOpened = 0;
+        int numClosed = 0;
+    };
+
+    explicit BackupFileSourceMock(State* state) : _state(state) {}
+
+    StatusWith<BackupCursorInfo> openBackupCursor() override {
+        if (_state->openFailures > 0) {
+            --_state->openFailures;
+            return Status(ErrorCodes::HostUnreachable, "failed to open backup cursor");
+        }
+        ++_state->numOpened;
+
+        BackupCursorInfo info{_backupId, _state->checkpoint, {}};
+        for (auto&& [filename, contents] : _state->files) {
+            info.files.push_back({filename, static_cast<std::int64_t>(contents.size())});
+        }
+        return info;
+    }
+
+    StatusWith<std::string> readFile(const UUID& backupId,
+                                     const std::string& filename,
+                                     std::int64_t offset,
+                                     std::int64_t length) override {
+        ASSERT_EQUALS(_backupId, backupId);
+        auto it = _state->files.find(filename);
+        if (it == _state->files.end()) {
+            return Status(ErrorCodes::NoSuchKey, "no such file");
+        }
+        return it->second.substr(offset, length);
+    }
+
+    void closeBackupCursor(const UUID& backupId) override {
+        ASSERT_EQUALS(_backupId, backupId);
+        ++_state->numClosed;
+    }
+
+private:
+    State* const _state;
+    const UUID _backupId = UUID::gen();
+};
+
+class FileCopyBasedInitialSyncerTest : public ServiceContextTest {
+protected:
+    void setUp() override {
+        ServiceContextTest::setUp();
+
+        ThreadPool::Options options;
+        options.poolName = "FileCopyBasedInitialSyncerTest";
+        _writerPool = std::make_unique<ThreadPool>(options);
+        _writerPool->startup();
+
+        _syncSourceSelector.setChooseNewSyncSourceResult_forTest(_syncSource);
+        _backupFileSource.checkpoint = {OpTime(Timestamp(20, 1), 1),
+                                        Date_t::fromMillisSinceEpoch(20)};
+
+        FileCopyBasedInitialSyncer::FileCopyOptions fileCopyOptions;
+        fileCopyOptions.makeBackupFileSource = [this](const HostAndPort& syncSource) {
+            ASSERT_EQUALS(_syncSource, syncSource);
+            return std::make_unique<BackupFileSourceMock>(&_backupFileSource);
+        };
+        fileCopyOptions.switchToCopiedFiles = [this](const std::string& directory,
+                                                     const OpTimeAndWallTime& checkpoint) {
+            _switchedTo.emplace(directory, checkpoint);
+            return Status::OK();
+        };
+        fileCopyOptions.stagingDirectory = _stagingDirectory();
+        fileCopyOptions.chunkSizeBytes = 4;
+        FileCopyBasedInitialSyncer::registerInitialSyncer(getServiceContext(),
+                                                          std::move(fileCopyOptions));
+    }
+
+    void tearDown() override {
+        _writerPool->shutdown();
+        _writerPool->join();
+        ServiceContextTest::tearDown();
+    }
+
+    /**
+     * Creates an initial syncer for the method named by the 'initialSyncMethod' server parameter.
+     */
+    std::shared_ptr<InitialSyncerInterface> _makeInitialSyncer() {
+        InitialSyncerOptions options;
+        options.syncSourceSelector = &_syncSourceSelector;
+        options.initialSyncRetryWait = Milliseconds(1);
+        return InitialSyncerFactory::get(getServiceContext())
+            ->makeInitialSyncer(options,
+                                std::make_unique<DataReplicatorExternalStateMock>(),
+                                _writerPool.get(),
+                                nullptr,
+                                nullptr,
+                                [this](const StatusWith<OpTimeAndWallTime>& lastApplied) {
+                                    _lastApplied = lastApplied;
+                                });
+    }
+
+    /**
+     * Runs an initial sync with the given number of attempts, and returns its outcome.
+     */
+    StatusWith<OpTimeAndWallTime> _runInitialSync(std::uint32_t maxAttempts) {
+        RAIIServerParameterControllerForTest initialSyncMethod("initialSyncMethod",
+                                                               "fileCopyBased");
+        auto initialSyncer = _makeInitialSyncer();
+        ASSERT_EQUALS("fileCopyBased", initialSyncer->getInitialSyncMethod());
+
+        auto opCtx = makeOperationContext();
+        ASSERT_OK(initialSyncer->startup(opCtx.get(), maxAttempts));
+        initialSyncer->join();
+        return _lastApplied;
+    }
+
+    std::string _stagingDirectory() const {
+        return (boost::filesystem::path(_tempDir.path()) / "staging").string();
+    }
+
+    std::string _readStagedFile(const std::string& filename) const {
+        std::ifstream in((boost::filesystem::path(_stagingDirectory()) / filename).string(),
+                         std::ios::binary);
+        ASSERT_TRUE(in.good()) << filename;
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    const HostAndPort _syncSource{"localhost", 12345};
+    unittest::TempDir _tempDir{"FileCopyBasedInitialSyncerTest"};
+    std::unique_ptr<ThreadPool> _writerPool;
+    SyncSourceSelectorMock _syncSourceSelector;
+    BackupFileSourceMock::State _backupFileSource;
+    boost::optional<std::pair<std::string, OpTimeAndWallTime>> _switchedTo;
+    StatusWith<OpTimeAndWallTime> _lastApplied =
+        Status(ErrorCodes::InternalError, "initial sync did not complete");
+};
+
+TEST_F(FileCopyBasedInitialSyncerTest, InitialSyncMethodSelectsFileCopyBasedInitialSyncer) {
+    auto factory = InitialSyncerFactory::get(getServiceContext());
+    ASSERT_TRUE(factory->hasInitialSyncer(InitialSyncerFactory::kFileCopyBasedInitialSyncMethod));
+
+    RAIIServerParameterControllerForTest initialSyncMethod("initialSyncMethod", "fileCopyBased");
+    auto initialSyncer = _makeInitialSyncer();
+    ASSERT_EQUALS("fileCopyBased", initialSyncer->getInitialSyncMethod());
+    ASSERT_BSONOBJ_EQ(BSONObj(), initialSyncer->getInitialSyncProgress());
+}
+
+TEST_F(FileCopyBasedInitialSyncerTest, CopiesBackupFilesAndSwitchesToThem) {
+    _backupFileSource.files = {{"WiredTiger", "WiredTiger 10.0.1"},
+                               {"collection-0.wt", "0123456789"},
+                               {"journal/WiredTigerLog.0000000001", "log"},
+                               {"empty.wt", ""}};
+
+    ASSERT_EQUALS(_backupFileSource.checkpoint, unittest::assertGet(_runInitialSync(1U)));
+
+    for (auto&& [filename, contents] : _backupFileSource.files) {
+        ASSERT_EQUALS(contents, _readStagedFile(filename));
+    }
+    ASSERT_TRUE(_switchedTo);
+    ASSERT_EQUALS(_stagingDirectory(), _switchedTo->first);
+    ASSERT_EQUALS(_backupFileSource.checkpoint, _switchedTo->second);
+    ASSERT_EQUALS(1, _backupFileSource.numOpened);
+    ASSERT_EQUALS(1, _backupFileSource.numClosed);
+}
+
+TEST_F(FileCopyBasedInitialSyncerTest, RetriesAfterFailedAttempt) {
+    _backupFileSource.files = {{"collection-0.wt", "0123456789"}};
+    _backupFileSource.openFailures = 1;
+
+    ASSERT_EQUALS(_backupFileSource.checkpoint, unittest::assertGet(_runInitialSync(2U)));
+    ASSERT_EQUALS("0123456789", _readStagedFile("collection-0.wt"));
+    ASSERT_TRUE(_switchedTo);
+}
+
+TEST_F(FileCopyBasedInitialSyncerTest, FailsAfterLastAttempt) {
+    _backupFileSource.openFailures = 2;
+
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, _runInitialSync(2U).getStatus());
+    ASSERT_FALSE(_switchedTo);
+}
+
+TEST_F(FileCopyBasedInitialSyncerTest, RejectsFilesOutsideTheDbpath) {
+    _backupFileSource.files = {{"../collection-0.wt", "0123456789"}};
+
+    ASSERT_EQUALS(ErrorCodes::InvalidPath, _runInitialSync(1U).getStatus());
+    ASSERT_FALSE(boost::filesystem::exists(boost::filesystem::path(_tempDir.path()) /
+                                           "collection-0.wt"));
+    ASSERT_FALSE(_switchedTo);
+    ASSERT_EQUALS(1, _backupFileSource.numClosed);
+}
+
+TEST_F(FileCopyBasedInitialSyncerTest, FailsWithoutSyncSource) {
+    _syncSourceSelector.setChooseNewSyncSourceResult_forTest(HostAndPort());
+
+    ASSERT_EQUALS(ErrorCodes::InitialSyncOplogSourceMissing, _runInitialSync(1U).getStatus());
+    ASSERT_EQUALS(0, _backupFileSource.numOpened);
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -31,6 +31,8 @@
 
 #include "mongo/db/repl/initial_sync_shared_data.h"
 
+#include "mongo/client/dbclient_connection.h"
+
 namespace mongo {
 namespace repl {
 int InitialSyncSharedData::incrementRetryingOperations(WithLock lk) {
@@ -76,5 +78,24 @@ Milliseconds InitialSyncSharedData::getCurrentOutageDuration(WithLock lk) {
                                            : Milliseconds::min());
 }
 
+Status InitialSyncSharedData::registerClient(WithLock lk, DBClientConnection* client) {
+    auto status = getStatus(lk);
+    if (!status.isOK()) {
+        return status;
+    }
+    _clients.insert(client);
+    return Status::OK();
+}
+
+void InitialSyncSharedData::unregisterClient(WithLock, DBClientConnection* client) {
+    _clients.erase(client);
+}
+
+void InitialSyncSharedData::shutdownClients(WithLock) {
+    for (auto client : _clients) {
+        client->shutdownAndDisallowReconnect();
+    }
+}
+
 }  // namespace repl
 }  // namespace mongo
@@ -33,8 +33,12 @@
 
 #include "mongo/db/repl/repl_sync_shared_data.h"
 #include "mongo/db/server_options.h"
+#include "mongo/stdx/unordered_set.h"
 
 namespace mongo {
+
+class DBClientConnection;
+
 namespace repl {
 class InitialSyncSharedData final : public ReplSyncSharedData {
 private:
@@ -128,6 +132,24 @@ public:
         _allowedOutageDuration = allowedOutageDuration;
     }
 
+    /**
+     * Registers a connection to the sync source which a cloner opened in addition to the main
+     * one, so that shutdownClients() interrupts it. Fails if initial sync has already failed, in
+     * which case the connection must not be used.
+     */
+    Status registerClient(WithLock lk, DBClientConnection* client);
+
+    /**
+     * Unregisters a connection registered by registerClient(), before it is destroyed.
+     */
+    void unregisterClient(WithLock, DBClientConnection* client);
+
+    /**
+     * Shuts down all registered connections, interrupting any operation running on them. Called
+     * when initial sync is canceled, after setting the failed status.
+     */
+    void shutdownClients(WithLock);
+
 private:
     class RetryingOperation {
     public:
@@ -214,6 +236,9 @@ private:
 
     // The initial sync ID on the source at the start of data cloning.
     boost::optional<UUID> _initialSyncSourceId;
+
+    // Connections registered by cloners, which are shut down when initial sync is canceled.
+    stdx::unordered_set<DBClientConnection*> _clients;
 };
 }  // namespace repl
 }  // namespace mongo
@@ -29,6 +29,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/client/dbclient_connection.h"
 #include "mongo/db/repl/initial_sync_shared_data.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
@@ -231,5 +232,27 @@ TEST(InitialSyncSharedDataTest, OperationTimesOut) {
     ASSERT_EQ(Milliseconds::min(), data.getCurrentOutageDuration(lk));
 }
 
+TEST(InitialSyncSharedDataTest, ShutdownClientsShutsDownRegisteredClients) {
+    Days timeout(1);
+    ClockSourceMock clock;
+    InitialSyncSharedData data(1 /* rollBackId */, timeout, &clock);
+    DBClientConnection registered;
+    DBClientConnection unregistered;
+
+    stdx::lock_guard<InitialSyncSharedData> lk(data);
+    ASSERT_OK(data.registerClient(lk, &registered));
+    ASSERT_OK(data.registerClient(lk, &unregistered));
+    data.unregisterClient(lk, &unregistered);
+
+    data.setStatusIfOK(lk, Status(ErrorCodes::CallbackCanceled, "Initial sync attempt canceled"));
+    data.shutdownClients(lk);
+    ASSERT_TRUE(registered.isFailed());
+    ASSERT_FALSE(unregistered.isFailed());
+
+    // Once initial sync has failed, no more clients may be registered.
+    DBClientConnection late;
+    ASSERT_EQ(ErrorCodes::CallbackCanceled, data.registerClient(lk, &late));
+}
+
 }  // namespace repl
 }  // namespace mongo
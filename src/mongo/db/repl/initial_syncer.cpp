@@ -185,6 +185,25 @@ StatusWith<OpTimeAndWallTime> parseOpTimeAndWallTime(const QueryResponseStatus&
     return OpTimeAndWallTime::parseOpTimeAndWallTimeFromOplogEntry(docs.front());
 }
 
+ServiceContext::ConstructorActionRegisterer registerLogicalInitialSyncer{
+    "RegisterLogicalInitialSyncer", [](ServiceContext* service) {
+        InitialSyncerFactory::get(service)->registerInitialSyncer(
+            InitialSyncerFactory::kLogicalInitialSyncMethod.toString(),
+            [](InitialSyncerOptions opts,
+               std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+               ThreadPool* writerPool,
+               StorageInterface* storage,
+               ReplicationProcess* replicationProcess,
+               const InitialSyncerInterface::OnCompletionFn& onCompletion) {
+                return std::make_shared<InitialSyncer>(std::move(opts),
+                                                       std::move(dataReplicatorExternalState),
+                                                       writerPool,
+                                                       storage,
+                                                       replicationProcess,
+                                                       onCompletion);
+            });
+    }};
+
 void pauseAtInitialSyncFuzzerSyncronizationPoints(std::string msg) {
     // Set and unset by the InitialSyncTest fixture to cause initial sync to pause so that the
     // Initial Sync Fuzzer can run commands on the sync source.
@@ -340,6 +359,7 @@ void InitialSyncer::_cancelRemainingWork_inlock() {
         stdx::lock_guard<InitialSyncSharedData> lock(*_sharedData);
         _sharedData->setStatusIfOK(
             lock, Status{ErrorCodes::CallbackCanceled, "Initial sync attempt canceled"});
+        _sharedData->shutdownClients(lock);
     }
     if (_client) {
         _client->shutdownAndDisallowReconnect();
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/initial_syncer_factory.h"
+
+#include "mongo/db/repl/data_replicator_external_state.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const auto getInitialSyncerFactory = ServiceContext::declareDecoration<InitialSyncerFactory>();
+
+}  // namespace
+
+InitialSyncerFactory* InitialSyncerFactory::get(ServiceContext* service) {
+    return &getInitialSyncerFactory(service);
+}
+
+void InitialSyncerFactory::registerInitialSyncer(const std::string& method,
+                                                 CreateInitialSyncerFunction createFn) {
+    auto inserted = _createFunctions.emplace(method, std::move(createFn)).second;
+    invariant(inserted, str::stream() << "Initial sync method '" << method << "' registered twice");
+}
+
+bool InitialSyncerFactory::hasInitialSyncer(StringData method) const {
+    return _createFunctions.find(method) != _createFunctions.end();
+}
+
+StatusWith<std::shared_ptr<InitialSyncerInterface>> InitialSyncerFactory::makeInitialSyncer(
+    StringData method,
+    InitialSyncerOptions opts,
+    std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+    ThreadPool* writerPool,
+    StorageInterface* storage,
+    ReplicationProcess* replicationProcess,
+    const InitialSyncerInterface::OnCompletionFn& onCompletion) const {
+    auto it = _createFunctions.find(method);
+    if (it == _createFunctions.end()) {
+        return {ErrorCodes::InvalidOptions,
+                str::stream() << "No initial syncer is available for initial sync method '"
+                              << method << "'"};
+    }
+    return it->second(std::move(opts),
+                      std::move(dataReplicatorExternalState),
+                      writerPool,
+                      storage,
+                      replicationProcess,
+                      onCompletion);
+}
+
+std::shared_ptr<InitialSyncerInterface> InitialSyncerFactory::makeInitialSyncer(
+    InitialSyncerOptions opts,
+    std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+    ThreadPool* writerPool,
+    StorageInterface* storage,
+    ReplicationProcess* replicationProcess,
+    const InitialSyncerInterface::OnCompletionFn& onCompletion) const {
+    StringData method = initialSyncMethod;
+    if (!hasInitialSyncer(method)) {
+        LOGV2(6179054,
+              "Initial sync method is not available, using logical initial sync instead",
+              "initialSyncMethod"_attr = method);
+        method = kLogicalInitialSyncMethod;
+    }
+    return uassertStatusOK(makeInitialSyncer(method,
+                                             std::move(opts),
+                                             std::move(dataReplicatorExternalState),
+                                             writerPool,
+                                             storage,
+                                             replicationProcess,
+                                             onCompletion));
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "mongo/base/status_with.h"
+#include "mongo/db/repl/initial_syncer_interface.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class ServiceContext;
+class ThreadPool;
+
+namespace repl {
+
+class DataReplicatorExternalState;
+class ReplicationProcess;
+class StorageInterface;
+
+/**
+ * Creates initial syncers by method name. Each method of initial sync registers a function to
+ * create its initial syncer. The 'logical' method, which clones documents and rebuilds indexes, is
+ * registered when the ServiceContext is constructed and is always available. The 'fileCopyBased'
+ * method, which copies the data files of the sync source, is registered by whoever provides access
+ * to those files. See FileCopyBasedInitialSyncer.
+ */
+class InitialSyncerFactory {
+public:
+    using CreateInitialSyncerFunction = std::function<std::shared_ptr<InitialSyncerInterface>(
+        InitialSyncerOptions opts,
+        std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+        ThreadPool* writerPool,
+        StorageInterface* storage,
+        ReplicationProcess* replicationProcess,
+        const InitialSyncerInterface::OnCompletionFn& onCompletion)>;
+
+    static constexpr StringData kLogicalInitialSyncMethod = "logical"_sd;
+    static constexpr StringData kFileCopyBasedInitialSyncMethod = "fileCopyBased"_sd;
+
+    static InitialSyncerFactory* get(ServiceContext* service);
+
+    /**
+     * Registers the function creating the initial syncers for 'method'. Must be called before any
+     * initial syncer is created.
+     */
+    void registerInitialSyncer(const std::string& method, CreateInitialSyncerFunction createFn);
+
+    /**
+     * Returns whether an initial syncer has been registered for 'method'.
+     */
+    bool hasInitialSyncer(StringData method) const;
+
+    /**
+     * Creates an initial syncer for 'method'. Returns InvalidOptions if no initial syncer is
+     * registered for it.
+     */
+    StatusWith<std::shared_ptr<InitialSyncerInterface>> makeInitialSyncer(
+        StringData method,
+        InitialSyncerOptions opts,
+        std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+        ThreadPool* writerPool,
+        StorageInterface* storage,
+        ReplicationProcess* replicationProcess,
+        const InitialSyncerInterface::OnCompletionFn& onCompletion) const;
+
+    /**
+     * Creates an initial syncer for the method named by the 'initialSyncMethod' server parameter.
+     * Falls back to logical initial sync if no initial syncer is registered for that method.
+     */
+    std::shared_ptr<InitialSyncerInterface> makeInitialSyncer(
+        InitialSyncerOptions opts,
+        std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+        ThreadPool* writerPool,
+        StorageInterface* storage,
+        ReplicationProcess* replicationProcess,
+        const InitialSyncerInterface::OnCompletionFn& onCompletion) const;
+
+private:
+    StringMap<CreateInitialSyncerFunction> _createFunctions;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -67,6 +67,7 @@
 #include "mongo/executor/mock_network_fixture.h"
 #include "mongo/executor/network_interface_mock.h"
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -727,6 +728,62 @@ TEST_F(InitialSyncerTest, InvalidConstruction) {
 
 TEST_F(InitialSyncerTest, CreateDestroy) {}
 
+TEST_F(InitialSyncerTest, FactoryCreatesLogicalInitialSyncer) {
+    auto factory = InitialSyncerFactory::get(getServiceContext());
+    ASSERT_TRUE(factory->hasInitialSyncer(InitialSyncerFactory::kLogicalInitialSyncMethod));
+    ASSERT_FALSE(factory->hasInitialSyncer("noSuchMethod"));
+
+    InitialSyncerOptions options;
+    options.getMyLastOptime = []() { return OpTime(); };
+    options.setMyLastOptime = [](const OpTimeAndWallTime&) {};
+    options.resetOptimes = []() {};
+    options.syncSourceSelector = this;
+    auto callback = [](const StatusWith<OpTimeAndWallTime>&) {};
+
+    {
+        auto dataReplicatorExternalState = std::make_unique<DataReplicatorExternalStateMock>();
+        dataReplicatorExternalState->taskExecutor = _executorProxy;
+        auto initialSyncer =
+            unittest::assertGet(factory->makeInitialSyncer("logical",
+                                                           options,
+                                                           std::move(dataReplicatorExternalState),
+                                                           _dbWorkThreadPool.get(),
+                                                           _storageInterface.get(),
+                                                           _replicationProcess.get(),
+                                                           callback));
+        ASSERT_EQUALS("logical", initialSyncer->getInitialSyncMethod());
+    }
+
+    {
+        auto dataReplicatorExternalState = std::make_unique<DataReplicatorExternalStateMock>();
+        dataReplicatorExternalState->taskExecutor = _executorProxy;
+        ASSERT_EQUALS(ErrorCodes::InvalidOptions,
+                      factory->makeInitialSyncer("noSuchMethod",
+                                                 options,
+                                                 std::move(dataReplicatorExternalState),
+                                                 _dbWorkThreadPool.get(),
+                                                 _storageInterface.get(),
+                                                 _replicationProcess.get(),
+                                                 callback)
+                          .getStatus());
+    }
+
+    {
+        // No file copy based initial syncer is registered, so logical initial sync is used.
+        RAIIServerParameterControllerForTest initialSyncMethod("initialSyncMethod",
+                                                               "fileCopyBased");
+        auto dataReplicatorExternalState = std::make_unique<DataReplicatorExternalStateMock>();
+        dataReplicatorExternalState->taskExecutor = _executorProxy;
+        auto initialSyncer = factory->makeInitialSyncer(options,
+                                                        std::move(dataReplicatorExternalState),
+                                                        _dbWorkThreadPool.get(),
+                                                        _storageInterface.get(),
+                                                        _replicationProcess.get(),
+                                                        callback);
+        ASSERT_EQUALS("logical", initialSyncer->getInitialSyncMethod());
+    }
+}
+
 const std::uint32_t maxAttempts = 1U;
 
 TEST_F(InitialSyncerTest, StartupReturnsIllegalOperationIfAlreadyActive) {
@@ -44,6 +44,7 @@
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/oplog_applier_utils.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_metrics.h"
 #include "mongo/db/repl/transaction_oplog_application.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -73,6 +74,15 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Time spent by writer threads applying their share of a batch, and the time the writer threads
+// spent idle while other writers were still applying the batch.
+Counter64 writerBusyMicros;
+ServerStatusMetricField<Counter64> displayWriterBusyMicros("repl.apply.writers.busyMicros",
+                                                           &writerBusyMicros);
+Counter64 writerIdleMicros;
+ServerStatusMetricField<Counter64> displayWriterIdleMicros("repl.apply.writers.idleMicros",
+                                                           &writerIdleMicros);
+
 /**
  * Used for logging a report of ops that take longer than "slowMS" to apply. This is called
  * right before returning from applyOplogEntryOrGroupedInserts, and it returns the same status.
@@ -453,7 +463,13 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     // Increment the batch size stat.
     oplogApplicationBatchSize.increment(ops.size());
 
-    std::vector<WorkerMultikeyPathInfo> multikeyVector(_writerPool->getStats().options.maxThreads);
+    // Operations are partitioned into more writer vectors than there are writer threads. Each
+    // writer vector only depends on itself, so the threads pick them up as they become free and a
+    // thread given a short vector does not sit idle while another works through a long one.
+    const size_t numWriterThreads = _writerPool->getStats().options.maxThreads;
+    const size_t numWriterVectors = numWriterThreads * replWriterBucketsPerThread.load();
+
+    std::vector<WorkerMultikeyPathInfo> multikeyVector(numWriterVectors);
     {
         // Each node records cumulative batch application stats for itself using this timer.
         TimerHolder timer(&applyBatchStats);
@@ -478,8 +494,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         //   and create a pseudo oplog.
         std::vector<std::vector<OplogEntry>> derivedOps;
 
-        std::vector<std::vector<const OplogEntry*>> writerVectors(
-            _writerPool->getStats().options.maxThreads);
+        std::vector<std::vector<const OplogEntry*>> writerVectors(numWriterVectors);
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
         // Wait for writes to finish before applying ops.
@@ -506,22 +521,38 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 
         {
 
-            std::vector<Status> statusVector(_writerPool->getStats().options.maxThreads,
-                                             Status::OK());
+            std::vector<Status> statusVector(writerVectors.size(), Status::OK());
+
+            // Schedule the longest writer vectors first, so that the longest chain of dependent
+            // operations (e.g. updates to a single hot document) starts as early as possible and
+            // the shorter vectors fill in the remaining threads around it.
+            std::vector<size_t> scheduleOrder;
+            for (size_t i = 0; i < writerVectors.size(); i++) {
+                if (!writerVectors[i].empty())
+                    scheduleOrder.push_back(i);
+            }
+            std::stable_sort(scheduleOrder.begin(), scheduleOrder.end(), [&](size_t a, size_t b) {
+                return writerVectors[a].size() > writerVectors[b].size();
+            });
+
+            AtomicWord<long long> busyMicros{0};
+            Timer applyTimer;
+
             // Doles out all the work to the writer pool threads. writerVectors is not modified,
             // but  applyOplogBatchPerWorker will modify the vectors that it contains.
             invariant(writerVectors.size() == statusVector.size());
-            for (size_t i = 0; i < writerVectors.size(); i++) {
-                if (writerVectors[i].empty())
-                    continue;
-
+            for (auto i : scheduleOrder) {
                 _writerPool->schedule([this,
                                        &writer = writerVectors.at(i),
                                        &status = statusVector.at(i),
                                        &multikeyVector = multikeyVector.at(i),
+                                       &busyMicros,
                                        isDataConsistent = isDataConsistent](auto scheduleStatus) {
                     invariant(scheduleStatus);
 
+                    Timer writerTimer;
+                    ON_BLOCK_EXIT([&] { busyMicros.fetchAndAdd(writerTimer.micros()); });
+
                     auto opCtx = cc().makeOperationContext();
 
                     // This code path is only executed on secondaries and initial syncing nodes,
@@ -538,6 +569,16 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 
             _writerPool->waitForIdle();
 
+            const long long elapsedMicros = applyTimer.micros();
+            const long long totalBusyMicros = busyMicros.load();
+            const long long availableMicros =
+                elapsedMicros * static_cast<long long>(numWriterThreads);
+            const long long totalIdleMicros = std::max(availableMicros - totalBusyMicros, 0LL);
+            writerBusyMicros.increment(totalBusyMicros);
+            writerIdleMicros.increment(totalIdleMicros);
+            ReplicationMetrics::get(opCtx).recordOplogWriterTime(Microseconds(totalBusyMicros),
+                                                                 Microseconds(totalIdleMicros));
+
             // If any of the statuses is not ok, return error.
             for (auto it = statusVector.cbegin(); it != statusVector.cend(); ++it) {
                 const auto& status = *it;
@@ -539,6 +539,69 @@ TEST_F(OplogApplierImplTest,
                   secondDerivedOp.getObject()["lastWriteOpTime"]["ts"].timestamp());
 }
 
+TEST_F(OplogApplierImplTest, FillWriterVectorsKeepsDocumentOpsTogetherAcrossExtraVectors) {
+    const NamespaceString nss{"test", "foo"};
+
+    // Interleave updates to a single hot document with inserts of distinct documents.
+    std::vector<OplogEntry> ops;
+    for (int i = 1; i <= 64; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(i), 0), 1LL}, nss, BSON("_id" << i)));
+        ops.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(i), 1), 1LL},
+                                                   nss,
+                                                   BSON("_id" << 0),
+                                                   BSON("$set" << BSON("x" << i))));
+    }
+
+    auto writerPool = makeReplWriterPool(2);
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    // Partition the batch into more writer vectors than there are writer threads.
+    const size_t numWriterVectors = 4 * writerPool->getStats().options.maxThreads;
+    std::vector<std::vector<const OplogEntry*>> writerVectors(numWriterVectors);
+    std::vector<std::vector<OplogEntry>> derivedOps;
+    oplogApplier.fillWriterVectors_forTest(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    size_t numNonEmpty = 0;
+    size_t numWithHotDocument = 0;
+    for (const auto& writer : writerVectors) {
+        if (!writer.empty()) {
+            numNonEmpty++;
+        }
+
+        std::vector<const OplogEntry*> hotDocumentOps;
+        std::copy_if(writer.begin(),
+                     writer.end(),
+                     std::back_inserter(hotDocumentOps),
+                     [](const OplogEntry* op) { return op->getOpType() == OpTypeEnum::kUpdate; });
+        if (hotDocumentOps.empty()) {
+            continue;
+        }
+
+        // All updates to the hot document are in a single writer vector, in oplog order.
+        numWithHotDocument++;
+        ASSERT_EQ(64U, hotDocumentOps.size());
+        ASSERT_TRUE(std::is_sorted(hotDocumentOps.begin(),
+                                   hotDocumentOps.end(),
+                                   [](const OplogEntry* a, const OplogEntry* b) {
+                                       return a->getOpTime() < b->getOpTime();
+                                   }));
+    }
+    ASSERT_EQ(1U, numWithHotDocument);
+
+    // The inserts spread out over more writer vectors than there are writer threads.
+    ASSERT_GT(numNonEmpty, writerPool->getStats().options.maxThreads);
+}
+
 class MultiOplogEntryOplogApplierImplTest : public OplogApplierImplTest {
 public:
     MultiOplogEntryOplogApplierImplTest()
@@ -42,30 +42,34 @@ namespace repl {
 MONGO_FAIL_POINT_DEFINE(skipOplogBatcherWaitForData);
 
 OplogBatcher::OplogBatcher(OplogApplier* oplogApplier, OplogBuffer* oplogBuffer)
-    : _oplogApplier(oplogApplier), _oplogBuffer(oplogBuffer), _ops(0) {}
+    : _oplogApplier(oplogApplier), _oplogBuffer(oplogBuffer) {}
 OplogBatcher::~OplogBatcher() {
     invariant(!_thread);
 }
 
 OplogBatch OplogBatcher::getNextBatch(Seconds maxWaitTime) {
     stdx::unique_lock<Latch> lk(_mutex);
-    // _ops can indicate the following cases:
+    // The front of _queue can indicate the following cases:
     // 1. A new batch is ready to consume.
     // 2. Shutdown.
     // 3. The batch has (or had) exhausted the buffer in draining mode.
-    // 4. Empty batch since the batch has/had exhausted the buffer but not in draining mode,
-    //    so there could be new oplog entries coming.
-    // 5. Empty batch since the batcher is still running.
     //
-    // In case (4) and (5), we wait for up to "maxWaitTime".
-    if (_ops.empty() && !_ops.mustShutdown() && !_ops.termWhenExhausted()) {
+    // If _queue is empty, either the buffer has been exhausted but not in draining mode, so there
+    // could be new oplog entries coming, or the batcher is still preparing the next batch. In
+    // both cases we wait for up to "maxWaitTime".
+    if (_queue.empty()) {
         // We intentionally don't care about whether this returns due to signaling or timeout
-        // since we do the same thing either way: return whatever is in _ops.
+        // since we do the same thing either way: return whatever is at the front of _queue.
         (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
     }
 
-    OplogBatch ops = std::move(_ops);
-    _ops = OplogBatch(0);
+    if (_queue.empty()) {
+        return OplogBatch(0);
+    }
+
+    OplogBatch ops = std::move(_queue.front());
+    _queue.pop_front();
+    _queuedBytes -= ops.getByteSize();
     _cv.notify_all();
     return ops;
 }
@@ -330,11 +334,21 @@ void OplogBatcher::_run(StorageInterface* storageInterface) {
         }
 
         stdx::unique_lock<Latch> lk(_mutex);
-        // Block until the previous batch has been taken.
-        _cv.wait(lk, [&] { return _ops.empty() && !_ops.termWhenExhausted(); });
-        _ops = std::move(ops);
+        // Block until there is room for this batch. Batches are prepared ahead of the applier while
+        // they fit in the prefetch budget, so the next batch is ready as soon as the applier is
+        // done with the current one. Empty batches must wait for the applier to take every batch
+        // before them, and nothing is queued behind them until they have been taken.
+        const auto prefetchBytes = static_cast<std::size_t>(replBatchPrefetchBytes.load());
+        _cv.wait(lk, [&] {
+            return _queue.empty() ||
+                (!ops.empty() && !_queue.back().empty() &&
+                 _queuedBytes + ops.getByteSize() <= prefetchBytes);
+        });
+        const bool mustShutdown = ops.mustShutdown();
+        _queuedBytes += ops.getByteSize();
+        _queue.push_back(std::move(ops));
         _cv.notify_all();
-        if (_ops.mustShutdown()) {
+        if (mustShutdown) {
             return;
         }
     }
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/repl/oplog_buffer.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -64,11 +66,20 @@ public:
         return _batch;
     }
 
+    /**
+     * Returns the total size of the raw oplog entries in this batch.
+     */
+    std::size_t getByteSize() const {
+        return _byteSize;
+    }
+
     void emplace_back(OplogEntry oplog) {
         invariant(!_mustShutdown);
+        _byteSize += oplog.getRawObjSizeBytes();
         _batch.emplace_back(std::move(oplog));
     }
     void pop_back() {
+        _byteSize -= _batch.back().getRawObjSizeBytes();
         _batch.pop_back();
     }
 
@@ -107,6 +118,7 @@ public:
 
 private:
     std::vector<OplogEntry> _batch;
+    std::size_t _byteSize = 0;
     bool _mustShutdown = false;
     boost::optional<long long> _termWhenExhausted;
 };
@@ -147,7 +159,8 @@ public:
     virtual ~OplogBatcher();
 
     /**
-     * Returns the batch of oplog entries and clears _ops so the batcher can store a new batch.
+     * Returns the oldest batch of oplog entries prepared by the batcher, making room for the
+     * batcher to prepare another one. Returns an empty batch if none is ready within 'maxWaitTime'.
      */
     OplogBatch getNextBatch(Seconds maxWaitTime);
 
@@ -206,9 +219,15 @@ private:
     stdx::condition_variable _cv;
 
     /**
-     * The latest batch of oplog entries ready for the applier.
+     * Batches of oplog entries ready for the applier, oldest first. The batcher prepares batches
+     * ahead of the applier while their total size stays within 'replBatchPrefetchBytes', and always
+     * at least one. An empty batch, which signals shutdown or a drained buffer, is only queued once
+     * the applier has taken every batch before it.
      */
-    OplogBatch _ops;
+    std::deque<OplogBatch> _queue;
+
+    // The total size of the batches in '_queue'.
+    std::size_t _queuedBytes = 0;
 
     std::unique_ptr<stdx::thread> _thread;
 };
@@ -0,0 +1,279 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_applier.h"
+#include "mongo/db/repl/oplog_batcher.h"
+#include "mongo/db/repl/oplog_batcher_test_fixture.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/repl/storage_interface_mock.h"
+#include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const NamespaceString nss("test.foo");
+
+/**
+ * Minimal implementation of OplogApplier whose shutdown state is observed by the batcher.
+ */
+class OplogApplierMock : public OplogApplier {
+public:
+    explicit OplogApplierMock(OplogBuffer* oplogBuffer)
+        : OplogApplier(nullptr,
+                       oplogBuffer,
+                       nullptr,
+                       OplogApplier::Options(OplogApplication::Mode::kSecondary)) {}
+
+    void _run(OplogBuffer* oplogBuffer) final {}
+    StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx,
+                                        std::vector<OplogEntry> ops) final {
+        return OpTime();
+    }
+};
+
+/**
+ * ReplicationCoordinatorMock whose applier state can be switched to draining.
+ */
+class ReplicationCoordinatorDrainingMock : public ReplicationCoordinatorMock {
+public:
+    using ReplicationCoordinatorMock::ReplicationCoordinatorMock;
+
+    ApplierState getApplierState() override {
+        return draining.load() ? ApplierState::Draining : ApplierState::Running;
+    }
+
+    AtomicWord<bool> draining{false};
+};
+
+class OplogBatcherTest : public ServiceContextMongoDTest {
+public:
+    void setUp() override;
+    void tearDown() override;
+
+protected:
+    /**
+     * Pushes one insert oplog entry per timestamp in [first, last] into the oplog buffer.
+     */
+    void pushInserts(int first, int last);
+
+    /**
+     * Waits until the batcher has popped all but 'count' entries from the oplog buffer.
+     */
+    void waitForBufferCount(std::size_t count);
+
+    /**
+     * Starts the batcher thread.
+     */
+    void startBatcher();
+
+    /**
+     * Returns the next batch prepared by the batcher, waiting for up to ten seconds.
+     */
+    OplogBatch getNextBatch();
+
+    std::unique_ptr<OplogBufferMock> _buffer;
+    std::unique_ptr<OplogApplierMock> _applier;
+    std::unique_ptr<OplogBatcher> _batcher;
+    StorageInterfaceMock _storageInterface;
+    ReplicationCoordinatorDrainingMock* _replCoord = nullptr;
+
+    // Whether the batcher thread is running.
+    bool _running = false;
+
+private:
+    int _oldBatchLimitOperations = 0;
+    int _oldPrefetchBytes = 0;
+};
+
+void OplogBatcherTest::setUp() {
+    ServiceContextMongoDTest::setUp();
+    auto service = getServiceContext();
+    auto replCoord = std::make_unique<ReplicationCoordinatorDrainingMock>(service);
+    _replCoord = replCoord.get();
+    ReplicationCoordinator::set(service, std::move(replCoord));
+
+    _buffer = std::make_unique<OplogBufferMock>();
+    _buffer->startup(nullptr);
+    _applier = std::make_unique<OplogApplierMock>(_buffer.get());
+    _batcher = std::make_unique<OplogBatcher>(_applier.get(), _buffer.get());
+
+    // Make every oplog entry a batch of its own.
+    _oldBatchLimitOperations = replBatchLimitOperations.load();
+    _oldPrefetchBytes = replBatchPrefetchBytes.load();
+    replBatchLimitOperations.store(1);
+}
+
+void OplogBatcherTest::tearDown() {
+    // The batcher thread only returns once the applier has taken every batch before the shutdown
+    // signal.
+    _applier->shutdown();
+    if (_running) {
+        while (!getNextBatch().mustShutdown()) {
+        }
+        _batcher->shutdown();
+    }
+
+    replBatchLimitOperations.store(_oldBatchLimitOperations);
+    replBatchPrefetchBytes.store(_oldPrefetchBytes);
+
+    _batcher = {};
+    _applier = {};
+    _buffer = {};
+    ServiceContextMongoDTest::tearDown();
+}
+
+void OplogBatcherTest::pushInserts(int first, int last) {
+    OplogBuffer::Batch entries;
+    for (int t = first; t <= last; ++t) {
+        entries.push_back(makeInsertOplogEntry(t, nss).getEntry().getRaw());
+    }
+    _buffer->push(nullptr, entries.cbegin(), entries.cend());
+}
+
+void OplogBatcherTest::waitForBufferCount(std::size_t count) {
+    const auto deadline = Date_t::now() + Seconds(10);
+    while (_buffer->getCount() > count) {
+        ASSERT_LT(Date_t::now(), deadline) << "oplog buffer still holds " << _buffer->getCount()
+                                           << " entries, expected " << count;
+        sleepmillis(1);
+    }
+    ASSERT_EQ(count, _buffer->getCount());
+}
+
+void OplogBatcherTest::startBatcher() {
+    _batcher->startup(&_storageInterface);
+    _running = true;
+}
+
+OplogBatch OplogBatcherTest::getNextBatch() {
+    // An empty batch without a signal only means that none was ready in time.
+    const auto deadline = Date_t::now() + Seconds(10);
+    auto batch = _batcher->getNextBatch(Seconds(10));
+    while (batch.empty() && !batch.mustShutdown() && !batch.termWhenExhausted()) {
+        ASSERT_LT(Date_t::now(), deadline) << "no batch was prepared in time";
+        batch = _batcher->getNextBatch(Seconds(1));
+    }
+    return batch;
+}
+
+TEST_F(OplogBatcherTest, PreparesBatchesAheadWithinPrefetchLimit) {
+    const auto entrySize = makeInsertOplogEntry(1, nss).getRawObjSizeBytes();
+    replBatchPrefetchBytes.store(3 * entrySize);
+    pushInserts(1, 10);
+    startBatcher();
+
+    // Three batches fit in the prefetch budget and the fourth has been popped from the buffer but
+    // waits for room.
+    waitForBufferCount(6);
+    sleepmillis(100);
+    ASSERT_EQ(6U, _buffer->getCount());
+
+    // Taking a batch makes room for the waiting one, after which the batcher pops the next.
+    for (int t = 1; t <= 10; ++t) {
+        auto batch = getNextBatch();
+        ASSERT_EQ(1U, batch.getBatch().size());
+        ASSERT_EQ(Timestamp(t, 1), batch.front().getTimestamp());
+        if (t < 7) {
+            waitForBufferCount(6 - t);
+        }
+    }
+}
+
+TEST_F(OplogBatcherTest, AlwaysPreparesOneBatchAheadWithoutPrefetchBudget) {
+    replBatchPrefetchBytes.store(0);
+    pushInserts(1, 5);
+    startBatcher();
+
+    // The first batch is queued whatever its size and the second waits for it to be taken.
+    waitForBufferCount(3);
+    sleepmillis(100);
+    ASSERT_EQ(3U, _buffer->getCount());
+
+    for (int t = 1; t <= 5; ++t) {
+        auto batch = getNextBatch();
+        ASSERT_EQ(1U, batch.getBatch().size());
+        ASSERT_EQ(Timestamp(t, 1), batch.front().getTimestamp());
+    }
+}
+
+TEST_F(OplogBatcherTest, SignalsDrainedBufferAfterQueuedBatches) {
+    replBatchPrefetchBytes.store(1024 * 1024);
+    pushInserts(1, 3);
+    _replCoord->draining.store(true);
+    startBatcher();
+    waitForBufferCount(0);
+
+    for (int t = 1; t <= 3; ++t) {
+        auto batch = getNextBatch();
+        ASSERT_EQ(1U, batch.getBatch().size());
+        ASSERT_EQ(Timestamp(t, 1), batch.front().getTimestamp());
+        ASSERT_FALSE(batch.termWhenExhausted());
+    }
+
+    auto batch = getNextBatch();
+    ASSERT_TRUE(batch.empty());
+    ASSERT_FALSE(batch.mustShutdown());
+    ASSERT_TRUE(batch.termWhenExhausted());
+    ASSERT_EQ(_replCoord->getTerm(), *batch.termWhenExhausted());
+}
+
+TEST_F(OplogBatcherTest, AppliesQueuedBatchesBeforeShutdown) {
+    replBatchPrefetchBytes.store(1024 * 1024);
+    pushInserts(1, 5);
+    startBatcher();
+    waitForBufferCount(0);
+
+    // The shutdown signal is queued behind the batches prepared before it.
+    _applier->shutdown();
+    for (int t = 1; t <= 5; ++t) {
+        auto batch = getNextBatch();
+        ASSERT_FALSE(batch.mustShutdown());
+        ASSERT_EQ(1U, batch.getBatch().size());
+        ASSERT_EQ(Timestamp(t, 1), batch.front().getTimestamp());
+    }
+
+    auto batch = getNextBatch();
+    ASSERT_TRUE(batch.mustShutdown());
+    ASSERT_TRUE(batch.empty());
+
+    // The batcher thread returns after queueing the shutdown signal.
+    _batcher->shutdown();
+    _running = false;
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
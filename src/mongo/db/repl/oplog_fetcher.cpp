@@ -100,6 +100,11 @@ Counter64 readersCreatedStats;
 ServerStatusMetricField<Counter64> displayReadersCreated("repl.network.readersCreated",
                                                          &readersCreatedStats);
 
+// The batchSize chosen for the getMores when 'oplogFetcherAdaptiveBatchSize' is enabled
+AdaptiveBatchSizeStats adaptiveBatchSizeStats;
+ServerStatusMetricField<AdaptiveBatchSizeStats> displayAdaptiveBatchSize(
+    "repl.network.adaptiveBatchSize", &adaptiveBatchSizeStats);
+
 const Milliseconds maximumAwaitDataTimeoutMS(30 * 1000);
 
 /**
@@ -190,7 +195,8 @@ OplogFetcher::OplogFetcher(executor::TaskExecutor* executor,
       _dataReplicatorExternalState(dataReplicatorExternalState),
       _enqueueDocumentsFn(enqueueDocumentsFn),
       _awaitDataTimeout(calculateAwaitDataTimeout(config.replSetConfig)),
-      _config(std::move(config)) {
+      _config(std::move(config)),
+      _batchSizer(_config.batchSize, _config.batchSize) {
     invariant(_config.replSetConfig.isInitialized());
     invariant(!_lastFetched.isNull());
     invariant(onShutdownCallbackFn);
@@ -544,7 +550,7 @@ void OplogFetcher::_createNewCursor(bool initialFind) {
                                          nullptr /* fieldsToReturn */,
                                          QueryOption_CursorTailable | QueryOption_AwaitData |
                                              (oplogFetcherUsesExhaust ? QueryOption_Exhaust : 0),
-                                         _config.batchSize);
+                                         _batchSizer.getBatchSize());
 
     _firstBatch = true;
 
@@ -592,13 +598,25 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
             _cursor->more();
         }
 
+        long long batchBytes = 0;
         while (_cursor->moreInCurrentBatch()) {
             batch.emplace_back(_cursor->nextSafe());
+            batchBytes += batch.back().objsize();
         }
 
         // This value is only used on a successful batch for metrics.repl.network.getmores. This
         // metric intentionally tracks the time taken by the initial find as well.
         _lastBatchElapsedMS = timer.millis();
+
+        // Exhaust cursors stream their batches without waiting for a getMore round trip, so
+        // there is no latency to hide by resizing them.
+        if (oplogFetcherAdaptiveBatchSize.load() && !oplogFetcherUsesExhaust) {
+            auto previousBatchSize = _batchSizer.getBatchSize();
+            auto batchSize =
+                _batchSizer.recordBatch(batch.size(), batchBytes, Microseconds(timer.micros()));
+            adaptiveBatchSizeStats.record(previousBatchSize, batchSize);
+            _cursor->setBatchSize(batchSize);
+        }
     } catch (const DBException& ex) {
         if (_cursor->connectionHasPendingReplies()) {
             // Close the connection because the connection cannot be used anymore as more data is on
@@ -38,6 +38,7 @@
 #include "mongo/client/dbclient_cursor.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/abstract_async_component.h"
+#include "mongo/db/repl/adaptive_batch_sizer.h"
 #include "mongo/db/repl/data_replicator_external_state.h"
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_process.h"
@@ -485,6 +486,10 @@ private:
     const Milliseconds _awaitDataTimeout;
     Config _config;
 
+    // Chooses the batchSize of the getMores when 'oplogFetcherAdaptiveBatchSize' is enabled.
+    // Never above the batchSize in the config.
+    AdaptiveBatchSizer _batchSizer;
+
     // Handle to currently scheduled _runQuery task.
     executor::TaskExecutor::CallbackHandle _runQueryHandle;
 
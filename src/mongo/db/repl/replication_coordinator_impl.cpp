@@ -69,6 +69,7 @@
 #include "mongo/db/repl/check_quorum_for_config_change.h"
 #include "mongo/db/repl/data_replicator_external_state_initial_sync.h"
 #include "mongo/db/repl/hello_response.h"
+#include "mongo/db/repl/initial_syncer_factory.h"
 #include "mongo/db/repl/isself.h"
 #include "mongo/db/repl/last_vote.h"
 #include "mongo/db/repl/read_concern_args.h"
@@ -776,7 +777,7 @@ void ReplicationCoordinatorImpl::_startDataReplication(OperationContext* opCtx,
         LOGV2_DEBUG(4853000, 1, "initial sync complete.");
     };
 
-    std::shared_ptr<InitialSyncer> initialSyncerCopy;
+    std::shared_ptr<InitialSyncerInterface> initialSyncerCopy;
     try {
         {
             // Must take the lock to set _initialSyncer, but not call it.
@@ -785,7 +786,8 @@ void ReplicationCoordinatorImpl::_startDataReplication(OperationContext* opCtx,
                 LOGV2(21326, "Initial Sync not starting because replication is shutting down");
                 return;
             }
-            initialSyncerCopy = std::make_shared<InitialSyncer>(
+            auto initialSyncerFactory = InitialSyncerFactory::get(getServiceContext());
+            initialSyncerCopy = initialSyncerFactory->makeInitialSyncer(
                 createInitialSyncerOptions(this, _externalState.get()),
                 std::make_unique<DataReplicatorExternalStateInitialSync>(this,
                                                                          _externalState.get()),
@@ -935,7 +937,7 @@ void ReplicationCoordinatorImpl::shutdown(OperationContext* opCtx) {
     LOGV2(21328, "Shutting down replication subsystems");
 
     // Used to shut down outside of the lock.
-    std::shared_ptr<InitialSyncer> initialSyncerCopy;
+    std::shared_ptr<InitialSyncerInterface> initialSyncerCopy;
     {
         stdx::unique_lock<Latch> lk(_mutex);
         fassert(28533, !_inShutdown);
@@ -2986,7 +2988,7 @@ Status ReplicationCoordinatorImpl::processReplSetGetStatus(
 
     BSONObj initialSyncProgress;
     if (responseStyle == ReplSetGetStatusResponseStyle::kInitialSync) {
-        std::shared_ptr<InitialSyncer> initialSyncerCopy;
+        std::shared_ptr<InitialSyncerInterface> initialSyncerCopy;
         {
             stdx::lock_guard<Latch> lk(_mutex);
             initialSyncerCopy = _initialSyncer;
@@ -3004,6 +3006,8 @@ Status ReplicationCoordinatorImpl::processReplSetGetStatus(
         ReplicationMetrics::get(getServiceContext()).getElectionCandidateMetricsBSON();
     BSONObj electionParticipantMetrics =
         ReplicationMetrics::get(getServiceContext()).getElectionParticipantMetricsBSON();
+    BSONObj oplogWriterMetrics =
+        ReplicationMetrics::get(getServiceContext()).getOplogWriterMetricsBSON();
 
     stdx::lock_guard<Latch> lk(_mutex);
     if (_inShutdown) {
@@ -3023,6 +3027,10 @@ Status ReplicationCoordinatorImpl::processReplSetGetStatus(
             _externalState->tooStale()},
         response,
         &result);
+
+    if (result.isOK() && !oplogWriterMetrics.isEmpty()) {
+        response->append("oplogWriterMetrics", oplogWriterMetrics);
+    }
     return result;
 }
 
@@ -3217,7 +3225,7 @@ Status ReplicationCoordinatorImpl::processReplSetSyncFrom(OperationContext* opCt
                                                           const HostAndPort& target,
                                                           BSONObjBuilder* resultObj) {
     Status result(ErrorCodes::InternalError, "didn't set status in prepareSyncFromResponse");
-    std::shared_ptr<InitialSyncer> initialSyncerCopy;
+    std::shared_ptr<InitialSyncerInterface> initialSyncerCopy;
     {
         stdx::lock_guard<Latch> lk(_mutex);
         _topCoord->prepareSyncFromResponse(target, resultObj, &result);
@@ -379,6 +379,42 @@ void ReplicationMetrics::clearParticipantNewTermDates() {
     _electionParticipantMetrics.setNewTermAppliedDate(boost::none);
 }
 
+void ReplicationMetrics::recordOplogWriterTime(Microseconds busy, Microseconds idle) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    ++_numOplogWriterBatches;
+    _oplogWriterBusy += busy;
+    _oplogWriterIdle += idle;
+    _lastBatchOplogWriterBusy = busy;
+    _lastBatchOplogWriterIdle = idle;
+}
+
+BSONObj ReplicationMetrics::getOplogWriterMetricsBSON() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_numOplogWriterBatches == 0) {
+        return BSONObj();
+    }
+
+    // The fraction of the writer threads' time spent applying operations.
+    auto utilization = [](Microseconds busy, Microseconds idle) {
+        const auto total = durationCount<Microseconds>(busy + idle);
+        return total > 0 ? static_cast<double>(durationCount<Microseconds>(busy)) / total : 0.0;
+    };
+
+    BSONObjBuilder builder;
+    builder.append("numBatches", _numOplogWriterBatches);
+    builder.append("busyMicros", durationCount<Microseconds>(_oplogWriterBusy));
+    builder.append("idleMicros", durationCount<Microseconds>(_oplogWriterIdle));
+    builder.append("utilization", utilization(_oplogWriterBusy, _oplogWriterIdle));
+    {
+        BSONObjBuilder lastBatch(builder.subobjStart("lastBatch"));
+        lastBatch.append("busyMicros", durationCount<Microseconds>(_lastBatchOplogWriterBusy));
+        lastBatch.append("idleMicros", durationCount<Microseconds>(_lastBatchOplogWriterIdle));
+        lastBatch.append("utilization",
+                         utilization(_lastBatchOplogWriterBusy, _lastBatchOplogWriterIdle));
+    }
+    return builder.obj();
+}
+
 void ReplicationMetrics::_updateAverageCatchUpOps(WithLock lk) {
     long numCatchUps = _electionMetrics.getNumCatchUps();
     if (numCatchUps > 0) {
@@ -119,6 +119,15 @@ public:
     void setParticipantNewTermDates(Date_t newTermStartDate, Date_t newTermAppliedDate);
     void clearParticipantNewTermDates();
 
+    // Oplog writer metrics
+
+    // Records the time the oplog writer threads spent applying a batch, and the time they spent
+    // idle while other writer threads were still applying it.
+    void recordOplogWriterTime(Microseconds busy, Microseconds idle);
+
+    // Returns an empty object until the node has applied a batch on the writer threads.
+    BSONObj getOplogWriterMetricsBSON();
+
 
 private:
     class ElectionMetricsSSS;
@@ -136,6 +145,12 @@ private:
     // This field is a double so that the division result in _updateAverageCatchUpOps will be a
     // double without any casting.
     double _totalNumCatchUpOps = 0.0;
+
+    long long _numOplogWriterBatches = 0;
+    Microseconds _oplogWriterBusy{0};
+    Microseconds _oplogWriterIdle{0};
+    Microseconds _lastBatchOplogWriterBusy{0};
+    Microseconds _lastBatchOplogWriterIdle{0};
 };
 
 }  // namespace repl
@@ -64,6 +64,7 @@
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/query/find.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/read_write_concern_defaults.h"
 #include "mongo/db/repl/optime.h"
@@ -2285,6 +2286,15 @@ void HandleRequest::completeOperation(DbResponse& response) {
             durationCount<Microseconds>(currentOp.elapsedTimeExcludingPauses()),
             currentOp.getReadWriteType());
 
+    if (const auto& queryShapeStatsKey = currentOp.debug().queryShapeStatsKey) {
+        QueryShapeStats::get(opCtx->getServiceContext())
+            .recordExecution(*queryShapeStatsKey,
+                             currentOp.debug(),
+                             currentOp.elapsedTimeExcludingPauses(),
+                             currentOp.getLogicalOp() == LogicalOp::opGetMore,
+                             opCtx->getServiceContext()->getFastClockSource()->now());
+    }
+
     if (shouldProfile) {
         // Performance profiling is on
         if (opCtx->lockState()->isReadLocked()) {
@@ -63,6 +63,7 @@
 #include "mongo/s/is_mongos.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/future.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -199,9 +200,11 @@ public:
                  std::streampos fileEndOffset,
                  const Settings& settings,
                  const boost::optional<std::string>& dbName,
-                 const uint32_t checksum)
+                 const uint32_t checksum,
+                 bool readAhead = false)
         : _settings(settings),
           _done(false),
+          _readAhead(readAhead),
           _fileFullPath(fileFullPath),
           _fileStartOffset(fileStartOffset),
           _fileEndOffset(fileEndOffset),
@@ -212,6 +215,11 @@ public:
                 boost::filesystem::file_size(_fileFullPath) != 0);
     }
 
+    ~FileIterator() {
+        // A pending read ahead refers to this iterator.
+        _waitForReadAhead();
+    }
+
     void openSource() {
         _file.open(_fileFullPath.c_str(), std::ios::in | std::ios::binary);
         uassert(16814,
@@ -227,6 +235,7 @@ public:
     }
 
     void closeSource() {
+        _waitForReadAhead();
         _file.close();
         uassert(50969,
                 str::stream() << "error closing file \"" << _fileFullPath
@@ -280,6 +289,14 @@ public:
     }
 
 private:
+    /**
+     * A block of decrypted and decompressed data. A null 'data' marks the end of the range.
+     */
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
     /**
      * Attempts to refill the _bufferReader if it is empty. Expects _done to be false.
      */
@@ -291,28 +308,102 @@ private:
     }
 
     /**
-     * Tries to read from disk and places any results in _bufferReader. If there is no more data to
-     * read, then _done is set to true and the function returns immediately.
+     * Places the next block of the range in _bufferReader, taking it from the pending read ahead
+     * if there is one. If there is no more data to read, then _done is set to true and the
+     * function returns immediately.
      */
     void fillBufferFromDisk() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
-        if (_done)
+        Block block;
+        if (_pendingBlock) {
+            auto swBlock = std::move(*_pendingBlock).getNoThrow();
+            _pendingBlock.reset();
+            block = uassertStatusOK(std::move(swBlock));
+        } else {
+            block = readBlock();
+        }
+
+        if (!block.data) {
+            _done = true;
             return;
+        }
+
+        _buffer = std::move(block.data);
+        _bufferReader.reset(new BufReader(_buffer.get(), block.size));
 
+        if (_readAhead) {
+            _scheduleReadAhead();
+        }
+    }
+
+    /**
+     * Starts reading the block following the one in _bufferReader on the read ahead thread pool.
+     */
+    void _scheduleReadAhead() {
+        auto pf = makePromiseFuture<Block>();
+        _pendingBlock.emplace(std::move(pf.future));
+        scheduleReadAhead([this, promise = std::move(pf.promise)](Status status) mutable {
+            if (!status.isOK()) {
+                promise.setError(status);
+                return;
+            }
+            promise.setWith([&] { return readBlock(); });
+        });
+    }
+
+    /**
+     * Waits for the pending read ahead, if any, to stop using the file. Its result is dropped.
+     */
+    void _waitForReadAhead() {
+        if (_pendingBlock) {
+            std::move(*_pendingBlock).getNoThrow().getStatus().ignore();
+            _pendingBlock.reset();
+        }
+    }
+
+    /**
+     * Reads the next block of the range from disk, then decrypts and decompresses it. Returns a
+     * Block with null data if the end of the range was reached. Only uses the file, the zstd
+     * decompressor and members that don't change while iterating, so that it can run on the read
+     * ahead thread pool: there is never more than one read in flight.
+     */
+    Block readBlock() {
+        for (;;) {
+            int32_t rawSize;
+            if (!read(&rawSize, sizeof(rawSize)))
+                return {};
+
+            boost::optional<sorter::SpillBlockType> type;
+            if (rawSize == sorter::kExtendedBlockMarker) {
+                uint8_t rawType;
+                uassert(6179046, "file too short?", read(&rawType, sizeof(rawType)));
+                uassert(6179047, "file too short?", read(&rawSize, sizeof(rawSize)));
+                uassert(6179048, "invalid spilled block size", rawSize >= 0);
+                type = static_cast<sorter::SpillBlockType>(rawType);
+            }
+
+            auto block = readBlockData(rawSize, type);
+            if (block.data)
+                return block;
+        }
+    }
+
+    /**
+     * Reads the data of a block whose header was just read. Returns a Block with null data for
+     * blocks which only carry state for the blocks that follow.
+     */
+    Block readBlockData(int32_t rawSize, boost::optional<sorter::SpillBlockType> type) {
         // negative size means compressed
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
 
-        _buffer.reset(new char[blockSize]);
-        read(_buffer.get(), blockSize);
-        uassert(16816, "file too short?", !_done);
+        std::unique_ptr<char[]> buffer(new char[blockSize]);
+        uassert(16816, "file too short?", read(buffer.get(), blockSize));
 
         if (auto encryptionHooks = getEncryptionHooksIfEnabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
             size_t outLen;
             Status status =
-                encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(_buffer.get()),
+                encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(buffer.get()),
                                                   blockSize,
                                                   reinterpret_cast<uint8_t*>(out.get()),
                                                   blockSize,
@@ -322,37 +413,58 @@ private:
                     str::stream() << "Failed to unprotect data: " << status.toString(),
                     status.isOK());
             blockSize = outLen;
-            _buffer.swap(out);
+            buffer.swap(out);
+        }
+
+        if (type) {
+            if (!_zstd) {
+                _zstd = std::make_unique<sorter::ZstdSpillDecompressor>();
+            }
+
+            StringData data(buffer.get(), blockSize);
+            switch (*type) {
+                case sorter::SpillBlockType::kZstdDictionary:
+                    _zstd->setDictionary(data);
+                    return {};
+                case sorter::SpillBlockType::kZstd:
+                case sorter::SpillBlockType::kZstdWithDictionary: {
+                    size_t size;
+                    auto decompressed = _zstd->decompress(
+                        data, *type == sorter::SpillBlockType::kZstdWithDictionary, &size);
+                    return {std::move(decompressed), size};
+                }
+            }
+            uasserted(6179049,
+                      str::stream() << "unknown spilled block type: " << static_cast<int>(*type));
         }
 
         if (!compressed) {
-            _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
+            return {std::move(buffer), static_cast<size_t>(blockSize)};
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+        dassert(snappy::IsValidCompressedBuffer(buffer.get(), blockSize));
 
         size_t uncompressedSize;
         uassert(17061,
                 "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                snappy::GetUncompressedLength(buffer.get(), blockSize, &uncompressedSize));
 
         std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
         uassert(17062,
                 "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                snappy::RawUncompress(buffer.get(), blockSize, decompressionBuffer.get()));
 
         // hold on to decompressed data and throw out compressed data at block exit
-        _buffer.swap(decompressionBuffer);
-        _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        return {std::move(decompressionBuffer), uncompressedSize};
     }
 
     /**
-     * Attempts to read data from disk. Sets _done to true when file offset reaches _fileEndOffset.
+     * Attempts to read data from disk. Returns false without reading when the file offset reaches
+     * _fileEndOffset.
      *
      * Masserts on any file errors
      */
-    void read(void* out, size_t size) {
+    bool read(void* out, size_t size) {
         invariant(_file.is_open());
 
         const std::streampos offset = _file.tellg();
@@ -363,8 +475,7 @@ private:
 
         if (offset >= _fileEndOffset) {
             invariant(offset == _fileEndOffset);
-            _done = true;
-            return;
+            return false;
         }
 
         _file.read(reinterpret_cast<char*>(out), size);
@@ -373,11 +484,20 @@ private:
                               << "\": " << myErrnoWithDescription(),
                 _file.good());
         verify(_file.gcount() == static_cast<std::streamsize>(size));
+        return true;
     }
 
     const Settings _settings;
     bool _done;
 
+    // Whether the next block is read ahead on the read ahead thread pool, see
+    // SortOptions::readAhead. While '_pendingBlock' is set, only that read may use '_file'.
+    const bool _readAhead;
+    boost::optional<Future<Block>> _pendingBlock;
+
+    // Decompresses the blocks spilled with zstd. Created by the first such block.
+    std::unique_ptr<sorter::ZstdSpillDecompressor> _zstd;
+
     std::unique_ptr<char[]> _buffer;
     std::unique_ptr<BufReader> _bufferReader;
     std::string _fileFullPath;        // File containing the sorted data range.
@@ -401,6 +521,11 @@ private:
  * Merge-sorts results from 0 or more FileIterators, all of which should be iterating over sorted
  * ranges within the same file. This class is given the data source file name upon construction and
  * is responsible for deleting the data source file upon destruction.
+ *
+ * The inputs are merged with a tree of losers: every internal node of a tournament tree over the
+ * inputs holds the input that lost the comparison at that node, and the overall winner is kept
+ * aside. Producing the next result replays the matches on the path from the winner's leaf to the
+ * root, which takes one comparison per level rather than the two a binary heap needs to sift down.
  */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -414,39 +539,36 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             iters[i]->openSource();
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_unique<Stream>(i, iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numLive = _streams.size();
+        _buildTree();
     }
 
     ~MergeIterator() {
         // Clear the remaining Stream objects to close the file handles. Some systems will error
         // closing the file if any file handles are still open.
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
     }
 
     void openSource() {}
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numLive > 1 || _streams[_winner]->more()))
             return true;
 
         _remaining = 0;
@@ -460,21 +582,18 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_winner]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        if (!_streams[_winner]->advance()) {
+            // Closes the input. The exhausted stream loses every match from now on.
+            _streams[_winner].reset();
+            --_numLive;
+            verify(_numLive > 0);
         }
+        _replay(_winner);
 
-        return _current->current();
+        return _streams[_winner]->current();
     }
 
 
@@ -516,32 +635,73 @@ private:
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
+    /**
+     * Returns true if the current data of stream 'lhs' must be returned before that of stream
+     * 'rhs'. Exhausted streams come last.
+     */
+    bool _precedes(size_t lhs, size_t rhs) const {
+        const auto& lhsStream = _streams[lhs];
+        const auto& rhsStream = _streams[rhs];
+        if (!lhsStream || !rhsStream) {
+            return !rhsStream && lhsStream;
+        }
 
-        template <typename Ptr>
-        bool operator()(const Ptr& lhs, const Ptr& rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
+        // first compare data
+        dassertCompIsSane(_comp, lhsStream->current(), rhsStream->current());
+        int ret = _comp(lhsStream->current(), rhsStream->current());
+        if (ret)
+            return ret < 0;
+
+        // then compare fileNums to ensure stability
+        return lhsStream->fileNum < rhsStream->fileNum;
+    }
+
+    /**
+     * Plays the whole tournament. The leaf of stream 'i' sits at position 'i + _streams.size()'
+     * of an implicit complete binary tree whose internal nodes are '_losers[1..size - 1]'.
+     */
+    void _buildTree() {
+        const size_t numStreams = _streams.size();
+        _losers.assign(numStreams, 0);
 
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+        std::vector<size_t> winners(2 * numStreams);
+        for (size_t i = 0; i < numStreams; i++) {
+            winners[numStreams + i] = i;
         }
+        for (size_t node = numStreams - 1; node > 0; node--) {
+            const size_t left = winners[2 * node];
+            const size_t right = winners[2 * node + 1];
+            const bool leftWins = _precedes(left, right);
+            winners[node] = leftWins ? left : right;
+            _losers[node] = leftWins ? right : left;
+        }
+        _winner = winners[1];
+    }
 
-    private:
-        const Comparator _comp;
-    };
+    /**
+     * Replays the matches from the leaf of 'stream', whose current data changed, up to the root.
+     */
+    void _replay(size_t stream) {
+        size_t winner = stream;
+        for (size_t node = (stream + _streams.size()) / 2; node > 0; node /= 2) {
+            if (_precedes(_losers[node], winner)) {
+                std::swap(_losers[node], winner);
+            }
+        }
+        _winner = winner;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
+
+    // The inputs that returned data, in input order. Exhausted streams are reset to null.
+    std::vector<std::unique_ptr<Stream>> _streams;
+    size_t _numLive = 0;
+
+    std::vector<size_t> _losers;  // Loser of the match at each internal node of the tree.
+    size_t _winner = 0;           // Stream whose current data is returned next.
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -582,7 +742,8 @@ public:
                                range.getEndOffset(),
                                this->_settings,
                                this->_opts.dbName,
-                               range.getChecksum());
+                               range.getChecksum(),
+                               this->_opts.readAhead);
                        });
     }
 
@@ -1045,7 +1206,16 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
       // _file.tellp() is not initialized on all systems to reflect this. Therefore, we must also
       // pass in the expected offset to this constructor.
       _fileStartOffset(fileStartOffset),
-      _dbName(opts.dbName) {
+      _dbName(opts.dbName),
+      _readAhead(opts.readAhead),
+      _compressor(opts.spillCompressor ? *opts.spillCompressor
+                                       : sorter::getDefaultSpillCompressor()) {
+    if (_compressor == sorter::SpillCompressor::kZstd) {
+        _zstd = std::make_unique<sorter::ZstdSpillCompressor>();
+        if (opts.trainSpillDictionary) {
+            _dictionarySampleSizes.emplace();
+        }
+    }
 
     // This should be checked by consumers, but if we get here don't allow writes.
     uassert(
@@ -1085,28 +1255,72 @@ void SortedFileWriter<Key, Value>::addAlreadySorted(const Key& key, const Value&
     _checksum =
         addDataToChecksum(_buffer.buf() + _nextObjPos, _buffer.len() - _nextObjPos, _checksum);
 
+    if (_dictionarySampleSizes) {
+        // The first block of the run is larger, to give the dictionary enough samples.
+        _dictionarySampleSizes->push_back(_buffer.len() - _nextObjPos);
+        if (_buffer.len() > 1024 * 1024)
+            spill();
+        return;
+    }
+
     if (_buffer.len() > 64 * 1024)
         spill();
 }
 
 template <typename Key, typename Value>
 void SortedFileWriter<Key, Value>::spill() {
-    int32_t size = _buffer.len();
-    char* outBuffer = _buffer.buf();
-
-    if (size == 0)
+    if (_buffer.len() == 0)
         return;
 
+    StringData data(_buffer.buf(), _buffer.len());
+    size_t bytesWritten = 0;
+
+    if (_dictionarySampleSizes) {
+        std::string dictionary = _zstd->trainDictionary(data, *_dictionarySampleSizes);
+        _dictionarySampleSizes.reset();
+        if (!dictionary.empty()) {
+            bytesWritten +=
+                _writeBlock(dictionary, false, sorter::SpillBlockType::kZstdDictionary);
+            _hasDictionary = true;
+        }
+    }
+
     std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
+    boost::optional<sorter::SpillBlockType> type;
+    switch (_compressor) {
+        case sorter::SpillCompressor::kNone:
+            break;
+        case sorter::SpillCompressor::kSnappy:
+            snappy::Compress(data.rawData(), data.size(), &compressed);
+            break;
+        case sorter::SpillCompressor::kZstd:
+            compressed = _zstd->compress(data);
+            type = _hasDictionary ? sorter::SpillBlockType::kZstdWithDictionary
+                                  : sorter::SpillBlockType::kZstd;
+            break;
+    }
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
+    const bool shouldCompress =
+        !compressed.empty() && compressed.size() < size_t(data.size() / 10 * 9);
     if (shouldCompress) {
-        size = compressed.size();
-        outBuffer = const_cast<char*>(compressed.data());
+        bytesWritten +=
+            _writeBlock(compressed, _compressor == sorter::SpillCompressor::kSnappy, type);
+    } else {
+        bytesWritten += _writeBlock(data, false);
     }
 
+    sorter::recordSpilledBlock(data.size(), bytesWritten);
+    _buffer.reset();
+}
+
+template <typename Key, typename Value>
+size_t SortedFileWriter<Key, Value>::_writeBlock(StringData data,
+                                                 bool snappyCompressed,
+                                                 boost::optional<sorter::SpillBlockType> type) {
+    int32_t size = data.size();
+    const char* outBuffer = data.rawData();
+
     std::unique_ptr<char[]> out;
     if (auto encryptionHooks = getEncryptionHooksIfEnabled()) {
         size_t protectedSizeMax = size + encryptionHooks->additionalBytesForProtectedBuffer();
@@ -1125,11 +1339,20 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    size_t bytesWritten = sizeof(size) + size;
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        if (type) {
+            const int32_t marker = sorter::kExtendedBlockMarker;
+            const uint8_t rawType = static_cast<uint8_t>(*type);
+            _file.write(reinterpret_cast<const char*>(&marker), sizeof(marker));
+            _file.write(reinterpret_cast<const char*>(&rawType), sizeof(rawType));
+            bytesWritten += sizeof(marker) + sizeof(rawType);
+        }
+
+        // negative size means compressed with snappy
+        const int32_t header = snappyCompressed ? -size : size;
+        _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        _file.write(outBuffer, size);
     } catch (const std::system_error& ex) {
         if (ex.code() == std::errc::no_space_on_device) {
             msgasserted(ErrorCodes::OutOfDiskSpace,
@@ -1144,7 +1367,7 @@ void SortedFileWriter<Key, Value>::spill() {
                                   << "\": " << sorter::myErrnoWithDescription());
     }
 
-    _buffer.reset();
+    return bytesWritten;
 }
 
 template <typename Key, typename Value>
@@ -1161,8 +1384,13 @@ SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     _fileEndOffset = currentFileOffset < _fileStartOffset ? _fileStartOffset : currentFileOffset;
     _file.close();
 
-    return new sorter::FileIterator<Key, Value>(
-        _fileFullPath, _fileStartOffset, _fileEndOffset, _settings, _dbName, _checksum);
+    return new sorter::FileIterator<Key, Value>(_fileFullPath,
+                                                _fileStartOffset,
+                                                _fileEndOffset,
+                                                _settings,
+                                                _dbName,
+                                                _checksum,
+                                                _readAhead);
 }
 
 //
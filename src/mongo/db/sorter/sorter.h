@@ -38,9 +38,12 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/sorter/sorter_compression.h"
 #include "mongo/db/sorter/sorter_gen.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/functional.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -118,11 +121,26 @@ struct SortOptions {
     // instead of copying.
     bool moveSortedDataIntoIterator;
 
+    // If set to true, iterators over data spilled to disk read, decrypt and decompress the next
+    // block of their range on a background thread while the current block is consumed.
+    bool readAhead;
+
+    // The codec compressing blocks of data spilled to disk. Defaults to the codec named by the
+    // 'sorterSpillCompressor' server parameter.
+    boost::optional<sorter::SpillCompressor> spillCompressor;
+
+    // If set to true and spills are compressed with zstd, every spilled run trains a dictionary on
+    // its first records and compresses its blocks with it. Worth it for data with much redundancy
+    // between records but little within one, such as index keys.
+    bool trainSpillDictionary;
+
     SortOptions()
         : limit(0),
           maxMemoryUsageBytes(64 * 1024 * 1024),
           extSortAllowed(false),
-          moveSortedDataIntoIterator(false) {}
+          moveSortedDataIntoIterator(false),
+          readAhead(false),
+          trainSpillDictionary(false) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -155,8 +173,35 @@ struct SortOptions {
         moveSortedDataIntoIterator = newMoveSortedDataIntoIterator;
         return *this;
     }
+
+    SortOptions& ReadAhead(bool newReadAhead = true) {
+        readAhead = newReadAhead;
+        return *this;
+    }
+
+    SortOptions& CompressSpills(sorter::SpillCompressor newSpillCompressor) {
+        spillCompressor = newSpillCompressor;
+        return *this;
+    }
+
+    SortOptions& TrainSpillDictionary(bool newTrainSpillDictionary = true) {
+        trainSpillDictionary = newTrainSpillDictionary;
+        return *this;
+    }
 };
 
+namespace sorter {
+
+/**
+ * Runs 'task' on the thread pool shared by the iterators reading ahead spilled data, see
+ * SortOptions::readAhead. The task is passed a non-OK status if it could not be scheduled.
+ *
+ * Unlike the rest of the Sorter, this is compiled once in sorter_read_ahead.cpp.
+ */
+void scheduleReadAhead(unique_function<void(Status)> task);
+
+}  // namespace sorter
+
 /**
  * This is a 0-sized dummy object that satisfies Sorter's Key/Value interface.
  */
@@ -359,6 +404,14 @@ public:
 private:
     void spill();
 
+    /**
+     * Encrypts 'data' if needed and writes it as a block, in the extended format if 'type' is set.
+     * Returns the number of bytes written.
+     */
+    size_t _writeBlock(StringData data,
+                       bool snappyCompressed,
+                       boost::optional<sorter::SpillBlockType> type = boost::none);
+
     const Settings _settings;
     std::string _fileFullPath;
     std::ofstream _file;
@@ -375,6 +428,17 @@ private:
     std::streampos _fileEndOffset;
 
     boost::optional<std::string> _dbName;
+
+    // Whether the iterator returned by done() reads ahead, see SortOptions::readAhead.
+    bool _readAhead;
+
+    sorter::SpillCompressor _compressor;
+    std::unique_ptr<sorter::ZstdSpillCompressor> _zstd;
+
+    // The sizes of the records buffered to train the dictionary of this run on, while it has not
+    // been trained yet. See SortOptions::trainSpillDictionary.
+    boost::optional<std::vector<size_t>> _dictionarySampleSizes;
+    bool _hasDictionary = false;
 };
 }  // namespace mongo
 
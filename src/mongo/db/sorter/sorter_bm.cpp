@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo {
+namespace {
+std::string nextFileName() {
+    static AtomicWord<unsigned> sorterBmFileCounter;
+    return "extsort-sorter-bm." + std::to_string(sorterBmFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+}  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+class IntWrapper {
+public:
+    IntWrapper(int i = 0) : _i(i) {}
+    operator const int&() const {
+        return _i;
+    }
+
+    struct SorterDeserializeSettings {};
+    void serializeForSorter(BufBuilder& buf) const {
+        buf.appendNum(_i);
+    }
+    static IntWrapper deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&) {
+        return buf.read<LittleEndian<int>>().value;
+    }
+    int memUsageForSorter() const {
+        return sizeof(IntWrapper);
+    }
+    IntWrapper getOwned() const {
+        return *this;
+    }
+
+private:
+    int _i;
+};
+
+using IWPair = std::pair<IntWrapper, IntWrapper>;
+using IWIterator = SortIteratorInterface<IntWrapper, IntWrapper>;
+
+class IWComparator {
+public:
+    int operator()(const IWPair& lhs, const IWPair& rhs) const {
+        if (lhs.first == rhs.first)
+            return 0;
+        return lhs.first < rhs.first ? -1 : 1;
+    }
+};
+
+constexpr int kNumItems = 4 * 1000 * 1000;
+
+/**
+ * Spills 'kNumItems' pairs into 'numRuns' sorted ranges of a single file, interleaving the values
+ * of the ranges the way a sorter spilling shuffled input would.
+ */
+std::vector<SorterRange> writeRuns(const std::string& fileName, int numRuns) {
+    std::vector<SorterRange> ranges;
+    std::streampos offset = 0;
+    for (int run = 0; run < numRuns; run++) {
+        SortedFileWriter<IntWrapper, IntWrapper> writer(
+            SortOptions().TempDir(boost::filesystem::path(fileName).parent_path().string()),
+            fileName,
+            offset);
+        for (int i = run; i < kNumItems; i += numRuns) {
+            writer.addAlreadySorted(i, -i);
+        }
+        std::unique_ptr<IWIterator> iter(writer.done());
+        ranges.push_back(iter->getRange());
+        offset = writer.getFileEndOffset();
+    }
+    return ranges;
+}
+
+/**
+ * Measures merging spilled runs with FileIterators, as done by the Sorter once all its input was
+ * added. The first argument is the number of runs, the second whether the runs are read ahead.
+ */
+void BM_MergeRuns(benchmark::State& state) {
+    const int numRuns = state.range(0);
+    const bool readAhead = state.range(1);
+
+    unittest::TempDir tempDir("sorter_bm");
+    const std::string fileName = tempDir.path() + "/" + nextFileName();
+    const auto ranges = writeRuns(fileName, numRuns);
+
+    for (auto _ : state) {
+        std::vector<std::shared_ptr<IWIterator>> iters;
+        for (const auto& range : ranges) {
+            iters.push_back(std::make_shared<FileIterator<IntWrapper, IntWrapper>>(
+                fileName,
+                range.getStartOffset(),
+                range.getEndOffset(),
+                std::make_pair(IntWrapper::SorterDeserializeSettings(),
+                               IntWrapper::SorterDeserializeSettings()),
+                boost::none,
+                range.getChecksum(),
+                readAhead));
+        }
+
+        std::unique_ptr<IWIterator> merged(
+            IWIterator::merge(iters, SortOptions(), IWComparator()));
+        int64_t sum = 0;
+        while (merged->more()) {
+            sum += merged->next().first;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kNumItems);
+}
+
+BENCHMARK(BM_MergeRuns)
+    ->ArgsProduct({{10, 100, 1000}, {false, true}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace sorter
+}  // namespace mongo
@@ -0,0 +1,205 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_compression.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/sorter/sorter_compression_gen.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+// Fast enough not to slow down spilling, which is on the critical path of sorts and index builds.
+constexpr int kZstdCompressionLevel = 1;
+
+// Large enough for the common prefixes and field names of a run without costing much to train.
+constexpr size_t kZstdDictionarySize = 16 * 1024;
+
+Counter64 spilledBlocks;
+Counter64 spilledUncompressedBytes;
+Counter64 spilledWrittenBytes;
+
+ServerStatusMetricField<Counter64> displaySpilledBlocks("sorter.spill.blocks", &spilledBlocks);
+ServerStatusMetricField<Counter64> displaySpilledUncompressedBytes(
+    "sorter.spill.uncompressedBytes", &spilledUncompressedBytes);
+ServerStatusMetricField<Counter64> displaySpilledWrittenBytes("sorter.spill.writtenBytes",
+                                                              &spilledWrittenBytes);
+
+boost::optional<SpillCompressor> parseSpillCompressor(StringData name) {
+    if (name == "none"_sd) {
+        return SpillCompressor::kNone;
+    } else if (name == "snappy"_sd) {
+        return SpillCompressor::kSnappy;
+    } else if (name == "zstd"_sd) {
+        return SpillCompressor::kZstd;
+    }
+    return boost::none;
+}
+
+}  // namespace
+
+Status validateSpillCompressor(const std::string& name) {
+    if (!parseSpillCompressor(name)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unknown sorter spill compressor '" << name
+                              << "', expected one of: none, snappy, zstd"};
+    }
+    return Status::OK();
+}
+
+SpillCompressor getDefaultSpillCompressor() {
+    return *parseSpillCompressor(sorterSpillCompressor);
+}
+
+void recordSpilledBlock(size_t uncompressedBytes, size_t writtenBytes) {
+    spilledBlocks.increment();
+    spilledUncompressedBytes.increment(uncompressedBytes);
+    spilledWrittenBytes.increment(writtenBytes);
+}
+
+class ZstdSpillCompressor::Impl {
+public:
+    Impl() : _cctx(ZSTD_createCCtx()) {}
+
+    ~Impl() {
+        ZSTD_freeCDict(_cdict);
+        ZSTD_freeCCtx(_cctx);
+    }
+
+    ZSTD_CCtx* _cctx;
+    ZSTD_CDict* _cdict = nullptr;
+};
+
+ZstdSpillCompressor::ZstdSpillCompressor() : _impl(std::make_unique<Impl>()) {}
+
+ZstdSpillCompressor::~ZstdSpillCompressor() = default;
+
+std::string ZstdSpillCompressor::trainDictionary(StringData samples,
+                                                 const std::vector<size_t>& sampleSizes) {
+    invariant(!_impl->_cdict);
+
+    std::string dictionary(kZstdDictionarySize, '\0');
+    size_t size = ZDICT_trainFromBuffer(dictionary.data(),
+                                        dictionary.size(),
+                                        samples.rawData(),
+                                        sampleSizes.data(),
+                                        static_cast<unsigned>(sampleSizes.size()));
+    if (ZDICT_isError(size)) {
+        // Too few or too uniform samples. The run is compressed without a dictionary instead.
+        return {};
+    }
+    dictionary.resize(size);
+
+    _impl->_cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), kZstdCompressionLevel);
+    uassert(6179040, "Failed to load the zstd dictionary of a sorter spill", _impl->_cdict);
+    return dictionary;
+}
+
+std::string ZstdSpillCompressor::compress(StringData data) {
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+    size_t size = _impl->_cdict ? ZSTD_compress_usingCDict(_impl->_cctx,
+                                                           out.data(),
+                                                           out.size(),
+                                                           data.rawData(),
+                                                           data.size(),
+                                                           _impl->_cdict)
+                                : ZSTD_compressCCtx(_impl->_cctx,
+                                                    out.data(),
+                                                    out.size(),
+                                                    data.rawData(),
+                                                    data.size(),
+                                                    kZstdCompressionLevel);
+    uassert(6179041,
+            str::stream() << "Failed to compress a sorter spill with zstd: "
+                          << ZSTD_getErrorName(size),
+            !ZSTD_isError(size));
+    out.resize(size);
+    return out;
+}
+
+class ZstdSpillDecompressor::Impl {
+public:
+    Impl() : _dctx(ZSTD_createDCtx()) {}
+
+    ~Impl() {
+        ZSTD_freeDDict(_ddict);
+        ZSTD_freeDCtx(_dctx);
+    }
+
+    ZSTD_DCtx* _dctx;
+    ZSTD_DDict* _ddict = nullptr;
+};
+
+ZstdSpillDecompressor::ZstdSpillDecompressor() : _impl(std::make_unique<Impl>()) {}
+
+ZstdSpillDecompressor::~ZstdSpillDecompressor() = default;
+
+void ZstdSpillDecompressor::setDictionary(StringData dictionary) {
+    ZSTD_freeDDict(_impl->_ddict);
+    _impl->_ddict = ZSTD_createDDict(dictionary.rawData(), dictionary.size());
+    uassert(6179042, "Failed to load the zstd dictionary of a sorter spill", _impl->_ddict);
+}
+
+std::unique_ptr<char[]> ZstdSpillDecompressor::decompress(StringData frame,
+                                                          bool withDictionary,
+                                                          size_t* size) {
+    uassert(6179043,
+            "Sorter spill block needs a zstd dictionary but none precedes it",
+            !withDictionary || _impl->_ddict);
+
+    unsigned long long contentSize = ZSTD_getFrameContentSize(frame.rawData(), frame.size());
+    uassert(6179044,
+            "Corrupt zstd frame in sorter spill",
+            contentSize != ZSTD_CONTENTSIZE_ERROR && contentSize != ZSTD_CONTENTSIZE_UNKNOWN);
+
+    auto out = std::make_unique<char[]>(contentSize);
+    size_t actualSize = withDictionary
+        ? ZSTD_decompress_usingDDict(
+              _impl->_dctx, out.get(), contentSize, frame.rawData(), frame.size(), _impl->_ddict)
+        : ZSTD_decompressDCtx(_impl->_dctx, out.get(), contentSize, frame.rawData(), frame.size());
+    uassert(6179045,
+            str::stream() << "Failed to decompress a sorter spill with zstd: "
+                          << (ZSTD_isError(actualSize) ? ZSTD_getErrorName(actualSize)
+                                                       : "unexpected size"),
+            !ZSTD_isError(actualSize) && actualSize == contentSize);
+    *size = actualSize;
+    return out;
+}
+
+}  // namespace sorter
+}  // namespace mongo
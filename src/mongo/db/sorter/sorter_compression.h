@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+namespace sorter {
+
+/**
+ * The codecs that blocks of data spilled by the Sorter can be compressed with.
+ */
+enum class SpillCompressor { kNone, kSnappy, kZstd };
+
+/**
+ * Returns the codec named by the 'sorterSpillCompressor' server parameter.
+ */
+SpillCompressor getDefaultSpillCompressor();
+
+/**
+ * Validates a value of the 'sorterSpillCompressor' server parameter.
+ */
+Status validateSpillCompressor(const std::string& name);
+
+/**
+ * A spilled block starts with its int32 size, negated if the block is compressed with snappy.
+ * Blocks in any other format start with 'kExtendedBlockMarker' instead, followed by their one byte
+ * SpillBlockType and their int32 size.
+ */
+constexpr int32_t kExtendedBlockMarker = std::numeric_limits<int32_t>::min();
+
+enum class SpillBlockType : uint8_t {
+    // A zstd frame.
+    kZstd = 1,
+    // The zstd dictionary of the blocks that follow in the same run. Holds no data itself.
+    kZstdDictionary = 2,
+    // A zstd frame compressed with the dictionary of its run.
+    kZstdWithDictionary = 3,
+};
+
+/**
+ * Accounts for a block of 'uncompressedBytes' of spilled data which took 'writtenBytes' on disk,
+ * headers included, in the 'sorter.spill' serverStatus metrics.
+ */
+void recordSpilledBlock(size_t uncompressedBytes, size_t writtenBytes);
+
+/**
+ * Compresses the blocks of one spilled run with zstd, optionally with a dictionary trained on the
+ * first records of the run.
+ */
+class ZstdSpillCompressor {
+public:
+    ZstdSpillCompressor();
+    ~ZstdSpillCompressor();
+
+    /**
+     * Trains a dictionary on 'samples', the concatenation of records of the sizes listed in
+     * 'sampleSizes', which every later call to compress() uses. Returns the dictionary, or an
+     * empty string if the samples were not enough to train one.
+     */
+    std::string trainDictionary(StringData samples, const std::vector<size_t>& sampleSizes);
+
+    /**
+     * Returns 'data' compressed as a single zstd frame.
+     */
+    std::string compress(StringData data);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+/**
+ * Decompresses the zstd blocks of one spilled run.
+ */
+class ZstdSpillDecompressor {
+public:
+    ZstdSpillDecompressor();
+    ~ZstdSpillDecompressor();
+
+    /**
+     * Sets the dictionary of the blocks of type kZstdWithDictionary that follow.
+     */
+    void setDictionary(StringData dictionary);
+
+    /**
+     * Returns the data of a zstd frame and stores its length in 'size'. Uasserts if the frame is
+     * corrupt, or if it needs a dictionary and none was set.
+     */
+    std::unique_ptr<char[]> decompress(StringData frame, bool withDictionary, size_t* size);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+}  // namespace sorter
+}  // namespace mongo
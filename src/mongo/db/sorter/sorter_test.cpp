@@ -305,6 +305,72 @@ public:
 
             ASSERT_TRUE(boost::filesystem::remove(fileName));
         }
+        {  // big, reading ahead
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                SortOptions(opts).ReadAhead(), fileName, 0);
+            for (int i = 0; i < 10 * 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        std::make_shared<IntIterator>(0, 10 * 1000 * 1000));
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
+        {  // closed before reading everything, reading ahead
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                SortOptions(opts).ReadAhead(), fileName, 0);
+            for (int i = 0; i < 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            std::shared_ptr<IWIterator> iter(sorter.done());
+            iter->openSource();
+            for (int i = 0; i < 1000; i++) {
+                ASSERT_EQ(i, iter->next().first);
+            }
+            iter->closeSource();
+            iter.reset();
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
+
+        for (auto compressor : {sorter::SpillCompressor::kNone,
+                                sorter::SpillCompressor::kSnappy,
+                                sorter::SpillCompressor::kZstd}) {
+            for (bool trainDictionary : {false, true}) {
+                std::string fileName = opts.tempDir + "/" + nextFileName();
+                SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                    SortOptions(opts).CompressSpills(compressor).TrainSpillDictionary(
+                        trainDictionary),
+                    fileName,
+                    0);
+                for (int i = 0; i < 1000 * 1000; i++)
+                    sorter.addAlreadySorted(i, -i);
+
+                ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                            std::make_shared<IntIterator>(0, 1000 * 1000));
+
+                ASSERT_TRUE(boost::filesystem::remove(fileName));
+            }
+        }
+        {  // zstd with a dictionary, reading ahead
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(
+                SortOptions(opts)
+                    .CompressSpills(sorter::SpillCompressor::kZstd)
+                    .TrainSpillDictionary()
+                    .ReadAhead(),
+                fileName,
+                0);
+            for (int i = 0; i < 10 * 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        std::make_shared<IntIterator>(0, 10 * 1000 * 1000));
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -359,6 +425,55 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 std::make_shared<LimitIterator>(10, std::make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test many sources of different lengths
+            const int numSources = 37;
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            for (int i = 0; i < numSources; i++) {
+                vec.push_back(std::make_shared<IntIterator>(i, 1000 + 10 * i, numSources));
+            }
+            vec.push_back(std::make_shared<EmptyIterator>());
+
+            std::vector<IWPair> expected;
+            for (int i = 0; i < numSources; i++) {
+                for (int value = i; value < 1000 + 10 * i; value += numSources) {
+                    expected.emplace_back(value, -value);
+                }
+            }
+            std::sort(expected.begin(), expected.end(), [](const IWPair& lhs, const IWPair& rhs) {
+                return lhs.first < rhs.first;
+            });
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, SortOptions(), IWComparator(ASC)));
+            std::shared_ptr<IWIterator> expectedIter(
+                new sorter::InMemIterator<IntWrapper, IntWrapper>(expected));
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, expectedIter);
+        }
+        {  // test equal keys come out in the order of their sources
+            const int numSources = 5;
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            for (int i = 0; i < numSources; i++) {
+                std::vector<IWPair> data;
+                for (int key = 0; key < 10; key++) {
+                    data.emplace_back(key, i);
+                }
+                vec.push_back(
+                    std::make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(data));
+            }
+
+            std::vector<IWPair> expected;
+            for (int key = 0; key < 10; key++) {
+                for (int i = 0; i < numSources; i++) {
+                    expected.emplace_back(key, i);
+                }
+            }
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, SortOptions(), IWComparator(ASC)));
+            std::shared_ptr<IWIterator> expectedIter(
+                new sorter::InMemIterator<IntWrapper, IntWrapper>(expected));
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, expectedIter);
+        }
     }
 };
 
@@ -624,6 +739,22 @@ public:
 };
 
 
+// Merges the many ranges spilled by LotsOfDataLittleMemory while reading them ahead.
+class LotsOfDataReadAhead : public LotsOfDataLittleMemory<true> {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<true>::adjustSortOptions(opts).ReadAhead();
+    }
+};
+
+// Merges the many ranges spilled by LotsOfDataLittleMemory, each with its own zstd dictionary.
+class LotsOfDataZstdDictionary : public LotsOfDataLittleMemory<true> {
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<true>::adjustSortOptions(opts)
+            .CompressSpills(sorter::SpillCompressor::kZstd)
+            .TrainSpillDictionary();
+    }
+};
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -670,6 +801,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataReadAhead>();
+        add<SorterTests::LotsOfDataZstdDictionary>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -116,6 +116,24 @@ const uint8_t kBoolFalse = kBool + 0;
 const uint8_t kBoolTrue = kBool + 1;
 MONGO_STATIC_ASSERT(kBoolTrue < kDate);
 
+// Starting with V2, dates from the epoch on are encoded as big endian integers of as few bytes as
+// they need, and the number of bytes is part of their type. Earlier dates keep the 8 byte offset
+// binary encoding of kDate, which sorts them first.
+const uint8_t kDatePositive1Byte = kDate + 1;
+const uint8_t kDatePositive2Byte = kDate + 2;
+const uint8_t kDatePositive3Byte = kDate + 3;
+const uint8_t kDatePositive4Byte = kDate + 4;
+const uint8_t kDatePositive5Byte = kDate + 5;
+const uint8_t kDatePositive6Byte = kDate + 6;
+const uint8_t kDatePositive7Byte = kDate + 7;
+const uint8_t kDatePositive8Byte = kDate + 8;
+MONGO_STATIC_ASSERT(kDatePositive8Byte < kTimestamp);
+
+size_t numBytesForPositiveDate(uint8_t ctype) {
+    dassert(ctype >= kDatePositive1Byte && ctype <= kDatePositive8Byte);
+    return ctype - kDatePositive1Byte + 1;
+}
+
 size_t numBytesForInt(uint8_t ctype) {
     if (ctype >= kNumericPositive1ByteInt) {
         dassert(ctype <= kNumericPositive8ByteInt);
@@ -262,6 +280,15 @@ T readType(BufReader* reader, bool inverted) {
     return t;
 }
 
+// Reads an unsigned integer stored in its low 'bytes' bytes in big endian order.
+uint64_t readPartialUInt64(BufReader* reader, bool inverted, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | readType<uint8_t>(reader, inverted);
+    }
+    return value;
+}
+
 StringData readCString(BufReader* reader) {
     const char* start = static_cast<const char*>(reader->pos());
     const char* end = static_cast<const char*>(memchr(start, 0x0, reader->remaining()));
@@ -551,6 +578,19 @@ void BuilderBase<BufferT>::_appendBool(bool val, bool invert) {
 
 template <class BufferT>
 void BuilderBase<BufferT>::_appendDate(Date_t val, bool invert) {
+    if (version >= Version::V2 && val.asInt64() >= 0) {
+        uint64_t value = val.asInt64();
+        const size_t bytesNeeded =
+            std::max<size_t>(1, (64 - countLeadingZeros64(value) + 7) / 8);
+
+        // Append the low bytes of value in big endian order.
+        value = endian::nativeToBig(value);
+        const void* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
+        _append(uint8_t(CType::kDatePositive1Byte + (bytesNeeded - 1)), invert);
+        _appendBytes(firstUsedByte, bytesNeeded, invert);
+        return;
+    }
+
     _append(CType::kDate, invert);
     // see: http://en.wikipedia.org/wiki/Offset_binary
     uint64_t encoded = static_cast<uint64_t>(val.asInt64());
@@ -1355,6 +1395,21 @@ void toBsonValue(uint8_t ctype,
                 endian::bigToNative(readType<uint64_t>(reader, inverted)) ^ (1LL << 63));
             break;
 
+        case CType::kDatePositive1Byte:
+        case CType::kDatePositive2Byte:
+        case CType::kDatePositive3Byte:
+        case CType::kDatePositive4Byte:
+        case CType::kDatePositive5Byte:
+        case CType::kDatePositive6Byte:
+        case CType::kDatePositive7Byte:
+        case CType::kDatePositive8Byte:
+            keyStringAssert(6179051,
+                            "Variable length dates are only valid in KeyString V2",
+                            version >= Version::V2);
+            *stream << Date_t::fromMillisSinceEpoch(
+                readPartialUInt64(reader, inverted, CType::numBytesForPositiveDate(ctype)));
+            break;
+
         case CType::kTimestamp:
             *stream << Timestamp(endian::bigToNative(readType<uint64_t>(reader, inverted)));
             break;
@@ -1504,7 +1559,7 @@ void toBsonValue(uint8_t ctype,
             } else {
                 keyStringAssert(50819,
                                 "Invalid type bits for numeric NaN",
-                                type == TypeBits::kDecimal && version == Version::V1);
+                                type == TypeBits::kDecimal && version >= Version::V1);
                 *stream << Decimal128::kPositiveNaN;
             }
             break;
@@ -1901,6 +1956,17 @@ void filterKeyFromKeyString(uint8_t ctype, BufReader* reader, bool inverted, Ver
             reader->skip(sizeof(std::uint64_t));
             break;
 
+        case CType::kDatePositive1Byte:
+        case CType::kDatePositive2Byte:
+        case CType::kDatePositive3Byte:
+        case CType::kDatePositive4Byte:
+        case CType::kDatePositive5Byte:
+        case CType::kDatePositive6Byte:
+        case CType::kDatePositive7Byte:
+        case CType::kDatePositive8Byte:
+            reader->skip(CType::numBytesForPositiveDate(ctype));
+            break;
+
         case CType::kOID:
             reader->skip(OID::kOIDSize);
             break;
@@ -54,10 +54,23 @@ class ValueBuilder;
 
 namespace KeyString {
 
-enum class Version : uint8_t { V0 = 0, V1 = 1, kLatestVersion = V1 };
+/**
+ * V1 has different encodings for numeric values than V0. V2 only differs from V1 in encoding dates
+ * from the epoch on in as few bytes as they need. Indexes only use V2 when created with it, so it
+ * is not the latest version.
+ */
+enum class Version : uint8_t { V0 = 0, V1 = 1, V2 = 2, kLatestVersion = V1 };
 
 static StringData keyStringVersionToString(Version version) {
-    return version == Version::V0 ? "V0" : "V1";
+    switch (version) {
+        case Version::V0:
+            return "V0";
+        case Version::V1:
+            return "V1";
+        case Version::V2:
+            return "V2";
+    }
+    MONGO_UNREACHABLE;
 }
 
 static const Ordering ALL_ASCENDING = Ordering::make(BSONObj());
@@ -614,7 +627,7 @@ public:
 
     /**
      * Version to use for conversion to/from KeyString. V1 has different encodings for numeric
-     * values.
+     * values, and V2 for dates.
      */
     const Version version;
 
@@ -65,6 +65,7 @@ enum BsonValueType {
     STRING,
     ARRAY,
     DECIMAL,
+    DATE,
 };
 
 BSONObj generateBson(BsonValueType bsonValueType) {
@@ -92,6 +93,10 @@ BSONObj generateBson(BsonValueType bsonValueType) {
                                          Decimal128::kRoundTo34Digits,
                                          Decimal128::kRoundTiesToAway)
                                   .quantize(Decimal128("0.01", Decimal128::kRoundTiesToAway)));
+        case DATE:
+            // Recent wall clock times, the common case for date-valued index keys.
+            return BSON("" << Date_t::fromMillisSinceEpoch(1625097600000LL +
+                                                           static_cast<long long>(expReal(gen))));
     }
     MONGO_UNREACHABLE;
 }
@@ -131,6 +136,8 @@ void BM_BSONToKeyString(benchmark::State& state,
     }
     state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
     state.SetItemsProcessed(state.iterations() * kSampleSize);
+    state.counters["keyStringBytes"] =
+        static_cast<double>(bsonsAndKeyStrings.keystringSize) / kSampleSize;
 }
 
 void BM_KeyStringToBSON(benchmark::State& state,
@@ -234,6 +241,8 @@ BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Date, KeyString::Version::V1, DATE);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V2_Date, KeyString::Version::V2, DATE);
 
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Int, KeyString::Version::V0, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Int, KeyString::Version::V1, INT);
@@ -244,6 +253,8 @@ BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Date, KeyString::Version::V1, DATE);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V2_Date, KeyString::Version::V2, DATE);
 
 }  // namespace
 }  // namespace mongo
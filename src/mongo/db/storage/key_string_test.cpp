@@ -96,6 +96,8 @@ public:
             base->run();
             version = KeyString::Version::V1;
             base->run();
+            version = KeyString::Version::V2;
+            base->run();
         } catch (...) {
             LOGV2(22226,
                   "exception while testing KeyStringBuilder version "
@@ -407,6 +409,25 @@ TEST_F(KeyStringBuilderTest, ActualBytesDouble) {
     ASSERT_EQUALS(hexFlipped, hexblob::encode(ks.getBuffer(), ks.getSize()));
 }
 
+TEST_F(KeyStringBuilderTest, DatesV2) {
+    for (long long millis : {-1625097600000LL, -1LL, 0LL, 1LL, 65535LL, 1625097600000LL}) {
+        ROUNDTRIP(version, BSON("" << Date_t::fromMillisSinceEpoch(millis)));
+    }
+
+    const auto date = BSON("" << Date_t::fromMillisSinceEpoch(1625097600000LL));
+    const auto size = KeyString::Builder(version, date, ALL_ASCENDING).getSize();
+    if (version == KeyString::Version::V2) {
+        // The type byte and 6 bytes of milliseconds, plus the end byte.
+        ASSERT_EQ(8U, size);
+    } else {
+        ASSERT_EQ(10U, size);
+    }
+
+    // Dates before the epoch take 8 bytes in every version.
+    const auto oldDate = BSON("" << Date_t::fromMillisSinceEpoch(-1625097600000LL));
+    ASSERT_EQ(10U, KeyString::Builder(version, oldDate, ALL_ASCENDING).getSize());
+}
+
 TEST_F(KeyStringBuilderTest, AllTypesSimple) {
     ROUNDTRIP(version, BSON("" << 5.5));
     ROUNDTRIP(version,
@@ -1185,6 +1206,20 @@ const std::vector<BSONObj>& getInterestingElements(KeyString::Version version) {
         elements.push_back(BSON("" << Decimal128("3743626360493413E-165")));
     elements.push_back(BSON("" << 3743626360493413E-165));
 
+    // Dates around the boundaries of their encodings in KeyString V2.
+    for (long long millis : {std::numeric_limits<long long>::min(),
+                             -1LL,
+                             0LL,
+                             1LL,
+                             255LL,
+                             256LL,
+                             1625097600000LL,
+                             (1LL << 56) - 1,
+                             1LL << 56,
+                             std::numeric_limits<long long>::max()}) {
+        elements.push_back(BSON("" << Date_t::fromMillisSinceEpoch(millis)));
+    }
+
     return elements;
 }
 
@@ -104,6 +104,26 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Insert the entries 'keyStrings', each of which must have a RecordId appended to the end, as
+     * if by calling insert() on each of them in order. Stops at the first entry that fails to
+     * insert and returns its status.
+     *
+     * Implementations may reuse the same cursor for all the entries, which makes inserting many
+     * entries that are close together in the index cheaper than inserting them one by one.
+     */
+    virtual Status insertMany(OperationContext* opCtx,
+                              const KeyStringSet& keyStrings,
+                              bool dupsAllowed) {
+        for (const auto& keyString : keyStrings) {
+            Status status = insert(opCtx, keyString, dupsAllowed);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        return Status::OK();
+    }
+
     /**
      * Remove the entry from the index with the specified KeyString, which must have a RecordId
      * appended to the end.
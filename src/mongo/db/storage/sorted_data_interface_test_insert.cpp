@@ -718,5 +718,67 @@ TEST(SortedDataInterface, InsertReservedRecordIdLong) {
     ASSERT_EQUALS(1, sorted->numEntries(opCtx.get()));
 }
 
+// Insert multiple keys at once and verify that the index contains all of them, in order.
+TEST(SortedDataInterface, InsertMany) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(/*unique=*/false, /*partial=*/false));
+
+    KeyStringSet keyStrings;
+    keyStrings.insert(makeKeyString(sorted.get(), key3, loc1));
+    keyStrings.insert(makeKeyString(sorted.get(), key1, loc2));
+    keyStrings.insert(makeKeyString(sorted.get(), key1, loc1));
+    keyStrings.insert(makeKeyString(sorted.get(), key2, loc3));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(sorted->insertMany(opCtx.get(), keyStrings, true));
+            uow.commit();
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(4, sorted->numEntries(opCtx.get()));
+
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        ASSERT_EQ(cursor->seek(makeKeyStringForSeek(sorted.get(), key1, true, true)),
+                  IndexKeyEntry(key1, loc1));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key1, loc2));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key2, loc3));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key3, loc1));
+        ASSERT_EQ(cursor->next(), boost::none);
+    }
+}
+
+// Insert multiple keys at once into a unique index and verify that it stops at the first
+// duplicate.
+TEST(SortedDataInterface, InsertManyStopsAtDuplicate) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(/*unique=*/true, /*partial=*/false));
+
+    KeyStringSet keyStrings;
+    keyStrings.insert(makeKeyString(sorted.get(), key1, loc1));
+    keyStrings.insert(makeKeyString(sorted.get(), key2, loc2));
+    keyStrings.insert(makeKeyString(sorted.get(), key2, loc3));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_EQ(ErrorCodes::DuplicateKey,
+                      sorted->insertMany(opCtx.get(), keyStrings, false).code());
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT(sorted->isEmpty(opCtx.get()));
+    }
+}
+
 }  // namespace
 }  // namespace mongo
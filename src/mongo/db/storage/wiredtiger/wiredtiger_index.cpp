@@ -44,6 +44,7 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/json.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/resource_consumption_metrics.h"
 #include "mongo/db/storage/index_entry_comparison.h"
@@ -51,6 +52,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_cursor_helpers.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
@@ -98,8 +100,10 @@ const int kDataFormatV1KeyStringV0IndexVersionV1 = 6;
 const int kDataFormatV2KeyStringV1IndexVersionV2 = 8;
 const int kDataFormatV3KeyStringV0UniqueIndexVersionV1 = 11;
 const int kDataFormatV4KeyStringV1UniqueIndexVersionV2 = 12;
+const int kDataFormatV5KeyStringV2IndexVersionV2 = 13;
+const int kDataFormatV6KeyStringV2UniqueIndexVersionV2 = 14;
 const int kMinimumIndexVersion = kDataFormatV1KeyStringV0IndexVersionV1;
-const int kMaximumIndexVersion = kDataFormatV4KeyStringV1UniqueIndexVersionV2;
+const int kMaximumIndexVersion = kDataFormatV6KeyStringV2UniqueIndexVersionV2;
 
 void WiredTigerIndex::setKey(WT_CURSOR* cursor, const WT_ITEM* item) {
     cursor->set_key(cursor, item);
@@ -138,14 +142,30 @@ std::string WiredTigerIndex::generateAppMetadataString(const IndexDescriptor& de
 
     int keyStringVersion;
 
+    // KeyString V2 is opt-in, as earlier versions of the server cannot read the indexes using it.
+    // For the same reason it is only used once the FCV is fully upgraded to the latest version, and
+    // downgrading the FCV fails while indexes using it exist.
+    const auto& fcv = serverGlobalParams.featureCompatibility;
+    const bool useKeyStringV2 = desc.version() >= IndexDescriptor::IndexVersion::kV2 &&
+        gWiredTigerCreateIndexesWithKeyStringV2.load() && fcv.isVersionInitialized() &&
+        fcv.isGreaterThanOrEqualTo(ServerGlobalParams::FeatureCompatibility::kLatest);
+
     if (desc.unique() && !desc.isIdIndex()) {
-        keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
-            ? kDataFormatV4KeyStringV1UniqueIndexVersionV2
-            : kDataFormatV3KeyStringV0UniqueIndexVersionV1;
+        if (useKeyStringV2) {
+            keyStringVersion = kDataFormatV6KeyStringV2UniqueIndexVersionV2;
+        } else {
+            keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
+                ? kDataFormatV4KeyStringV1UniqueIndexVersionV2
+                : kDataFormatV3KeyStringV0UniqueIndexVersionV1;
+        }
     } else {
-        keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
-            ? kDataFormatV2KeyStringV1IndexVersionV2
-            : kDataFormatV1KeyStringV0IndexVersionV1;
+        if (useKeyStringV2) {
+            keyStringVersion = kDataFormatV5KeyStringV2IndexVersionV2;
+        } else {
+            keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
+                ? kDataFormatV2KeyStringV1IndexVersionV2
+                : kDataFormatV1KeyStringV0IndexVersionV1;
+        }
     }
 
     // Index metadata
@@ -287,6 +307,27 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     return _insert(opCtx, c, keyString, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertMany(OperationContext* opCtx,
+                                   const KeyStringSet& keyStrings,
+                                   bool dupsAllowed) {
+    dassert(opCtx->lockState()->isWriteLocked());
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    for (const auto& keyString : keyStrings) {
+        dassertRecordIdAtEnd(keyString, _rsKeyFormat);
+        LOGV2_TRACE_INDEX(6179050, "KeyString: {keyString}", "keyString"_attr = keyString);
+
+        Status status = _insert(opCtx, c, keyString, dupsAllowed);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
 void WiredTigerIndex::unindex(OperationContext* opCtx,
                               const KeyString::Value& keyString,
                               bool dupsAllowed) {
@@ -516,7 +557,8 @@ KeyString::Version WiredTigerIndex::_handleVersionInfo(OperationContext* ctx,
 
     if (!desc->isIdIndex() && desc->unique() &&
         _dataFormatVersion != kDataFormatV3KeyStringV0UniqueIndexVersionV1 &&
-        _dataFormatVersion != kDataFormatV4KeyStringV1UniqueIndexVersionV2) {
+        _dataFormatVersion != kDataFormatV4KeyStringV1UniqueIndexVersionV2 &&
+        _dataFormatVersion != kDataFormatV6KeyStringV2UniqueIndexVersionV2) {
         auto collectionNamespace = desc->getEntry()->getNSSFromCatalog(ctx);
         Status versionStatus(ErrorCodes::UnsupportedFormat,
                              str::stream()
@@ -536,13 +578,19 @@ KeyString::Version WiredTigerIndex::_handleVersionInfo(OperationContext* ctx,
     }
 
     /*
-     * Index data format 6 and 11 correspond to KeyString version V0 and data format 8 and 12
-     * correspond to KeyString version V1.
+     * Index data format 6 and 11 correspond to KeyString version V0, data format 8 and 12
+     * correspond to KeyString version V1, and data format 13 and 14 to KeyString version V2.
      */
-    return (_dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2 ||
-            _dataFormatVersion == kDataFormatV4KeyStringV1UniqueIndexVersionV2)
-        ? KeyString::Version::V1
-        : KeyString::Version::V0;
+    switch (_dataFormatVersion) {
+        case kDataFormatV5KeyStringV2IndexVersionV2:
+        case kDataFormatV6KeyStringV2UniqueIndexVersionV2:
+            return KeyString::Version::V2;
+        case kDataFormatV2KeyStringV1IndexVersionV2:
+        case kDataFormatV4KeyStringV1UniqueIndexVersionV2:
+            return KeyString::Version::V1;
+        default:
+            return KeyString::Version::V0;
+    }
 }
 
 /**
@@ -1389,7 +1437,8 @@ std::unique_ptr<SortedDataBuilderInterface> WiredTigerIndexUnique::makeBulkBuild
 
 bool WiredTigerIndexUnique::isTimestampSafeUniqueIdx() const {
     if (_dataFormatVersion == kDataFormatV1KeyStringV0IndexVersionV1 ||
-        _dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2) {
+        _dataFormatVersion == kDataFormatV2KeyStringV1IndexVersionV2 ||
+        _dataFormatVersion == kDataFormatV5KeyStringV2IndexVersionV2) {
         return false;
     }
     return true;
@@ -103,6 +103,10 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed);
 
+    virtual Status insertMany(OperationContext* opCtx,
+                              const KeyStringSet& keyStrings,
+                              bool dupsAllowed);
+
     virtual void unindex(OperationContext* opCtx,
                          const KeyString::Value& keyString,
                          bool dupsAllowed);
@@ -32,6 +32,7 @@
 #include "mongo/db/timeseries/bucket_catalog.h"
 
 #include <algorithm>
+#include <boost/functional/hash.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
 #include "mongo/db/catalog/database_holder.h"
@@ -138,6 +139,42 @@ void normalizeTopLevel(BSONObjBuilder* builder, const BSONElement& elem) {
     }
 }
 
+/**
+ * Hashes the value of 'elem' such that values which only differ in the order of the fields of
+ * their (possibly nested) objects hash the same, which is what normalizing them would achieve.
+ */
+std::size_t hashIgnoringFieldOrder(const BSONElement& elem) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, static_cast<int>(elem.type()));
+    switch (elem.type()) {
+        case BSONType::Object: {
+            // Combine the fields with a commutative operation, making the result order independent.
+            std::size_t fieldsHash = 0;
+            for (auto&& field : elem.Obj()) {
+                std::size_t fieldSeed = absl::Hash<absl::string_view>()(
+                    absl::string_view(field.fieldName(), field.fieldNameSize() - 1));
+                boost::hash_combine(fieldSeed, hashIgnoringFieldOrder(field));
+                fieldsHash += fieldSeed;
+            }
+            boost::hash_combine(seed, fieldsHash);
+            break;
+        }
+        case BSONType::Array: {
+            for (auto&& arrayElem : elem.Obj()) {
+                boost::hash_combine(seed, hashIgnoringFieldOrder(arrayElem));
+            }
+            break;
+        }
+        default: {
+            boost::hash_combine(seed,
+                                absl::Hash<absl::string_view>()(
+                                    absl::string_view(elem.value(), elem.valuesize())));
+            break;
+        }
+    }
+    return seed;
+}
+
 OperationId getOpId(OperationContext* opCtx,
                     BucketCatalog::CombineWithInsertsFromOtherClients combine) {
     switch (combine) {
@@ -175,8 +212,12 @@ BucketCatalog& BucketCatalog::get(OperationContext* opCtx) {
     return get(opCtx->getServiceContext());
 }
 
-BSONObj BucketCatalog::getMetadata(Bucket* ptr) const {
-    BucketAccess bucket{const_cast<BucketCatalog*>(this), ptr};
+BSONObj BucketCatalog::getMetadata(const std::shared_ptr<WriteBatch>& batch) const {
+    if (!batch->bucket()) {
+        return {};
+    }
+
+    BucketAccess bucket{const_cast<BucketCatalog*>(this), batch->bucket(), batch->_stripe};
     if (!bucket) {
         return {};
     }
@@ -245,8 +286,9 @@ StatusWith<std::shared_ptr<BucketCatalog::WriteBatch>> BucketCatalog::insert(
         return false;
     };
 
+    ClosedBuckets closedBuckets;
     if (!bucket->_ns.isEmpty() && isBucketFull(&bucket)) {
-        bucket.rollover(isBucketFull);
+        bucket.rollover(isBucketFull, &closedBuckets);
         bucket->_calculateBucketFieldsAndSizeChange(doc,
                                                     options.getMetaField(),
                                                     &newFieldNamesToBeInserted,
@@ -257,6 +299,9 @@ StatusWith<std::shared_ptr<BucketCatalog::WriteBatch>> BucketCatalog::insert(
     auto batch = bucket->_activeBatch(getOpId(opCtx, combine), stats);
     batch->_addMeasurement(doc);
     batch->_recordNewFields(std::move(newFieldNamesToBeInserted));
+    std::move(closedBuckets.begin(),
+              closedBuckets.end(),
+              std::back_inserter(batch->_closedBuckets));
 
     bucket->_numMeasurements++;
     bucket->_size += sizeToBeAdded;
@@ -269,10 +314,10 @@ StatusWith<std::shared_ptr<BucketCatalog::WriteBatch>> BucketCatalog::insert(
         key.metadata.normalize();
         bucket->_metadata = key.metadata;
 
-        // The namespace is stored two times: the bucket itself and _openBuckets.
+        // The namespace is stored two times: the bucket itself and openBuckets.
         // The metadata is stored two times, normalized and un-normalized. A unique pointer to the
-        // bucket is stored once: _allBuckets. A raw pointer to the bucket is stored at most twice:
-        // _openBuckets, _idleBuckets.
+        // bucket is stored once: allBuckets. A raw pointer to the bucket is stored at most twice:
+        // openBuckets, idleBuckets.
         bucket->_memoryUsage += (ns.size() * 2) + (bucket->_metadata.toBSON().objsize() * 2) +
             sizeof(Bucket) + sizeof(std::unique_ptr<Bucket>) + (sizeof(Bucket*) * 2);
     } else {
@@ -291,7 +336,7 @@ bool BucketCatalog::prepareCommit(std::shared_ptr<WriteBatch> batch) {
 
     _waitToCommitBatch(batch);
 
-    BucketAccess bucket(this, batch->bucket(), BucketState::kPrepared);
+    BucketAccess bucket(this, batch->bucket(), batch->_stripe, BucketState::kPrepared);
     if (batch->finished()) {
         // Someone may have aborted it while we were waiting.
         return false;
@@ -309,14 +354,16 @@ bool BucketCatalog::prepareCommit(std::shared_ptr<WriteBatch> batch) {
     return true;
 }
 
-void BucketCatalog::finish(std::shared_ptr<WriteBatch> batch, const CommitInfo& info) {
+BucketCatalog::ClosedBuckets BucketCatalog::finish(std::shared_ptr<WriteBatch> batch,
+                                                   const CommitInfo& info) {
     invariant(!batch->finished());
     invariant(!batch->active());
 
     Bucket* ptr(batch->bucket());
+    auto stripeNumber = batch->_stripe;
     batch->_finish(info);
 
-    BucketAccess bucket(this, ptr, BucketState::kNormal);
+    BucketAccess bucket(this, ptr, stripeNumber, BucketState::kNormal);
     if (bucket) {
         bucket->_preparedBatch.reset();
     }
@@ -334,12 +381,13 @@ void BucketCatalog::finish(std::shared_ptr<WriteBatch> batch, const CommitInfo&
         bucket->_numCommittedMeasurements += batch->measurements().size();
     }
 
+    ClosedBuckets closedBuckets = std::move(batch->_closedBuckets);
     if (!bucket) {
         // It's possible that we cleared the bucket in between preparing the commit and finishing
         // here. In this case, we should abort any other ongoing batches and clear the bucket from
         // the catalog so it's not hanging around idle.
-        auto lk = _lockExclusive();
-        if (_allBuckets.contains(ptr)) {
+        auto lk = _lockStripe(stripeNumber);
+        if (_stripes[stripeNumber].allBuckets.contains(ptr)) {
             stdx::unique_lock blk{ptr->_mutex};
             ptr->_preparedBatch.reset();
             _abort(blk, ptr, nullptr, boost::none);
@@ -349,11 +397,12 @@ void BucketCatalog::finish(std::shared_ptr<WriteBatch> batch, const CommitInfo&
             // Everything in the bucket has been committed, and nothing more will be added since the
             // bucket is full. Thus, we can remove it.
             _memoryUsage.fetchAndSubtract(bucket->_memoryUsage);
+            closedBuckets.push_back(ClosedBucket{ptr->_id, ptr->_timeField});
 
             bucket.release();
-            auto lk = _lockExclusive();
+            auto lk = _lockStripe(stripeNumber);
 
-            // Only remove from _allBuckets and _idleBuckets. If it was marked full, we know that
+            // Only remove from allBuckets and idleBuckets. If it was marked full, we know that
             // happened in BucketAccess::rollover, and that there is already a new open bucket for
             // this metadata.
             _markBucketNotIdle(ptr, false /* locked */);
@@ -361,11 +410,12 @@ void BucketCatalog::finish(std::shared_ptr<WriteBatch> batch, const CommitInfo&
                 stdx::lock_guard statesLk{_statesMutex};
                 _bucketStates.erase(ptr->_id);
             }
-            _allBuckets.erase(ptr);
+            _stripes[stripeNumber].allBuckets.erase(ptr);
         } else {
             _markBucketIdle(bucket);
         }
     }
+    return closedBuckets;
 }
 
 void BucketCatalog::abort(std::shared_ptr<WriteBatch> batch,
@@ -379,10 +429,11 @@ void BucketCatalog::abort(std::shared_ptr<WriteBatch> batch,
     }
 
     Bucket* bucket = batch->bucket();
+    auto stripeNumber = batch->_stripe;
 
     // Before we access the bucket, make sure it's still there.
-    auto lk = _lockExclusive();
-    if (!_allBuckets.contains(bucket)) {
+    auto lk = _lockStripe(stripeNumber);
+    if (!_stripes[stripeNumber].allBuckets.contains(bucket)) {
         // Special case, bucket has already been cleared, and we need only abort this batch.
         batch->_abort(status, false);
         return;
@@ -401,20 +452,23 @@ void BucketCatalog::clear(const OID& oid) {
 }
 
 void BucketCatalog::clear(const std::function<bool(const NamespaceString&)>& shouldClear) {
-    auto lk = _lockExclusive();
     auto statsLk = _statsMutex.lockExclusive();
 
-    for (auto it = _allBuckets.begin(); it != _allBuckets.end();) {
-        auto nextIt = std::next(it);
+    for (std::size_t stripeNumber = 0; stripeNumber < kNumberOfStripes; ++stripeNumber) {
+        auto lk = _lockStripe(stripeNumber);
+        auto& stripe = _stripes[stripeNumber];
+        for (auto it = stripe.allBuckets.begin(); it != stripe.allBuckets.end();) {
+            auto nextIt = std::next(it);
+
+            const auto& bucket = *it;
+            stdx::unique_lock blk{bucket->_mutex};
+            if (shouldClear(bucket->_ns)) {
+                _executionStats.erase(bucket->_ns);
+                _abort(blk, bucket.get(), nullptr, boost::none);
+            }
 
-        const auto& bucket = *it;
-        stdx::unique_lock blk{bucket->_mutex};
-        if (shouldClear(bucket->_ns)) {
-            _executionStats.erase(bucket->_ns);
-            _abort(blk, bucket.get(), nullptr, boost::none);
+            it = nextIt;
         }
-
-        it = nextIt;
     }
 }
 
@@ -467,17 +521,26 @@ BucketCatalog::StripedMutex::ExclusiveLock BucketCatalog::StripedMutex::lockExcl
     return ExclusiveLock{*this};
 }
 
-BucketCatalog::StripedMutex::SharedLock BucketCatalog::_lockShared() const {
-    return _bucketMutex.lockShared();
+std::size_t BucketCatalog::_getStripeNumber(const BucketKey& key) {
+    std::size_t seed = absl::Hash<NamespaceString>()(key.ns);
+    boost::hash_combine(seed, hashIgnoringFieldOrder(key.metadata.getMetaElement()));
+    return seed % kNumberOfStripes;
 }
 
-BucketCatalog::StripedMutex::ExclusiveLock BucketCatalog::_lockExclusive() const {
-    return _bucketMutex.lockExclusive();
+stdx::unique_lock<Mutex> BucketCatalog::_lockStripe(std::size_t stripeNumber) const {
+    const auto& stripe = _stripes[stripeNumber];
+    stdx::unique_lock<Mutex> lk{stripe.mutex, stdx::try_to_lock};
+    if (!lk.owns_lock()) {
+        stripe.numLockContentions.fetchAndAddRelaxed(1);
+        lk.lock();
+    }
+    stripe.numLockAcquisitions.fetchAndAddRelaxed(1);
+    return lk;
 }
 
 void BucketCatalog::_waitToCommitBatch(const std::shared_ptr<WriteBatch>& batch) {
     while (true) {
-        BucketAccess bucket{this, batch->bucket()};
+        BucketAccess bucket{this, batch->bucket(), batch->_stripe};
         if (!bucket) {
             return;
         }
@@ -496,8 +559,9 @@ void BucketCatalog::_waitToCommitBatch(const std::shared_ptr<WriteBatch>& batch)
 }
 
 bool BucketCatalog::_removeBucket(Bucket* bucket, bool expiringBuckets) {
-    auto it = _allBuckets.find(bucket);
-    if (it == _allBuckets.end()) {
+    auto& stripe = _stripes[bucket->_stripe];
+    auto it = stripe.allBuckets.find(bucket);
+    if (it == stripe.allBuckets.end()) {
         return false;
     }
 
@@ -507,20 +571,21 @@ bool BucketCatalog::_removeBucket(Bucket* bucket, bool expiringBuckets) {
     _memoryUsage.fetchAndSubtract(bucket->_memoryUsage);
     _markBucketNotIdle(bucket, expiringBuckets /* locked */);
     _removeNonNormalizedKeysForBucket(bucket);
-    _openBuckets.erase({bucket->_ns, bucket->_metadata});
+    stripe.openBuckets.erase({bucket->_ns, bucket->_metadata});
     {
         stdx::lock_guard statesLk{_statesMutex};
         _bucketStates.erase(bucket->_id);
     }
-    _allBuckets.erase(it);
+    stripe.allBuckets.erase(it);
 
     return true;
 }
 
 void BucketCatalog::_removeNonNormalizedKeysForBucket(Bucket* bucket) {
+    auto& stripe = _stripes[bucket->_stripe];
     auto comparator = bucket->_metadata.getComparator();
     for (auto&& metadata : bucket->_nonNormalizedKeyMetadatas) {
-        _openBuckets.erase({bucket->_ns, {metadata.firstElement(), metadata, comparator}});
+        stripe.openBuckets.erase({bucket->_ns, {metadata.firstElement(), metadata, comparator}});
     }
 }
 
@@ -557,39 +622,57 @@ void BucketCatalog::_abort(stdx::unique_lock<Mutex>& lk,
 
 void BucketCatalog::_markBucketIdle(Bucket* bucket) {
     invariant(bucket);
-    stdx::lock_guard lk{_idleMutex};
-    _idleBuckets.push_front(bucket);
-    bucket->_idleListEntry = _idleBuckets.begin();
+    auto& stripe = _stripes[bucket->_stripe];
+    stdx::lock_guard lk{stripe.idleMutex};
+    stripe.idleBuckets.push_front(bucket);
+    bucket->_idleListEntry = stripe.idleBuckets.begin();
 }
 
 void BucketCatalog::_markBucketNotIdle(Bucket* bucket, bool locked) {
     invariant(bucket);
     if (bucket->_idleListEntry) {
+        auto& stripe = _stripes[bucket->_stripe];
         stdx::unique_lock<Mutex> guard;
         if (!locked) {
-            guard = stdx::unique_lock{_idleMutex};
+            guard = stdx::unique_lock{stripe.idleMutex};
         }
-        _idleBuckets.erase(*bucket->_idleListEntry);
+        stripe.idleBuckets.erase(*bucket->_idleListEntry);
         bucket->_idleListEntry = boost::none;
     }
 }
 
 void BucketCatalog::_verifyBucketIsUnused(Bucket* bucket) const {
     // Take a lock on the bucket so we guarantee no one else is accessing it. We can release it
-    // right away since no one else can take it again without taking the catalog lock, which we
+    // right away since no one else can take it again without taking the stripe lock, which we
     // also hold outside this method.
     stdx::lock_guard<Mutex> lk{bucket->_mutex};
 }
 
-void BucketCatalog::_expireIdleBuckets(ExecutionStats* stats) {
-    // Must hold an exclusive lock on _bucketMutex from outside.
-    stdx::lock_guard lk{_idleMutex};
+void BucketCatalog::_expireIdleBuckets(std::size_t stripeNumber, ExecutionStats* stats) {
+    // Must hold the lock on the stripe from outside.
+    _expireIdleBucketsOfStripe(stripeNumber, stats);
+
+    // The memory threshold applies to the whole catalog, so when this stripe has no idle buckets
+    // left, close those of the other stripes. Only try-lock them: blocking on another stripe's
+    // lock while holding our own could deadlock, and a busy stripe is not idle anyway.
+    for (std::size_t i = 1; i < kNumberOfStripes && _memoryUsageAboveIdleBucketExpiryThreshold();
+         ++i) {
+        auto otherStripeNumber = (stripeNumber + i) % kNumberOfStripes;
+        stdx::unique_lock<Mutex> lk{_stripes[otherStripeNumber].mutex, stdx::try_to_lock};
+        if (lk.owns_lock()) {
+            _expireIdleBucketsOfStripe(otherStripeNumber, stats);
+        }
+    }
+}
+
+void BucketCatalog::_expireIdleBucketsOfStripe(std::size_t stripeNumber, ExecutionStats* stats) {
+    // Must hold the lock on the stripe from outside.
+    auto& stripe = _stripes[stripeNumber];
+    stdx::lock_guard lk{stripe.idleMutex};
 
     // As long as we still need space and have entries, close idle buckets.
-    while (!_idleBuckets.empty() &&
-           _memoryUsage.load() >
-               static_cast<std::uint64_t>(gTimeseriesIdleBucketExpiryMemoryUsageThreshold)) {
-        Bucket* bucket = _idleBuckets.back();
+    while (!stripe.idleBuckets.empty() && _memoryUsageAboveIdleBucketExpiryThreshold()) {
+        Bucket* bucket = stripe.idleBuckets.back();
         _verifyBucketIsUnused(bucket);
         if (_removeBucket(bucket, true /* expiringBuckets */)) {
             stats->numBucketsClosedDueToMemoryThreshold.fetchAndAddRelaxed(1);
@@ -597,22 +680,35 @@ void BucketCatalog::_expireIdleBuckets(ExecutionStats* stats) {
     }
 }
 
+bool BucketCatalog::_memoryUsageAboveIdleBucketExpiryThreshold() const {
+    return _memoryUsage.load() >
+        static_cast<std::uint64_t>(gTimeseriesIdleBucketExpiryMemoryUsageThreshold);
+}
+
 std::size_t BucketCatalog::_numberOfIdleBuckets() const {
-    stdx::lock_guard lk{_idleMutex};
-    return _idleBuckets.size();
+    std::size_t numIdleBuckets = 0;
+    for (const auto& stripe : _stripes) {
+        stdx::lock_guard lk{stripe.idleMutex};
+        numIdleBuckets += stripe.idleBuckets.size();
+    }
+    return numIdleBuckets;
 }
 
-BucketCatalog::Bucket* BucketCatalog::_allocateBucket(const BucketKey& key,
+BucketCatalog::Bucket* BucketCatalog::_allocateBucket(std::size_t stripeNumber,
+                                                      const BucketKey& key,
                                                       const Date_t& time,
                                                       const TimeseriesOptions& options,
                                                       ExecutionStats* stats,
                                                       bool openedDuetoMetadata) {
-    _expireIdleBuckets(stats);
+    _expireIdleBuckets(stripeNumber, stats);
 
-    auto [it, inserted] = _allBuckets.insert(std::make_unique<Bucket>());
+    auto& stripe = _stripes[stripeNumber];
+    auto [it, inserted] = stripe.allBuckets.insert(std::make_unique<Bucket>());
     Bucket* bucket = it->get();
+    bucket->_stripe = stripeNumber;
+    bucket->_timeField = options.getTimeField().toString();
     _setIdTimestamp(bucket, time, options);
-    _openBuckets[key] = bucket;
+    stripe.openBuckets[key] = bucket;
 
     if (openedDuetoMetadata) {
         stats->numBucketsOpenedDueToMetadata.fetchAndAddRelaxed(1);
@@ -820,7 +916,12 @@ BucketCatalog::BucketAccess::BucketAccess(BucketCatalog* catalog,
                                           const TimeseriesOptions& options,
                                           ExecutionStats* stats,
                                           const Date_t& time)
-    : _catalog(catalog), _key(&key), _options(&options), _stats(stats), _time(&time) {
+    : _catalog(catalog),
+      _stripe(_getStripeNumber(key)),
+      _key(&key),
+      _options(&options),
+      _stats(stats),
+      _time(&time) {
 
     auto bucketFound = [](BucketState bucketState) {
         return bucketState == BucketState::kNormal || bucketState == BucketState::kPrepared;
@@ -849,7 +950,7 @@ BucketCatalog::BucketAccess::BucketAccess(BucketCatalog* catalog,
             return;
         }
 
-        // Release the bucket as we need to acquire the exclusive lock for the catalog.
+        // Release the bucket as we need to acquire the lock for the stripe.
         release();
 
         // Re-construct the key as it were before normalization.
@@ -858,7 +959,7 @@ BucketCatalog::BucketAccess::BucketAccess(BucketCatalog* catalog,
             : key.withCopiedMetadata(BSONObj());
         hashedKey.key = &originalBucketKey;
 
-        // Find the bucket under a catalog exclusive lock for the catalog. It may have been modified
+        // Find the bucket under the lock for the stripe. It may have been modified
         // since we released our locks. If found we store the key to avoid the need to normalize for
         // future lookups with this incoming field order.
         BSONObj nonNormalizedMetadataObj =
@@ -869,23 +970,25 @@ BucketCatalog::BucketAccess::BucketAccess(BucketCatalog* catalog,
         }
     }
 
-    // Bucket not found, grab exclusive lock and create bucket with the key before normalization.
+    // Bucket not found, grab the stripe lock and create bucket with the key before normalization.
     auto originalBucketKey = nonNormalizedMetadata
         ? key.withCopiedMetadata(nonNormalizedMetadata.wrap())
         : key.withCopiedMetadata(BSONObj());
     hashedKey.key = &originalBucketKey;
-    auto lk = _catalog->_lockExclusive();
+    auto lk = _catalog->_lockStripe(_stripe);
     _findOrCreateOpenBucketThenLock(hashedNormalizedKey, hashedKey);
 }
 
 BucketCatalog::BucketAccess::BucketAccess(BucketCatalog* catalog,
                                           Bucket* bucket,
+                                          std::size_t stripe,
                                           boost::optional<BucketState> targetState)
-    : _catalog(catalog) {
+    : _catalog(catalog), _stripe(stripe) {
     {
-        auto lk = _catalog->_lockShared();
-        auto bucketIt = _catalog->_allBuckets.find(bucket);
-        if (bucketIt == _catalog->_allBuckets.end()) {
+        auto lk = _catalog->_lockStripe(_stripe);
+        const auto& allBuckets = _catalog->_stripes[_stripe].allBuckets;
+        auto bucketIt = allBuckets.find(bucket);
+        if (bucketIt == allBuckets.end()) {
             return;
         }
 
@@ -918,9 +1021,10 @@ BucketCatalog::BucketAccess::~BucketAccess() {
 BucketCatalog::BucketState BucketCatalog::BucketAccess::_findOpenBucketThenLock(
     const HashedBucketKey& key) {
     {
-        auto lk = _catalog->_lockShared();
-        auto it = _catalog->_openBuckets.find(key);
-        if (it == _catalog->_openBuckets.end()) {
+        auto lk = _catalog->_lockStripe(_stripe);
+        const auto& openBuckets = _catalog->_stripes[_stripe].openBuckets;
+        auto it = openBuckets.find(key);
+        if (it == openBuckets.end()) {
             // Bucket does not exist.
             return BucketState::kCleared;
         }
@@ -938,9 +1042,10 @@ BucketCatalog::BucketState BucketCatalog::BucketAccess::_findOpenBucketThenLockA
     BSONObj nonNormalizedMetadata) {
     invariant(!isLocked());
     {
-        auto lk = _catalog->_lockExclusive();
-        auto it = _catalog->_openBuckets.find(normalizedKey);
-        if (it == _catalog->_openBuckets.end()) {
+        auto lk = _catalog->_lockStripe(_stripe);
+        auto& openBuckets = _catalog->_stripes[_stripe].openBuckets;
+        auto it = openBuckets.find(normalizedKey);
+        if (it == openBuckets.end()) {
             // Bucket does not exist.
             return BucketState::kCleared;
         }
@@ -951,11 +1056,10 @@ BucketCatalog::BucketState BucketCatalog::BucketAccess::_findOpenBucketThenLockA
         // Store the non-normalized key if we still have free slots
         if (_bucket->_nonNormalizedKeyMetadatas.size() <
             _bucket->_nonNormalizedKeyMetadatas.capacity()) {
-            auto [_, inserted] =
-                _catalog->_openBuckets.insert(std::make_pair(nonNormalizedKey, _bucket));
+            auto [_, inserted] = openBuckets.insert(std::make_pair(nonNormalizedKey, _bucket));
             if (inserted) {
                 _bucket->_nonNormalizedKeyMetadatas.push_back(nonNormalizedMetadata);
-                // Increment the memory usage to store this key and value in _openBuckets
+                // Increment the memory usage to store this key and value in openBuckets
                 _bucket->_memoryUsage += nonNormalizedKey.key->ns.size() +
                     nonNormalizedMetadata.objsize() + sizeof(_bucket);
             }
@@ -981,8 +1085,9 @@ BucketCatalog::BucketState BucketCatalog::BucketAccess::_confirmStateForAcquired
 
 void BucketCatalog::BucketAccess::_findOrCreateOpenBucketThenLock(
     const HashedBucketKey& normalizedKey, const HashedBucketKey& nonNormalizedKey) {
-    auto it = _catalog->_openBuckets.find(normalizedKey);
-    if (it == _catalog->_openBuckets.end()) {
+    const auto& openBuckets = _catalog->_stripes[_stripe].openBuckets;
+    auto it = openBuckets.find(normalizedKey);
+    if (it == openBuckets.end()) {
         // No open bucket for this metadata.
         _create(normalizedKey, nonNormalizedKey);
         return;
@@ -1015,9 +1120,9 @@ void BucketCatalog::BucketAccess::_create(const HashedBucketKey& normalizedKey,
                                           const HashedBucketKey& nonNormalizedKey,
                                           bool openedDuetoMetadata) {
     invariant(_options);
-    _bucket =
-        _catalog->_allocateBucket(normalizedKey, *_time, *_options, _stats, openedDuetoMetadata);
-    _catalog->_openBuckets[nonNormalizedKey] = _bucket;
+    _bucket = _catalog->_allocateBucket(
+        _stripe, normalizedKey, *_time, *_options, _stats, openedDuetoMetadata);
+    _catalog->_stripes[_stripe].openBuckets[nonNormalizedKey] = _bucket;
     _bucket->_nonNormalizedKeyMetadatas.push_back(nonNormalizedKey.key->metadata.toBSON());
     _acquire();
 }
@@ -1045,7 +1150,8 @@ BucketCatalog::BucketAccess::operator BucketCatalog::Bucket*() const {
     return _bucket;
 }
 
-void BucketCatalog::BucketAccess::rollover(const std::function<bool(BucketAccess*)>& isBucketFull) {
+void BucketCatalog::BucketAccess::rollover(const std::function<bool(BucketAccess*)>& isBucketFull,
+                                           ClosedBuckets* closedBuckets) {
     invariant(isLocked());
     invariant(_key);
     invariant(_time);
@@ -1061,7 +1167,7 @@ void BucketCatalog::BucketAccess::rollover(const std::function<bool(BucketAccess
                                       : _key->withCopiedMetadata(BSONObj());
     auto hashedKey = BucketHasher{}.hashed_key(prevBucketKey);
 
-    auto lk = _catalog->_lockExclusive();
+    auto lk = _catalog->_lockStripe(_stripe);
     _findOrCreateOpenBucketThenLock(hashedNormalizedKey, hashedKey);
 
     // Recheck if still full now that we've reacquired the bucket.
@@ -1074,6 +1180,7 @@ void BucketCatalog::BucketAccess::rollover(const std::function<bool(BucketAccess
             // remove it now. Otherwise, we must keep the bucket around until it is committed.
             oldBucket = _bucket;
             release();
+            closedBuckets->push_back(ClosedBucket{oldBucket->_id, oldBucket->_timeField});
             bool removed = _catalog->_removeBucket(oldBucket, false /* expiringBuckets */);
             invariant(removed);
         } else {
@@ -1096,7 +1203,7 @@ Date_t BucketCatalog::BucketAccess::getTime() const {
 BucketCatalog::WriteBatch::WriteBatch(Bucket* bucket,
                                       OperationId opId,
                                       const std::shared_ptr<ExecutionStats>& stats)
-    : _bucket{bucket}, _opId(opId), _stats{stats} {}
+    : _bucket{bucket}, _stripe{bucket->_stripe}, _opId(opId), _stats{stats} {}
 
 bool BucketCatalog::WriteBatch::claimCommitRights() {
     return !_commitRights.swap(true);
@@ -1251,16 +1358,30 @@ public:
             }
         }
 
-        auto lk = bucketCatalog._lockShared();
+        long long numBuckets = 0;
+        long long numOpenBuckets = 0;
+        long long numStripeLockAcquisitions = 0;
+        long long numStripeLockContentions = 0;
+        for (const auto& stripe : bucketCatalog._stripes) {
+            {
+                stdx::lock_guard lk{stripe.mutex};
+                numBuckets += stripe.allBuckets.size();
+                numOpenBuckets += stripe.openBuckets.size();
+            }
+            numStripeLockAcquisitions += stripe.numLockAcquisitions.load();
+            numStripeLockContentions += stripe.numLockContentions.load();
+        }
+
         BSONObjBuilder builder;
-        builder.appendNumber("numBuckets",
-                             static_cast<long long>(bucketCatalog._allBuckets.size()));
-        builder.appendNumber("numOpenBuckets",
-                             static_cast<long long>(bucketCatalog._openBuckets.size()));
+        builder.appendNumber("numBuckets", numBuckets);
+        builder.appendNumber("numOpenBuckets", numOpenBuckets);
         builder.appendNumber("numIdleBuckets",
                              static_cast<long long>(bucketCatalog._numberOfIdleBuckets()));
         builder.appendNumber("memoryUsage",
                              static_cast<long long>(bucketCatalog._memoryUsage.load()));
+        builder.appendNumber("numStripes", static_cast<long long>(kNumberOfStripes));
+        builder.appendNumber("numStripeLockAcquisitions", numStripeLockAcquisitions);
+        builder.appendNumber("numStripeLockContentions", numStripeLockContentions);
         return builder.obj();
     }
 } bucketCatalogServerStatus;
@@ -65,6 +65,16 @@ public:
         boost::optional<OID> electionId;
     };
 
+    /**
+     * Information of a bucket that has been closed, i.e. is full and has had all of its
+     * measurements committed, so that it will not be written to by the catalog again.
+     */
+    struct ClosedBucket {
+        OID bucketId;
+        std::string timeField;
+    };
+    using ClosedBuckets = std::vector<ClosedBucket>;
+
     /**
      * The basic unit of work for a bucket. Each insert will return a shared_ptr to a WriteBatch.
      * When a writer is finished with all their insertions, they should then take steps to ensure
@@ -149,6 +159,11 @@ public:
 
 
         Bucket* _bucket;
+
+        // The catalog stripe owning '_bucket'. Recorded separately so that the bucket can be looked
+        // up safely after it may have been removed from the catalog.
+        std::size_t _stripe;
+
         OperationId _opId;
         std::shared_ptr<ExecutionStats> _stats;
 
@@ -157,6 +172,7 @@ public:
         BSONObj _max;  // Batch-local max; full if first batch, updates otherwise.
         uint32_t _numPreviouslyCommittedMeasurements = 0;
         StringMap<std::size_t> _newFieldNamesToBeInserted;  // Value is hash of string key
+        ClosedBuckets _closedBuckets;  // Buckets closed while adding measurements to the batch.
 
         bool _active = true;
 
@@ -173,14 +189,14 @@ public:
     BucketCatalog operator=(const BucketCatalog&) = delete;
 
     /**
-     * Returns the metadata for the given bucket in the following format:
+     * Returns the metadata for the bucket of the given batch in the following format:
      *     {<metadata field name>: <value>}
      * All measurements in the given bucket share same metadata value.
      *
      * Returns an empty document if the given bucket cannot be found or if this time-series
      * collection was not created with a metadata field name.
      */
-    BSONObj getMetadata(Bucket* bucket) const;
+    BSONObj getMetadata(const std::shared_ptr<WriteBatch>& batch) const;
 
     /**
      * Returns the WriteBatch into which the document was inserted. Any caller who receives the same
@@ -204,9 +220,10 @@ public:
 
     /**
      * Records the result of a batch commit. Caller must already have commit rights on batch, and
-     * batch must have been previously prepared.
+     * batch must have been previously prepared. Returns the buckets that were closed by this
+     * commit or by the inserts that make up the batch.
      */
-    void finish(std::shared_ptr<WriteBatch> batch, const CommitInfo& info);
+    ClosedBuckets finish(std::shared_ptr<WriteBatch> batch, const CommitInfo& info);
 
     /**
      * Aborts the given write batch and any other outstanding batches on the same bucket. Caller
@@ -378,6 +395,12 @@ public:
         // The namespace that this bucket is used for.
         NamespaceString _ns;
 
+        // The catalog stripe this bucket belongs to.
+        std::size_t _stripe = 0;
+
+        // The time field name of the time-series collection this bucket is used for.
+        std::string _timeField;
+
         // The metadata of the data that this bucket contains.
         BucketMetadata _metadata;
 
@@ -417,7 +440,7 @@ public:
         // Batches, per operation, that haven't been committed or aborted yet.
         stdx::unordered_map<OperationId, std::shared_ptr<WriteBatch>> _batches;
 
-        // If the bucket is in _idleBuckets, then its position is recorded here.
+        // If the bucket is in its stripe's idle list, then its position is recorded here.
         boost::optional<IdleList::iterator> _idleListEntry = boost::none;
 
         // Approximate memory usage of this bucket.
@@ -552,6 +575,7 @@ private:
                      const Date_t& time);
         BucketAccess(BucketCatalog* catalog,
                      Bucket* bucket,
+                     std::size_t stripe,
                      boost::optional<BucketState> targetState = boost::none);
         ~BucketAccess();
 
@@ -567,26 +591,27 @@ private:
          * Close the existing, full bucket and open a new one for the same metadata.
          * Parameter is a function which should check that the bucket is indeed still full after
          * reacquiring the necessary locks. The first parameter will give the function access to
-         * this BucketAccess instance, with the bucket locked.
+         * this BucketAccess instance, with the bucket locked. If the existing bucket could be
+         * removed from the catalog right away, it is added to 'closedBuckets'.
          */
-        void rollover(const std::function<bool(BucketAccess*)>& isBucketFull);
+        void rollover(const std::function<bool(BucketAccess*)>& isBucketFull,
+                      ClosedBuckets* closedBuckets);
 
         // Retrieve the time associated with the bucket (id)
         Date_t getTime() const;
 
     private:
         /**
-         * Helper to find and lock an open bucket for the given metadata if it exists. Takes a
-         * shared lock on the catalog. Returns the state of the bucket if it is locked and usable.
+         * Helper to find and lock an open bucket for the given metadata if it exists. Takes the
+         * lock on the stripe. Returns the state of the bucket if it is locked and usable.
          * In case the bucket does not exist or was previously cleared and thus is not usable, the
          * return value will be BucketState::kCleared.
          */
         BucketState _findOpenBucketThenLock(const HashedBucketKey& key);
 
         /**
-         * Same as _findOpenBucketThenLock above but takes an exclusive lock on the catalog. In
-         * addition to finding the bucket it also store a non-normalized key if there are available
-         * slots in the bucket.
+         * Same as _findOpenBucketThenLock above. In addition to finding the bucket it also store a
+         * non-normalized key if there are available slots in the bucket.
          */
         BucketState _findOpenBucketThenLockAndStoreKey(const HashedBucketKey& normalizedKey,
                                                        const HashedBucketKey& key,
@@ -600,7 +625,7 @@ private:
         BucketState _confirmStateForAcquiredBucket();
 
         // Helper to find an open bucket for the given metadata if it exists, create it if it
-        // doesn't, and lock it. Requires an exclusive lock on the catalog.
+        // doesn't, and lock it. Requires the lock on the stripe.
         void _findOrCreateOpenBucketThenLock(const HashedBucketKey& normalizedKey,
                                              const HashedBucketKey& key);
 
@@ -614,6 +639,7 @@ private:
                      bool openedDuetoMetadata = true);
 
         BucketCatalog* _catalog;
+        std::size_t _stripe = 0;
         BucketKey* _key = nullptr;
         const TimeseriesOptions* _options = nullptr;
         ExecutionStats* _stats = nullptr;
@@ -623,15 +649,61 @@ private:
         stdx::unique_lock<Mutex> _guard;
     };
 
+    /**
+     * The buckets of the catalog are partitioned into stripes by the hash of their namespace and
+     * metadata, so that inserts into different series rarely contend on the same lock.
+     *
+     * You must hold 'mutex' when accessing 'allBuckets' or 'openBuckets' of a stripe. While holding
+     * it, you can take a lock on an individual bucket of the stripe, then release 'mutex'. Any
+     * iterators on the protected structures should be considered invalid once the lock is
+     * released. You must *not* be holding a lock on a bucket when you attempt to acquire 'mutex',
+     * as this can result in deadlock. No thread ever waits for the lock of a stripe while holding
+     * the lock of another: expiring idle buckets only try-locks the other stripes.
+     *
+     * Typically, if you want to acquire a bucket, you should use the BucketAccess RAII class to do
+     * so, as it will take care of most of this logic for you. Only use the stripe lock directly for
+     * maintenance where you want to interact with multiple buckets of the stripe atomically.
+     */
+    struct Stripe {
+        mutable Mutex mutex = MONGO_MAKE_LATCH("BucketCatalog::Stripe::mutex");
+
+        // All buckets of the stripe, including buckets which are full but not yet committed.
+        stdx::unordered_set<std::unique_ptr<Bucket>> allBuckets;
+
+        // The current open bucket for each namespace and metadata pair of the stripe.
+        stdx::unordered_map<BucketKey, Bucket*, BucketHasher, BucketEq> openBuckets;
+
+        // This mutex protects access to 'idleBuckets'.
+        mutable Mutex idleMutex = MONGO_MAKE_LATCH("BucketCatalog::Stripe::idleMutex");
+
+        // Buckets of the stripe that do not have any writers.
+        IdleList idleBuckets;
+
+        // Number of acquisitions of 'mutex', and how many of them had to wait for another thread.
+        mutable AtomicWord<long long> numLockAcquisitions;
+        mutable AtomicWord<long long> numLockContentions;
+    };
+
+    static constexpr std::size_t kNumberOfStripes = 32;
+
     class ServerStatus;
 
-    StripedMutex::SharedLock _lockShared() const;
-    StripedMutex::ExclusiveLock _lockExclusive() const;
+    /**
+     * Returns the stripe owning the buckets for the given key. The stripe does not depend on the
+     * field order of the metadata, so normalized and non-normalized keys map to the same stripe.
+     */
+    static std::size_t _getStripeNumber(const BucketKey& key);
+
+    /**
+     * Locks the given stripe, recording whether the lock was contended.
+     */
+    stdx::unique_lock<Mutex> _lockStripe(std::size_t stripe) const;
 
     void _waitToCommitBatch(const std::shared_ptr<WriteBatch>& batch);
 
     /**
-     * Removes the given bucket from the bucket catalog's internal data structures.
+     * Removes the given bucket from the bucket catalog's internal data structures. Requires the
+     * lock on the bucket's stripe.
      */
     bool _removeBucket(Bucket* bucket, bool expiringBuckets);
 
@@ -657,25 +729,36 @@ private:
 
     /**
      * Remove the bucket from the list of idle buckets. The second parameter encodes whether the
-     * caller holds a lock on _idleMutex.
+     * caller holds a lock on the idle mutex of the bucket's stripe.
      */
     void _markBucketNotIdle(Bucket* bucket, bool locked);
 
     /**
-     * Verify the bucket is currently unused by taking a lock on it. Must hold exclusive lock from
-     * the outside for the result to be meaningful.
+     * Verify the bucket is currently unused by taking a lock on it. Must hold the lock on the
+     * bucket's stripe from the outside for the result to be meaningful.
      */
     void _verifyBucketIsUnused(Bucket* bucket) const;
 
     /**
-     * Expires idle buckets until the bucket catalog's memory usage is below the expiry threshold.
+     * Expires idle buckets until the bucket catalog's memory usage is below the expiry threshold,
+     * starting with those of the given stripe and moving on to the other stripes which are not
+     * locked by another thread. Requires the lock on the given stripe.
+     */
+    void _expireIdleBuckets(std::size_t stripe, ExecutionStats* stats);
+
+    /**
+     * Expires idle buckets of the given stripe until the bucket catalog's memory usage is below the
+     * expiry threshold. Requires the lock on the stripe.
      */
-    void _expireIdleBuckets(ExecutionStats* stats);
+    void _expireIdleBucketsOfStripe(std::size_t stripe, ExecutionStats* stats);
+
+    bool _memoryUsageAboveIdleBucketExpiryThreshold() const;
 
     std::size_t _numberOfIdleBuckets() const;
 
-    // Allocate a new bucket (and ID) and add it to the catalog
-    Bucket* _allocateBucket(const BucketKey& key,
+    // Allocate a new bucket (and ID) and add it to the given stripe of the catalog
+    Bucket* _allocateBucket(std::size_t stripe,
+                            const BucketKey& key,
                             const Date_t& time,
                             const TimeseriesOptions& options,
                             ExecutionStats* stats,
@@ -696,40 +779,12 @@ private:
      */
     boost::optional<BucketState> _setBucketState(const OID& id, BucketState target);
 
-    /**
-     * You must hold a lock on _bucketMutex when accessing _allBuckets or _openBuckets.
-     * While holding a lock on _bucketMutex, you can take a lock on an individual bucket, then
-     * release _bucketMutex. Any iterators on the protected structures should be considered invalid
-     * once the lock is released. Any subsequent access to the structures requires relocking
-     * _bucketMutex. You must *not* be holding a lock on a bucket when you attempt to acquire the
-     * lock on _mutex, as this can result in deadlock.
-     *
-     * The StripedMutex class has both shared (read-only) and exclusive (write) locks. If you are
-     * going to write to any of the protected structures, you must hold an exclusive lock.
-     *
-     * Typically, if you want to acquire a bucket, you should use the BucketAccess RAII
-     * class to do so, as it will take care of most of this logic for you. Only use the _bucketMutex
-     * directly for more global maintenance where you want to take the lock once and interact with
-     * multiple buckets atomically.
-     */
-    mutable StripedMutex _bucketMutex;
-
-    // All buckets currently in the catalog, including buckets which are full but not yet committed.
-    stdx::unordered_set<std::unique_ptr<Bucket>> _allBuckets;
-
-    // The current open bucket for each namespace and metadata pair.
-    stdx::unordered_map<BucketKey, Bucket*, BucketHasher, BucketEq> _openBuckets;
+    std::array<Stripe, kNumberOfStripes> _stripes;
 
     // Bucket state
     mutable Mutex _statesMutex = MONGO_MAKE_LATCH("BucketCatalog::_statesMutex");
     stdx::unordered_map<OID, BucketState, OID::Hasher> _bucketStates;
 
-    // This mutex protects access to _idleBuckets
-    mutable Mutex _idleMutex = MONGO_MAKE_LATCH("BucketCatalog::_idleMutex");
-
-    // Buckets that do not have any writers.
-    IdleList _idleBuckets;
-
     /**
      * This mutex protects access to the _executionStats map. Once you complete your lookup, you
      * can keep the shared_ptr to an individual namespace's stats object and release the lock. The
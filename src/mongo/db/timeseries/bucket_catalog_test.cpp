@@ -35,6 +35,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/timeseries/bucket_catalog.h"
 #include "mongo/db/views/view_catalog.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/stdx/future.h"
 #include "mongo/unittest/bson_test_util.h"
 #include "mongo/unittest/death_test.h"
@@ -235,9 +236,8 @@ TEST_F(BucketCatalogTest, GetMetadataReturnsEmptyDocOnMissingBucket) {
                               BucketCatalog::CombineWithInsertsFromOtherClients::kAllow)
                      .getValue();
     ASSERT(batch->claimCommitRights());
-    auto bucket = batch->bucket();
     _bucketCatalog->abort(batch);
-    ASSERT_BSONOBJ_EQ(BSONObj(), _bucketCatalog->getMetadata(bucket));
+    ASSERT_BSONOBJ_EQ(BSONObj(), _bucketCatalog->getMetadata(batch));
 }
 
 TEST_F(BucketCatalogTest, InsertIntoDifferentBuckets) {
@@ -270,10 +270,10 @@ TEST_F(BucketCatalogTest, InsertIntoDifferentBuckets) {
 
     // Check metadata in buckets.
     ASSERT_BSONOBJ_EQ(BSON(_metaField << "123"),
-                      _bucketCatalog->getMetadata(result1.getValue()->bucket()));
+                      _bucketCatalog->getMetadata(result1.getValue()));
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSONObj()),
-                      _bucketCatalog->getMetadata(result2.getValue()->bucket()));
-    ASSERT(_bucketCatalog->getMetadata(result3.getValue()->bucket()).isEmpty());
+                      _bucketCatalog->getMetadata(result2.getValue()));
+    ASSERT(_bucketCatalog->getMetadata(result3.getValue()).isEmpty());
 
     // Committing one bucket should only return the one document in that bucket and should not
     // affect the other bucket.
@@ -302,9 +302,9 @@ TEST_F(BucketCatalogTest, InsertIntoSameBucketArray) {
 
     // Check metadata in buckets.
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSON_ARRAY(BSON("a" << 0 << "b" << 1))),
-                      _bucketCatalog->getMetadata(result1.getValue()->bucket()));
+                      _bucketCatalog->getMetadata(result1.getValue()));
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSON_ARRAY(BSON("a" << 0 << "b" << 1))),
-                      _bucketCatalog->getMetadata(result2.getValue()->bucket()));
+                      _bucketCatalog->getMetadata(result2.getValue()));
 }
 
 TEST_F(BucketCatalogTest, InsertIntoSameBucketObjArray) {
@@ -333,11 +333,11 @@ TEST_F(BucketCatalogTest, InsertIntoSameBucketObjArray) {
     ASSERT_BSONOBJ_EQ(
         BSON(_metaField << BSONObj(BSON(
                  "c" << BSON_ARRAY(BSON("a" << 0 << "b" << 1) << BSON("f" << 1 << "g" << 0))))),
-        _bucketCatalog->getMetadata(result1.getValue()->bucket()));
+        _bucketCatalog->getMetadata(result1.getValue()));
     ASSERT_BSONOBJ_EQ(
         BSON(_metaField << BSONObj(BSON(
                  "c" << BSON_ARRAY(BSON("a" << 0 << "b" << 1) << BSON("f" << 1 << "g" << 0))))),
-        _bucketCatalog->getMetadata(result2.getValue()->bucket()));
+        _bucketCatalog->getMetadata(result2.getValue()));
 }
 
 
@@ -369,11 +369,11 @@ TEST_F(BucketCatalogTest, InsertIntoSameBucketNestedArray) {
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSONObj(BSON("c" << BSON_ARRAY(BSON("a" << 0 << "b" << 1)
                                                                         << BSON_ARRAY("123"
                                                                                       << "456"))))),
-                      _bucketCatalog->getMetadata(result1.getValue()->bucket()));
+                      _bucketCatalog->getMetadata(result1.getValue()));
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSONObj(BSON("c" << BSON_ARRAY(BSON("a" << 0 << "b" << 1)
                                                                         << BSON_ARRAY("123"
                                                                                       << "456"))))),
-                      _bucketCatalog->getMetadata(result2.getValue()->bucket()));
+                      _bucketCatalog->getMetadata(result2.getValue()));
 }
 
 TEST_F(BucketCatalogTest, InsertNullAndMissingMetaFieldIntoDifferentBuckets) {
@@ -397,8 +397,8 @@ TEST_F(BucketCatalogTest, InsertNullAndMissingMetaFieldIntoDifferentBuckets) {
 
     // Check metadata in buckets.
     ASSERT_BSONOBJ_EQ(BSON(_metaField << BSONNULL),
-                      _bucketCatalog->getMetadata(result1.getValue()->bucket()));
-    ASSERT(_bucketCatalog->getMetadata(result2.getValue()->bucket()).isEmpty());
+                      _bucketCatalog->getMetadata(result1.getValue()));
+    ASSERT(_bucketCatalog->getMetadata(result2.getValue()).isEmpty());
 
     // Committing one bucket should only return the one document in that bucket and should not
     // affect the other bucket.
@@ -436,6 +436,77 @@ TEST_F(BucketCatalogTest, ClearDatabaseBuckets) {
     _insertOneAndCommit(_ns3, 1);
 }
 
+TEST_F(BucketCatalogTest, ClearNamespaceBucketsAcrossStripes) {
+    // Different metadata values are spread over the stripes of the catalog.
+    std::vector<std::shared_ptr<BucketCatalog::WriteBatch>> batches;
+    for (int i = 0; i < 100; ++i) {
+        auto result = _bucketCatalog->insert(
+            _opCtx,
+            _ns1,
+            _getCollator(_ns1),
+            _getTimeseriesOptions(_ns1),
+            BSON(_timeField << Date_t::now() << _metaField << BSON("a" << i << "b" << -i)),
+            BucketCatalog::CombineWithInsertsFromOtherClients::kAllow);
+        ASSERT_OK(result.getStatus());
+        batches.push_back(result.getValue());
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_BSONOBJ_EQ(BSON(_metaField << BSON("a" << i << "b" << -i)),
+                          _bucketCatalog->getMetadata(batches[i]));
+    }
+
+    _bucketCatalog->clear(_ns1);
+
+    for (const auto& batch : batches) {
+        ASSERT(batch->finished());
+        ASSERT_EQ(batch->getResult().getStatus(), ErrorCodes::TimeseriesBucketCleared);
+    }
+}
+
+TEST_F(BucketCatalogTest, ExpireIdleBucketsAcrossStripes) {
+    // Leave idle buckets spread over the stripes of the catalog.
+    for (int i = 0; i < 100; ++i) {
+        auto result = _bucketCatalog->insert(
+            _opCtx,
+            _ns1,
+            _getCollator(_ns1),
+            _getTimeseriesOptions(_ns1),
+            BSON(_timeField << Date_t::now() << _metaField << BSON("a" << i << "b" << -i)),
+            BucketCatalog::CombineWithInsertsFromOtherClients::kAllow);
+        ASSERT_OK(result.getStatus());
+        _commit(result.getValue(), 0);
+    }
+
+    // Opening a bucket above the memory threshold closes every idle bucket, not only those of the
+    // stripe the new bucket is allocated on.
+    RAIIServerParameterControllerForTest memoryThreshold(
+        "timeseriesIdleBucketExpiryMemoryUsageThreshold", 1);
+    auto result = _bucketCatalog->insert(_opCtx,
+                                         _ns2,
+                                         _getCollator(_ns2),
+                                         _getTimeseriesOptions(_ns2),
+                                         BSON(_timeField << Date_t::now()),
+                                         BucketCatalog::CombineWithInsertsFromOtherClients::kAllow);
+    ASSERT_OK(result.getStatus());
+    _commit(result.getValue(), 0);
+
+    BSONObjBuilder builder;
+    _bucketCatalog->appendExecutionStats(_ns2, &builder);
+    ASSERT_EQ(100, builder.obj().getIntField("numBucketsClosedDueToMemoryThreshold"));
+
+    // The measurements of the first namespace now go to new buckets.
+    result = _bucketCatalog->insert(
+        _opCtx,
+        _ns1,
+        _getCollator(_ns1),
+        _getTimeseriesOptions(_ns1),
+        BSON(_timeField << Date_t::now() << _metaField << BSON("a" << 0 << "b" << 0)),
+        BucketCatalog::CombineWithInsertsFromOtherClients::kAllow);
+    ASSERT_OK(result.getStatus());
+    _commit(result.getValue(), 0);
+}
+
 TEST_F(BucketCatalogTest, InsertBetweenPrepareAndFinish) {
     auto batch1 = _bucketCatalog
                       ->insert(_opCtx,
@@ -501,7 +572,7 @@ TEST_F(BucketCatalogWithoutMetadataTest, GetMetadataReturnsEmptyDoc) {
                               BucketCatalog::CombineWithInsertsFromOtherClients::kAllow)
                      .getValue();
 
-    ASSERT_BSONOBJ_EQ(BSONObj(), _bucketCatalog->getMetadata(batch->bucket()));
+    ASSERT_BSONOBJ_EQ(BSONObj(), _bucketCatalog->getMetadata(batch));
 
     _commit(batch, 0);
 }
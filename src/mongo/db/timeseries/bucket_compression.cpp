@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_compression.h"
+
+#include "mongo/base/parse_number.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/bsoncolumn.h"
+#include "mongo/db/timeseries/timeseries_constants.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/decimal_counter.h"
+
+namespace mongo::timeseries {
+namespace {
+
+/**
+ * Returns the position of 'elem' in its column, or boost::none if its field name is not a
+ * decimal row index below 'numMeasurements'.
+ */
+boost::optional<uint32_t> rowIndex(const BSONElement& elem, uint32_t numMeasurements) {
+    uint32_t index;
+    if (!NumberParser{}(elem.fieldNameStringData(), &index).isOK() || index >= numMeasurements) {
+        return boost::none;
+    }
+    return index;
+}
+
+}  // namespace
+
+boost::optional<BSONObj> compressBucket(const BSONObj& bucketDoc, StringData timeFieldName) {
+    if (isCompressedBucket(bucketDoc)) {
+        return boost::none;
+    }
+
+    BSONElement dataElem = bucketDoc[kBucketDataFieldName];
+    if (dataElem.type() != Object) {
+        return boost::none;
+    }
+    BSONObj data = dataElem.Obj();
+
+    BSONElement timeColumnElem = data[timeFieldName];
+    if (timeColumnElem.type() != Object) {
+        return boost::none;
+    }
+
+    // The time column is dense: every measurement has a time value, stored under consecutive
+    // decimal indexes.
+    std::vector<std::pair<Date_t, uint32_t>> times;
+    {
+        DecimalCounter<uint32_t> expectedIndex;
+        for (auto&& elem : timeColumnElem.Obj()) {
+            if (elem.type() != Date || elem.fieldNameStringData() != StringData(expectedIndex)) {
+                LOGV2_DEBUG(6179020,
+                            1,
+                            "Skipping compression of time-series bucket with unexpected time "
+                            "column",
+                            "bucketId"_attr = bucketDoc[kBucketIdFieldName]);
+                return boost::none;
+            }
+            times.emplace_back(elem.date(), times.size());
+            ++expectedIndex;
+        }
+    }
+    const uint32_t numMeasurements = times.size();
+
+    std::stable_sort(times.begin(), times.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    BSONObjBuilder builder;
+    for (auto&& elem : bucketDoc) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kBucketControlFieldName && elem.type() == Object) {
+            BSONObjBuilder controlBuilder(builder.subobjStart(kBucketControlFieldName));
+            for (auto&& controlElem : elem.Obj()) {
+                if (controlElem.fieldNameStringData() == kBucketControlVersionFieldName) {
+                    controlBuilder.append(kBucketControlVersionFieldName,
+                                          kTimeseriesControlCompressedVersion);
+                } else {
+                    controlBuilder.append(controlElem);
+                }
+            }
+            continue;
+        }
+
+        if (fieldName != kBucketDataFieldName) {
+            builder.append(elem);
+            continue;
+        }
+
+        BSONObjBuilder dataBuilder(builder.subobjStart(kBucketDataFieldName));
+        std::vector<BSONElement> rows(numMeasurements);
+        for (auto&& column : data) {
+            if (column.type() != Object) {
+                return boost::none;
+            }
+
+            std::fill(rows.begin(), rows.end(), BSONElement());
+            for (auto&& value : column.Obj()) {
+                auto index = rowIndex(value, numMeasurements);
+                if (!index || rows[*index]) {
+                    return boost::none;
+                }
+                rows[*index] = value;
+            }
+
+            BSONColumnBuilder columnBuilder(column.fieldNameStringData());
+            for (auto&& [_, index] : times) {
+                if (rows[index]) {
+                    columnBuilder.append(rows[index]);
+                } else {
+                    columnBuilder.skip();
+                }
+            }
+            dataBuilder.append(columnBuilder.fieldName(), columnBuilder.finalize());
+        }
+    }
+
+    return builder.obj();
+}
+
+bool isCompressedBucket(const BSONObj& bucketDoc) {
+    BSONElement controlElem = bucketDoc[kBucketControlFieldName];
+    return controlElem.type() == Object &&
+        controlElem.Obj()[kBucketControlVersionFieldName].numberInt() ==
+        kTimeseriesControlCompressedVersion;
+}
+
+}  // namespace mongo::timeseries
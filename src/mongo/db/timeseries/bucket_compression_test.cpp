@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/bson/util/bsoncolumn.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+#include "mongo/db/timeseries/timeseries_constants.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::timeseries {
+namespace {
+
+const BSONObj kBucket = fromjson(R"({
+    _id: {$oid: "630ea4802d5dbcaf3cf9bb3a"},
+    control: {version: 1,
+              min: {time: {$date: "2021-07-01T00:00:00Z"}, a: 1},
+              max: {time: {$date: "2021-07-01T00:00:03Z"}, a: 3}},
+    meta: "sensor",
+    data: {time: {"0": {$date: "2021-07-01T00:00:02Z"},
+                  "1": {$date: "2021-07-01T00:00:00Z"},
+                  "2": {$date: "2021-07-01T00:00:03Z"},
+                  "3": {$date: "2021-07-01T00:00:01Z"}},
+           a: {"0": 3, "1": 1, "3": 2},
+           b: {"2": "x"}}
+})");
+
+TEST(BucketCompression, CompressesAndSortsByTime) {
+    auto compressed = compressBucket(kBucket, "time"_sd);
+    ASSERT(compressed);
+    ASSERT(isCompressedBucket(*compressed));
+    ASSERT_FALSE(isCompressedBucket(kBucket));
+
+    ASSERT_BSONOBJ_EQ((*compressed)["_id"].wrap(), kBucket["_id"].wrap());
+    ASSERT_BSONOBJ_EQ((*compressed)["meta"].wrap(), kBucket["meta"].wrap());
+    ASSERT_EQ((*compressed)["control"]["version"].numberInt(),
+              kTimeseriesControlCompressedVersion);
+    ASSERT_BSONOBJ_EQ((*compressed)["control"]["min"].Obj(), kBucket["control"]["min"].Obj());
+
+    auto data = (*compressed)["data"].Obj();
+    ASSERT_BSONOBJ_EQ(BSONColumn(data["time"]).decompress(), fromjson(R"({
+                          "0": {$date: "2021-07-01T00:00:00Z"},
+                          "1": {$date: "2021-07-01T00:00:01Z"},
+                          "2": {$date: "2021-07-01T00:00:02Z"},
+                          "3": {$date: "2021-07-01T00:00:03Z"}})"));
+    ASSERT_BSONOBJ_EQ(BSONColumn(data["a"]).decompress(), fromjson(R"({"0": 1, "1": 2, "2": 3})"));
+    ASSERT_BSONOBJ_EQ(BSONColumn(data["b"]).decompress(), fromjson(R"({"3": "x"})"));
+    ASSERT_EQ(BSONColumn(data["b"]).size(), 4);
+}
+
+TEST(BucketCompression, AlreadyCompressedBucketIsNotRecompressed) {
+    auto compressed = compressBucket(kBucket, "time"_sd);
+    ASSERT(compressed);
+    ASSERT_FALSE(compressBucket(*compressed, "time"_sd));
+}
+
+TEST(BucketCompression, MalformedBucketsAreNotCompressed) {
+    // Missing time column.
+    ASSERT_FALSE(compressBucket(kBucket, "t"_sd));
+
+    // Non-contiguous time column.
+    ASSERT_FALSE(compressBucket(fromjson(R"({control: {version: 1},
+        data: {time: {"0": {$date: "2021-07-01T00:00:00Z"},
+                      "2": {$date: "2021-07-01T00:00:01Z"}}}})"),
+                                "time"_sd));
+
+    // Data field with a row index beyond the number of measurements.
+    ASSERT_FALSE(compressBucket(fromjson(R"({control: {version: 1},
+        data: {time: {"0": {$date: "2021-07-01T00:00:00Z"}}, a: {"1": 1}}})"),
+                                "time"_sd));
+}
+
+}  // namespace
+}  // namespace mongo::timeseries
@@ -159,6 +159,26 @@ std::unique_ptr<mongo::DBClientCursor> MockDBClientConnection::query(
             resultsInCursor = BSONArray(result.copy());
         }
 
+        // A simple mock implementation of index bounds on _id, where we only return the documents
+        // with an _id in the range [$min, $max).
+        if (queryBson.hasField("$min") || queryBson.hasField("$max")) {
+            auto inBounds = [&](const BSONElement& id) {
+                if (queryBson.hasField("$min") &&
+                    id.woCompare(queryBson["$min"].Obj().firstElement(), false) < 0) {
+                    return false;
+                }
+                return !queryBson.hasField("$max") ||
+                    id.woCompare(queryBson["$max"].Obj().firstElement(), false) < 0;
+            };
+            BSONArrayBuilder builder;
+            for (auto&& elem : resultsInCursor) {
+                if (inBounds(elem.Obj()["_id"])) {
+                    builder.append(elem.Obj());
+                }
+            }
+            resultsInCursor = BSONArray(builder.obj());
+        }
+
         std::unique_ptr<mongo::DBClientCursor> cursor;
         cursor.reset(new DBClientMockCursor(
             this, BSONArray(resultsInCursor), provideResumeToken, batchSize));